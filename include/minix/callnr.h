@@ -1,4 +1,4 @@
-#define NCALLS		  77	/* number of system calls allowed */
+#define NCALLS		  79	/* number of system calls allowed */
 
 #define EXIT		   1 
 #define FORK		   2 
@@ -64,3 +64,5 @@
 #define SIGRETURN	  75
 
 #define REBOOT		  76
+#define KTRACE		  77
+#define PROFIL		  78
@@ -41,6 +41,8 @@
 #	define DL_INIT		7
 #	define DL_STOP		8
 #	define DL_GETSTAT	9
+#	define DL_READMV	10	/* read several frames in one go */
+#	define DL_WRITEMV	11	/* write several frames in one go */
 
 /* Message type for data link layer replies. */
 #	define DL_INIT_REPLY	20
@@ -52,6 +54,7 @@
 #	define DL_MODE		m2_l1
 #	define DL_CLCK		m2_l2
 #	define DL_ADDR		m2_p1
+#	define DL_STRIDE	m2_l1	/* iovec entries per frame (DL_*MV) */
 #	define DL_STAT		m2_l1
 
 /* Bits in 'DL_STAT' field of DL replies. */
@@ -138,6 +141,19 @@
 #	define SYS_SIGRETURN 18	/* fcn code for sys_sigreturn(&sigmsg) */
 #	define SYS_ENDSIG    19	/* fcn code for sys_endsig(procno) */
 #	define SYS_GETMAP    20	/* fcn code for sys_getmap(procno, map_ptr) */
+#	define SYS_KTRACE    21	/* fcn code for sys_ktrace(proc, req, buf, n) */
+#	define SYS_PROFIL    22	/* fcn code for sys_profil(proc, owner, ...) */
+
+/* Requests for SYS_KTRACE and for the KTRACE call to MM. */
+#define KTRACE_START	   0	/* empty the trace ring and start recording */
+#define KTRACE_STOP	   1	/* stop recording */
+#define KTRACE_READ	   2	/* stop, copy the events out oldest first */
+
+/* Who to profile with the PROFIL call to MM: a pid, the caller, or a server
+ * given by process number, e.g. PROF_SERVER(FS_PROC_NR).
+ */
+#define PROF_SELF	   0
+#define PROF_SERVER(n)	(-1 - (n))
 
 #define HARDWARE          -1	/* used as source on interrupt generated msgs*/
 
@@ -84,6 +84,12 @@
 /* DMA_SECTORS may be increased to speed up DMA based drivers. */
 #define DMA_SECTORS        1	/* DMA buffer size (must be >= 1) */
 
+/* TRACK_SECTORS is the size of the floppy track cache.  18 sectors hold a
+ * track of a 1.44M diskette, or a cylinder of a 720K one.  Use 0 to disable
+ * it, or at least 9.
+ */
+#define TRACK_SECTORS     18	/* floppy track cache size in sectors */
+
 /* Enable or disable networking code (TCP/IP task & drivers). */
 #define ENABLE_NETWORKING  0	/* enable TCP/IP code (main switch) */
 #define ENABLE_WDETH       0	/* enable Western Digital WD80x3 */
@@ -105,6 +111,24 @@
 #define	NR_RS_LINES	   0	/* # rs232 terminals (0, 1, or 2) */
 #define	NR_PTYS		   0	/* # pseudo terminals (0 to 64) */
 
+/* CONS_SHADOW_LINES is the number of new lines the console collects during
+ * a write before it scrolls them onto the screen in one go.  Use 0 to scroll
+ * line by line.
+ */
+#define CONS_SHADOW_LINES 25	/* console.c - lines of 80 chars batched */
+
+/* KTRACE_SIZE is the number of events the kernel trace ring holds, a power
+ * of two.  Interrupts, messages and process switches are recorded there
+ * while the ktrace(8) command has tracing turned on.  Use 0 to leave the
+ * trace code out.
+ */
+#define KTRACE_SIZE	 256	/* ktrace.c - 10 bytes per event */
+
+/* ENABLE_PROFILING lets the clock interrupt sample the program counter of
+ * processes profiled with profil(2), which the prof(1) command uses.
+ */
+#define ENABLE_PROFILING   1	/* clock.c - 10 bytes per process */
+
 #if (MACHINE == ATARI)
 /* The next define says if you have an ATARI ST or TT */
 #define ATARI_TYPE	  TT
@@ -20,7 +20,8 @@ typedef struct eth_stat
 	ets_fifoUnder,		/* # FIFO underruns (processor too busy) */
 	ets_fifoOver,		/* # FIFO overruns (processor too busy) */
 	ets_CDheartbeat,	/* # times unable to transmit collision sig*/
-	ets_OWC;		/* # times out of window collision */
+	ets_OWC,		/* # times out of window collision */
+	ets_sendqFull;		/* # sends that waited for a free buffer */
 } eth_stat_t;
 
 #endif /* _ETH_HW_H */
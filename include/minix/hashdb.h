@@ -0,0 +1,59 @@
+/* The <minix/hashdb.h> header describes the hashed databases that mkdb(8)
+ * makes of /etc/termcap, /etc/passwd and /etc/group, so that a name or a
+ * number is found with a few reads instead of by reading the whole text.
+ * A database "file.db" is only used while the text file has the same size
+ * and modification time as when the database was made.  Mkdb only reads a
+ * text file that was last changed before the current second, so an edit
+ * made later changes the modification time and the library goes back to
+ * the text file until mkdb is run again.  A change that sets the old time
+ * stamp back, like "cp -p" of a file of the same size, is not noticed.
+ *
+ * The file starts with a header, then h_ntab tables of h_nslot slots, then
+ * the records.  A key is looked up in the slot its hash selects, and the
+ * slots after that one until a free one.  A name hashes with _hdbhash(),
+ * a user or group id is its own hash.  A record holds an entry in the form
+ * of the text file, so the text parser can be used on it.
+ */
+
+#ifndef _HASHDB_H
+#define _HASHDB_H
+
+#ifndef _TYPES_H
+#include <sys/types.h>
+#endif
+
+#define HDB_MAGIC	0x4844	/* "HD", also tells the byte order */
+#define HDB_SUFFIX	".db"	/* added to the name of the text file */
+
+struct hdb_head {
+  unsigned short h_magic;	/* HDB_MAGIC */
+  unsigned short h_ntab;	/* number of tables */
+  unsigned short h_nslot;	/* slots per table, a power of two */
+  unsigned short h_nrec;	/* number of records */
+  time_t h_mtime;		/* modification time of the text file */
+  off_t h_size;			/* size of the text file */
+};
+
+struct hdb_slot {
+  off_t s_off;			/* offset of the record, 0 if free */
+  unsigned short s_len;		/* length of the record */
+  unsigned short s_hash;	/* hash of the key */
+};
+
+/* The tables of each database. */
+#define HDB_TCNAME	0	/* termcap: every name of a terminal */
+#define HDB_PWNAME	0	/* passwd: user name */
+#define HDB_PWUID	1	/* passwd: user id */
+#define HDB_GRNAME	0	/* group: group name */
+#define HDB_GRGID	1	/* group: group id */
+
+#ifndef _ANSI_H
+#include <ansi.h>
+#endif
+
+_PROTOTYPE( unsigned _hdbhash, (const char *_key, size_t _len)		);
+_PROTOTYPE( int _hdbfind, (const char *_file, int _tab, unsigned _hash,
+	int (*_match)(char *_rec, const void *_key), const void *_key,
+	char *_buf, size_t _size)					);
+
+#endif /* _HASHDB_H */
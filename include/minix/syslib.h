@@ -40,6 +40,10 @@ _PROTOTYPE( int sys_trace, (int _req, int _procnr, long _addr, long *_data_p));
 _PROTOTYPE( int sys_xit, (int _parent, int _proc, phys_clicks *_basep, 
 						 phys_clicks *_sizep));
 _PROTOTYPE( int sys_kill, (int _proc, int _sig)				);
+_PROTOTYPE( int sys_ktrace, (int _proc, int _req, char *_buf, long _count,
+						long *_total_p)		);
+_PROTOTYPE( int sys_profil, (int _proc, int _owner, char *_buf, long _size,
+					long _offset, unsigned _scale)	);
 _PROTOTYPE( int sys_times, (int _proc, clock_t _ptr[5])			);
 
 #endif /* _SYSLIB_H */
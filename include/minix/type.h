@@ -132,4 +132,47 @@ struct psinfo {		/* information for the ps(1) program */
   vir_bytes proc, mproc, fproc;	/* addresses of the main process tables. */
 };
 
+struct pstab {		/* a process in a snapshot of the process tables */
+  char ps_name[16];		/* task or program name */
+  char ps_state;		/* PS_RUN, PS_WAIT, etc., PS_FREE if unused */
+  char ps_ftask;		/* what FS suspended it on, fp_task */
+  int ps_flags;			/* kernel flags, p_flags */
+  unsigned ps_mflags;		/* MM flags, mp_flags */
+  int ps_recv;			/* process it wants to receive from, or ANY */
+  int ps_blocked;		/* process it is blocked on, or ANY */
+  pid_t ps_pid, ps_ppid, ps_pgrp;	/* process, parent and group ids */
+  uid_t ps_ruid, ps_euid;	/* real and effective user id */
+  dev_t ps_tty;			/* controlling tty */
+  clock_t ps_utime, ps_stime;	/* user and system time in ticks */
+  struct mem_map ps_map[NR_SEGS];	/* text, data and stack in clicks */
+  vir_bytes ps_procargs;	/* initial stack frame */
+};
+
+/* Process states in ps_state. */
+#define PS_FREE		 0	/* slot not in use */
+#define PS_RUN		'R'	/* runnable */
+#define PS_WAIT		'W'	/* a short wait for a task or server */
+#define PS_SLEEP	'S'	/* in wait(), pause(), or on a pipe or tty */
+#define PS_STOP		'T'	/* stopped by a tracer */
+#define PS_ZOMBIE	'Z'	/* exited, parent hasn't waited yet */
+
+struct ktrace {		/* an event in the kernel trace ring */
+  u16_t kt_ticks;		/* clock ticks since boot (low 16 bits) */
+  u16_t kt_count;		/* timer counts since that tick */
+  u8_t kt_event;		/* what happened, see below */
+  i8_t kt_proc;			/* process (or irq) the event is about */
+  i8_t kt_peer;			/* other side of a message */
+  u8_t kt_pad;
+  u16_t kt_type;		/* message type */
+};
+
+/* Kernel trace events. */
+#define KT_IRQ		   1	/* interrupt handler called for irq kt_proc */
+#define KT_IRQ_DONE	   2	/* interrupt handler returned */
+#define KT_SEND		   3	/* kt_proc sends to kt_peer */
+#define KT_RECEIVE	   4	/* kt_proc gets a message from kt_peer */
+#define KT_SWITCH	   5	/* kt_proc is chosen to run */
+#define KT_HOLD		   6	/* interrupt for task kt_proc held up */
+#define KT_UNHOLD	   7	/* held up interrupt replayed */
+
 #endif /* _MINIX_TYPE_H */
@@ -66,8 +66,10 @@ typedef struct eth_stat
 					   too busy) */
 		ets_CDheartbeat,	/* # times unable to transmit
 					   collision signal */
-		ets_OWC;		/* # times out of window
+		ets_OWC,		/* # times out of window
 					   collision */
+		ets_sendqFull;		/* # times a send had to wait
+					   for a free send buffer */
 } eth_stat_t;
 
 typedef struct nwio_ethstat
@@ -52,4 +52,18 @@ typedef struct nwio_ipopt
 #	define NWIO_RWDATONLY	0x00001000l
 #	define NWIO_RWDATALL	0x10000000l
 
+typedef struct nwio_arpstat
+{
+	u32_t nwas_hit;		/* lookups answered from the cache */
+	u32_t nwas_miss;	/* lookups that started a new request */
+	u32_t nwas_pending;	/* lookups of a request in progress */
+	u32_t nwas_unreach;	/* lookups of an unreachable host */
+	u32_t nwas_refresh;	/* entries refreshed before expiry */
+	u32_t nwas_expire;	/* entries that expired */
+	u32_t nwas_evict;	/* entries evicted to make room */
+	u32_t nwas_timeout;	/* requests that were never answered */
+	u16_t nwas_inuse;	/* entries in use by this port */
+	u16_t nwas_size;	/* size of the cache */
+} nwio_arpstat_t;
+
 #endif /* __SERVER__IP__GEN__IP_IO_H__ */
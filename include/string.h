@@ -49,6 +49,8 @@ _PROTOTYPE( int bcmp, (const void *_s1, const void *_s2, size_t _length));
 _PROTOTYPE( void bzero, (void *_dst, size_t _length)			);
 _PROTOTYPE( void *memccpy, (char *_dst, const char *_src, int _ucharstop,
 						    size_t _size)	);
+_PROTOTYPE( void *memmem, (const void *_hay, size_t _hlen,
+				const void *_pat, size_t _plen)		);
 /* BSD functions */
 _PROTOTYPE( int strcasecmp, (const char *_s1, const char *_s2)		);
 #endif
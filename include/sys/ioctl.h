@@ -47,6 +47,7 @@
 #define	TIOCGPGRP	_IOW('T', 18, int)
 #define	TIOCSPGRP	_IOW('T', 19, int)
 #define TIOCSFON	_IOW('T', 20, u8_t [8192])
+#define TIOCGSERSTAT	_IOR('T', 21, struct serstat)
 
 #define TIOCGETP	_IOR('t',  1, struct sgttyb)
 #define TIOCSETP	_IOW('t',  2, struct sgttyb)
@@ -63,6 +64,7 @@
 #define NWIOGIPCONF	_IOR('n', 33, struct nwio_ipconf)
 #define NWIOSIPOPT	_IOW('n', 34, struct nwio_ipopt)
 #define NWIOGIPOPT	_IOR('n', 35, struct nwio_ipopt)
+#define NWIOGIPARPSTAT	_IOR('n', 36, struct nwio_arpstat)
 
 #define NWIOGIPOROUTE	_IORW('n', 40, struct nwio_route)
 #define NWIOSIPOROUTE	_IOW ('n', 41, struct nwio_route)
@@ -91,6 +93,7 @@
 #define DIOCEJECT	_IO ('d', 5)
 #define DIOCSETP	_IOW('d', 6, struct partition)
 #define DIOCGETP	_IOR('d', 7, struct partition)
+#define DIOCFLUSH	_IO ('d', 8)
 
 /* Keyboard ioctls. */
 #define KIOCSMAP	_IOW('k', 3, keymap_t)
@@ -99,6 +102,7 @@
 #define MIOCRAMSIZE	_IOW('m', 3, u32_t)	/* Size of the ramdisk */
 #define MIOCSPSINFO	_IOW('m', 4, void *)
 #define MIOCGPSINFO	_IOR('m', 5, struct psinfo)
+#define MIOCGPSTAB	_IOR('m', 6, struct pstab)	/* nr_tasks+nr_procs */
 
 /* Magnetic tape ioctls. */
 #define MTIOCTOP	_IOW('M', 1, struct mtop)
@@ -202,6 +202,17 @@ struct winsize
 	unsigned short	ws_xpixel;	/* horizontal size, pixels */
 	unsigned short	ws_ypixel;	/* vertical size, pixels */
 };
+
+/* Serial line statistics (TIOCGSERSTAT). */
+struct serstat
+{
+	unsigned	ss_framing;	/* framing errors */
+	unsigned	ss_overrun;	/* UART overruns, characters lost */
+	unsigned	ss_parity;	/* parity errors */
+	unsigned	ss_break;	/* breaks received */
+	unsigned	ss_dropped;	/* input lost, driver buffer full */
+	unsigned	ss_fifo;	/* UART FIFO size, 1 if none */
+};
 #endif /* _MINIX */
 
 #endif /* _TERMIOS_H */
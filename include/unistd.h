@@ -148,6 +148,11 @@ _PROTOTYPE( char *sbrk, (int _incr)					);
 _PROTOTYPE( int sync, (void)						);
 _PROTOTYPE( int umount, (const char *_name)				);
 _PROTOTYPE( int reboot, (int _how, ...)					);
+_PROTOTYPE( int ktrace, (int _req, void *_buf, long _count, long *_total));
+_PROTOTYPE( int profil, (unsigned short *_buf, size_t _bufsiz,
+				size_t _offset, unsigned _scale)	);
+_PROTOTYPE( int pprofil, (int _who, unsigned short *_buf, size_t _bufsiz,
+				size_t _offset, unsigned _scale)	);
 _PROTOTYPE( int gethostname, (char *_hostname, size_t _len)		);
 _PROTOTYPE( int getdomainname, (char *_domain, size_t _len)		);
 _PROTOTYPE( int ttyslot, (void)						);
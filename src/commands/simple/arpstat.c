@@ -0,0 +1,118 @@
+/*
+arpstat.c
+
+Print the ARP cache statistics of an IP device.
+*/
+
+#include <sys/types.h>
+#include <sys/ioctl.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <net/netlib.h>
+#include <net/gen/in.h>
+#include <net/gen/ip_io.h>
+#include <net/gen/inet.h>
+
+char *prog_name;
+
+static void print_stat(char *name, unsigned long value, unsigned long total);
+static void usage(void);
+
+int main(int argc, char *argv[])
+{
+	nwio_arpstat_t arpstat;
+	nwio_ipconf_t ip_conf;
+	int ip_fd;
+	int result;
+	int c;
+	char *ip_device;
+	unsigned long lookups;
+
+	prog_name= argv[0];
+
+	ip_device= NULL;
+	while ((c =getopt(argc, argv, "?I:")) != -1)
+	{
+		switch(c)
+		{
+		case '?':
+			usage();
+		case 'I':
+			if (ip_device)
+				usage();
+			ip_device= optarg;
+			break;
+		default:
+			fprintf(stderr, "%s: getopt failed: '%c'\n",
+				prog_name, c);
+			exit(1);
+		}
+	}
+	if (optind != argc)
+		usage();
+
+	if (ip_device == NULL)
+		ip_device= getenv("IP_DEVICE");
+	if (ip_device == NULL)
+		ip_device= IP_DEVICE;
+
+	ip_fd= open(ip_device, O_RDWR);
+	if (ip_fd == -1)
+	{
+		fprintf(stderr, "%s: unable to open %s: %s\n", prog_name,
+			ip_device, strerror(errno));
+		exit(1);
+	}
+
+	result= ioctl(ip_fd, NWIOGIPCONF, &ip_conf);
+	if (result == -1)
+	{
+		fprintf(stderr, "%s: unable to NWIOGIPCONF: %s\n",
+			prog_name, strerror(errno));
+		exit(1);
+	}
+
+	result= ioctl(ip_fd, NWIOGIPARPSTAT, &arpstat);
+	if (result == -1)
+	{
+		fprintf(stderr, "%s: unable to NWIOGIPARPSTAT: %s\n",
+			prog_name, strerror(errno));
+		exit(1);
+	}
+
+	lookups= arpstat.nwas_hit + arpstat.nwas_miss +
+		arpstat.nwas_pending + arpstat.nwas_unreach;
+
+	printf("ARP cache of %s (%s): %u of %u entries in use\n",
+		ip_device, inet_ntoa(ip_conf.nwic_ipaddr),
+		arpstat.nwas_inuse, arpstat.nwas_size);
+	printf("%10lu lookups\n", lookups);
+	print_stat("hits", arpstat.nwas_hit, lookups);
+	print_stat("misses", arpstat.nwas_miss, lookups);
+	print_stat("waiting for a reply", arpstat.nwas_pending, lookups);
+	print_stat("unreachable", arpstat.nwas_unreach, lookups);
+	print_stat("refreshed before expiry", arpstat.nwas_refresh, 0);
+	print_stat("expired", arpstat.nwas_expire, 0);
+	print_stat("evicted", arpstat.nwas_evict, 0);
+	print_stat("requests timed out", arpstat.nwas_timeout, 0);
+	exit(0);
+}
+
+static void print_stat(char *name, unsigned long value, unsigned long total)
+{
+	printf("%10lu %s", value, name);
+	if (total != 0)
+		printf(" (%lu%%)", value * 100 / total);
+	printf("\n");
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "Usage: %s [ -I <ip-device> ]\n", prog_name);
+	exit(1);
+}
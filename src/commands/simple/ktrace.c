@@ -0,0 +1,333 @@
+/* ktrace - kernel trace
+ *
+ * Usage: ktrace [-d] [-n samples] [-s seconds] [command [arg ...]]
+ *
+ * Turn on the trace ring of the kernel, let it run for a while (or as long
+ * as the command takes), and read out the last events.  The events are
+ * turned into the time interrupt handlers take, the time from an interrupt
+ * until the task it woke up runs, and the rate of messages each process
+ * receives and sends.  With -n several samples are taken and added up.
+ * The -d flag dumps the events themselves.
+ */
+#define nil 0
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <minix/config.h>
+#include <minix/const.h>
+#include <minix/type.h>
+#include <minix/com.h>
+
+#define TIMER_FREQ	1193182L	/* clock frequency of the PC timer */
+#define TIMER_COUNT	((unsigned) (TIMER_FREQ / HZ))	/* counts per tick */
+#define NR_EVENTS	1024	/* never more than this many in the ring */
+#define NR_IRQS		  16
+#define NR_BUCKETS	  10	/* histogram buckets, 16 us and doubling */
+#define NR_SLOTS	(NR_TASKS + NR_PROCS)
+
+struct hist {
+	unsigned long	count;
+	unsigned long	sum;		/* in us */
+	unsigned long	max;
+	unsigned long	bucket[NR_BUCKETS];
+};
+
+struct hist handler[NR_IRQS];	/* time spent in the interrupt handler */
+struct hist wakeup[NR_IRQS];	/* interrupt until the task runs */
+
+struct slot {
+	unsigned long	received;
+	unsigned long	sent;
+	unsigned long	hardint;
+	unsigned long	switched;
+	int		wake_irq;	/* irq that woke this task, or -1 */
+	unsigned long	wake_time;	/* and when */
+} slot[NR_SLOTS];
+
+struct ktrace ev[NR_EVENTS];
+unsigned long span;		/* time covered by all samples, in counts */
+unsigned long nevents, nrecorded;
+int dflag;
+
+char *prog;
+
+void fatal(char *label)
+{
+	fprintf(stderr, "%s: %s: %s\n", prog, label, strerror(errno));
+	exit(1);
+}
+
+void usage(void)
+{
+	fprintf(stderr,
+	"Usage: %s [-d] [-n samples] [-s seconds] [command [arg ...]]\n",
+		prog);
+	exit(1);
+}
+
+char *procname(int p)
+/* The name of a task or server, or just the process number. */
+{
+	static char name[16];
+
+	if (p == HARDWARE) return "hardware";
+	if (p == SYSTASK) return "systask";
+	if (p == CLOCK) return "clock";
+	if (p == MEM) return "memory";
+	if (p == FLOPPY) return "floppy";
+	if (p == PRINTER) return "printer";
+	if (p == IDLE) return "idle";
+	if (p == SYN_ALRM_TASK) return "syn_alrm";
+#if ENABLE_WINI
+	if (p == WINCHESTER) return "winch";
+#endif
+#if ENABLE_NETWORKING
+	if (p == DL_ETH) return "dl_eth";
+#endif
+	if (p == TTY) return "tty";
+	if (p == MM_PROC_NR) return "mm";
+	if (p == FS_PROC_NR) return "fs";
+#if ENABLE_NETWORKING
+	if (p == INET_PROC_NR) return "inet";
+#endif
+	if (p == INIT_PROC_NR) return "init";
+	sprintf(name, p < 0 ? "task %d" : "proc %d", p);
+	return name;
+}
+
+struct slot *procslot(int p)
+{
+	if (p < -NR_TASKS || p >= NR_PROCS) return nil;
+	return &slot[p + NR_TASKS];
+}
+
+unsigned long us(unsigned long counts)
+/* Timer counts to microseconds. */
+{
+	return counts / 1193 * 1000 + counts % 1193 * 1000 / 1193;
+}
+
+void add(struct hist *hp, unsigned long counts)
+{
+	unsigned long t = us(counts);
+	unsigned long lim;
+	int b;
+
+	hp->count++;
+	hp->sum += t;
+	if (t > hp->max) hp->max = t;
+	for (b = 0, lim = 16; b < NR_BUCKETS-1 && t >= lim; b++) lim <<= 1;
+	hp->bucket[b]++;
+}
+
+void sample(int n, long recorded)
+/* Go through the events of one sample. */
+{
+	struct ktrace *kp;
+	struct slot *sp;
+	unsigned long t, prev, irq_time[NR_IRQS];
+	int irq_stack[NR_IRQS], depth;
+	unsigned t0;
+	int i;
+
+	nevents += n;
+	nrecorded += recorded;
+	if (n == 0) return;
+
+	t0 = ev[0].kt_ticks;
+	prev = 0;
+	depth = 0;
+
+	for (i = 0; i < n; i++) {
+		kp = &ev[i];
+
+		/* Time since the first event.  A tick that isn't counted yet
+		 * makes time go back, so correct for that.
+		 */
+		t = (unsigned long) (u16_t) (kp->kt_ticks - t0) * TIMER_COUNT
+							+ kp->kt_count;
+		if (t < prev) t += TIMER_COUNT;
+		prev = t;
+
+		if (dflag) {
+			printf("%10lu.%03lu ", us(t) / 1000, us(t) % 1000);
+		}
+
+		switch (kp->kt_event) {
+		case KT_IRQ:
+			if (dflag) printf("irq %d\n", kp->kt_proc);
+			if (kp->kt_proc < 0 || kp->kt_proc >= NR_IRQS) break;
+			irq_time[kp->kt_proc] = t;
+			if (depth < NR_IRQS) irq_stack[depth++] = kp->kt_proc;
+			break;
+		case KT_IRQ_DONE:
+			if (dflag) printf("irq %d done\n", kp->kt_proc);
+			if (depth == 0 || irq_stack[depth-1] != kp->kt_proc)
+				break;
+			depth--;
+			add(&handler[kp->kt_proc], t - irq_time[kp->kt_proc]);
+			break;
+		case KT_SEND:
+			if (dflag) printf("%s sends %d to %s\n",
+				procname(kp->kt_proc), kp->kt_type,
+				procname(kp->kt_peer));
+			if ((sp = procslot(kp->kt_proc)) != nil) sp->sent++;
+			break;
+		case KT_RECEIVE:
+			if (dflag) printf("%s receives %d from %s\n",
+				procname(kp->kt_proc), kp->kt_type,
+				procname(kp->kt_peer));
+			if ((sp = procslot(kp->kt_proc)) == nil) break;
+			if (kp->kt_peer != HARDWARE) {
+				sp->received++;
+				break;
+			}
+			sp->hardint++;
+			if (depth > 0) {
+				/* Woken up by the current interrupt. */
+				sp->wake_irq = irq_stack[depth-1];
+				sp->wake_time = irq_time[sp->wake_irq];
+			}
+			break;
+		case KT_SWITCH:
+			if (dflag) printf("run %s\n", procname(kp->kt_proc));
+			if ((sp = procslot(kp->kt_proc)) == nil) break;
+			sp->switched++;
+			if (sp->wake_irq >= 0) {
+				add(&wakeup[sp->wake_irq], t - sp->wake_time);
+				sp->wake_irq = -1;
+			}
+			break;
+		case KT_HOLD:
+			if (dflag) printf("hold interrupt for %s\n",
+				procname(kp->kt_proc));
+			break;
+		case KT_UNHOLD:
+			if (dflag) printf("replay interrupt for %s\n",
+				procname(kp->kt_proc));
+			break;
+		default:
+			if (dflag) printf("event %d?\n", kp->kt_event);
+		}
+	}
+	span += prev;
+
+	/* A wakeup that isn't followed by a switch is not counted. */
+	for (i = 0; i < NR_SLOTS; i++) slot[i].wake_irq = -1;
+}
+
+void print_hist(char *title, struct hist *hp)
+{
+	int irq, b;
+	unsigned long lim;
+
+	printf("%s (us)\nirq  count    avg    max", title);
+	for (b = 0, lim = 16; b < NR_BUCKETS-1; b++, lim <<= 1)
+		printf(" %5lu", lim);
+	printf("  more\n");
+
+	for (irq = 0; irq < NR_IRQS; irq++, hp++) {
+		if (hp->count == 0) continue;
+		printf("%3d %6lu %6lu %6lu", irq, hp->count,
+			hp->sum / hp->count, hp->max);
+		for (b = 0; b < NR_BUCKETS; b++) printf(" %5lu", hp->bucket[b]);
+		printf("\n");
+	}
+	printf("\n");
+}
+
+unsigned long rate(unsigned long n, unsigned long time)
+/* Events per second, given a time in us. */
+{
+	if (time == 0) return 0;
+	if (n < 4000) return n * 1000000L / time;
+	return n * 1000 / (time / 1000 + 1);
+}
+
+void report(void)
+{
+	int i;
+	unsigned long time = us(span);
+	struct slot *sp;
+
+	printf("%lu events in %lu.%03lu ms", nevents, time / 1000,
+		time % 1000);
+	if (nrecorded > nevents)
+		printf(" (%lu older events overwritten)", nrecorded - nevents);
+	printf("\n\n");
+
+	print_hist("Interrupt handler time", handler);
+	print_hist("Interrupt to task run", wakeup);
+
+	printf("process   received    /s      sent    /s  hardint  switched\n");
+	for (i = 0, sp = slot; i < NR_SLOTS; i++, sp++) {
+		if (sp->received + sp->sent + sp->hardint + sp->switched == 0)
+			continue;
+		printf("%-9s %8lu %5lu %8lu %5lu %8lu %9lu\n",
+			procname(i - NR_TASKS),
+			sp->received, rate(sp->received, time),
+			sp->sent, rate(sp->sent, time),
+			sp->hardint, sp->switched);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	int i, n, pid, status;
+	int samples = 1;
+	unsigned seconds = 1;
+	long recorded;
+
+	if ((prog = strrchr(argv[0], '/')) == nil) prog = argv[0]; else prog++;
+
+	i = 1;
+	while (i < argc && argv[i][0] == '-') {
+		char *opt = argv[i++] + 1;
+
+		if (opt[0] == '-' && opt[1] == 0) break;	/* -- */
+
+		while (*opt != 0) switch (*opt++) {
+		case 'd':	dflag = 1;	break;
+		case 'n':
+		case 's':
+			if (*opt == 0) {
+				if (i == argc) usage();
+				opt = argv[i++];
+			}
+			n = atoi(opt);
+			if (n <= 0) usage();
+			if (opt[-1] == 'n') samples = n; else seconds = n;
+			opt = "";
+			break;
+		default:	usage();
+		}
+	}
+	for (n = 0; n < NR_SLOTS; n++) slot[n].wake_irq = -1;
+
+	while (samples-- > 0) {
+		if (ktrace(KTRACE_START, nil, 0L, nil) < 0) fatal("ktrace");
+
+		if (i < argc) {
+			/* Trace while the command runs. */
+			if ((pid = fork()) < 0) fatal("fork");
+			if (pid == 0) {
+				execvp(argv[i], argv + i);
+				fatal(argv[i]);
+			}
+			while (wait(&status) != pid) {}
+			samples = 0;
+		} else {
+			sleep(seconds);
+		}
+
+		n = ktrace(KTRACE_READ, ev, (long) NR_EVENTS, &recorded);
+		if (n < 0) fatal("ktrace");
+		sample(n, recorded);
+	}
+	report();
+	return 0;
+}
@@ -0,0 +1,341 @@
+/* mkdb - make hashed databases of termcap, passwd and group
+ *
+ * Usage: mkdb [-t] [-p] [-g] [file]
+ *
+ * Make /etc/termcap.db (-t), /etc/passwd.db (-p) or /etc/group.db (-g),
+ * or all three without flags.  With one flag and a file, the database of
+ * that file is made, file.db.  The library finds a terminal, user or group
+ * in a database with a few reads, but only while the text file is as it
+ * was when the database was made; after an edit it reads the text file
+ * again until mkdb is run.  A text file changed in the current second is
+ * only read after a wait, so that an edit can't keep its time stamp.  The
+ * database gets the owner and mode of the text file, and replaces the old
+ * one at once.  See <minix/hashdb.h>.
+ */
+#define nil 0
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pwd.h>
+#include <grp.h>
+#include <minix/hashdb.h>
+
+#define TERMCAP		0
+#define PASSWD		1
+#define GROUP		2
+
+char *deffile[]= { "/etc/termcap", "/etc/passwd", "/etc/group" };
+int ntables[]= { 1, 2, 2 };
+
+char *prog;
+char *textfile;			/* the file the database is made of */
+char dbname[64], tmpname[64];
+int dbfd= -1;
+
+unsigned ntab, nslot;		/* tables and slots per table */
+struct hdb_slot *slot;		/* ntab * nslot slots */
+char **key;			/* the key of each slot */
+unsigned nkeys;			/* keys in the first table */
+unsigned nrec;			/* records written */
+off_t recoff;			/* where the next record goes */
+int counting;			/* first pass, only count the keys */
+
+void fatal(char *label)
+{
+	fprintf(stderr, "%s: %s: %s\n", prog, label, strerror(errno));
+	if (dbfd >= 0) (void) unlink(tmpname);
+	exit(1);
+}
+
+void usage(void)
+{
+	fprintf(stderr, "Usage: %s [-t] [-p] [-g] [file]\n", prog);
+	exit(1);
+}
+
+void *allocate(size_t n)
+{
+	void *p;
+
+	if ((p= malloc(n)) == nil) {
+		fprintf(stderr, "%s: %s: out of memory\n", prog, textfile);
+		if (dbfd >= 0) (void) unlink(tmpname);
+		exit(1);
+	}
+	return p;
+}
+
+off_t record(char *rec, size_t len)
+/* Add a record to the database, return its offset. */
+{
+	off_t off= recoff;
+
+	if (counting) return 0;
+	if (write(dbfd, rec, len) != len) fatal(tmpname);
+	recoff+= len;
+	nrec++;
+	return off;
+}
+
+void addkey(int tab, char *k, unsigned hash, off_t off, size_t len)
+/* Enter a key for a record in a table, unless it is already there; the
+ * first entry in the text file is the one the library would find.
+ */
+{
+	struct hdb_slot *sp;
+	unsigned i;
+
+	if (counting) {
+		if (tab == 0) nkeys++;
+		return;
+	}
+	hash&= 0xFFFF;
+	i= hash & (nslot - 1);
+	for (;;) {
+		sp= &slot[tab * nslot + i];
+		if (sp->s_off == 0) break;
+		if (sp->s_hash == hash && strcmp(key[tab * nslot + i], k) == 0)
+			return;
+		i= (i + 1) & (nslot - 1);
+	}
+	sp->s_off= off;
+	sp->s_len= len;
+	sp->s_hash= hash;
+	key[tab * nslot + i]= strcpy(allocate(strlen(k) + 1), k);
+}
+
+void do_termcap(void)
+/* Index every name of every terminal.  Entries are read the way tgetent()
+ * reads them, so that the record is what it would leave in its buffer.
+ */
+{
+	FILE *fp;
+	char bp[1024];
+	char name[1024];
+	char *cp, *np;
+	int def_len;
+	off_t off;
+	size_t len;
+
+	if ((fp= fopen(textfile, "r")) == nil) fatal(textfile);
+
+	for (;;) {
+		def_len= 0;
+		do {
+			if (fgets(bp + def_len, 1024 - def_len, fp) == nil) {
+				(void) fclose(fp);
+				return;
+			}
+			def_len= strlen(bp) - 2;
+		} while (def_len >= 0 && bp[def_len] == '\\');
+
+		cp= bp;
+		while (isspace(*cp)) cp++;
+		if (*cp == '#' || *cp == 0) continue;
+
+		len= strlen(bp);
+		off= record(bp, len);
+		do {
+			np= name;
+			while (*cp != 0 && *cp != '|' && *cp != ':')
+				*np++= *cp++;
+			*np= 0;
+			if (np > name) {
+				addkey(HDB_TCNAME, name,
+					_hdbhash(name, np - name), off, len);
+			}
+		} while (*cp++ == '|');
+	}
+}
+
+void do_passwd(void)
+/* Index users by name and by id.  The entries are read with getpwent(),
+ * so the bad lines it skips are left out.
+ */
+{
+	struct passwd *pw;
+	char line[1024], id[8];
+	off_t off;
+	size_t len;
+
+	setpwfile(textfile);
+	if (setpwent() < 0) fatal(textfile);
+	while ((pw= getpwent()) != nil) {
+		sprintf(line, "%s:%s:%d:%d:%s:%s:%s\n",
+			pw->pw_name, pw->pw_passwd, pw->pw_uid, pw->pw_gid,
+			pw->pw_gecos, pw->pw_dir, pw->pw_shell);
+		len= strlen(line);
+		off= record(line, len);
+		addkey(HDB_PWNAME, pw->pw_name,
+			_hdbhash(pw->pw_name, strlen(pw->pw_name)), off, len);
+		sprintf(id, "%d", pw->pw_uid);
+		addkey(HDB_PWUID, id, (unsigned) pw->pw_uid, off, len);
+	}
+	endpwent();
+}
+
+void do_group(void)
+/* Index groups by name and by id. */
+{
+	struct group *gr;
+	char line[1024], id[8];
+	char **mem;
+	off_t off;
+	size_t len;
+
+	setgrfile(textfile);
+	if (setgrent() < 0) fatal(textfile);
+	while ((gr= getgrent()) != nil) {
+		sprintf(line, "%s:%s:%d:", gr->gr_name, gr->gr_passwd,
+								gr->gr_gid);
+		for (mem= gr->gr_mem; *mem != nil; mem++) {
+			if (mem > gr->gr_mem) strcat(line, ",");
+			strcat(line, *mem);
+		}
+		strcat(line, "\n");
+		len= strlen(line);
+		off= record(line, len);
+		addkey(HDB_GRNAME, gr->gr_name,
+			_hdbhash(gr->gr_name, strlen(gr->gr_name)), off, len);
+		sprintf(id, "%d", gr->gr_gid);
+		addkey(HDB_GRGID, id, (unsigned) gr->gr_gid, off, len);
+	}
+	endgrent();
+}
+
+void scan(int kind)
+{
+	switch (kind) {
+	case TERMCAP:	do_termcap();	break;
+	case PASSWD:	do_passwd();	break;
+	case GROUP:	do_group();	break;
+	}
+}
+
+void mkdb(int kind, char *file)
+/* Make the database of a text file. */
+{
+	struct stat st;
+	struct hdb_head head;
+	time_t now;
+	size_t size;
+	unsigned i;
+
+	textfile= file;
+	if (strlen(file) + sizeof(HDB_SUFFIX) + 1 > sizeof(dbname)) {
+		fprintf(stderr, "%s: %s: name too long\n", prog, file);
+		exit(1);
+	}
+	strcpy(dbname, file);
+	strcat(dbname, HDB_SUFFIX);
+	strcpy(tmpname, dbname);
+	strcat(tmpname, "~");
+
+	/* The database holds for the text file as it is now.  Time stamps
+	 * are in seconds, so wait until the file was last changed before this
+	 * second.  Then any change made from now on, even while we read it,
+	 * gives it another time stamp and puts the database out of date.
+	 */
+	for (;;) {
+		now= time(nil);
+		if (stat(file, &st) < 0) fatal(file);
+		if (st.st_mtime < now) break;
+		if (st.st_mtime > now) {
+			fprintf(stderr,
+				"%s: %s: modification time is in the future\n",
+				prog, file);
+			exit(1);
+		}
+		sleep(1);
+	}
+
+	/* Count the keys, make the tables twice as big. */
+	counting= 1;
+	nkeys= 0;
+	scan(kind);
+	ntab= ntables[kind];
+	for (nslot= 16; nslot / 2 < nkeys && nslot < 0x8000; nslot<<= 1) {}
+	if ((unsigned long) ntab * nslot * sizeof(slot[0]) > (size_t) -1
+						|| nslot / 2 < nkeys) {
+		fprintf(stderr, "%s: %s: too many entries\n", prog, file);
+		exit(1);
+	}
+	size= (size_t) ntab * nslot;
+	slot= allocate(size * sizeof(slot[0]));
+	key= allocate(size * sizeof(key[0]));
+	for (i= 0; i < size; i++) slot[i].s_off= 0;
+
+	if ((dbfd= open(tmpname, O_WRONLY | O_CREAT | O_TRUNC, 0600)) < 0)
+		fatal(tmpname);
+	recoff= sizeof(head) + (off_t) size * sizeof(slot[0]);
+	if (lseek(dbfd, recoff, SEEK_SET) == -1) fatal(tmpname);
+	counting= 0;
+	nrec= 0;
+	scan(kind);
+
+	head.h_magic= HDB_MAGIC;
+	head.h_ntab= ntab;
+	head.h_nslot= nslot;
+	head.h_nrec= nrec;
+	head.h_mtime= st.st_mtime;
+	head.h_size= st.st_size;
+	if (lseek(dbfd, (off_t) 0, SEEK_SET) == -1
+		|| write(dbfd, (char *) &head, sizeof(head)) != sizeof(head)
+		|| write(dbfd, (char *) slot, size * sizeof(slot[0]))
+						!= size * sizeof(slot[0])
+	) fatal(tmpname);
+
+	if (close(dbfd) < 0) fatal(tmpname);
+	(void) chown(tmpname, st.st_uid, st.st_gid);
+	if (chmod(tmpname, st.st_mode & 07777) < 0) fatal(tmpname);
+	dbfd= -1;
+	if (rename(tmpname, dbname) < 0) {
+		(void) unlink(tmpname);
+		fatal(dbname);
+	}
+
+	for (i= 0; i < size; i++) if (slot[i].s_off != 0) free(key[i]);
+	free(slot);
+	free(key);
+}
+
+int main(int argc, char **argv)
+{
+	int i, kind, make[3];
+	char *p;
+
+	if ((prog= strrchr(argv[0], '/')) == nil) prog= argv[0]; else prog++;
+
+	make[TERMCAP]= make[PASSWD]= make[GROUP]= 0;
+	for (i= 1; i < argc && argv[i][0] == '-'; i++) {
+		for (p= argv[i] + 1; *p != 0; p++) {
+			switch (*p) {
+			case 't':	make[TERMCAP]= 1;	break;
+			case 'p':	make[PASSWD]= 1;	break;
+			case 'g':	make[GROUP]= 1;		break;
+			default:	usage();
+			}
+		}
+	}
+	if (i == 1) make[TERMCAP]= make[PASSWD]= make[GROUP]= 1;
+
+	if (i < argc) {
+		/* One database of a given file. */
+		if (i + 1 < argc || make[TERMCAP] + make[PASSWD] + make[GROUP]
+									!= 1)
+			usage();
+		for (kind= 0; !make[kind]; kind++) {}
+		mkdb(kind, argv[i]);
+	} else {
+		for (kind= 0; kind < 3; kind++)
+			if (make[kind]) mkdb(kind, deffile[kind]);
+	}
+	return 0;
+}
@@ -0,0 +1,317 @@
+/* prof - statistical execution profile */
+
+/* Usage: prof [-s seconds] [-p who] [-f file] [command [arg ...]]
+ *
+ * Run a command, or watch a process or server for a number of seconds, while
+ * the clock interrupt samples its program counter with pprofil(2).  Then map
+ * the samples to the text symbols of the program, read the way nm(1) reads
+ * them, and print a flat profile in the layout of gprof(1).
+ *
+ * flags:
+ *	-s	seconds to watch a process (default 10)
+ *	-p	process to watch: a pid, or one of mm, fs and inet
+ *	-f	file with the symbols, needed with -p, else the command
+ */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <a.out.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+#include <minix/config.h>
+#include <minix/const.h>
+#include <minix/com.h>
+
+#define NCOUNT		4096	/* maximum number of counters */
+
+unsigned short count[NCOUNT];	/* samples per piece of text */
+unsigned ncount;		/* counters in use */
+unsigned scale;			/* profil() scale of pc to counter */
+
+struct exec header;		/* header of the a.out file */
+struct nlist *stbl;		/* text symbols, sorted by address */
+int stbl_elems;			/* #elements in symbol table */
+long *samples;			/* samples per symbol */
+
+_PROTOTYPE(int main, (int argc, char **argv));
+_PROTOTYPE(void usage, (void));
+_PROTOTYPE(int parse_who, (char *arg));
+_PROTOTYPE(char *find_path, (char *name));
+_PROTOTYPE(void read_symbols, (char *file));
+_PROTOTYPE(int value_sort, (const void *tmp_stbl1, const void *tmp_stbl2));
+_PROTOTYPE(int run_command, (char **argv));
+_PROTOTYPE(void report, (void));
+
+int main(argc, argv)
+int argc;
+char **argv;
+{
+  int c, who = 0;
+  unsigned seconds = 10;
+  char *file = NULL;
+  unsigned long s;
+
+  argv++;
+  while (*argv != 0 && **argv == '-') {
+	char *opt = *argv++ + 1;
+
+	if (*opt == '-' && opt[1] == '\0') break;
+	while (*opt != '\0') {
+		switch (c = *opt++) {
+		    case 's':
+		    case 'p':
+		    case 'f':
+			if (*opt == '\0' && (opt = *argv++) == 0) usage();
+			if (c == 's' && (seconds = atoi(opt)) == 0) usage();
+			if (c == 'p') who = parse_who(opt);
+			if (c == 'f') file = opt;
+			opt = "";
+			break;
+		    default:
+			usage();
+		}
+	}
+  }
+  if ((who == 0) == (*argv == 0)) usage();
+  if (file == NULL) {
+	if (*argv == 0) usage();
+	if ((file = find_path(argv[0])) == NULL) {
+		fprintf(stderr, "prof: %s: not found\n", argv[0]);
+		exit(1);
+	}
+  }
+  read_symbols(file);
+
+  /* One counter for every few bytes of text, as many as we have. */
+  s = (unsigned long) NCOUNT * 0x20000L / header.a_text;
+  scale = s > 0xFFFF ? 0xFFFF : s < 2 ? 2 : (unsigned) s;
+  ncount = (unsigned) (((header.a_text + 1) >> 1) * scale >> 16) + 1;
+  if (ncount > NCOUNT) ncount = NCOUNT;
+
+  if (*argv != 0) {
+	if (run_command(argv) != 0) exit(1);
+  } else {
+	if (pprofil(who, count, ncount * sizeof(count[0]), 0, scale) < 0) {
+		fprintf(stderr, "prof: can't profile: %s\n", strerror(errno));
+		exit(1);
+	}
+	sleep(seconds);
+	(void) pprofil(who, NULL, 0, 0, 0);
+  }
+  report();
+  return(0);
+}
+
+void usage()
+{
+  fprintf(stderr,
+	"Usage: prof [-s seconds] [-p who] [-f file] [command [arg ...]]\n");
+  exit(1);
+}
+
+int parse_who(arg)
+char *arg;
+{
+/* A pid, or the name of a server. */
+  int pid;
+
+  if (strcmp(arg, "mm") == 0) return(PROF_SERVER(MM_PROC_NR));
+  if (strcmp(arg, "fs") == 0) return(PROF_SERVER(FS_PROC_NR));
+#if ENABLE_NETWORKING
+  if (strcmp(arg, "inet") == 0) return(PROF_SERVER(INET_PROC_NR));
+#endif
+  if ((pid = atoi(arg)) <= 0) usage();
+  return(pid);
+}
+
+char *find_path(name)
+char *name;
+{
+/* Find an executable the way the shell would. */
+  static char path[256];
+  char *list, *end;
+  size_t n;
+
+  if (strchr(name, '/') != NULL) return(name);
+  if ((list = getenv("PATH")) == NULL) list = ":/bin:/usr/bin";
+  for (;;) {
+	if ((end = strchr(list, ':')) == NULL) end = list + strlen(list);
+	n = end - list;
+	if (n + 1 + strlen(name) < sizeof(path)) {
+		if (n == 0) {
+			strcpy(path, name);
+		} else {
+			memcpy(path, list, n);
+			path[n] = '/';
+			strcpy(path + n + 1, name);
+		}
+		if (access(path, X_OK) == 0) return(path);
+	}
+	if (*end == '\0') return(NULL);
+	list = end + 1;
+  }
+}
+
+void read_symbols(file)
+char *file;
+{
+/* Read the text symbols like nm(1) does and sort them by address. */
+  struct nlist *sp, *tp;
+  int fd;
+
+  if ((fd = open(file, O_RDONLY)) == -1) {
+	fprintf(stderr, "prof: can't open %s\n", file);
+	exit(1);
+  }
+  if (read(fd, (char *) &header, sizeof(struct exec)) != sizeof(struct exec)
+						|| BADMAG(header)) {
+	fprintf(stderr, "prof: %s: no executable file\n", file);
+	exit(1);
+  }
+  if (header.a_syms == 0) {
+	fprintf(stderr, "prof: %s: no symbols\n", file);
+	exit(1);
+  }
+  if ((int) header.a_syms != header.a_syms || header.a_text == 0
+	|| (stbl = (struct nlist *) malloc((size_t) header.a_syms)) == NULL) {
+	fprintf(stderr, "prof: %s: symbol table too large\n", file);
+	exit(1);
+  }
+  lseek(fd, A_SYMPOS(header), SEEK_SET);
+  if (read(fd, (char *) stbl, (unsigned) header.a_syms) != header.a_syms) {
+	fprintf(stderr, "prof: %s: can't read symbol table\n", file);
+	exit(1);
+  }
+  close(fd);
+
+  /* Keep the text symbols only. */
+  stbl_elems = (int) header.a_syms / sizeof(struct nlist);
+  for (sp = tp = stbl; sp < &stbl[stbl_elems]; sp++) {
+	if ((sp->n_sclass & N_SECT) != N_TEXT) continue;
+	if (sp->n_name[0] == '.') continue;	/* section name */
+	*tp++ = *sp;
+  }
+  stbl_elems = tp - stbl;
+  qsort(stbl, (size_t) stbl_elems, sizeof(struct nlist), value_sort);
+
+  if ((samples = (long *) calloc((size_t) stbl_elems + 1, sizeof(long)))
+								== NULL) {
+	fprintf(stderr, "prof: out of memory\n");
+	exit(1);
+  }
+}
+
+int value_sort(tmp_stbl1, tmp_stbl2)
+_CONST void *tmp_stbl1, *tmp_stbl2;
+{
+  struct nlist *stbl1 = (struct nlist *)tmp_stbl1;
+  struct nlist *stbl2 = (struct nlist *)tmp_stbl2;
+
+  if (stbl1->n_value < stbl2->n_value) return(-1);
+  if (stbl1->n_value > stbl2->n_value) return(1);
+  return(0);
+}
+
+int run_command(argv)
+char **argv;
+{
+/* Start the command, profile it from before its exec, and wait for it. */
+  int fd[2], pid, status;
+  char c;
+
+  if (pipe(fd) < 0) {
+	perror("prof: pipe");
+	return(-1);
+  }
+  switch (pid = fork()) {
+      case -1:
+	perror("prof: fork");
+	return(-1);
+      case 0:
+	/* Wait until the parent has turned profiling on. */
+	close(fd[1]);
+	if (read(fd[0], &c, 1) != 1) _exit(1);
+	close(fd[0]);
+	execvp(argv[0], argv);
+	fprintf(stderr, "prof: %s: %s\n", argv[0], strerror(errno));
+	_exit(127);
+  }
+  close(fd[0]);
+  if (pprofil(pid, count, ncount * sizeof(count[0]), 0, scale) < 0) {
+	fprintf(stderr, "prof: can't profile: %s\n", strerror(errno));
+	close(fd[1]);
+	(void) waitpid(pid, &status, 0);
+	return(-1);
+  }
+  (void) write(fd[1], "", 1);
+  close(fd[1]);
+  if (waitpid(pid, &status, 0) < 0) {
+	perror("prof: wait");
+	return(-1);
+  }
+  return(0);
+}
+
+void report()
+{
+/* Add the counters up per symbol and print them, busiest first. */
+  unsigned i;
+  int lo, hi, mid, n, best;
+  unsigned long addr;
+  long total, cumulative, self, hz;
+  char name[9];
+
+  hz = sysconf(_SC_CLK_TCK);
+
+  total = 0;
+  for (i = 0; i < ncount; i++) {
+	if (count[i] == 0) continue;
+	total += count[i];
+
+	/* The counter covers text from this address on. */
+	addr = ((unsigned long) i << 17) / scale;
+	lo = 0;
+	hi = stbl_elems;
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (stbl[mid].n_value <= addr) lo = mid + 1; else hi = mid;
+	}
+	samples[lo] += count[i];	/* [0] is before the first symbol */
+  }
+
+  printf("Flat profile:\n\n");
+  printf("Each sample counts as 1/%ld of a second.  %ld samples.\n\n",
+								hz, total);
+  printf("  %%   cumulative   self              self     total\n");
+  printf(" time   seconds   seconds    calls  ms/call  ms/call  name\n");
+  if (total == 0) return;
+
+  name[8] = '\0';
+  cumulative = 0;
+  for (;;) {
+	/* Select the symbol with the most samples left. */
+	best = -1;
+	for (n = 0; n <= stbl_elems; n++) {
+		if (samples[n] > 0 && (best < 0 || samples[n] > samples[best]))
+			best = n;
+	}
+	if (best < 0) break;
+	self = samples[best];
+	samples[best] = 0;
+	cumulative += self;
+
+	if (best == 0)
+		strcpy(name, "<text>");
+	else
+		strncpy(name, stbl[best - 1].n_name, (size_t) 8);
+	printf("%3ld.%02ld %7ld.%02ld %6ld.%02ld %8s %8s %8s  %s\n",
+		self * 100 / total, self * 10000 / total % 100,
+		cumulative / hz, cumulative * 100 / hz % 100,
+		self / hz, self * 100 / hz % 100,
+		"", "", "", name);
+  }
+}
@@ -0,0 +1,359 @@
+/* top - show the busiest processes
+ *
+ * Usage: top [-d seconds]
+ *
+ * Show the processes sorted by the CPU time they used since the last
+ * screen, every second or every so many seconds.  The first screen counts
+ * from boot.  Type q to quit, any other key to look again at once.  Each
+ * screen costs one MIOCGPSTAB ioctl on /dev/mem, which has the memory task
+ * merge the kernel, MM and FS tables at one moment, so top can run for a
+ * long time without getting in the way of what it watches.  Top must be
+ * set-gid kmem to open /dev/mem, like ps.
+ */
+#define nil 0
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/times.h>
+#include <sys/ioctl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <termios.h>
+#include <pwd.h>
+#include <ttyent.h>
+#include <curses.h>
+#include <minix/config.h>
+#include <minix/const.h>
+#include <minix/type.h>
+#include <minix/com.h>
+
+#define MEM_PATH	"/dev/mem"
+#define HEADLINES	4	/* lines above the processes */
+
+char *prog;
+int memfd;
+int nslots;			/* nr_tasks + nr_procs */
+int nr_tasks;
+struct pstab *now, *then;	/* this snapshot and the one before */
+long *delta;			/* ticks used between them */
+int *order;			/* slots sorted by delta */
+
+struct ttyname {		/* a tty name for a device */
+	dev_t	dev;
+	char	name[8];
+} *ttys;
+int nttys= -1;
+
+struct user {			/* a user name for a uid */
+	uid_t	uid;
+	char	name[9];
+	struct user *next;
+} *users;
+
+void fatal(char *label)
+{
+	fprintf(stderr, "%s: %s: %s\n", prog, label, strerror(errno));
+	exit(1);
+}
+
+void usage(void)
+{
+	fprintf(stderr, "Usage: %s [-d seconds]\n", prog);
+	exit(1);
+}
+
+void quit(int sig)
+{
+	endwin();
+	exit(0);
+}
+
+void *allocate(size_t n)
+{
+	void *p;
+
+	if ((p= calloc(n, 1)) == nil) {
+		fprintf(stderr, "%s: out of memory\n", prog);
+		exit(1);
+	}
+	return p;
+}
+
+char *ttyname_of(dev_t dev)
+/* A short name for a tty, from the devices in /etc/ttytab. */
+{
+	struct ttyent *ty;
+	struct stat st;
+	char path[64];
+	int i, n;
+
+	if (dev == 0) return "";
+	if (nttys < 0) {
+		nttys= 0;
+		n= 0;
+		while ((ty= getttyent()) != nil) {
+			if (strlen(ty->ty_name) + 6 > sizeof(path)) continue;
+			strcpy(path, "/dev/");
+			strcat(path, ty->ty_name);
+			if (stat(path, &st) < 0 || !S_ISCHR(st.st_mode))
+				continue;
+			if (nttys == n) {
+				n= 2 * n + 8;
+				ttys= realloc(ttys, n * sizeof(ttys[0]));
+				if (ttys == nil) fatal("realloc()");
+			}
+			ttys[nttys].dev= st.st_rdev;
+			strncpy(ttys[nttys].name,
+				strncmp(ty->ty_name, "tty", 3) == 0
+					? ty->ty_name + 3 : ty->ty_name,
+				sizeof(ttys[0].name) - 1);
+			nttys++;
+		}
+		endttyent();
+	}
+	for (i= 0; i < nttys; i++) {
+		if (ttys[i].dev == dev) return ttys[i].name;
+	}
+	return "?";
+}
+
+char *username(uid_t uid)
+/* The name of a user, looked up once. */
+{
+	struct user *up;
+	struct passwd *pw;
+
+	for (up= users; up != nil; up= up->next) {
+		if (up->uid == uid) return up->name;
+	}
+	up= allocate(sizeof(*up));
+	up->uid= uid;
+	if ((pw= getpwuid(uid)) != nil)
+		strncpy(up->name, pw->pw_name, sizeof(up->name) - 1);
+	else
+		sprintf(up->name, "%u", (unsigned) uid);
+	up->next= users;
+	users= up;
+	return up->name;
+}
+
+char *procname(int p)
+/* The name in a slot of the snapshot, for a process number. */
+{
+	if (p == ANY) return "ANY";
+	if (p < -nr_tasks || p + nr_tasks >= nslots) return "?";
+	return now[p + nr_tasks].ps_name;
+}
+
+long ticks(struct pstab *ps)
+{
+	return ps->ps_utime + ps->ps_stime;
+}
+
+unsigned long size(struct pstab *ps)
+/* Memory in clicks: text, and data up to the end of the stack. */
+{
+	return ps->ps_map[T].mem_len
+		+ ps->ps_map[S].mem_phys + ps->ps_map[S].mem_len
+		- ps->ps_map[D].mem_phys;
+}
+
+void snapshot(void)
+/* Take a new snapshot, and compute what each process used since the last. */
+{
+	struct pstab *tmp;
+	int i;
+
+	tmp= then; then= now; now= tmp;
+	if (ioctl(memfd, MIOCGPSTAB, (void *) now) < 0) {
+		endwin();
+		fatal("MIOCGPSTAB");
+	}
+	for (i= 0; i < nslots; i++) {
+		delta[i]= 0;
+		if (now[i].ps_state == PS_FREE) continue;
+		delta[i]= ticks(&now[i]);
+		if (then[i].ps_state != PS_FREE
+			&& then[i].ps_pid == now[i].ps_pid
+			&& ticks(&then[i]) <= delta[i]
+		) {
+			delta[i]-= ticks(&then[i]);
+		}
+	}
+}
+
+void sort(void)
+/* Order the processes by their use of the CPU, busiest first. */
+{
+	int i, j, s;
+
+	for (i= 0; i < nslots; i++) {
+		s= i;
+		for (j= i; j > 0; j--) {
+			if (delta[order[j-1]] > delta[s]) break;
+			if (delta[order[j-1]] == delta[s]
+				&& ticks(&now[order[j-1]]) >= ticks(&now[s]))
+				break;
+			order[j]= order[j-1];
+		}
+		order[j]= s;
+	}
+}
+
+char *percent(long part, long total)
+{
+	static char buf[4][8];
+	static int n;
+	long p;
+
+	if (total == 0) total= 1;
+	p= (part * 1000 + total / 2) / total;
+	n= (n + 1) % 4;
+	sprintf(buf[n], "%3ld.%ld%%", p / 10, p % 10);
+	return buf[n];
+}
+
+void show(void)
+/* Draw a screen. */
+{
+	struct pstab *ps;
+	struct tms tms;
+	clock_t up;
+	long total, task, server, user, idle, t;
+	unsigned long mem;
+	int i, j, p, line, nproc, nrun, nsleep, nzombie;
+
+	total= task= server= user= idle= 0;
+	nproc= nrun= nsleep= nzombie= 0;
+	mem= 0;
+	for (i= 0; i < nslots; i++) {
+		ps= &now[i];
+		if (ps->ps_state == PS_FREE) continue;
+		p= i - nr_tasks;
+		total+= delta[i];
+		if (p == IDLE) idle+= delta[i];
+		else if (p < 0) task+= delta[i];
+		else if (p < INIT_PROC_NR) server+= delta[i];
+		else user+= delta[i];
+		if (p < INIT_PROC_NR) continue;
+
+		nproc++;
+		if (ps->ps_state == PS_RUN) nrun++;
+		if (ps->ps_state == PS_SLEEP) nsleep++;
+		if (ps->ps_state == PS_ZOMBIE) nzombie++;
+
+		/* Shared text is counted once. */
+		mem+= size(ps);
+		for (j= nr_tasks + INIT_PROC_NR; j < i; j++) {
+			if (now[j].ps_state != PS_FREE
+				&& ps->ps_map[T].mem_len != 0
+				&& now[j].ps_map[T].mem_phys
+						== ps->ps_map[T].mem_phys
+			) {
+				mem-= ps->ps_map[T].mem_len;
+				break;
+			}
+		}
+	}
+
+	up= times(&tms) / HZ;
+	move(0, 0);
+	printw("up %ld:%02ld:%02ld, %d processes: %d running, %d sleeping",
+		up / 3600, up / 60 % 60, up % 60, nproc, nrun, nsleep);
+	if (nzombie > 0) printw(", %d zombie", nzombie);
+	clrtoeol();
+	mvprintw(1, 0, "CPU: %s user, %s servers, %s tasks, %s idle",
+		percent(user, total), percent(server, total),
+		percent(task, total), percent(idle, total));
+	clrtoeol();
+	mvprintw(2, 0, "Memory: %luK in use by processes",
+		(mem << CLICK_SHIFT) / 1024);
+	clrtoeol();
+	mvprintw(3, 0,
+"  PID USERNAME S TTY    SIZE   TIME   CPU% WAIT     COMMAND");
+	clrtoeol();
+
+	sort();
+	line= HEADLINES;
+	for (i= 0; i < nslots && line < LINES; i++) {
+		ps= &now[order[i]];
+		if (ps->ps_state == PS_FREE) continue;
+		p= order[i] - nr_tasks;
+		t= ticks(ps) / HZ;
+		move(line, 0);
+		if (p >= INIT_PROC_NR) {
+			printw("%5d %-8.8s %c %-4.4s %5luK",
+				ps->ps_pid, username(ps->ps_euid),
+				ps->ps_state, ttyname_of(ps->ps_tty),
+				(size(ps) << CLICK_SHIFT) / 1024);
+		} else {
+			printw("%5s %-8.8s %c %-4.4s %5s ",
+				"", "", ps->ps_state, "", "");
+		}
+		printw(" %3ld:%02ld %s %-8.8s %.*s",
+			t / 60, t % 60, percent(delta[order[i]], total),
+			ps->ps_state == PS_RUN ? "" : procname(ps->ps_blocked),
+			COLS - 53 > 0 ? COLS - 53 : 0, ps->ps_name);
+		clrtoeol();
+		line++;
+	}
+	clrtobot();
+	move(0, 0);
+	refresh();
+}
+
+int main(int argc, char **argv)
+{
+	struct psinfo psinfo;
+	int i, delay;
+	char *end, c;
+
+	if ((prog= strrchr(argv[0], '/')) == nil) prog= argv[0]; else prog++;
+
+	delay= 1;
+	for (i= 1; i < argc && argv[i][0] == '-'; i++) {
+		if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+			delay= strtol(argv[++i], &end, 10);
+			if (*end != 0 || delay < 1 || delay > 25) usage();
+		} else {
+			usage();
+		}
+	}
+	if (i < argc) usage();
+
+	if ((memfd= open(MEM_PATH, O_RDONLY)) < 0) fatal(MEM_PATH);
+	if (ioctl(memfd, MIOCGPSINFO, (void *) &psinfo) < 0)
+		fatal("MIOCGPSINFO");
+	nr_tasks= psinfo.nr_tasks;
+	nslots= psinfo.nr_tasks + psinfo.nr_procs;
+	now= allocate(nslots * sizeof(now[0]));
+	then= allocate(nslots * sizeof(then[0]));
+	delta= allocate(nslots * sizeof(delta[0]));
+	order= allocate(nslots * sizeof(order[0]));
+
+	/* The first snapshot is compared to an empty one (PS_FREE is 0), so
+	 * it shows what each process has used since it started.
+	 */
+	initscr();
+	signal(SIGINT, quit);
+	signal(SIGTERM, quit);
+	cbreak();
+	noecho();
+
+	/* A read waits for a key, or until it is time for the next screen. */
+	_tty.c_cc[VMIN]= 0;
+	_tty.c_cc[VTIME]= delay * 10;
+	tcsetattr(0, TCSANOW, &_tty);
+
+	for (;;) {
+		snapshot();
+		show();
+		if (read(0, &c, 1) == 1 && (c == 'q' || c == 'Q')) break;
+	}
+	quit(0);
+	return 0;
+}
@@ -29,6 +29,9 @@ FORWARD _PROTOTYPE( void fs_init, (void)				);
 FORWARD _PROTOTYPE( void get_boot_parameters, (void)			);
 FORWARD _PROTOTYPE( void get_work, (void)				);
 FORWARD _PROTOTYPE( void load_ram, (void)				);
+FORWARD _PROTOTYPE( int block_in_use, (struct super_block *sp, block_t b) );
+FORWARD _PROTOTYPE( void cap_zones, (struct super_block *sp, zone_t zones,
+							long room)	);
 FORWARD _PROTOTYPE( void load_super, (Dev_t super_dev)			);
 
 
@@ -222,14 +225,14 @@ PRIVATE void get_boot_parameters()
  *===========================================================================*/
 PRIVATE void load_ram()
 {
-/* If the root device is the RAM disk, copy the entire root image device
+/* If the root device is the RAM disk, copy the used blocks of the root image
  * block-by-block to a RAM disk with the same size as the image.
  * Otherwise, just allocate a RAM disk with size given in the boot parameters.
  */
 
   register struct buf *bp, *bp1;
   long k_loaded, lcount;
-  u32_t ram_size, fsmax;
+  u32_t ram_size, fsmax, mem_size;
   zone_t zones;
   struct super_block *sp, *dsp;
   block_t b;
@@ -280,9 +283,12 @@ PRIVATE void load_ram()
   m1.POSITION = ram_size;
   if (sendrec(MEM, &m1) != OK || m1.REP_STATUS != OK)
 	panic("Can't set RAM disk size", NO_NUM);
+  mem_size = m1.POSITION;
 
-  /* Tell MM the RAM disk size, and wait for it to come "on-line". */
-  m1.m1_i1 = ((long) ram_size * BLOCK_SIZE) >> CLICK_SHIFT;
+  /* Tell MM the memory the RAM disk takes, which is less than its size if
+   * it is sparse, and wait for it to come "on-line".
+   */
+  m1.m1_i1 = ((long) mem_size * BLOCK_SIZE) >> CLICK_SHIFT;
   if (sendrec(MM_PROC_NR, &m1) != OK)
 	panic("FS can't sync up with MM", NO_NUM);
 
@@ -303,12 +309,15 @@ PRIVATE void load_ram()
   inode[0].i_zone[0] = IMAGE_DEV;
 
   for (b = 0; b < (block_t) lcount; b++) {
-	bp = rahead(&inode[0], b, (off_t)BLOCK_SIZE * b, BLOCK_SIZE);
-	bp1 = get_block(ROOT_DEV, b, NO_READ);
-	memcpy(bp1->b_data, bp->b_data, (size_t) BLOCK_SIZE);
-	bp1->b_dirt = DIRTY;
-	put_block(bp, FULL_DATA_BLOCK);
-	put_block(bp1, FULL_DATA_BLOCK);
+	/* Free zones need not be copied, FS zeroes a zone it allocates. */
+	if (block_in_use(sp, b)) {
+		bp = rahead(&inode[0], b, (off_t)BLOCK_SIZE * b, BLOCK_SIZE);
+		bp1 = get_block(ROOT_DEV, b, NO_READ);
+		memcpy(bp1->b_data, bp->b_data, (size_t) BLOCK_SIZE);
+		bp1->b_dirt = DIRTY;
+		put_block(bp, FULL_DATA_BLOCK);
+		put_block(bp1, FULL_DATA_BLOCK);
+	}
 	k_loaded = ( (long) b * BLOCK_SIZE)/1024L;	/* K loaded so far */
 	if (k_loaded % 5 == 0) printf("\b\b\b\b\b\b\b%5ldK ", k_loaded);
   }
@@ -329,6 +338,101 @@ PRIVATE void load_ram()
   dsp->s_zones = conv4(sp->s_native, zones);
   bp->b_dirt = DIRTY;
   put_block(bp, ZUPER_BLOCK);
+
+  /* A sparse RAM disk has memory for the blocks of its pool, less the zero
+   * block and the block map in front (see memory.c).
+   */
+  if (mem_size < ram_size) {
+	cap_zones(sp, zones, (long) mem_size - 1
+		- (long) ((ram_size * sizeof(u16_t) + BLOCK_SIZE-1) / BLOCK_SIZE));
+  }
+}
+
+
+/*===========================================================================*
+ *				block_in_use				     *
+ *===========================================================================*/
+PRIVATE int block_in_use(sp, b)
+struct super_block *sp;		/* super block of the root image */
+block_t b;			/* block on the root image */
+{
+/* Tell if a block of the root image holds anything.  The super block, bit
+ * maps and inodes always do, a data block only if its zone is allocated.
+ */
+  unsigned chunk_bits = usizeof(bitchunk_t) * CHAR_BIT;
+  unsigned map_bits = BITMAP_CHUNKS * chunk_bits;
+  bit_t bit;
+  bitchunk_t k;
+  struct buf *bp;
+
+  if (b < ((block_t) sp->s_firstdatazone << sp->s_log_zone_size)) return(TRUE);
+  bit = (b >> sp->s_log_zone_size) - (sp->s_firstdatazone - 1);
+
+  bp = get_block(sp->s_dev, SUPER_BLOCK + 1 + sp->s_imap_blocks
+					+ (block_t) (bit / map_bits), NORMAL);
+  k = conv2(sp->s_native, (int) bp->b_bitmap[(bit % map_bits) / chunk_bits]);
+  put_block(bp, MAP_BLOCK);
+  return((k >> (bit % chunk_bits)) & 1);
+}
+
+
+/*===========================================================================*
+ *				cap_zones				     *
+ *===========================================================================*/
+PRIVATE void cap_zones(sp, zones, room)
+struct super_block *sp;		/* super block of the root image */
+zone_t zones;			/* zones on the RAM disk */
+long room;			/* blocks the RAM disk has memory for */
+{
+/* Mark the free zones of a sparse RAM disk that don't fit in its memory in
+ * use, so that the free space FS and df see is the space there is, and a
+ * write can't fail later for want of memory.  Zones are marked from the end
+ * of the disk.  Fsck will report them as allocated but unused.
+ */
+  unsigned chunk_bits = usizeof(bitchunk_t) * CHAR_BIT;
+  unsigned map_bits = BITMAP_CHUNKS * chunk_bits;
+  block_t map_block;
+  bit_t bit, nbits;
+  bitchunk_t k, mask;
+  struct buf *bp;
+  int pass, word;
+  long zone_blocks;
+
+  zone_blocks = 1L << sp->s_log_zone_size;
+  room -= (long) sp->s_firstdatazone << sp->s_log_zone_size;
+  nbits = zones - (sp->s_firstdatazone - 1);
+  map_block = SUPER_BLOCK + 1 + sp->s_imap_blocks;
+
+  /* Pass 0 takes the zones in use from the room, pass 1 keeps free zones
+   * while there is room, and marks the rest.
+   */
+  for (pass = 0; pass < 2; pass++) {
+	bp = NIL_BUF;
+	for (bit = 0; bit < nbits; bit++) {
+		if (bit % map_bits == 0) {
+			if (bp != NIL_BUF) put_block(bp, MAP_BLOCK);
+			bp = get_block(ROOT_DEV, map_block + (block_t)
+						(bit / map_bits), NORMAL);
+		}
+		word = (bit % map_bits) / chunk_bits;
+		mask = 1 << (bit % chunk_bits);
+		k = conv2(sp->s_native, (int) bp->b_bitmap[word]);
+		if (pass == 0) {
+			if (k & mask) room -= zone_blocks;
+		} else
+		if (!(k & mask)) {
+			if (room >= zone_blocks) {
+				room -= zone_blocks;
+			} else {
+				k |= mask;
+				bp->b_bitmap[word] = conv2(sp->s_native, (int) k);
+				bp->b_dirt = DIRTY;
+			}
+		}
+	}
+	if (bp != NIL_BUF) put_block(bp, MAP_BLOCK);
+	if (room < 0) panic("RAM disk pool too small for root image", NO_NUM);
+  }
 }
 
 
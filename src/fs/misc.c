@@ -15,6 +15,7 @@
 
 #include "fs.h"
 #include <fcntl.h>
+#include <sys/ioctl.h>
 #include <unistd.h>	/* cc runs out of memory with unistd.h :-( */
 #include <minix/callnr.h>
 #include <minix/com.h>
@@ -25,6 +26,7 @@
 #include "inode.h"
 #include "dev.h"
 #include "param.h"
+#include "super.h"
 
 
 /*===========================================================================*
@@ -134,6 +136,7 @@ PUBLIC int do_sync()
 
   register struct inode *rip;
   register struct buf *bp;
+  register struct super_block *sp;
 
   /* The order in which the various tables are flushed is critical.  The
    * blocks must be flushed last, since rw_inode() leaves its results in
@@ -148,6 +151,11 @@ PUBLIC int do_sync()
   for (bp = &buf[0]; bp < &buf[NR_BUFS]; bp++)
 	if (bp->b_dev != NO_DEV && bp->b_dirt == DIRTY) flushall(bp->b_dev);
 
+  /* Tell the drivers to write back what they cache themselves. */
+  for (sp = &super_block[0]; sp < &super_block[NR_SUPERS]; sp++)
+	if (sp->s_dev != NO_DEV) (void) dev_io(DEV_IOCTL, 0, sp->s_dev,
+				(off_t) 0, DIOCFLUSH, FS_PROC_NR, NIL_PTR);
+
   return(OK);		/* sync() can't fail */
 }
 
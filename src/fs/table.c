@@ -94,6 +94,8 @@ PUBLIC _PROTOTYPE (int (*call_vector[NCALLS]), (void) ) = {
 	no_sys,		/* 74 = SIGPROCMASK */
 	no_sys,		/* 75 = SIGRETURN */
 	no_sys,		/* 76 = REBOOT */
+	no_sys,		/* 77 = KTRACE */
+	no_sys,		/* 78 = PROFIL */
 };
 
 
@@ -29,7 +29,11 @@ THIS_FILE
 #endif
 #endif
 #ifndef BUF2K_NR
+#if CRAMPED
 #define BUF2K_NR	0
+#else
+#define BUF2K_NR	32
+#endif
 #endif
 #ifndef BUF32K_NR
 #define BUF32K_NR	0
@@ -107,6 +111,7 @@ FORWARD acc_t *_bf_small_memreq ARGS(( char *clnt_file, int clnt_line,
 #define bf_small_memreq(a) _bf_small_memreq(clnt_file, clnt_line, a)
 #endif
 FORWARD void free_accs ARGS(( void ));
+FORWARD int bf_avail ARGS(( size_t size ));
 #ifdef BUF_CONSISTENCY_CHECK
 FORWARD void count_free_bufs ARGS(( acc_t *list ));
 FORWARD int report_buffer ARGS(( buf_t *buf, char *label, int i ));
@@ -273,9 +278,14 @@ size_t size;
 		{
 			DBLOCK(1, printf("freeing buffers\n"));
 
+			/* Small buffers are only handed out for requests that
+			 * fit, so that a request of up to BUF_S bytes gets a
+			 * single buffer.  Free until one of the right kind is
+			 * back.
+			 */
 			bf_free_bufsize= 0;
-			for (i=0; bf_free_bufsize<size && i<MAX_BUFREQ_PRI;
-				i++)
+			for (i=0; (bf_free_bufsize<size || !bf_avail(size)) &&
+				i<MAX_BUFREQ_PRI; i++)
 			{
 				for (j=0; j<CLIENT_NR; j++)
 				{
@@ -291,7 +301,7 @@ size_t size;
 #if DEBUG
  { printf("last level was level %d\n", i-1); }
 #endif
-			if (bf_free_bufsize<size)
+			if (!bf_avail(size))
 				ip_panic(( "not enough buffers freed" ));
 
 			continue;
@@ -327,6 +337,29 @@ size_t size;
 	return head;
 }
 
+/*
+bf_avail
+*/
+
+PRIVATE int bf_avail(size)
+size_t size;
+{
+	/* Is there a free buffer that bf_memreq hands out for size bytes? */
+#if BUF512_NR
+	if (buf512_freelist && (512 == BUF_S || size <= 512))
+		return 1;
+#endif
+#if BUF2K_NR
+	if (buf2K_freelist && (2*1024 == BUF_S || size <= 2*1024))
+		return 1;
+#endif
+#if BUF32K_NR
+	if (buf32K_freelist && (32*1024 == BUF_S || size <= 32*1024))
+		return 1;
+#endif
+	return 0;
+}
+
 /*
 bf_small_memreq
 */
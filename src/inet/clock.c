@@ -15,12 +15,43 @@ THIS_FILE
 
 PUBLIC int clck_call_expire;
 
+/* Timers are kept in a hierarchical timing wheel.  The first level has a
+ * slot per tick for the block of CLCK_W0_NR ticks that contains wheel_time,
+ * the second level has a slot per block for the remainder of the current
+ * range of CLCK_W1_NR blocks.  Timers further away are kept on an unsorted
+ * overflow list.  Whenever wheel_time enters a new block, the second level
+ * slot of that block is spread over the first level (and at the start of a
+ * new range the overflow list over both levels).  Inserting and canceling
+ * a timer is O(1), only expiring timers walks the wheel.
+ */
+#define CLCK_W0_BITS	8
+#define CLCK_W0_NR	(1 << CLCK_W0_BITS)
+#define CLCK_W0_MASK	(CLCK_W0_NR-1)
+#define CLCK_W1_BITS	6
+#define CLCK_W1_NR	(1 << CLCK_W1_BITS)
+#define CLCK_W1_MASK	(CLCK_W1_NR-1)
+#define CLCK_RANGE_BITS	(CLCK_W0_BITS+CLCK_W1_BITS)
+#define CLCK_RANGE_MASK	((1L << CLCK_RANGE_BITS)-1)
+
+#define TL_WHEEL0	0
+#define TL_WHEEL1	1
+#define TL_OVERFLOW	2
+
 PRIVATE time_t curr_time;
-PRIVATE timer_t *timer_chain;
 PRIVATE time_t next_timeout;
+PRIVATE time_t wheel_time;		/* current tick of the wheel */
+PRIVATE timer_t *wheel0[CLCK_W0_NR];
+PRIVATE timer_t *wheel1[CLCK_W1_NR];
+PRIVATE timer_t *wheel_overflow;
+PRIVATE int wheel_count[3];		/* number of timers per level */
 
 FORWARD _PROTOTYPE( void clck_fast_release, (timer_t *timer) );
 FORWARD _PROTOTYPE( void set_timer, (void) );
+FORWARD _PROTOTYPE( void set_alarm, (time_t new_time) );
+FORWARD _PROTOTYPE( void wheel_insert, (timer_t *timer) );
+FORWARD _PROTOTYPE( void wheel_advance, (time_t new_time) );
+FORWARD _PROTOTYPE( void wheel_spread, (timer_t **list_p) );
+FORWARD _PROTOTYPE( time_t wheel_first, (void) );
 
 PUBLIC void clck_init()
 {
@@ -71,36 +102,25 @@ time_t timeout;
 timer_func_t func;
 int fd;
 {
-	timer_t *timer_index;
-
 	if (timer->tim_active)
 		clck_fast_release(timer);
 	assert(!timer->tim_active);
 
-	timer->tim_next= 0;
+	if (wheel_count[TL_WHEEL0] + wheel_count[TL_WHEEL1] +
+		wheel_count[TL_OVERFLOW] == 0 && wheel_time < get_time())
+	{
+		/* Nothing to expire, catch up with the current time. */
+		wheel_time= get_time();
+	}
+
 	timer->tim_func= func;
 	timer->tim_ref= fd;
 	timer->tim_time= timeout;
 	timer->tim_active= 1;
+	wheel_insert(timer);
 
-	if (!timer_chain)
-		timer_chain= timer;
-	else if (timeout < timer_chain->tim_time)
-	{
-		timer->tim_next= timer_chain;
-		timer_chain= timer;
-	}
-	else
-	{
-		timer_index= timer_chain;
-		while (timer_index->tim_next &&
-			timer_index->tim_next->tim_time < timeout)
-			timer_index= timer_index->tim_next;
-		timer->tim_next= timer_index->tim_next;
-		timer_index->tim_next= timer;
-	}
-	if (next_timeout == 0 || timer_chain->tim_time < next_timeout)
-		set_timer();
+	if (next_timeout == 0 || timeout < next_timeout)
+		set_alarm(timeout);
 }
 
 PUBLIC void clck_tick (mess)
@@ -113,34 +133,32 @@ message *mess;
 PRIVATE void clck_fast_release (timer)
 timer_t *timer;
 {
-	timer_t *timer_index;
-
 	if (!timer->tim_active)
 		return;
 
-	if (timer == timer_chain)
-		timer_chain= timer_chain->tim_next;
-	else
-	{
-		timer_index= timer_chain;
-		while (timer_index && timer_index->tim_next != timer)
-			timer_index= timer_index->tim_next;
-		assert(timer_index);
-		timer_index->tim_next= timer->tim_next;
-	}
+	*timer->tim_prevp= timer->tim_next;
+	if (timer->tim_next)
+		timer->tim_next->tim_prevp= timer->tim_prevp;
+	wheel_count[timer->tim_level]--;
 	timer->tim_active= 0;
 }
 
 PRIVATE void set_timer()
 {
 	time_t new_time;
-	time_t curr_time;
 
-	if (!timer_chain)
+	new_time= wheel_first();
+	if (new_time == 0)
 		return;
+	set_alarm(new_time);
+}
+
+PRIVATE void set_alarm(new_time)
+time_t new_time;
+{
+	time_t curr_time;
 
 	curr_time= get_time();
-	new_time= timer_chain->tim_time;
 	if (new_time <= curr_time)
 	{
 		clck_call_expire= 1;
@@ -168,32 +186,161 @@ PRIVATE void set_timer()
 PUBLIC void clck_untimer (timer)
 timer_t *timer;
 {
+	/* The alarm is left alone, an early alarm just finds nothing to
+	 * expire.
+	 */
 	clck_fast_release (timer);
-	set_timer();
 }
 
 PUBLIC void clck_expire_timers()
 {
-	time_t curr_time;
-	timer_t *timer_index;
+	time_t curr_time, next_time;
+	timer_t *timer;
 
 	clck_call_expire= 0;
 
-	if (timer_chain == NULL)
-		return;
-
+	/* Expire the slots up to and including the current time.  The wheel
+	 * stays at the current tick, so timers that are set for the current
+	 * time or earlier go into a slot that is expired on the next call.
+	 */
 	curr_time= get_time();
-	while (timer_chain && timer_chain->tim_time<=curr_time)
+	for (;;)
 	{
-		assert(timer_chain->tim_active);
-		timer_chain->tim_active= 0;
-		timer_index= timer_chain;
-		timer_chain= timer_chain->tim_next;
-		(*timer_index->tim_func)(timer_index->tim_ref, timer_index);
+		if (wheel_count[TL_WHEEL0] == 0)
+		{
+			/* Skip to the next block, or the next range if the
+			 * second level is empty as well.
+			 */
+			if (wheel_time >= curr_time ||
+				wheel_count[TL_WHEEL1] +
+				wheel_count[TL_OVERFLOW] == 0)
+			{
+				break;
+			}
+			if (wheel_count[TL_WHEEL1] == 0)
+				next_time= (wheel_time | CLCK_RANGE_MASK) + 1;
+			else
+				next_time= (wheel_time | CLCK_W0_MASK) + 1;
+			if (next_time > curr_time)
+				next_time= curr_time;
+			wheel_advance(next_time);
+			continue;
+		}
+
+		/* A timer function can move wheel_time forward by setting
+		 * the first timer of an empty wheel.
+		 */
+		while ((timer= wheel0[wheel_time & CLCK_W0_MASK]) != NULL)
+		{
+			assert(timer->tim_active);
+			clck_fast_release(timer);
+			(*timer->tim_func)(timer->tim_ref, timer);
+		}
+		if (wheel_time >= curr_time)
+			break;
+		wheel_advance(wheel_time+1);
 	}
 	set_timer();
 }
 
+PRIVATE void wheel_insert(timer)
+timer_t *timer;
+{
+	timer_t **list_p;
+	time_t t;
+
+	/* Timers in the past go into the current slot. */
+	t= timer->tim_time;
+	if (t < wheel_time)
+		t= wheel_time;
+
+	if ((t >> CLCK_W0_BITS) == (wheel_time >> CLCK_W0_BITS))
+	{
+		list_p= &wheel0[t & CLCK_W0_MASK];
+		timer->tim_level= TL_WHEEL0;
+	}
+	else if ((t >> CLCK_RANGE_BITS) == (wheel_time >> CLCK_RANGE_BITS))
+	{
+		list_p= &wheel1[(t >> CLCK_W0_BITS) & CLCK_W1_MASK];
+		timer->tim_level= TL_WHEEL1;
+	}
+	else
+	{
+		list_p= &wheel_overflow;
+		timer->tim_level= TL_OVERFLOW;
+	}
+	wheel_count[timer->tim_level]++;
+
+	timer->tim_next= *list_p;
+	if (timer->tim_next)
+		timer->tim_next->tim_prevp= &timer->tim_next;
+	timer->tim_prevp= list_p;
+	*list_p= timer;
+}
+
+PRIVATE void wheel_advance(new_time)
+time_t new_time;
+{
+	/* Move the wheel forward, the caller makes sure that no block
+	 * boundary is skipped while there are timers in the second level.
+	 */
+	wheel_time= new_time;
+	if ((wheel_time & CLCK_W0_MASK) != 0)
+		return;
+
+	if ((wheel_time & CLCK_RANGE_MASK) == 0)
+		wheel_spread(&wheel_overflow);
+	wheel_spread(&wheel1[(wheel_time >> CLCK_W0_BITS) & CLCK_W1_MASK]);
+}
+
+PRIVATE void wheel_spread(list_p)
+timer_t **list_p;
+{
+	timer_t *timer, *next;
+
+	timer= *list_p;
+	*list_p= NULL;
+	for (; timer; timer= next)
+	{
+		next= timer->tim_next;
+		wheel_count[timer->tim_level]--;
+		wheel_insert(timer);
+	}
+}
+
+PRIVATE time_t wheel_first()
+{
+	/* Return the time the first timer expires, or the start of the
+	 * block that contains it, 0 if there are no timers.
+	 */
+	timer_t *timer;
+	time_t t, first;
+
+	if (wheel_count[TL_WHEEL0] != 0)
+	{
+		for (t= wheel_time; wheel0[t & CLCK_W0_MASK] == NULL; t++)
+			assert(((t+1) & CLCK_W0_MASK) != 0);
+		return t;
+	}
+	if (wheel_count[TL_WHEEL1] != 0)
+	{
+		for (t= (wheel_time | CLCK_W0_MASK) + 1;
+			wheel1[(t >> CLCK_W0_BITS) & CLCK_W1_MASK] == NULL;
+			t += CLCK_W0_NR)
+		{
+			assert(((t+CLCK_W0_NR) & CLCK_RANGE_MASK) != 0);
+		}
+		return t;
+	}
+	first= 0;
+	for (timer= wheel_overflow; timer; timer= timer->tim_next)
+	{
+		if (first == 0 || timer->tim_time < first)
+			first= timer->tim_time;
+	}
+	return first;
+}
+
 /*
  * $PchId: clock.c,v 1.6 1995/11/21 06:54:39 philip Exp $
  */
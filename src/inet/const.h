@@ -29,7 +29,16 @@ Copyright 1995 Philip Homburg
 #define NW_WOULDBLOCK	EWOULDBLOCK
 #define NW_OK		OK
 
+/* The largest buffer size.  Large buffers let a full ethernet frame or
+ * a bulk transfer chunk live in a single buffer, which saves iovec and
+ * cpvec entries (and the work per entry) on every copy to the driver and
+ * to the user.
+ */
+#if CRAMPED
 #define BUF_S		512
+#else
+#define BUF_S		2048
+#endif
 
 #endif /* INET__CONST_H */
 
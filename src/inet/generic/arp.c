@@ -17,7 +17,14 @@ Copyright 1995 Philip Homburg
 
 THIS_FILE
 
-#define ARP_CACHE_NR	64
+#define ARP_CACHE_NR	(sizeof(int) == 2 ? 64 : 256)
+#define ARP_HASH_NR	32
+#define ARP_HASH_MASK	(ARP_HASH_NR-1)
+
+#define hash_arp(ipaddr, hash_tmp) (hash_tmp= (ipaddr), \
+	hash_tmp= (hash_tmp >> 16) ^ hash_tmp, \
+	hash_tmp= (hash_tmp >> 8) ^ hash_tmp, \
+	hash_tmp & ARP_HASH_MASK)
 
 #define MAX_ARP_RETRIES		5
 #define ARP_TIMEOUT		(HZ/2+1)	/* .5 seconds */
@@ -27,6 +34,9 @@ THIS_FILE
 #define ARP_NOTRCH_EXP_TIME	(5*HZ)		/* 5 seconds */
 #define ARP_INUSE_OFFSET	(60*HZ)	/* an entry in the cache can be deleted
 					   if its not used for 1 minute */
+#define ARP_REFRESH_TIME	(60L*HZ)	/* refresh an entry that is used
+						 * in the last minute before it
+						 * expires */
 
 typedef struct arp46
 {
@@ -72,11 +82,15 @@ typedef struct arp_port
 	ether_addr_t ap_write_ethaddr;
 	ipaddr_t ap_write_ipaddr;
 	int ap_write_code;
+	int ap_write_bcast;
 
-	ipaddr_t ap_req_ipaddr;
-	int ap_req_count;
+	struct arp_cache *ap_wrq_head;	/* entries with a reply or a request
+					 * to send */
+	struct arp_cache *ap_wrq_tail;
+	struct arp_cache *ap_reqlist;	/* requests waiting for a reply */
 
 	arp_func_t ap_arp_func;
+	nwio_arpstat_t ap_stat;
 } arp_port_t;
 
 #define APF_EMPTY	0
@@ -86,8 +100,7 @@ typedef struct arp_port
 #define APF_ARP_WR_SP	0x20
 #define APF_INADDR_SET	0x100
 #define APF_MORE2WRITE	0x200
-#define APF_CLIENTREQ	0x400
-#define APF_CLIENTWRITE	0x1000
+#define APF_CACHEWAIT	0x400	/* a request found the cache full */
 #define APF_SUSPEND	0x2000
 
 #define APS_INITIAL	0x00
@@ -106,10 +119,19 @@ typedef struct arp_cache
 	arp_port_t *ac_port;
 	time_t ac_expire;
 	time_t ac_lastuse;
+	time_t ac_reqtime;
+	int ac_retries;
+	struct arp_cache *ac_hashnext;
+	struct arp_cache *ac_wrqnext;
+	struct arp_cache *ac_reqnext;
 } arp_cache_t;
 
 #define ACF_EMPTY	0
-#define ACF_GOTREQ	1
+#define ACF_GOTREQ	1	/* a reply should be sent */
+#define ACF_SENDREQ	2	/* a request should be sent */
+#define ACF_REFRESH	4	/* valid entry with a request in progress */
+#define ACF_WRQ		8	/* on the write queue of the port */
+#define ACF_REQLIST	0x10	/* on the request list of the port */
 
 #define ACS_UNUSED	0
 #define ACS_INCOMPLETE	1
@@ -129,27 +151,46 @@ FORWARD void client_reply ARGS(( arp_port_t *arp_port,
 	ipaddr_t ipaddr, ether_addr_t *ethaddr ));
 FORWARD arp_cache_t *find_cache_ent ARGS(( arp_port_t *arp_port,
 	ipaddr_t ipaddr ));
-FORWARD arp_cache_t *alloc_cache_ent ARGS(( void ));
+FORWARD arp_cache_t *alloc_cache_ent ARGS(( arp_port_t *arp_port ));
+FORWARD void hash_cache_ent ARGS(( arp_cache_t *cache ));
+FORWARD void free_cache_ent ARGS(( arp_cache_t *cache ));
+FORWARD void send_request ARGS(( arp_port_t *arp_port, arp_cache_t *cache ));
+FORWARD void queue_write ARGS(( arp_port_t *arp_port, arp_cache_t *cache ));
+FORWARD void unqueue_write ARGS(( arp_cache_t *cache ));
+FORWARD void unlist_request ARGS(( arp_cache_t *cache ));
 
 PRIVATE arp_port_t arp_port_table[ARP_PORT_NR];
 /* PRIVATE arp_port_t *arp_port; */
 PRIVATE	arp_cache_t arp_cache[ARP_CACHE_NR];
+PRIVATE arp_cache_t *arp_hash[ARP_HASH_NR];
+PRIVATE arp_cache_t *arp_free;
 
 PUBLIC void arp_init()
 {
 	arp_port_t *arp_port;
+	arp_cache_t *cache;
 	int i;
 
 	assert (BUF_S >= sizeof(struct nwio_ethstat));
 	assert (BUF_S >= sizeof(struct nwio_ethopt));
 	assert (BUF_S >= sizeof(arp46_t));
+	assert (BUF_S >= sizeof(nwio_arpstat_t));
 
 	for (i=0, arp_port= arp_port_table; i<ARP_PORT_NR; i++, arp_port++)
 	{
 		arp_port->ap_state= APS_ERROR;	/* Mark all ports as
 						 * unavailable */
+		arp_port->ap_wrq_head= NULL;
+		arp_port->ap_reqlist= NULL;
 	}
 
+	arp_free= NULL;
+	for (i=0, cache= arp_cache; i<ARP_CACHE_NR; i++, cache++)
+	{
+		cache->ac_state= ACS_UNUSED;
+		cache->ac_hashnext= arp_free;
+		arp_free= cache;
+	}
 }
 
 PRIVATE void arp_main(arp_port)
@@ -194,13 +235,15 @@ arp_port_t *arp_port;
 			arp_cache_t *cache;
 			int i;
 
+			/* Flush the entries of a previous incarnation. */
 			cache= arp_cache;
 			for (i=0; i<ARP_CACHE_NR; i++, cache++)
 			{
-				cache->ac_state= ACS_UNUSED;
-				cache->ac_flags= ACF_EMPTY;
-				cache->ac_expire= 0;
-				cache->ac_lastuse= 0;
+				if (cache->ac_state != ACS_UNUSED &&
+					cache->ac_port == arp_port)
+				{
+					free_cache_ent(cache);
+				}
 			}
 		}
 		result= eth_ioctl (arp_port->ap_eth_fd, NWIOSETHOPT);
@@ -295,7 +338,7 @@ int for_ioctl;
 		arp= (arp46_t *)ptr2acc_data(data);
 		data->acc_offset += offset;
 		data->acc_length= count;
-		if (arp_port->ap_write_code == ARP_REPLY)
+		if (!arp_port->ap_write_bcast)
 			arp->a46_dstaddr= arp_port->ap_write_ethaddr;
 		else
 		{
@@ -432,44 +475,66 @@ arp_port_t *arp_port;
 PRIVATE void setup_write(arp_port)
 arp_port_t *arp_port;
 {
-	int i, result;
+	int result;
+	arp_cache_t *cache;
 
 	while (arp_port->ap_flags & APF_MORE2WRITE)
 	{
-		if (arp_port->ap_flags & APF_CLIENTWRITE)
+		cache= arp_port->ap_wrq_head;
+		if (cache == NULL)
 		{
-			arp_port->ap_flags &= ~APF_CLIENTWRITE;
-			arp_port->ap_write_ipaddr= arp_port->ap_req_ipaddr;
-			arp_port->ap_write_code= ARP_REQUEST;
-			clck_timer(&arp_port->ap_timer,
-				get_time() + ARP_TIMEOUT,
-				arp_timeout, arp_port-arp_port_table);
+			arp_port->ap_flags &= ~APF_MORE2WRITE;
+			break;
+		}
+		if (!(cache->ac_flags & (ACF_GOTREQ|ACF_SENDREQ)))
+		{
+			/* The request was answered before it was sent. */
+			unqueue_write(cache);
+			continue;
+		}
+		if (cache->ac_flags & ACF_GOTREQ)
+		{
+			cache->ac_flags &= ~ACF_GOTREQ;
+			arp_port->ap_write_ethaddr= cache->ac_ethaddr;
+			arp_port->ap_write_ipaddr= cache->ac_ipaddr;
+			arp_port->ap_write_code= ARP_REPLY;
+			arp_port->ap_write_bcast= FALSE;
 		}
 		else
 		{
-			arp_cache_t *cache;
-
-			cache= arp_cache;
-			for (i=0; i<ARP_CACHE_NR; i++, cache++)
+			/* A refresh of a valid entry is sent to the host
+			 * directly, new requests are broadcast.
+			 */
+			cache->ac_flags &= ~ACF_SENDREQ;
+			cache->ac_reqtime= get_time();
+			arp_port->ap_write_ipaddr= cache->ac_ipaddr;
+			arp_port->ap_write_code= ARP_REQUEST;
+			if (cache->ac_state == ACS_VALID)
 			{
-				if ((cache->ac_flags & ACF_GOTREQ) &&
-					cache->ac_port == arp_port)
-				{
-					cache->ac_flags &= ~ACF_GOTREQ;
-					arp_port->ap_write_ethaddr= cache->
-						ac_ethaddr;
-					arp_port->ap_write_ipaddr= cache->
-						ac_ipaddr;
-					arp_port->ap_write_code= ARP_REPLY;
-					break;
-				}
+				arp_port->ap_write_ethaddr= cache->ac_ethaddr;
+				arp_port->ap_write_bcast= FALSE;
 			}
-			if (i>=ARP_CACHE_NR)
+			else
 			{
-				arp_port->ap_flags &= ~APF_MORE2WRITE;
-				break;
+				memset(&arp_port->ap_write_ethaddr, '\0',
+					sizeof(arp_port->ap_write_ethaddr));
+				arp_port->ap_write_bcast= TRUE;
+			}
+			if (!(cache->ac_flags & ACF_REQLIST))
+			{
+				cache->ac_flags |= ACF_REQLIST;
+				cache->ac_reqnext= arp_port->ap_reqlist;
+				arp_port->ap_reqlist= cache;
+			}
+			if (!arp_port->ap_timer.tim_active)
+			{
+				clck_timer(&arp_port->ap_timer,
+					cache->ac_reqtime + ARP_TIMEOUT,
+					arp_timeout, arp_port-arp_port_table);
 			}
 		}
+		if (!(cache->ac_flags & (ACF_GOTREQ|ACF_SENDREQ)))
+			unqueue_write(cache);
 		arp_port->ap_flags= (arp_port->ap_flags & ~APF_ARP_WR_SP) |
 			APF_ARP_WR_IP;
 		result= eth_write(arp_port->ap_eth_fd, sizeof(arp46_t));
@@ -485,13 +550,78 @@ arp_port_t *arp_port;
 	}
 }
 
+PRIVATE void send_request(arp_port, cache)
+arp_port_t *arp_port;
+arp_cache_t *cache;
+{
+	cache->ac_flags |= ACF_SENDREQ;
+	queue_write(arp_port, cache);
+	if (!(arp_port->ap_flags & APF_ARP_WR_IP))
+		setup_write(arp_port);
+}
+
+PRIVATE void queue_write(arp_port, cache)
+arp_port_t *arp_port;
+arp_cache_t *cache;
+{
+	/* Put an entry with ACF_GOTREQ or ACF_SENDREQ set at the end of the
+	 * write queue, setup_write takes it from there.
+	 */
+	arp_port->ap_flags |= APF_MORE2WRITE;
+	if (cache->ac_flags & ACF_WRQ)
+		return;
+	cache->ac_flags |= ACF_WRQ;
+	cache->ac_wrqnext= NULL;
+	if (arp_port->ap_wrq_head == NULL)
+		arp_port->ap_wrq_head= cache;
+	else
+		arp_port->ap_wrq_tail->ac_wrqnext= cache;
+	arp_port->ap_wrq_tail= cache;
+}
+
+PRIVATE void unqueue_write(cache)
+arp_cache_t *cache;
+{
+	arp_port_t *arp_port;
+	arp_cache_t **cache_p, *prev;
+
+	assert(cache->ac_flags & ACF_WRQ);
+	arp_port= cache->ac_port;
+	prev= NULL;
+	for (cache_p= &arp_port->ap_wrq_head; *cache_p != cache;
+		cache_p= &(*cache_p)->ac_wrqnext)
+	{
+		assert(*cache_p != NULL);
+		prev= *cache_p;
+	}
+	*cache_p= cache->ac_wrqnext;
+	if (arp_port->ap_wrq_tail == cache)
+		arp_port->ap_wrq_tail= prev;
+	cache->ac_flags &= ~ACF_WRQ;
+}
+
+PRIVATE void unlist_request(cache)
+arp_cache_t *cache;
+{
+	arp_cache_t **cache_p;
+
+	assert(cache->ac_flags & ACF_REQLIST);
+	for (cache_p= &cache->ac_port->ap_reqlist; *cache_p != cache;
+		cache_p= &(*cache_p)->ac_reqnext)
+	{
+		assert(*cache_p != NULL);
+	}
+	*cache_p= cache->ac_reqnext;
+	cache->ac_flags &= ~ACF_REQLIST;
+}
+
 PRIVATE void process_arp_req (arp_port, data)
 arp_port_t *arp_port;
 acc_t *data;
 {
 	arp46_t *arp;
 	arp_cache_t *ce;
-	int level;
+	int level, reply;
 	time_t curr_time;
 	ipaddr_t spa, tpa;
 
@@ -507,11 +637,13 @@ acc_t *data;
 		arp->a46_pln != 4)
 		return;
 	ce= find_cache_ent(arp_port, spa);
-	if (ce && ce->ac_expire < curr_time)
+	if (ce && ce->ac_expire < curr_time &&
+		ce->ac_state != ACS_INCOMPLETE)
 	{
 		DBLOCK(0x10, printf("arp: expiring entry for ");
 			writeIpAddr(ce->ac_ipaddr); printf("\n"));
-		ce->ac_state= ACS_UNUSED;
+		arp_port->ap_stat.nwas_expire++;
+		free_cache_ent(ce);
 		ce= NULL;
 	}
 	if (ce == NULL)
@@ -522,7 +654,9 @@ acc_t *data;
 		DBLOCK(0x10, printf("arp: allocating entry for ");
 			writeIpAddr(spa); printf("\n"));
 
-		ce= alloc_cache_ent();
+		ce= alloc_cache_ent(arp_port);
+		if (ce == NULL)
+			return;
 		ce->ac_flags= ACF_EMPTY;
 		ce->ac_state= ACS_VALID;
 		ce->ac_ethaddr= arp->a46_sha;
@@ -530,18 +664,22 @@ acc_t *data;
 		ce->ac_port= arp_port;
 		ce->ac_expire= curr_time+ARP_EXP_TIME;
 		ce->ac_lastuse= curr_time-ARP_INUSE_OFFSET; /* never used */
+		ce->ac_reqtime= 0;
+		ce->ac_retries= 0;
+		hash_cache_ent(ce);
 	}
 
+	/* Any request for this host is answered. */
+	ce->ac_flags &= ~(ACF_SENDREQ|ACF_REFRESH);
+
+	/* The client is told last, the packets it sends may evict ce. */
+	reply= FALSE;
 	if (ce->ac_state == ACS_INCOMPLETE || ce->ac_state == ACS_UNREACHABLE)
 	{
 		ce->ac_ethaddr= arp->a46_sha;
 		if (ce->ac_state == ACS_INCOMPLETE)
-		{
-			ce->ac_state= ACS_VALID;
-			client_reply(arp_port, spa, &arp->a46_sha);
-		}
-		else
-			ce->ac_state= ACS_VALID;
+			reply= TRUE;
+		ce->ac_state= ACS_VALID;
 	}
 
 	/* Update fields in the arp cache. */
@@ -566,10 +704,12 @@ acc_t *data;
 	if (arp->a46_op == HTONS(ARP_REQUEST) && (tpa == arp_port->ap_ipaddr))
 	{
 		ce->ac_flags |= ACF_GOTREQ;
-		arp_port->ap_flags |= APF_MORE2WRITE;
+		queue_write(arp_port, ce);
 		if (!(arp_port->ap_flags & APF_ARP_WR_IP))
 			setup_write(arp_port);
 	}
+	if (reply)
+		client_reply(arp_port, spa, &arp->a46_sha);
 }
 
 PRIVATE void client_reply (arp_port, ipaddr, ethaddr)
@@ -577,12 +717,6 @@ arp_port_t *arp_port;
 ipaddr_t ipaddr;
 ether_addr_t *ethaddr;
 {
-	if ((arp_port->ap_flags & APF_CLIENTREQ) &&
-		ipaddr == arp_port->ap_req_ipaddr)
-	{
-		arp_port->ap_flags &= ~(APF_CLIENTREQ|APF_CLIENTWRITE);
-		clck_untimer(&arp_port->ap_timer);
-	}
 	(*arp_port->ap_arp_func)(arp_port-arp_port_table, ipaddr, ethaddr);
 }
 
@@ -591,37 +725,93 @@ arp_port_t *arp_port;
 ipaddr_t ipaddr;
 {
 	arp_cache_t *cache;
-	int i;
+	unsigned long hash_tmp;
 
-	for (i=0, cache= arp_cache; i<ARP_CACHE_NR; i++, cache++)
+	for (cache= arp_hash[hash_arp(ipaddr, hash_tmp)]; cache;
+		cache= cache->ac_hashnext)
 	{
-		if (cache->ac_state != ACS_UNUSED &&
-			cache->ac_port == arp_port &&
-			cache->ac_ipaddr == ipaddr)
+		if (cache->ac_ipaddr == ipaddr && cache->ac_port == arp_port)
 		{
+			assert(cache->ac_state != ACS_UNUSED);
 			return cache;
 		}
 	}
 	return NULL;
 }
 
-PRIVATE arp_cache_t *alloc_cache_ent()
+PRIVATE void hash_cache_ent(cache)
+arp_cache_t *cache;
 {
+	arp_cache_t **hash_p;
+	unsigned long hash_tmp;
+
+	hash_p= &arp_hash[hash_arp(cache->ac_ipaddr, hash_tmp)];
+	cache->ac_hashnext= *hash_p;
+	*hash_p= cache;
+}
+
+PRIVATE arp_cache_t *alloc_cache_ent(arp_port)
+arp_port_t *arp_port;
+{
+	/* Take an entry from the free list, or evict the least recently
+	 * used entry that is not waiting for a reply and has no reply of
+	 * its own to send.  The entry is not hashed, the caller fills it
+	 * in and calls hash_cache_ent.
+	 */
 	arp_cache_t *cache, *old;
 	int i;
 
+	if (arp_free != NULL)
+	{
+		cache= arp_free;
+		arp_free= cache->ac_hashnext;
+		return cache;
+	}
+
 	old= NULL;
 	for (i=0, cache= arp_cache; i<ARP_CACHE_NR; i++, cache++)
 	{
-		if (cache->ac_state == ACS_UNUSED)
-			return cache;
-		if (cache->ac_state == ACS_INCOMPLETE)
+		assert(cache->ac_state != ACS_UNUSED);
+		if (cache->ac_state == ACS_INCOMPLETE ||
+			(cache->ac_flags & ACF_GOTREQ))
+		{
 			continue;
+		}
 		if (!old || cache->ac_lastuse < old->ac_lastuse)
 			old= cache;
 	}
-	assert(old);
-	return old;
+	if (old == NULL)
+		return NULL;
+	arp_port->ap_stat.nwas_evict++;
+	free_cache_ent(old);
+	cache= arp_free;
+	arp_free= cache->ac_hashnext;
+	return cache;
+}
+
+PRIVATE void free_cache_ent(cache)
+arp_cache_t *cache;
+{
+	arp_cache_t **hash_p;
+	unsigned long hash_tmp;
+
+	assert(cache->ac_state != ACS_UNUSED);
+	for (hash_p= &arp_hash[hash_arp(cache->ac_ipaddr, hash_tmp)];
+		*hash_p != cache; hash_p= &(*hash_p)->ac_hashnext)
+	{
+		assert(*hash_p != NULL);
+	}
+	*hash_p= cache->ac_hashnext;
+
+	if (cache->ac_flags & ACF_WRQ)
+		unqueue_write(cache);
+	if (cache->ac_flags & ACF_REQLIST)
+		unlist_request(cache);
+
+	cache->ac_state= ACS_UNUSED;
+	cache->ac_flags= ACF_EMPTY;
+	cache->ac_hashnext= arp_free;
+	arp_free= cache;
 }
 
 PUBLIC void arp_set_ipaddr (ip_port, ipaddr)
@@ -671,7 +861,6 @@ ipaddr_t ipaddr;
 ether_addr_t *ethaddr;
 {
 	arp_port_t *arp_port;
-	int i;
 	arp_cache_t *ce;
 	time_t curr_time;
 
@@ -683,9 +872,11 @@ ether_addr_t *ethaddr;
 	curr_time= get_time();
 
 	ce= find_cache_ent (arp_port, ipaddr);
-	if (ce && ce->ac_expire < curr_time)
+	if (ce && ce->ac_expire < curr_time &&
+		ce->ac_state != ACS_INCOMPLETE)
 	{
-		ce->ac_state= ACS_UNUSED;
+		arp_port->ap_stat.nwas_expire++;
+		free_cache_ent(ce);
 		ce= NULL;
 	}
 	if (ce)
@@ -696,69 +887,182 @@ ether_addr_t *ethaddr;
 		ce->ac_lastuse= curr_time;
 		if (ce->ac_state == ACS_VALID)
 		{
+			arp_port->ap_stat.nwas_hit++;
+
+			/* Refresh an entry that is in use before it expires,
+			 * the old address is used until the reply arrives.
+			 */
+			if (ce->ac_expire - curr_time < ARP_REFRESH_TIME &&
+				!(ce->ac_flags & ACF_REFRESH))
+			{
+				arp_port->ap_stat.nwas_refresh++;
+				ce->ac_flags |= ACF_REFRESH;
+				ce->ac_retries= 0;
+				send_request(arp_port, ce);
+			}
 			*ethaddr= ce->ac_ethaddr;
 			return NW_OK;
 		}
 		if (ce->ac_state == ACS_UNREACHABLE)
+		{
+			arp_port->ap_stat.nwas_unreach++;
 			return EDSTNOTRCH;
+		}
 		assert(ce->ac_state == ACS_INCOMPLETE);
+		arp_port->ap_stat.nwas_pending++;
 		return NW_SUSPEND;
 	}
 
-	if (arp_port->ap_flags & APF_CLIENTREQ)
+	/* Start a new request.  Requests for different hosts proceed in
+	 * parallel, the caller queues its packets until client_reply
+	 * reports the result.
+	 */
+	ce= alloc_cache_ent(arp_port);
+	if (ce == NULL)
 	{
-		/* We should implement something to be able to do
-		 * multiple arp lookups at the same time. At the moment
-		 * we just return SUSPEND.
+		/* All entries are busy.  The caller queues the packet, the
+		 * timer calls client_reply to make it try again.
 		 */
+		arp_port->ap_stat.nwas_pending++;
+		arp_port->ap_flags |= APF_CACHEWAIT;
+		if (!arp_port->ap_timer.tim_active)
+		{
+			clck_timer(&arp_port->ap_timer, curr_time + ARP_TIMEOUT,
+				arp_timeout, arp_port-arp_port_table);
+		}
 		return NW_SUSPEND;
 	}
-	ce= alloc_cache_ent();
-	ce->ac_flags= 0;
+	arp_port->ap_stat.nwas_miss++;
+	ce->ac_flags= ACF_EMPTY;
 	ce->ac_state= ACS_INCOMPLETE;
 	ce->ac_ipaddr= ipaddr;
 	ce->ac_port= arp_port;
 	ce->ac_expire= curr_time+ARP_EXP_TIME;
 	ce->ac_lastuse= curr_time;
-	arp_port->ap_flags |= APF_CLIENTREQ|APF_MORE2WRITE | APF_CLIENTWRITE;
-	arp_port->ap_req_ipaddr= ipaddr;
-	arp_port->ap_req_count= 0;
-	if (!(arp_port->ap_flags & APF_ARP_WR_IP))
-		setup_write(arp_port);
+	ce->ac_reqtime= curr_time;
+	ce->ac_retries= 0;
+	hash_cache_ent(ce);
+	send_request(arp_port, ce);
 	return NW_SUSPEND;
 }
 
+PUBLIC int arp_get_stat (ip_port, arpstat)
+int ip_port;
+nwio_arpstat_t *arpstat;
+{
+	arp_port_t *arp_port;
+	arp_cache_t *cache;
+	int i, inuse;
+
+	if (ip_port < 0 || ip_port >= ARP_PORT_NR)
+		return ENXIO;
+	arp_port= &arp_port_table[ip_port];
+	if (arp_port->ap_state != APS_ARPMAIN)
+		return ENXIO;
+
+	inuse= 0;
+	for (i=0, cache= arp_cache; i<ARP_CACHE_NR; i++, cache++)
+	{
+		if (cache->ac_state != ACS_UNUSED &&
+			cache->ac_port == arp_port)
+		{
+			inuse++;
+		}
+	}
+	*arpstat= arp_port->ap_stat;
+	arpstat->nwas_inuse= inuse;
+	arpstat->nwas_size= ARP_CACHE_NR;
+	return NW_OK;
+}
+
 PRIVATE void arp_timeout (fd, timer)
 int fd;
 timer_t *timer;
 {
 	arp_port_t *arp_port;
-	arp_cache_t *ce;
-	int level;
-	time_t curr_time;
+	arp_cache_t *ce, **ce_p;
+	time_t curr_time, next_time;
 
 	arp_port= &arp_port_table[fd];
 
 	assert (timer == &arp_port->ap_timer);
 
-	if (++arp_port->ap_req_count < MAX_ARP_RETRIES)
-	{
-		arp_port->ap_flags |= APF_CLIENTWRITE|APF_MORE2WRITE;
-		if (!(arp_port->ap_flags & APF_ARP_WR_IP))
-			setup_write(arp_port);
-	}
-	else
+	curr_time= get_time();
+	next_time= 0;
+	ce_p= &arp_port->ap_reqlist;
+	while ((ce= *ce_p) != NULL)
 	{
-		ce= find_cache_ent(arp_port, arp_port->ap_req_ipaddr);
-		assert(ce && ce->ac_state == ACS_INCOMPLETE ||
-			(printf("ce= %p, ce->ac_state= %d\n",
-				ce, ce ? ce->ac_state : -1),0));
-		curr_time= get_time();
+		if (ce->ac_state != ACS_INCOMPLETE &&
+			!(ce->ac_flags & ACF_REFRESH))
+		{
+			unlist_request(ce);	/* Answered */
+			continue;
+		}
+		if (ce->ac_flags & ACF_SENDREQ)
+		{
+			unlist_request(ce);	/* Not sent yet */
+			continue;
+		}
+		if (ce->ac_reqtime + ARP_TIMEOUT > curr_time)
+		{
+			if (next_time == 0 ||
+				ce->ac_reqtime + ARP_TIMEOUT < next_time)
+			{
+				next_time= ce->ac_reqtime + ARP_TIMEOUT;
+			}
+			ce_p= &ce->ac_reqnext;
+			continue;
+		}
+
+		/* setup_write puts the entry back on the list when the
+		 * retry is sent.
+		 */
+		unlist_request(ce);
+		if (++ce->ac_retries < MAX_ARP_RETRIES)
+		{
+			ce->ac_flags |= ACF_SENDREQ;
+			queue_write(arp_port, ce);
+			continue;
+		}
+
+		arp_port->ap_stat.nwas_timeout++;
+		if (ce->ac_flags & ACF_REFRESH)
+		{
+			/* Keep using the old address until the entry
+			 * expires.
+			 */
+			ce->ac_flags &= ~ACF_REFRESH;
+			continue;
+		}
+
 		ce->ac_state= ACS_UNREACHABLE;
 		ce->ac_expire= curr_time+ ARP_NOTRCH_EXP_TIME;
 		ce->ac_lastuse= curr_time;
 
+		/* The client may change the list, start over. */
 		client_reply(arp_port, ce->ac_ipaddr, NULL);
+		ce_p= &arp_port->ap_reqlist;
+	}
+
+	if (arp_port->ap_flags & APF_CACHEWAIT)
+	{
+		/* No queued packet is for IP address 0, the client only
+		 * retries the requests it could not start.
+		 */
+		arp_port->ap_flags &= ~APF_CACHEWAIT;
+		client_reply(arp_port, (ipaddr_t)0, NULL);
+	}
+
+	/* Sending the retries restarts the timer. */
+	if (next_time != 0 && !arp_port->ap_timer.tim_active)
+	{
+		clck_timer(&arp_port->ap_timer, next_time, arp_timeout,
+			arp_port-arp_port_table);
+	}
+	if ((arp_port->ap_flags & APF_MORE2WRITE) &&
+		!(arp_port->ap_flags & APF_ARP_WR_IP))
+	{
+		setup_write(arp_port);
 	}
 }
 
@@ -20,6 +20,7 @@ void arp_init ARGS(( void ));
 void arp_set_ipaddr ARGS(( int ip_port, ipaddr_t ipaddr ));
 int arp_set_cb ARGS(( int ip_port, int eth_port, arp_func_t arp_func ));
 int arp_ip_eth ARGS(( int ip_port, ipaddr_t ipaddr, ether_addr_t *ethaddr ));
+int arp_get_stat ARGS(( int ip_port, nwio_arpstat_t *arpstat ));
 
 #endif /* ARP_H */
 
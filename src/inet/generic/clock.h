@@ -14,10 +14,12 @@ typedef void (*timer_func_t) ARGS(( int fd, struct timer *timer ));
 typedef struct timer
 {
 	struct timer *tim_next;
+	struct timer **tim_prevp;
 	timer_func_t tim_func;
 	int tim_ref;
 	time_t tim_time;
 	int tim_active;
+	int tim_level;
 } timer_t;
 
 extern int clck_call_expire;	/* Call clck_expire_timer from the mainloop */
@@ -82,6 +82,8 @@ PUBLIC void eth_init()
 	{
 		eth_port_table[i].etp_flags= EFF_EMPTY;
 		eth_port_table[i].etp_type_any= NULL;
+		eth_port_table[i].etp_wr_q_head= NULL;
+		eth_port_table[i].etp_wr_q_nr= 0;
 		ev_init(&eth_port_table[i].etp_sendev);
 		for (j= 0; j<ETH_TYPE_HASH_NR; j++)
 			eth_port_table[i].etp_type[j]= NULL;
@@ -397,6 +399,7 @@ size_t data_len;
 	eth_fd_t *eth_fd;
 	eth_port_t *eth_port;
 	eth_hdr_t *eth_hdr;
+	ether_addr_t *dst_addr;
 	acc_t *eth_pack;
 	unsigned long nweo_flags;
 	size_t count;
@@ -417,11 +420,28 @@ size_t data_len;
 		DBLOCK(1, printf("illegal packetsize (%d)\n",count));
 		return EPACKSIZE;
 	}
-	if (eth_port->etp_wr_pack)
-		return NW_WOULDBLOCK;
-	
 	nweo_flags= eth_fd->ef_ethopt.nweo_flags;
 
+	if (eth_port->etp_wr_pack)
+	{
+		/* A send is in progress. Frames for the wire are collected
+		 * for the next batch, but a loopback frame has to wait.
+		 */
+		if (eth_port->etp_wr_q_nr >= WR_FRAMES)
+			return NW_WOULDBLOCK;
+		if (nweo_flags & NWEO_REMSPEC)
+			dst_addr= &eth_fd->ef_ethopt.nweo_rem;
+		else if (!(nweo_flags & NWEO_RWDATONLY) &&
+			data->acc_length >= sizeof(*dst_addr))
+		{
+			dst_addr= (ether_addr_t *)ptr2acc_data(data);
+		}
+		else
+			return NW_WOULDBLOCK;
+		if (eth_addrcmp(*dst_addr, eth_port->etp_ethaddr) == 0)
+			return NW_WOULDBLOCK;
+	}
+
 	if (nweo_flags & NWEO_RWDATONLY)
 	{
 		eth_pack= bf_memreq(ETH_HDR_SIZE);
@@ -440,6 +460,7 @@ size_t data_len;
 	if (nweo_flags & NWEO_TYPESPEC)
 		eth_hdr->eh_proto= eth_fd->ef_ethopt.nweo_type;
 
+	eth_pack->acc_ext_link= NULL;
 	if (eth_addrcmp(eth_hdr->eh_dst, eth_port->etp_ethaddr) == 0)
 	{
 		/* Local loopback. */
@@ -447,6 +468,19 @@ size_t data_len;
 		ev_arg.ev_ptr= eth_port;
 		ev_enqueue(&eth_port->etp_sendev, eth_loop_ev, ev_arg);
 	}
+	else if (eth_port->etp_wr_pack)
+	{
+		/* Collect the frames that arrive while a send is in
+		 * progress. eth_restart_write passes them to the driver
+		 * in one batch.
+		 */
+		if (eth_port->etp_wr_q_head == NULL)
+			eth_port->etp_wr_q_head= eth_pack;
+		else
+			eth_port->etp_wr_q_tail->acc_ext_link= eth_pack;
+		eth_port->etp_wr_q_tail= eth_pack;
+		eth_port->etp_wr_q_nr++;
+	}
 	else
 		eth_write_port(eth_port, eth_pack);
 	return NW_OK;
@@ -664,6 +698,14 @@ eth_port_t *eth_port;
 
 	assert(eth_port->etp_wr_pack == NULL);
 
+	if (eth_port->etp_wr_q_head)
+	{
+		pack= eth_port->etp_wr_q_head;
+		eth_port->etp_wr_q_head= NULL;
+		eth_port->etp_wr_q_nr= 0;
+		eth_write_port(eth_port, pack);
+	}
+
 	if (!(eth_port->etp_flags & EPF_MORE2WRITE))
 		return;
 	eth_port->etp_flags &= ~EPF_MORE2WRITE;
@@ -904,8 +946,21 @@ PRIVATE void eth_bufcheck()
 
 	for (i= 0; i<ETH_PORT_NR; i++)
 	{
-		bf_check_acc(eth_port_table[i].etp_rd_pack);
-		bf_check_acc(eth_port_table[i].etp_wr_pack);
+		for (pack= eth_port_table[i].etp_rd_pack; pack;
+			pack= pack->acc_ext_link)
+		{
+			bf_check_acc(pack);
+		}
+		for (pack= eth_port_table[i].etp_wr_pack; pack;
+			pack= pack->acc_ext_link)
+		{
+			bf_check_acc(pack);
+		}
+		for (pack= eth_port_table[i].etp_wr_q_head; pack;
+			pack= pack->acc_ext_link)
+		{
+			bf_check_acc(pack);
+		}
 	}
 	for (i= 0, eth_fd= eth_fd_table; i<ETH_FD_NR; i++, eth_fd++)
 	{
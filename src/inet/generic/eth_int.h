@@ -14,6 +14,8 @@ typedef struct eth_port
 	int etp_flags;
 	ether_addr_t etp_ethaddr;
 	acc_t *etp_wr_pack, *etp_rd_pack;
+	acc_t *etp_wr_q_head, *etp_wr_q_tail;	/* frames for the next batch */
+	int etp_wr_q_nr;
 	struct eth_fd *etp_type_any;
 	struct eth_fd *etp_type[ETH_TYPE_HASH_NR];
 	event_t etp_sendev;
@@ -118,6 +118,7 @@ PUBLIC void ip_init()
 
 	icmp_init();
 	ipr_init();
+	ip_ass_init();
 
 	for (i=0, ip_port= ip_port_table; i<IP_PORT_NR; i++, ip_port++)
 	{
@@ -249,7 +250,6 @@ int priority;
 	int i;
 	ip_port_t *ip_port;
 	ip_fd_t *ip_fd;
-	ip_ass_t *ip_ass;
 	acc_t *pack, *next_pack;
 
 	for (i= 0, ip_port= ip_port_table; i<IP_PORT_NR; i++, ip_port++)
@@ -347,19 +347,7 @@ int priority;
 		}
 	}
 	if (priority == IP_PRI_ASSBUFS)
-	{
-		for (i= 0, ip_ass= ip_ass_table; i<IP_ASS_NR; i++, ip_ass++)
-		{
-			next_pack= ip_ass->ia_frags;
-			while(ip_ass->ia_frags != NULL)
-			{
-				pack= ip_ass->ia_frags;
-				ip_ass->ia_frags= pack->acc_ext_link;
-				bf_afree(pack);
-			}
-			ip_ass->ia_first_time= 0;
-		}
-	}
+		ip_ass_flush();
 }
 
 #ifdef BUF_CONSISTENCY_CHECK
@@ -8,7 +8,7 @@ Copyright 1995 Philip Homburg
 #define INET_IP_INT_H
 
 #define IP_FD_NR	32
-#define IP_ASS_NR	3
+#define IP_ASS_NR	(sizeof(int) == 2 ? 8 : 32)
 
 #define IP_42BSD_BCAST		1	/* hostnumber 0 is also network
 					   broadcast */
@@ -83,12 +83,16 @@ typedef struct ip_port
 
 typedef struct ip_ass
 {
-	acc_t *ia_frags;
+	acc_t *ia_frags;	/* sorted on offset, touching fragments are
+				 * merged, the gaps are the holes */
 	int ia_min_ttl;
 	ip_port_t *ia_port;
 	time_t ia_first_time;
 	ipaddr_t ia_srcaddr, ia_dstaddr;
 	int ia_proto, ia_id;
+	u32_t ia_size;		/* bytes held by ia_frags */
+	struct ip_ass *ia_hash_next;
+	struct ip_ass *ia_age_next;	/* per port, oldest first */
 } ip_ass_t;
 
 typedef struct ip_fd
@@ -153,6 +157,8 @@ void ip_port_arrive ARGS(( ip_port_t *port, acc_t *pack, ip_hdr_t *ip_hdr ));
 void ip_arrived ARGS(( ip_port_t *port, acc_t *pack ));
 void ip_arrived_broadcast ARGS(( ip_port_t *port, acc_t *pack ));
 void ip_process_loopb ARGS(( event_t *ev, ev_arg_t arg ));
+void ip_ass_init ARGS(( void ));
+void ip_ass_flush ARGS(( void ));
 
 /* ip_write.c */
 void dll_eth_write_frame ARGS(( ip_port_t *port ));
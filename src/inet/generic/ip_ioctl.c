@@ -230,6 +230,26 @@ ioreq_t req;
 		return (*ip_fd->if_put_userdata)(ip_fd->if_srfd, result, 
 							(acc_t *)0, TRUE);
 	
+	case NWIOGIPARPSTAT:
+		ip_port= ip_fd->if_port;
+		if (ip_port->ip_dl_type != IPDL_ETH)
+		{
+			return (*ip_fd->if_put_userdata)(ip_fd->if_srfd,
+				EBADIOCTL, (acc_t *)0, TRUE);
+		}
+		data= bf_memreq(sizeof(nwio_arpstat_t));
+		result= arp_get_stat(ip_port-ip_port_table,
+			(nwio_arpstat_t *)ptr2acc_data(data));
+		if (result < 0)
+			bf_afree(data);
+		else
+		{
+			result= (*ip_fd->if_put_userdata)(ip_fd->if_srfd, 0,
+				data, TRUE);
+		}
+		return (*ip_fd->if_put_userdata)(ip_fd->if_srfd,
+			result, (acc_t *)0, TRUE);
+
 	case NWIOGIPIROUTE:
 		data= (*ip_fd->if_get_userdata)(ip_fd->if_srfd,
 			0, sizeof(nwio_route_t), TRUE);
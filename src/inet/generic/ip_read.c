@@ -19,9 +19,32 @@ Copyright 1995 Philip Homburg
 
 THIS_FILE
 
+/* Reassembly tunables. Together the incomplete datagrams may hold about
+ * half of the buffer pool (see buf.c) and each gets IP_ASS_TIMEOUT to
+ * complete.
+ */
+#define IP_ASS_HASH_NR	16	/* power of 2 */
+#define IP_ASS_MEM	(sizeof(int) == 2 ? 8*1024L : 64*1024L)
+#define IP_ASS_TIMEOUT	(15L*HZ)
+
+PRIVATE ip_ass_t *ip_ass_hash[IP_ASS_HASH_NR];
+PRIVATE ip_ass_t *ip_ass_freelist;
+PRIVATE ip_ass_t *ip_ass_head[IP_PORT_NR];
+PRIVATE ip_ass_t *ip_ass_tail[IP_PORT_NR];
+PRIVATE timer_t ip_ass_timer[IP_PORT_NR];
+PRIVATE u32_t ip_ass_mem;
+PRIVATE ip_ass_t *ip_ass_busy;	/* entry reassemble() is merging into */
+
 FORWARD ip_ass_t *find_ass_ent ARGS(( ip_port_t *ip_port, U16_t id,
 	int proto, ipaddr_t src, ipaddr_t dst ));
-FORWARD acc_t *merge_frags ARGS(( acc_t *first, acc_t *second ));
+FORWARD void free_ass_ent ARGS(( ip_ass_t *ass_ent, int report ));
+FORWARD ip_ass_t *oldest_ass_ent ARGS(( ip_ass_t *except ));
+FORWARD int ass_hash ARGS(( U16_t id, int proto, ipaddr_t src,
+	ipaddr_t dst ));
+FORWARD void set_ass_timer ARGS(( int port_nr ));
+FORWARD void ass_timeout ARGS(( int port_nr, timer_t *timer ));
+FORWARD size_t frag_offset ARGS(( acc_t *pack ));
+FORWARD acc_t *merge_frags ARGS(( acc_t *first ));
 FORWARD int ip_frag_chk ARGS(( acc_t *pack ));
 FORWARD acc_t *reassemble ARGS(( ip_port_t *ip_port, acc_t *pack, 
 	ip_hdr_t *ip_hdr ));
@@ -64,73 +87,102 @@ size_t count;
 	return NW_SUSPEND;
 }
 
+PUBLIC void ip_ass_init()
+{
+	int i;
+	ip_ass_t *ass_ent;
+
+	ip_ass_freelist= NULL;
+	for (i= 0, ass_ent= ip_ass_table; i<IP_ASS_NR; i++, ass_ent++)
+	{
+		ass_ent->ia_frags= NULL;
+		ass_ent->ia_hash_next= ip_ass_freelist;
+		ip_ass_freelist= ass_ent;
+	}
+	for (i= 0; i<IP_ASS_HASH_NR; i++)
+		ip_ass_hash[i]= NULL;
+	for (i= 0; i<IP_PORT_NR; i++)
+	{
+		ip_ass_head[i]= NULL;
+		ip_ass_tail[i]= NULL;
+	}
+	ip_ass_mem= 0;
+}
+
+PUBLIC void ip_ass_flush()
+{
+	/* Drop the datagrams being reassembled.  The buffers may run out
+	 * while reassemble() merges fragments, so the entry it is working
+	 * on is left alone.
+	 */
+	int i;
+	ip_ass_t *ass_ent, *next_ent;
+
+	for (i= 0; i<IP_PORT_NR; i++)
+	{
+		for (ass_ent= ip_ass_head[i]; ass_ent != NULL; ass_ent= next_ent)
+		{
+			next_ent= ass_ent->ia_age_next;
+			if (ass_ent != ip_ass_busy)
+				free_ass_ent(ass_ent, FALSE);
+		}
+	}
+}
+
 PRIVATE acc_t *reassemble (ip_port, pack, pack_hdr)
 ip_port_t *ip_port;
 acc_t *pack;
 ip_hdr_t *pack_hdr;
 {
-	ip_ass_t *ass_ent;
-	size_t pack_hdr_len, pack_data_len, pack_offset, tmp_offset;
+	ip_ass_t *ass_ent, *old_ent;
+	size_t pack_offset;
 	u16_t pack_flags_fragoff;
-	acc_t *prev_acc, *curr_acc, *next_acc, *head_acc, *tmp_acc;
-	ip_hdr_t *tmp_hdr;
+	acc_t *prev_acc, *next_acc, *head_acc, *tmp_acc, **prevp;
 	time_t first_time;
+	int min_ttl;
 
 	ass_ent= find_ass_ent (ip_port, pack_hdr->ih_id,
 		pack_hdr->ih_proto, pack_hdr->ih_src, pack_hdr->ih_dst);
 
-	pack_flags_fragoff= ntohs(pack_hdr->ih_flags_fragoff);
-	pack_hdr_len= (pack_hdr->ih_vers_ihl & IH_IHL_MASK) * 4;
-	pack_data_len= ntohs(pack_hdr->ih_length)-pack_hdr_len;
-	pack_offset= (pack_flags_fragoff & IH_FRAGOFF_MASK)*8;
+	pack_offset= (ntohs(pack_hdr->ih_flags_fragoff) & IH_FRAGOFF_MASK)*8;
 	pack->acc_ext_link= NULL;
 
+	/* Find the last fragment that starts at or before this one,
+	 * prevp points to the link that refers to it.
+	 */
 	head_acc= ass_ent->ia_frags;
-	ass_ent->ia_frags= NULL;
-	if (head_acc == NULL)
-	{
-		ass_ent->ia_frags= pack;
-		return NULL;
-	}
-
+	prevp= &head_acc;
 	prev_acc= NULL;
-	curr_acc= NULL;
 	next_acc= head_acc;
-
-	while(next_acc)
+	while (next_acc && frag_offset(next_acc) <= pack_offset)
 	{
-		tmp_hdr= (ip_hdr_t *)ptr2acc_data(next_acc);
-		tmp_offset= (ntohs(tmp_hdr->ih_flags_fragoff) &
-			IH_FRAGOFF_MASK)*8;
-
-		if (pack_offset < tmp_offset)
-			break;
-
-		prev_acc= curr_acc;
-		curr_acc= next_acc;
+		if (prev_acc)
+			prevp= &prev_acc->acc_ext_link;
+		prev_acc= next_acc;
 		next_acc= next_acc->acc_ext_link;
 	}
-	if (curr_acc == NULL)
-	{
-		assert(prev_acc == NULL);
-		assert(next_acc != NULL);
-
-		curr_acc= merge_frags(pack, next_acc);
-		head_acc= curr_acc;
-	}
+	pack->acc_ext_link= next_acc;
+	ip_ass_busy= ass_ent;
+	if (prev_acc == NULL)
+		head_acc= merge_frags(pack);
 	else
 	{
-		curr_acc= merge_frags(curr_acc, pack);
-		if (next_acc != NULL)
-			curr_acc= merge_frags(curr_acc, next_acc);
-		if (prev_acc != NULL)
-			prev_acc->acc_ext_link= curr_acc;
-		else
-			head_acc= curr_acc;
+		prev_acc->acc_ext_link= pack;
+		prev_acc= merge_frags(prev_acc);
+		*prevp= prev_acc;
+		if (prev_acc->acc_ext_link == pack)
+			prev_acc->acc_ext_link= merge_frags(pack);
 	}
+	ip_ass_busy= NULL;
 	ass_ent->ia_frags= head_acc;
 
-	pack= ass_ent->ia_frags;
+	ip_ass_mem -= ass_ent->ia_size;
+	ass_ent->ia_size= 0;
+	for (tmp_acc= head_acc; tmp_acc; tmp_acc= tmp_acc->acc_ext_link)
+		ass_ent->ia_size += bf_bufsize(tmp_acc);
+	ip_ass_mem += ass_ent->ia_size;
+
+	pack= head_acc;
 	pack_hdr= (ip_hdr_t *)ptr2acc_data(pack);
 	pack_flags_fragoff= ntohs(pack_hdr->ih_flags_fragoff);
 
@@ -138,9 +190,10 @@ ip_hdr_t *pack_hdr;
 		/* it's now a complete packet */
 	{
 		first_time= ass_ent->ia_first_time;
+		min_ttl= ass_ent->ia_min_ttl;
 
-		ass_ent->ia_frags= 0;
-		ass_ent->ia_first_time= 0;
+		ass_ent->ia_frags= NULL;
+		free_ass_ent(ass_ent, FALSE);
 
 		while (pack->acc_ext_link)
 		{
@@ -148,83 +201,108 @@ ip_hdr_t *pack_hdr;
 			pack->acc_ext_link= tmp_acc->acc_ext_link;
 			bf_afree(tmp_acc);
 		}
-		if ((ass_ent->ia_min_ttl) * HZ + first_time <
-			get_time())
+		if (min_ttl * HZ + first_time < get_time())
 			icmp_snd_time_exceeded(ip_port-ip_port_table, pack,
 				ICMP_FRAG_REASSEM);
 		else
 			return pack;
+		return NULL;
+	}
+
+	/* Keep the fragments within the memory budget, the oldest
+	 * datagrams go first.
+	 */
+	while (ip_ass_mem > IP_ASS_MEM)
+	{
+		old_ent= oldest_ass_ent(ass_ent);
+		if (old_ent == NULL)
+			old_ent= ass_ent;
+		DBLOCK(1, printf(
+			"ip_read: reassembly memory full, dropping id %u\n",
+			ntohs(old_ent->ia_id)));
+		free_ass_ent(old_ent, FALSE);
+		if (old_ent == ass_ent)
+			break;
 	}
 	return NULL;
 }
 
-PRIVATE acc_t *merge_frags (first, second)
-acc_t *first, *second;
+PRIVATE size_t frag_offset(pack)
+acc_t *pack;
 {
+	ip_hdr_t *ip_hdr;
+
+	ip_hdr= (ip_hdr_t *)ptr2acc_data(pack);
+	return (ntohs(ip_hdr->ih_flags_fragoff) & IH_FRAGOFF_MASK)*8;
+}
+
+PRIVATE acc_t *merge_frags (first)
+acc_t *first;
+{
+	/* Merge first with the fragments that follow it as long as they
+	 * overlap or touch.  Returns the new first fragment, which is still
+	 * linked to the rest of the list.
+	 */
 	ip_hdr_t *first_hdr, *second_hdr;
 	size_t first_hdr_size, second_hdr_size, first_datasize, second_datasize,
 		first_offset, second_offset;
-	acc_t *cut_second, *tmp_acc;
+	acc_t *second, *cut_second, *next_acc;
 
-	if (!second)
+	while ((second= first->acc_ext_link) != NULL)
 	{
-		first->acc_ext_link= NULL;
-		return first;
-	}
-
 assert (first->acc_length >= IP_MIN_HDR_SIZE);
 assert (second->acc_length >= IP_MIN_HDR_SIZE);
 
-	first_hdr= (ip_hdr_t *)ptr2acc_data(first);
-	first_offset= (ntohs(first_hdr->ih_flags_fragoff) &
-		IH_FRAGOFF_MASK) * 8;
-	first_hdr_size= (first_hdr->ih_vers_ihl & IH_IHL_MASK) * 4;
-	first_datasize= ntohs(first_hdr->ih_length) - first_hdr_size;
+		first_hdr= (ip_hdr_t *)ptr2acc_data(first);
+		first_offset= (ntohs(first_hdr->ih_flags_fragoff) &
+			IH_FRAGOFF_MASK) * 8;
+		first_hdr_size= (first_hdr->ih_vers_ihl & IH_IHL_MASK) * 4;
+		first_datasize= ntohs(first_hdr->ih_length) - first_hdr_size;
 
-	second_hdr= (ip_hdr_t *)ptr2acc_data(second);
-	second_offset= (ntohs(second_hdr->ih_flags_fragoff) &
-		IH_FRAGOFF_MASK) * 8;
-	second_hdr_size= (second_hdr->ih_vers_ihl & IH_IHL_MASK) * 4;
-	second_datasize= ntohs(second_hdr->ih_length) - second_hdr_size;
+		second_hdr= (ip_hdr_t *)ptr2acc_data(second);
+		second_offset= (ntohs(second_hdr->ih_flags_fragoff) &
+			IH_FRAGOFF_MASK) * 8;
+		second_hdr_size= (second_hdr->ih_vers_ihl & IH_IHL_MASK) * 4;
+		second_datasize= ntohs(second_hdr->ih_length) - second_hdr_size;
 
-	assert (first_hdr_size + first_datasize == bf_bufsize(first));
-	assert (second_hdr_size + second_datasize == bf_bufsize(second));
-	assert (second_offset >= first_offset);
+		assert (first_hdr_size + first_datasize == bf_bufsize(first));
+		assert (second_hdr_size + second_datasize ==
+			bf_bufsize(second));
+		assert (second_offset >= first_offset);
 
-	if (second_offset > first_offset+first_datasize)
-	{
-		DBLOCK(1, printf("ip fragments out of order\n"));
-		first->acc_ext_link= second;
-		return first;
-	}
+		if (second_offset > first_offset+first_datasize)
+		{
+			/* There is a hole between first and second */
+			break;
+		}
 
-	if (second_offset + second_datasize <= first_offset +
-		first_datasize)
-	{
-		/* May cause problems if we try to merge. */
-		bf_afree(first);
-		return second;
-	}
+		next_acc= second->acc_ext_link;
+		if (!(second_hdr->ih_flags_fragoff & HTONS(IH_MORE_FRAGS)))
+			first_hdr->ih_flags_fragoff &= ~HTONS(IH_MORE_FRAGS);
 
-	if (!(second_hdr->ih_flags_fragoff & HTONS(IH_MORE_FRAGS)))
-		first_hdr->ih_flags_fragoff &= ~HTONS(IH_MORE_FRAGS);
+		if (second_offset + second_datasize <= first_offset +
+			first_datasize)
+		{
+			/* Nothing new in second */
+			bf_afree(second);
+			first->acc_ext_link= next_acc;
+			continue;
+		}
 
-	second_datasize= second_offset+second_datasize-(first_offset+
-		first_datasize);
-	cut_second= bf_cut(second, second_hdr_size + first_offset+
-		first_datasize-second_offset, second_datasize);
-	tmp_acc= second->acc_ext_link;
-	bf_afree(second);
-	second= tmp_acc;
+		second_datasize= second_offset+second_datasize-(first_offset+
+			first_datasize);
+		cut_second= bf_cut(second, second_hdr_size + first_offset+
+			first_datasize-second_offset, second_datasize);
+		bf_afree(second);
 
-	first_datasize += second_datasize;
-	first_hdr->ih_length= htons(first_hdr_size + first_datasize);
+		first_datasize += second_datasize;
+		first_hdr->ih_length= htons(first_hdr_size + first_datasize);
 
-	first= bf_append (first, cut_second);
-	first->acc_ext_link= second;
+		first= bf_append (first, cut_second);
+		first->acc_ext_link= next_acc;
 
 assert (first_hdr_size + first_datasize == bf_bufsize(first));
-
+	}
 	return first;
 }
 
@@ -235,66 +313,207 @@ ipproto_t proto;
 ipaddr_t src;
 ipaddr_t dst;
 {
-	ip_ass_t *new_ass_ent, *tmp_ass_ent;
-	int i;
-	acc_t *tmp_acc, *curr_acc;
+	ip_ass_t *ass_ent;
+	int hash, port_nr;
+
+	hash= ass_hash(id, proto, src, dst);
+	for (ass_ent= ip_ass_hash[hash]; ass_ent;
+		ass_ent= ass_ent->ia_hash_next)
+	{
+		if ((ass_ent->ia_srcaddr == src) &&
+			(ass_ent->ia_dstaddr == dst) &&
+			(ass_ent->ia_proto == proto) &&
+			(ass_ent->ia_id == id) &&
+			(ass_ent->ia_port == ip_port))
+		{
+			return ass_ent;
+		}
+	}
+
+	if (ip_ass_freelist == NULL)
+	{
+		ass_ent= oldest_ass_ent(NULL);
+		assert(ass_ent != NULL);
+		DBLOCK(1, printf("old frags id= %u, proto= %u, src= ",
+			ntohs(ass_ent->ia_id),
+			ntohs(ass_ent->ia_proto));
+			writeIpAddr(ass_ent->ia_srcaddr); printf(" dst= ");
+			writeIpAddr(ass_ent->ia_dstaddr); printf(": ");
+			ip_print_frags(ass_ent->ia_frags); printf("\n"));
+		free_ass_ent(ass_ent, FALSE);
+	}
+	ass_ent= ip_ass_freelist;
+	ip_ass_freelist= ass_ent->ia_hash_next;
+
+	ass_ent->ia_frags= NULL;
+	ass_ent->ia_size= 0;
+	ass_ent->ia_min_ttl= IP_MAX_TTL;
+	ass_ent->ia_port= ip_port;
+	ass_ent->ia_first_time= get_time();
+	ass_ent->ia_srcaddr= src;
+	ass_ent->ia_dstaddr= dst;
+	ass_ent->ia_proto= proto;
+	ass_ent->ia_id= id;
+
+	ass_ent->ia_hash_next= ip_ass_hash[hash];
+	ip_ass_hash[hash]= ass_ent;
+
+	/* New entries are the youngest of their port */
+	port_nr= ip_port-ip_port_table;
+	ass_ent->ia_age_next= NULL;
+	if (ip_ass_head[port_nr] == NULL)
+	{
+		ip_ass_head[port_nr]= ass_ent;
+		set_ass_timer(port_nr);
+	}
+	else
+		ip_ass_tail[port_nr]->ia_age_next= ass_ent;
+	ip_ass_tail[port_nr]= ass_ent;
+
+	return ass_ent;
+}
+
+PRIVATE void free_ass_ent (ass_ent, report)
+ip_ass_t *ass_ent;
+int report;
+{
+	ip_ass_t **ass_p, *prev_ent;
+	acc_t *pack, *tmp_acc;
+	int port_nr;
 
-	new_ass_ent= 0;
+	port_nr= ass_ent->ia_port-ip_port_table;
 
-	for (i=0, tmp_ass_ent= ip_ass_table; i<IP_ASS_NR; i++,
-		tmp_ass_ent++)
+	for (ass_p= &ip_ass_hash[ass_hash(ass_ent->ia_id, ass_ent->ia_proto,
+		ass_ent->ia_srcaddr, ass_ent->ia_dstaddr)];
+		*ass_p != ass_ent; ass_p= &(*ass_p)->ia_hash_next)
 	{
-		if (!tmp_ass_ent->ia_frags && tmp_ass_ent->ia_first_time)
+		assert(*ass_p != NULL);
+	}
+	*ass_p= ass_ent->ia_hash_next;
+
+	if (ip_ass_head[port_nr] == ass_ent)
+	{
+		ip_ass_head[port_nr]= ass_ent->ia_age_next;
+		if (ip_ass_head[port_nr] == NULL)
+			ip_ass_tail[port_nr]= NULL;
+		set_ass_timer(port_nr);
+	}
+	else
+	{
+		for (prev_ent= ip_ass_head[port_nr];
+			prev_ent->ia_age_next != ass_ent;
+			prev_ent= prev_ent->ia_age_next)
 		{
-			DBLOCK(1,
-		printf("strange ip_ass entry (can be a race condition)\n"));
-			continue;
+			assert(prev_ent->ia_age_next != NULL);
 		}
+		prev_ent->ia_age_next= ass_ent->ia_age_next;
+		if (ip_ass_tail[port_nr] == ass_ent)
+			ip_ass_tail[port_nr]= prev_ent;
+	}
 
-		if ((tmp_ass_ent->ia_srcaddr == src) &&
-			(tmp_ass_ent->ia_dstaddr == dst) &&
-			(tmp_ass_ent->ia_proto == proto) &&
-			(tmp_ass_ent->ia_id == id) &&
-			(tmp_ass_ent->ia_port == ip_port))
+	pack= ass_ent->ia_frags;
+	ass_ent->ia_frags= NULL;
+	if (pack != NULL)
+	{
+		while (pack->acc_ext_link)
 		{
-			return tmp_ass_ent;
+			tmp_acc= pack->acc_ext_link;
+			pack->acc_ext_link= tmp_acc->acc_ext_link;
+			bf_afree(tmp_acc);
 		}
-		if (!new_ass_ent || tmp_ass_ent->ia_first_time <
-			new_ass_ent->ia_first_time)
+
+		/* Only report a timeout if the first fragment arrived
+		 * (RFC-1122, 3.3.2).
+		 */
+		if (report && frag_offset(pack) == 0)
 		{
-			new_ass_ent= tmp_ass_ent;
+			icmp_snd_time_exceeded(port_nr, pack,
+				ICMP_FRAG_REASSEM);
 		}
+		else
+			bf_afree(pack);
 	}
+	ip_ass_mem -= ass_ent->ia_size;
+	ass_ent->ia_size= 0;
 
-	if (new_ass_ent->ia_frags)
+	ass_ent->ia_hash_next= ip_ass_freelist;
+	ip_ass_freelist= ass_ent;
+}
+
+PRIVATE ip_ass_t *oldest_ass_ent (except)
+ip_ass_t *except;
+{
+	/* The age lists are sorted, so only the heads (or the entry after
+	 * except) have to be compared.
+	 */
+	ip_ass_t *ass_ent, *oldest;
+	int i;
+
+	oldest= NULL;
+	for (i= 0; i<IP_PORT_NR; i++)
 	{
-		DBLOCK(1, printf("old frags id= %u, proto= %u, src= ",
-			ntohs(new_ass_ent->ia_id),
-			ntohs(new_ass_ent->ia_proto));
-			writeIpAddr(new_ass_ent->ia_srcaddr); printf(" dst= ");
-			writeIpAddr(new_ass_ent->ia_dstaddr); printf(": ");
-			ip_print_frags(new_ass_ent->ia_frags); printf("\n"));
-		curr_acc= new_ass_ent->ia_frags->acc_ext_link;
-		while (curr_acc)
+		ass_ent= ip_ass_head[i];
+		if (ass_ent == except && ass_ent != NULL)
+			ass_ent= ass_ent->ia_age_next;
+		if (ass_ent == NULL)
+			continue;
+		if (oldest == NULL || ass_ent->ia_first_time <
+			oldest->ia_first_time)
 		{
-			tmp_acc= curr_acc->acc_ext_link;
-			bf_afree(curr_acc);
-			curr_acc= tmp_acc;
+			oldest= ass_ent;
 		}
-		curr_acc= new_ass_ent->ia_frags;
-		new_ass_ent->ia_frags= 0;
-		icmp_snd_time_exceeded(ip_port-ip_port_table, curr_acc,
-			ICMP_FRAG_REASSEM);
-	}
-	new_ass_ent->ia_min_ttl= IP_MAX_TTL;
-	new_ass_ent->ia_port= ip_port;
-	new_ass_ent->ia_first_time= get_time();
-	new_ass_ent->ia_srcaddr= src;
-	new_ass_ent->ia_dstaddr= dst;
-	new_ass_ent->ia_proto= proto;
-	new_ass_ent->ia_id= id;
-
-	return new_ass_ent;
+	}
+	return oldest;
+}
+
+PRIVATE int ass_hash (id, proto, src, dst)
+u16_t id;
+ipproto_t proto;
+ipaddr_t src;
+ipaddr_t dst;
+{
+	u32_t hash;
+
+	hash= src ^ dst;
+	hash ^= hash >> 16;
+	hash ^= id ^ proto;
+	hash ^= hash >> 8;
+	return hash & (IP_ASS_HASH_NR-1);
+}
+
+PRIVATE void set_ass_timer (port_nr)
+int port_nr;
+{
+	ip_ass_t *ass_ent;
+
+	ass_ent= ip_ass_head[port_nr];
+	if (ass_ent == NULL)
+	{
+		clck_untimer(&ip_ass_timer[port_nr]);
+		return;
+	}
+	clck_timer(&ip_ass_timer[port_nr],
+		ass_ent->ia_first_time + IP_ASS_TIMEOUT, ass_timeout, port_nr);
+}
+
+PRIVATE void ass_timeout (port_nr, timer)
+int port_nr;
+timer_t *timer;
+{
+	ip_ass_t *ass_ent;
+	time_t curr_time;
+
+	assert(timer == &ip_ass_timer[port_nr]);
+
+	curr_time= get_time();
+	while ((ass_ent= ip_ass_head[port_nr]) != NULL &&
+		ass_ent->ia_first_time + IP_ASS_TIMEOUT <= curr_time)
+	{
+		DBLOCK(1, printf("ip_read: reassembly of id %u timed out\n",
+			ntohs(ass_ent->ia_id)));
+		free_ass_ent(ass_ent, TRUE);
+	}
+	set_ass_timer(port_nr);
 }
 
 PRIVATE int ip_frag_chk(pack)
@@ -17,8 +17,11 @@ Copyright 1995 Philip Homburg
 
 THIS_FILE
 
-#define OROUTE_NR		32
-#define OROUTE_STATIC_NR	16
+/* On a 16-bit system inet has a single data segment, so the tables stay
+ * small there and the trie mostly saves the time spent per route.
+ */
+#define OROUTE_NR		(sizeof(int) == 2 ? 64 : 2048)
+#define OROUTE_STATIC_NR	(OROUTE_NR/2)
 #define OROUTE_HASH_ASS_NR	 4
 #define OROUTE_HASH_NR		32
 #define OROUTE_HASH_MASK	(OROUTE_HASH_NR-1)
@@ -36,11 +39,11 @@ typedef struct oroute_hash
 } oroute_hash_t;
 
 PRIVATE oroute_t oroute_table[OROUTE_NR];
-PRIVATE oroute_t *oroute_head;
+PRIVATE oroute_t *oroute_free;
 PRIVATE int static_oroute_nr;
 PRIVATE oroute_hash_t oroute_hash_table[OROUTE_HASH_NR][OROUTE_HASH_ASS_NR];
 
-#define IROUTE_NR		(sizeof(int) == 2 ? 64 : 512)
+#define IROUTE_NR		(sizeof(int) == 2 ? 64 : 2048)
 #define IROUTE_HASH_ASS_NR	 4
 #define IROUTE_HASH_NR		32
 #define IROUTE_HASH_MASK	(IROUTE_HASH_NR-1)
@@ -58,33 +61,93 @@ typedef struct iroute_hash
 } iroute_hash_t;
 
 PRIVATE iroute_t iroute_table[IROUTE_NR];
+PRIVATE iroute_t *iroute_free;
 PRIVATE iroute_hash_t iroute_hash_table[IROUTE_HASH_NR][IROUTE_HASH_ASS_NR];
 
+/* Both routing tables are indexed by a path compressed binary radix trie
+ * (Patricia trie) keyed on the network prefix.  Every node holds a prefix
+ * (in host byte order) and its length in bits, the two children continue
+ * with the next bit after the prefix.  A node either carries the routes
+ * for exactly its prefix in rtn_data, or is an internal branch node with
+ * two children.  Lookups walk down the trie and remember the last node
+ * with routes, which gives the longest prefix match in at most 32 steps.
+ *
+ * Output routes are kept in one trie per IP port, rtn_data points to the
+ * head of the gateway/distance lists of the network (formerly linked
+ * through a global list).  Input routes are kept in a single trie,
+ * rtn_data points to the list of routes for that network, linked through
+ * irt_next.  Each distinct prefix needs at most two nodes.
+ */
+typedef struct rtnode
+{
+	u32_t rtn_key;
+	int rtn_len;
+	void *rtn_data;
+	struct rtnode *rtn_child[2];
+	struct rtnode *rtn_parent;
+} rtnode_t;
+
+#define RTNODE_NR		(2*(OROUTE_NR + IROUTE_NR))
+
+#define rt_bit(key, n)	((int)(((key) >> (31-(n))) & 1))
+#define rt_mask(len)	((len) == 0 ? (u32_t)0 : \
+				(u32_t)0xffffffffL << (32-(len)))
+
+PRIVATE rtnode_t rtnode_table[RTNODE_NR];
+PRIVATE rtnode_t *rtnode_free;
+PRIVATE rtnode_t *oroute_trie[IP_PORT_NR];
+PRIVATE rtnode_t *iroute_trie;
+
 FORWARD oroute_t *oroute_find_ent ARGS(( int port_nr, ipaddr_t dest ));
 FORWARD void oroute_del ARGS(( oroute_t *oroute ));
+FORWARD void oroute_release ARGS(( oroute_t *oroute ));
 FORWARD oroute_t *sort_dists ARGS(( oroute_t *oroute ));
 FORWARD oroute_t *sort_gws ARGS(( oroute_t *oroute ));
 FORWARD	oroute_uncache_nw ARGS(( ipaddr_t dest, ipaddr_t netmask ));
 FORWARD	iroute_uncache_nw ARGS(( ipaddr_t dest, ipaddr_t netmask ));
+FORWARD int rt_masklen ARGS(( ipaddr_t netmask ));
+FORWARD rtnode_t *rt_alloc ARGS(( u32_t key, int len, rtnode_t *parent ));
+FORWARD rtnode_t *rt_lookup ARGS(( rtnode_t *root, ipaddr_t dest,
+							ipaddr_t netmask ));
+FORWARD rtnode_t *rt_insert ARGS(( rtnode_t **rootp, ipaddr_t dest,
+							ipaddr_t netmask ));
+FORWARD rtnode_t *rt_match ARGS(( rtnode_t *root, ipaddr_t dest ));
+FORWARD void rt_prune ARGS(( rtnode_t **rootp, rtnode_t *node ));
 
 PUBLIC void ipr_init()
 {
 	int i;
 	oroute_t *oroute;
 	iroute_t *iroute;
+	rtnode_t *rtnode;
 
 #if ZERO
-	for (i= 0, oroute= oroute_table; i<OROUTE_NR; i++, oroute++)
-		oroute->ort_flags= ORTF_EMPTY;
 	static_oroute_nr= 0;
 #endif
+	oroute_free= NULL;
+	for (i= 0, oroute= oroute_table; i<OROUTE_NR; i++, oroute++)
+	{
+		oroute->ort_flags= ORTF_EMPTY;
+		oroute->ort_nextgw= oroute_free;
+		oroute_free= oroute;
+	}
 	assert(OROUTE_HASH_ASS_NR == 4);
 
-#if ZERO
+	iroute_free= NULL;
 	for (i= 0, iroute= iroute_table; i<IROUTE_NR; i++, iroute++)
+	{
 		iroute->irt_flags= IRTF_EMPTY;
-#endif
+		iroute->irt_next= iroute_free;
+		iroute_free= iroute;
+	}
 	assert(IROUTE_HASH_ASS_NR == 4);
+
+	rtnode_free= NULL;
+	for (i= 0, rtnode= rtnode_table; i<RTNODE_NR; i++, rtnode++)
+	{
+		rtnode->rtn_parent= rtnode_free;
+		rtnode_free= rtnode;
+	}
 }
 
 
@@ -92,10 +155,11 @@ PUBLIC iroute_t *iroute_frag(port_nr, dest)
 int port_nr;
 ipaddr_t dest;
 {
-	int hash, i, r_hash_ind;
+	int hash;
 	iroute_hash_t *iroute_hash;
 	iroute_hash_t tmp_hash;
 	iroute_t *iroute, *bestroute;
+	rtnode_t *rtnode;
 	time_t currtim;
 	unsigned long hash_tmp;
 
@@ -134,30 +198,21 @@ ipaddr_t dest;
 	if (iroute)
 		return iroute;
 
+	rtnode= rt_match(iroute_trie, dest);
+	if (rtnode == NULL)
+		return NULL;
+
+	/* All routes on the list have the same, longest matching, prefix. */
 	bestroute= NULL;
-	for (i= 0, iroute= iroute_table; i < IROUTE_NR; i++, iroute++)
+	for (iroute= rtnode->rtn_data; iroute; iroute= iroute->irt_next)
 	{
-		if (!(iroute->irt_flags & IRTF_INUSE))
-			continue;
-		if (((dest ^ iroute->irt_dest) & iroute->irt_subnetmask) != 0)
-			continue;
+		assert(iroute->irt_flags & IRTF_INUSE);
 		if (!bestroute)
 		{
 			bestroute= iroute;
 			continue;
 		}
 
-		/* More specific netmasks are better */
-		if (iroute->irt_subnetmask != bestroute->irt_subnetmask)
-		{
-			if (ntohl(iroute->irt_subnetmask) > 
-				ntohl(bestroute->irt_subnetmask))
-			{
-				bestroute= iroute;
-			}
-			continue;
-		}
-			
 		/* Dynamic routes override static routes */
 		if ((iroute->irt_flags & IRTF_STATIC) != 
 			(bestroute->irt_flags & IRTF_STATIC))
@@ -222,11 +277,20 @@ oroute_t **oroute_p;
 	ip_port_t *ip_port;
 	oroute_t *oroute, *oldest_route, *prev, *nw_route, *gw_route, 
 		*prev_route;
+	rtnode_t *rtnode;
 	time_t currtim;
 
 	oldest_route= 0;
 	currtim= get_time();
 
+	if (rt_masklen(subnetmask) < 0)
+	{
+		DBLOCK(1, printf("ipr_add_oroute: non-contiguous netmask: ");
+			writeIpAddr(subnetmask); printf("\n"));
+		return EINVAL;
+	}
+	dest &= subnetmask;
+
 	DBLOCK(0x10, 
 		printf("adding oroute to "); writeIpAddr(dest);
 		printf("["); writeIpAddr(subnetmask); printf("] through ");
@@ -252,16 +316,8 @@ oroute_t **oroute_p;
 	else
 	{
 		/* Try to track down any old routes. */
-		for(oroute= oroute_head; oroute; oroute= oroute->ort_nextnw)
-		{
-			if (oroute->ort_port != port_nr)
-				continue;
-			if (oroute->ort_dest == dest &&
-				oroute->ort_subnetmask == subnetmask)
-			{
-				break;
-			}
-		}
+		rtnode= rt_lookup(oroute_trie[port_nr], dest, subnetmask);
+		oroute= rtnode ? rtnode->rtn_data : NULL;
 		for(; oroute; oroute= oroute->ort_nextgw)
 		{
 			if (oroute->ort_gateway == gateway)
@@ -297,13 +353,18 @@ oroute_t **oroute_p;
 		}
 	}
 
+	if (oldest_route == NULL && oroute_free != NULL)
+	{
+		/* Take an unused entry */
+		oldest_route= oroute_free;
+		oroute_free= oldest_route->ort_nextgw;
+	}
 	if (oldest_route == NULL)
 	{
-		/* Look for an unused entry, or remove an existing one */
+		/* The table is full, remove an expired or the oldest route */
 		for (i= 0, oroute= oroute_table; i<OROUTE_NR; i++, oroute++)
 		{
-			if ((oroute->ort_flags & ORTF_INUSE) == 0)
-				break;
+			assert(oroute->ort_flags & ORTF_INUSE);
 			if (oroute->ort_exp_tim && oroute->ort_exp_tim < 
 				currtim)
 			{
@@ -353,24 +414,11 @@ oroute_t **oroute_p;
 	if (static_route)
 		oldest_route->ort_flags |= ORTF_STATIC;
 	
-	/* Insert the route by tearing apart the routing table, 
+	/* Insert the route by tearing apart the routes for this network, 
 	 * and insert the entry during the reconstruction.
 	 */
-	for (prev= 0, nw_route= oroute_head; nw_route; 
-				prev= nw_route, nw_route= nw_route->ort_nextnw)
-	{
-		if (nw_route->ort_port != port_nr)
-			continue;
-		if (nw_route->ort_dest == dest &&
-					nw_route->ort_subnetmask == subnetmask)
-		{
-			if (prev)
-				prev->ort_nextnw= nw_route->ort_nextnw;
-			else
-				oroute_head= nw_route->ort_nextnw;
-			break;
-		}
-	}
+	rtnode= rt_insert(&oroute_trie[port_nr], dest, subnetmask);
+	nw_route= rtnode->rtn_data;
 	prev_route= nw_route;
 	for(prev= NULL, gw_route= nw_route; gw_route; 
 				prev= gw_route, gw_route= gw_route->ort_nextgw)
@@ -390,8 +438,7 @@ oroute_t **oroute_p;
 	gw_route->ort_nextgw= nw_route;
 	nw_route= gw_route;
 	nw_route= sort_gws(nw_route);
-	nw_route->ort_nextnw= oroute_head;
-	oroute_head= nw_route;
+	rtnode->rtn_data= nw_route;
 	if (nw_route != prev_route)
 		oroute_uncache_nw(nw_route->ort_dest, nw_route->ort_subnetmask);
 	if (oroute_p != NULL)
@@ -554,8 +601,7 @@ nwio_route_t *route_ent;
 	if ((oroute->ort_flags & ORTF_INUSE) && oroute->ort_exp_tim &&
 					oroute->ort_exp_tim < get_time())
 	{
-		oroute_del(oroute);
-		oroute->ort_flags &= ~ORTF_INUSE;
+		oroute_release(oroute);
 	}
 
 	route_ent->nwr_ent_no= ent_no;
@@ -581,10 +627,11 @@ PRIVATE oroute_t *oroute_find_ent(port_nr, dest)
 int port_nr;
 ipaddr_t dest;
 {
-	int hash, i, r_hash_ind;
+	int hash;
 	oroute_hash_t *oroute_hash;
 	oroute_hash_t tmp_hash;
 	oroute_t *oroute, *bestroute;
+	rtnode_t *rtnode;
 	time_t currtim;
 	unsigned long hash_tmp;
 
@@ -624,36 +671,16 @@ ipaddr_t dest;
 	{
 		assert(oroute->ort_port == port_nr);
 		if (oroute->ort_exp_tim && oroute->ort_exp_tim<currtim)
-		{
-			oroute_del(oroute);
-			oroute->ort_flags &= ~ORTF_INUSE;
-		}
+			oroute_release(oroute);
 		else
 			return oroute;
 	}
 
-	bestroute= NULL;
-	for (oroute= oroute_head; oroute; oroute= oroute->ort_nextnw)
-	{
-		if (((dest ^ oroute->ort_dest) & oroute->ort_subnetmask) != 0)
-			continue;
-		if (oroute->ort_port != port_nr)
-			continue;
-		if (!bestroute)
-		{
-			bestroute= oroute;
-			continue;
-		}
-		assert(oroute->ort_dest != bestroute->ort_dest);
-		if (ntohl(oroute->ort_subnetmask) > 
-			ntohl(bestroute->ort_subnetmask))
-		{
-			bestroute= oroute;
-			continue;
-		}
-	}
-	if (bestroute == NULL)
+	rtnode= rt_match(oroute_trie[port_nr], dest);
+	if (rtnode == NULL)
 		return NULL;
+	bestroute= rtnode->rtn_data;
+	assert(bestroute != NULL && bestroute->ort_port == port_nr);
 
 	oroute_hash[3]= oroute_hash[2];
 	oroute_hash[2]= oroute_hash[1];
@@ -669,22 +696,13 @@ PRIVATE void oroute_del(oroute)
 oroute_t *oroute;
 {
 	oroute_t *prev, *nw_route, *gw_route, *dist_route, *prev_route;
+	rtnode_t *rtnode;
 
-	for (prev= NULL, nw_route= oroute_head; nw_route; 
-				prev= nw_route, nw_route= nw_route->ort_nextnw)
-	{
-		if (oroute->ort_port == nw_route->ort_port &&
-			oroute->ort_dest == nw_route->ort_dest &&
-			oroute->ort_subnetmask == nw_route->ort_subnetmask)
-		{
-			break;
-		}
-	}
+	rtnode= rt_lookup(oroute_trie[oroute->ort_port], oroute->ort_dest,
+		oroute->ort_subnetmask);
+	assert(rtnode);
+	nw_route= rtnode->rtn_data;
 	assert(nw_route);
-	if (prev)
-		prev->ort_nextnw= nw_route->ort_nextnw;
-	else
-		oroute_head= nw_route->ort_nextnw;
 	prev_route= nw_route;
 	for (prev= NULL, gw_route= nw_route; gw_route; 
 				prev= gw_route, gw_route= gw_route->ort_nextgw)
@@ -715,11 +733,9 @@ oroute_t *oroute;
 		nw_route= gw_route;
 	}
 	nw_route= sort_gws(nw_route);
-	if (nw_route != NULL)
-	{
-		nw_route->ort_nextnw= oroute_head;
-		oroute_head= nw_route;
-	}
+	rtnode->rtn_data= nw_route;
+	if (nw_route == NULL)
+		rt_prune(&oroute_trie[oroute->ort_port], rtnode);
 	if (nw_route != prev_route)
 	{
 		oroute_uncache_nw(prev_route->ort_dest, 
@@ -728,6 +744,17 @@ oroute_t *oroute;
 }
 
 
+PRIVATE void oroute_release(oroute)
+oroute_t *oroute;
+{
+	/* Remove a route and put its entry on the free list. */
+	oroute_del(oroute);
+	oroute->ort_flags &= ~ORTF_INUSE;
+	oroute->ort_nextgw= oroute_free;
+	oroute_free= oroute;
+}
+
+
 PRIVATE oroute_t *sort_dists(oroute)
 oroute_t *oroute;
 {
@@ -879,53 +906,46 @@ int dist;
 int static_route;
 iroute_t **iroute_p;
 {
-	int i;
-	iroute_t *iroute, *unused_route;
+	iroute_t *iroute;
+	rtnode_t *rtnode;
 
-	unused_route= NULL;
-	if (static_route)
-	{
-		/* Static routes are not reused automatically, so we look 
-		 * for an unused entry.
-		 */
-		for(i= 0, iroute= iroute_table; i<IROUTE_NR; i++, iroute++)
-		{
-			if ((iroute->irt_flags & IRTF_INUSE) == 0)
-				break;
-		}
-		if (i != IROUTE_NR)
-			unused_route= iroute;
-	}
-	else
+	if (rt_masklen(subnetmask) < 0)
+		return EINVAL;
+	dest &= subnetmask;
+
+	iroute= NULL;
+	if (!static_route)
 	{
-		/* Try to track down any old routes, and look for an
-		 * unused one.
+		/* Static routes are not reused automatically. Try to track
+		 * down an old dynamic route.
 		 */
-		for(i= 0, iroute= iroute_table; i<IROUTE_NR; i++, iroute++)
+		rtnode= rt_lookup(iroute_trie, dest, subnetmask);
+		if (rtnode != NULL)
+			iroute= rtnode->rtn_data;
+		for (; iroute; iroute= iroute->irt_next)
 		{
-			if ((iroute->irt_flags & IRTF_INUSE) == 0)
-			{
-				unused_route= iroute;
-				continue;
-			}
 			if ((iroute->irt_flags & IRTF_STATIC) != 0)
 				continue;
 			if (iroute->irt_port != port_nr ||
-				iroute->irt_dest != dest ||
-				iroute->irt_subnetmask != subnetmask ||
 				iroute->irt_gateway != gateway)
 			{
 				continue;
 			}
 			break;
 		}
-		if (i != IROUTE_NR)
-			unused_route= iroute;
 	}
 
-	if (unused_route == NULL)
-		return ENOMEM;
-	iroute= unused_route;
+	if (iroute == NULL)
+	{
+		iroute= iroute_free;
+		if (iroute == NULL)
+			return ENOMEM;
+		iroute_free= iroute->irt_next;
+
+		rtnode= rt_insert(&iroute_trie, dest, subnetmask);
+		iroute->irt_next= rtnode->rtn_data;
+		rtnode->rtn_data= iroute;
+	}
 
 	iroute->irt_port= port_nr;
 	iroute->irt_dest= dest;
@@ -952,19 +972,17 @@ ipaddr_t gateway;
 int dist;
 int static_route;
 {
-	int i;
-	iroute_t *iroute;
+	iroute_t *iroute, *prev;
+	rtnode_t *rtnode;
 
-	/* Try to track down any old routes, and look for an
-	 * unused one.
-	 */
-	for(i= 0, iroute= iroute_table; i<IROUTE_NR; i++, iroute++)
+	rtnode= rt_lookup(iroute_trie, dest & subnetmask, subnetmask);
+	if (rtnode == NULL)
+		return ESRCH;
+
+	for (prev= NULL, iroute= rtnode->rtn_data; iroute; 
+				prev= iroute, iroute= iroute->irt_next)
 	{
-		if ((iroute->irt_flags & IRTF_INUSE) == 0)
-			continue;
 		if (iroute->irt_port != port_nr ||
-			iroute->irt_dest != dest ||
-			iroute->irt_subnetmask != subnetmask ||
 			iroute->irt_gateway != gateway)
 		{
 			continue;
@@ -974,11 +992,20 @@ int static_route;
 		break;
 	}
 
-	if (i == IROUTE_NR)
+	if (iroute == NULL)
 		return ESRCH;
 
+	if (prev)
+		prev->irt_next= iroute->irt_next;
+	else
+		rtnode->rtn_data= iroute->irt_next;
+	if (rtnode->rtn_data == NULL)
+		rt_prune(&iroute_trie, rtnode);
+
 	iroute_uncache_nw(iroute->irt_dest, iroute->irt_subnetmask);
 	iroute->irt_flags= IRTF_EMPTY;
+	iroute->irt_next= iroute_free;
+	iroute_free= iroute;
 	return NW_OK;
 }
 
@@ -1007,6 +1034,200 @@ ipaddr_t netmask;
 
 
 
+/*
+ * Radix trie
+ */
+
+PRIVATE int rt_masklen(netmask)
+ipaddr_t netmask;
+{
+	u32_t mask;
+	int len;
+
+	mask= ntohl(netmask);
+	for (len= 0; len < 32 && (mask & 0x80000000L); len++)
+		mask <<= 1;
+	if (mask != 0)
+		return -1;	/* Non-contiguous netmask */
+	return len;
+}
+
+
+PRIVATE rtnode_t *rt_alloc(key, len, parent)
+u32_t key;
+int len;
+rtnode_t *parent;
+{
+	rtnode_t *rtnode;
+
+	rtnode= rtnode_free;
+	assert(rtnode != NULL);
+	rtnode_free= rtnode->rtn_parent;
+
+	rtnode->rtn_key= key;
+	rtnode->rtn_len= len;
+	rtnode->rtn_data= NULL;
+	rtnode->rtn_child[0]= NULL;
+	rtnode->rtn_child[1]= NULL;
+	rtnode->rtn_parent= parent;
+	return rtnode;
+}
+
+
+PRIVATE rtnode_t *rt_lookup(root, dest, netmask)
+rtnode_t *root;
+ipaddr_t dest;
+ipaddr_t netmask;
+{
+	/* Find the node for exactly dest/netmask. */
+	rtnode_t *rtnode;
+	u32_t key;
+	int len;
+
+	len= rt_masklen(netmask);
+	if (len < 0)
+		return NULL;
+	key= ntohl(dest) & rt_mask(len);
+
+	for (rtnode= root; rtnode; rtnode= rtnode->rtn_child[rt_bit(key,
+		rtnode->rtn_len)])
+	{
+		if (rtnode->rtn_len > len)
+			return NULL;
+		if (((key ^ rtnode->rtn_key) & rt_mask(rtnode->rtn_len)) != 0)
+			return NULL;
+		if (rtnode->rtn_len == len)
+			return rtnode;
+	}
+	return NULL;
+}
+
+
+PRIVATE rtnode_t *rt_insert(rootp, dest, netmask)
+rtnode_t **rootp;
+ipaddr_t dest;
+ipaddr_t netmask;
+{
+	/* Find or create the node for dest/netmask. */
+	rtnode_t **linkp, *rtnode, *parent, *new_node, *split;
+	u32_t key, diff;
+	int len, common, max, bit;
+
+	len= rt_masklen(netmask);
+	assert(len >= 0);
+	key= ntohl(dest) & rt_mask(len);
+
+	parent= NULL;
+	linkp= rootp;
+	for (;;)
+	{
+		rtnode= *linkp;
+		if (rtnode == NULL)
+		{
+			*linkp= rt_alloc(key, len, parent);
+			return *linkp;
+		}
+
+		max= len < rtnode->rtn_len ? len : rtnode->rtn_len;
+		diff= (key ^ rtnode->rtn_key) & rt_mask(max);
+		for (common= 0; common < max; common++)
+		{
+			if (diff & (0x80000000L >> common))
+				break;
+		}
+
+		if (common == rtnode->rtn_len)
+		{
+			if (rtnode->rtn_len == len)
+				return rtnode;
+			parent= rtnode;
+			linkp= &rtnode->rtn_child[rt_bit(key, rtnode->rtn_len)];
+			continue;
+		}
+
+		if (common == len)
+		{
+			/* The new prefix covers this node. */
+			new_node= rt_alloc(key, len, parent);
+			new_node->rtn_child[rt_bit(rtnode->rtn_key, len)]=
+				rtnode;
+			rtnode->rtn_parent= new_node;
+			*linkp= new_node;
+			return new_node;
+		}
+
+		/* The prefixes diverge, add a branch node. */
+		split= rt_alloc(key & rt_mask(common), common, parent);
+		new_node= rt_alloc(key, len, split);
+		bit= rt_bit(key, common);
+		split->rtn_child[bit]= new_node;
+		split->rtn_child[!bit]= rtnode;
+		rtnode->rtn_parent= split;
+		*linkp= split;
+		return new_node;
+	}
+}
+
+
+PRIVATE rtnode_t *rt_match(root, dest)
+rtnode_t *root;
+ipaddr_t dest;
+{
+	/* Longest prefix match: the deepest node on the path that carries
+	 * routes.
+	 */
+	rtnode_t *rtnode, *best;
+	u32_t key;
+
+	key= ntohl(dest);
+	best= NULL;
+	for (rtnode= root; rtnode; rtnode= rtnode->rtn_child[rt_bit(key,
+		rtnode->rtn_len)])
+	{
+		if (((key ^ rtnode->rtn_key) & rt_mask(rtnode->rtn_len)) != 0)
+			break;
+		if (rtnode->rtn_data != NULL)
+			best= rtnode;
+		if (rtnode->rtn_len == 32)
+			break;
+	}
+	return best;
+}
+
+
+PRIVATE void rt_prune(rootp, rtnode)
+rtnode_t **rootp;
+rtnode_t *rtnode;
+{
+	/* Remove nodes that no longer carry routes and are not needed
+	 * as a branch.
+	 */
+	rtnode_t *parent, *child;
+
+	while (rtnode != NULL && rtnode->rtn_data == NULL)
+	{
+		if (rtnode->rtn_child[0] && rtnode->rtn_child[1])
+			break;
+		child= rtnode->rtn_child[0] ? rtnode->rtn_child[0] :
+			rtnode->rtn_child[1];
+		parent= rtnode->rtn_parent;
+		if (child)
+			child->rtn_parent= parent;
+		if (parent == NULL)
+			*rootp= child;
+		else
+			parent->rtn_child[parent->rtn_child[1] == rtnode]= child;
+
+		rtnode->rtn_parent= rtnode_free;
+		rtnode_free= rtnode;
+
+		if (child)
+			break;
+		rtnode= parent;
+	}
+}
+
+
 /*
  * Debugging, management
  */
@@ -19,7 +19,6 @@ typedef struct oroute
 	time_t ort_timestamp;
 	int ort_flags;
 
-	struct oroute *ort_nextnw;
 	struct oroute *ort_nextgw;
 	struct oroute *ort_nextdist;
 } oroute_t;
@@ -38,6 +37,8 @@ typedef struct iroute
 	int irt_dist;
 	int irt_port;
 	int irt_flags;
+
+	struct iroute *irt_next;
 } iroute_t;
 
 #define IRTD_UNREACHABLE	512
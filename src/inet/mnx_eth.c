@@ -22,7 +22,12 @@ THIS_FILE
 
 FORWARD _PROTOTYPE( void setup_read, (eth_port_t *eth_port) );
 FORWARD _PROTOTYPE( void read_int, (eth_port_t *eth_port, int count) );
+FORWARD _PROTOTYPE( void read_frames, (eth_port_t *eth_port, acc_t *pack,
+								int count) );
 FORWARD _PROTOTYPE( void write_int, (eth_port_t *eth_port) );
+FORWARD _PROTOTYPE( int write_iovec, (acc_t **pack_p, iovec_t *iovec,
+								int iovec_nr) );
+FORWARD _PROTOTYPE( int loop_frames, (eth_port_t *eth_port, acc_t *pack) );
 FORWARD _PROTOTYPE( void eth_recvev, (event_t *ev, ev_arg_t ev_arg) );
 FORWARD _PROTOTYPE( void eth_sendev, (event_t *ev, ev_arg_t ev_arg) );
 FORWARD _PROTOTYPE( eth_port_t *find_port, (message *m) );
@@ -87,6 +92,8 @@ PUBLIC void osdep_eth_init()
 
 		eth_port->etp_flags |= EPF_ENABLED;
 		eth_port->etp_wr_pack= 0;
+		eth_port->etp_wr_q_head= 0;
+		eth_port->etp_wr_q_nr= 0;
 		eth_port->etp_rd_pack= 0;
 		setup_read (eth_port);
 	}
@@ -96,59 +103,62 @@ PUBLIC void eth_write_port(eth_port, pack)
 eth_port_t *eth_port;
 acc_t *pack;
 {
+	/* Send the frame pack, or the list of frames linked through
+	 * acc_ext_link. A list is handed to the driver as one DL_WRITEMV.
+	 */
 	eth_port_t *loc_port;
 	message mess1, block_msg;
-	int i, pack_size;
-	acc_t *pack_ptr;
+	int i, j;
+	acc_t **pack_p, *next_pack;
 	iovec_t *iovec;
-	u8_t *eth_dst_ptr;
-	int multicast, r;
+	int r;
 	ev_arg_t ev_arg;
 
 	assert(eth_port->etp_wr_pack == NULL);
 	eth_port->etp_wr_pack= pack;
 
+	mess1.DL_PORT= eth_port->etp_osdep.etp_port;
+	mess1.DL_PROC= this_proc;
+	mess1.DL_MODE= DL_NOMODE;
+
 	iovec= eth_port->etp_osdep.etp_wr_iovec;
-	pack_size= 0;
-	for (i=0, pack_ptr= pack; i<IOVEC_NR && pack_ptr; i++,
-		pack_ptr= pack_ptr->acc_next)
+	if (pack->acc_ext_link)
 	{
-		iovec[i].iov_addr= (vir_bytes)ptr2acc_data(pack_ptr);
-		pack_size += iovec[i].iov_size= pack_ptr->acc_length;
-	}
-	if (i>= IOVEC_NR)
-	{
-		pack= bf_pack(pack);		/* packet is too fragmented */
-		eth_port->etp_wr_pack= pack;
-		pack_size= 0;
-		for (i=0, pack_ptr= pack; i<IOVEC_NR && pack_ptr;
-			i++, pack_ptr= pack_ptr->acc_next)
+		pack_p= &eth_port->etp_wr_pack;
+		for (j= 0; *pack_p; j++, pack_p= &(*pack_p)->acc_ext_link)
 		{
-			iovec[i].iov_addr= (vir_bytes)ptr2acc_data(pack_ptr);
-			pack_size += iovec[i].iov_size= pack_ptr->acc_length;
+			assert(j < WR_FRAMES);
+			i= write_iovec(pack_p, iovec + j*WR_IOVEC, WR_IOVEC);
+			for (; i<WR_IOVEC; i++)
+			{
+				iovec[j*WR_IOVEC + i].iov_addr= 0;
+				iovec[j*WR_IOVEC + i].iov_size= 0;
+			}
 		}
-	}
-	assert (i< IOVEC_NR);
-	assert (pack_size >= ETH_MIN_PACK_SIZE);
-
-	if (i == 1)
-	{
-		/* simple packets can be sent using DL_WRITE instead of 
-		 * DL_WRITEV.
-		 */
-		mess1.DL_COUNT= iovec[0].iov_size;
-		mess1.DL_ADDR= (char *)iovec[0].iov_addr;
-		mess1.m_type= DL_WRITE;
+		mess1.DL_COUNT= j * WR_IOVEC;
+		mess1.DL_STRIDE= WR_IOVEC;
+		mess1.DL_ADDR= (char *)iovec;
+		mess1.m_type= DL_WRITEMV;
 	}
 	else
 	{
-		mess1.DL_COUNT= i;
-		mess1.DL_ADDR= (char *)iovec;
-		mess1.m_type= DL_WRITEV;
+		i= write_iovec(&eth_port->etp_wr_pack, iovec, IOVEC_NR-1);
+		if (i == 1)
+		{
+			/* simple packets can be sent using DL_WRITE instead
+			 * of DL_WRITEV.
+			 */
+			mess1.DL_COUNT= iovec[0].iov_size;
+			mess1.DL_ADDR= (char *)iovec[0].iov_addr;
+			mess1.m_type= DL_WRITE;
+		}
+		else
+		{
+			mess1.DL_COUNT= i;
+			mess1.DL_ADDR= (char *)iovec;
+			mess1.m_type= DL_WRITEV;
+		}
 	}
-	mess1.DL_PORT= eth_port->etp_osdep.etp_port;
-	mess1.DL_PROC= this_proc;
-	mess1.DL_MODE= DL_NOMODE;
 
 	for (;;)
 	{
@@ -208,12 +218,10 @@ acc_t *pack;
 		return;
 	}
 
-	/* If the port is in promiscuous mode or the packet is
+	/* If the port is in promiscuous mode or a packet is
 	 * broadcasted/multicasted, enqueue the reply packet.
 	 */
-	eth_dst_ptr= (u8_t *)ptr2acc_data(pack);
-	multicast= (*eth_dst_ptr & 1);	/* low order bit indicates multicast */
-	if (multicast || (eth_port->etp_osdep.etp_recvconf & NWEO_EN_PROMISC))
+	if (loop_frames(eth_port, eth_port->etp_wr_pack))
 	{
 		eth_port->etp_osdep.etp_sendrepl= mess1;
 		ev_arg.ev_ptr= eth_port;
@@ -223,9 +231,71 @@ acc_t *pack;
 		return;
 	}
 
-	/* packet is sent */
-	bf_afree(eth_port->etp_wr_pack);
+	/* packets are sent */
+	pack= eth_port->etp_wr_pack;
 	eth_port->etp_wr_pack= NULL;
+	while (pack)
+	{
+		next_pack= pack->acc_ext_link;
+		pack->acc_ext_link= NULL;
+		bf_afree(pack);
+		pack= next_pack;
+	}
+}
+
+PRIVATE int write_iovec(pack_p, iovec, iovec_nr)
+acc_t **pack_p;
+iovec_t *iovec;
+int iovec_nr;
+{
+	/* Describe the frame *pack_p with at most iovec_nr iovecs. A frame
+	 * that is too fragmented is packed first.
+	 */
+	acc_t *pack, *pack_ptr, *ext_link;
+	int i;
+
+	pack= *pack_p;
+	for (i=0, pack_ptr= pack; i<iovec_nr && pack_ptr; i++,
+		pack_ptr= pack_ptr->acc_next)
+	{
+		iovec[i].iov_addr= (vir_bytes)ptr2acc_data(pack_ptr);
+		iovec[i].iov_size= pack_ptr->acc_length;
+	}
+	if (pack_ptr)
+	{
+		ext_link= pack->acc_ext_link;
+		pack= bf_pack(pack);		/* packet is too fragmented */
+		pack->acc_ext_link= ext_link;
+		*pack_p= pack;
+		for (i=0, pack_ptr= pack; i<iovec_nr && pack_ptr;
+			i++, pack_ptr= pack_ptr->acc_next)
+		{
+			iovec[i].iov_addr= (vir_bytes)ptr2acc_data(pack_ptr);
+			iovec[i].iov_size= pack_ptr->acc_length;
+		}
+		assert(!pack_ptr);
+	}
+	return i;
+}
+
+PRIVATE int loop_frames(eth_port, pack)
+eth_port_t *eth_port;
+acc_t *pack;
+{
+	/* Tell whether some frame of the list has to be looped back to
+	 * the local readers after it is sent.
+	 */
+	u8_t *eth_dst_ptr;
+
+	if (eth_port->etp_osdep.etp_recvconf & NWEO_EN_PROMISC)
+		return 1;
+	for (; pack; pack= pack->acc_ext_link)
+	{
+		eth_dst_ptr= (u8_t *)ptr2acc_data(pack);
+		if (*eth_dst_ptr & 1)	/* low order bit indicates multicast */
+			return 1;
+	}
+	return 0;
 }
 
 PUBLIC void eth_rec(m)
@@ -357,19 +427,31 @@ u32_t flags;
 PRIVATE void write_int(eth_port)
 eth_port_t *eth_port;
 {
-	acc_t *pack;
+	acc_t *pack, *next_pack;
 	int multicast;
 	u8_t *eth_dst_ptr;
 
 	pack= eth_port->etp_wr_pack;
 	eth_port->etp_wr_pack= NULL;
 
-	eth_dst_ptr= (u8_t *)ptr2acc_data(pack);
-	multicast= (*eth_dst_ptr & 1);	/* low order bit indicates multicast */
-	if (multicast || (eth_port->etp_osdep.etp_recvconf & NWEO_EN_PROMISC))
-		eth_arrive(eth_port, pack, bf_bufsize(pack));
-	else
-		bf_afree(pack);
+	/* One reply covers all frames of a DL_WRITEMV */
+	while (pack)
+	{
+		next_pack= pack->acc_ext_link;
+		pack->acc_ext_link= NULL;
+
+		eth_dst_ptr= (u8_t *)ptr2acc_data(pack);
+		multicast= (*eth_dst_ptr & 1);	/* low order bit indicates
+						 * multicast */
+		if (multicast ||
+			(eth_port->etp_osdep.etp_recvconf & NWEO_EN_PROMISC))
+		{
+			eth_arrive(eth_port, pack, bf_bufsize(pack));
+		}
+		else
+			bf_afree(pack);
+		pack= next_pack;
+	}
 
 	eth_restart_write(eth_port);
 }
@@ -378,29 +460,58 @@ PRIVATE void read_int(eth_port, count)
 eth_port_t *eth_port;
 int count;
 {
-	acc_t *pack, *cut_pack;
+	acc_t *pack;
 
 	pack= eth_port->etp_rd_pack;
 	eth_port->etp_rd_pack= NULL;
 
-	cut_pack= bf_cut(pack, 0, count);
-	bf_afree(pack);
-
-	eth_arrive(eth_port, cut_pack, count);
+	read_frames(eth_port, pack, count);
 	
 	eth_port->etp_flags &= ~(EPF_READ_IP|EPF_READ_SP);
 	setup_read(eth_port);
 }
 
+PRIVATE void read_frames(eth_port, pack, count)
+eth_port_t *eth_port;
+acc_t *pack;
+int count;
+{
+	/* The driver filled the first count receive buffers of the list
+	 * and stored the length of each frame in the first iovec of its
+	 * slot.
+	 */
+	acc_t *next_pack, *cut_pack;
+	iovec_t *iovec;
+	size_t size;
+
+	assert(count >= 1 && count <= RD_FRAMES);
+	iovec= eth_port->etp_osdep.etp_rd_iovec;
+	while (pack)
+	{
+		next_pack= pack->acc_ext_link;
+		pack->acc_ext_link= NULL;
+		if (count > 0)
+		{
+			size= iovec->iov_size;
+			cut_pack= bf_cut(pack, 0, size);
+			eth_arrive(eth_port, cut_pack, size);
+			iovec += RD_IOVEC;
+			count--;
+		}
+		bf_afree(pack);
+		pack= next_pack;
+	}
+}
+
 PRIVATE void setup_read(eth_port)
 eth_port_t *eth_port;
 {
 	eth_port_t *loc_port;
-	acc_t *pack, *pack_ptr;
+	acc_t *pack, *pack_ptr, *head, *tail;
 	message mess1, block_msg;
 	iovec_t *iovec;
 	ev_arg_t ev_arg;
-	int i, r;
+	int i, j, r;
 
 	assert(!(eth_port->etp_flags & (EPF_READ_IP|EPF_READ_SP)));
 
@@ -408,22 +519,46 @@ eth_port_t *eth_port;
 	{
 		assert (!eth_port->etp_rd_pack);
 
+		/* Post RD_FRAMES receive buffers, each in a slot of
+		 * RD_IOVEC iovecs. The buffers are linked through
+		 * acc_ext_link.
+		 */
 		iovec= eth_port->etp_osdep.etp_rd_iovec;
-		pack= bf_memreq (ETH_MAX_PACK_SIZE);
-
-		for (i=0, pack_ptr= pack; i<RD_IOVEC && pack_ptr;
-			i++, pack_ptr= pack_ptr->acc_next)
+		head= NULL;
+		tail= NULL;
+		for (j= 0; j<RD_FRAMES; j++, iovec += RD_IOVEC)
 		{
-			iovec[i].iov_addr= (vir_bytes)ptr2acc_data(pack_ptr);
-			iovec[i].iov_size= (vir_bytes)pack_ptr->acc_length;
+			pack= bf_memreq (ETH_MAX_PACK_SIZE);
+
+			for (i=0, pack_ptr= pack; i<RD_IOVEC && pack_ptr;
+				i++, pack_ptr= pack_ptr->acc_next)
+			{
+				iovec[i].iov_addr=
+					(vir_bytes)ptr2acc_data(pack_ptr);
+				iovec[i].iov_size=
+					(vir_bytes)pack_ptr->acc_length;
+			}
+			assert (!pack_ptr);
+			for (; i<RD_IOVEC; i++)
+			{
+				iovec[i].iov_addr= 0;
+				iovec[i].iov_size= 0;
+			}
+
+			pack->acc_ext_link= NULL;
+			if (head == NULL)
+				head= pack;
+			else
+				tail->acc_ext_link= pack;
+			tail= pack;
 		}
-		assert (!pack_ptr);
 
-		mess1.m_type= DL_READV;
+		mess1.m_type= DL_READMV;
 		mess1.DL_PORT= eth_port->etp_osdep.etp_port;
 		mess1.DL_PROC= this_proc;
-		mess1.DL_COUNT= i;
-		mess1.DL_ADDR= (char *)iovec;
+		mess1.DL_COUNT= RD_FRAMES * RD_IOVEC;
+		mess1.DL_STRIDE= RD_IOVEC;
+		mess1.DL_ADDR= (char *)eth_port->etp_osdep.etp_rd_iovec;
 
 		for (;;)
 		{
@@ -474,16 +609,13 @@ eth_port_t *eth_port;
 
 		if (mess1.DL_STAT & DL_PACK_RECV)
 		{
-			/* packet received */
-			pack_ptr= bf_cut(pack, 0, mess1.DL_COUNT);
-			bf_afree(pack);
-
-			eth_arrive(eth_port, pack_ptr, mess1.DL_COUNT);
+			/* packets received */
+			read_frames(eth_port, head, mess1.DL_COUNT);
 		}
 		else
 		{
 			/* no packet received */
-			eth_port->etp_rd_pack= pack;
+			eth_port->etp_rd_pack= head;
 			eth_port->etp_flags |= EPF_READ_IP;
 		}
 
@@ -14,13 +14,36 @@ Copyright 1995 Philip Homburg
 #define IOVEC_NR	16
 #define RD_IOVEC	((ETH_MAX_PACK_SIZE + BUF_S -1)/BUF_S)
 
+/* Number of frames that the driver can return with one DL_READMV */
+#if CRAMPED
+#define RD_FRAMES	2
+#else
+#define RD_FRAMES	4
+#endif
+
+/* A DL_WRITEMV carries up to WR_FRAMES frames in slots of WR_IOVEC iovecs.
+ * The iovec array is also used for single frames, which may need up to
+ * IOVEC_NR entries.
+ */
+#define WR_IOVEC	8
+#if CRAMPED
+#define WR_FRAMES	2
+#else
+#define WR_FRAMES	4
+#endif
+#if WR_FRAMES * WR_IOVEC > IOVEC_NR
+#define WR_IOVEC_NR	(WR_FRAMES * WR_IOVEC)
+#else
+#define WR_IOVEC_NR	IOVEC_NR
+#endif
+
 typedef struct osdep_eth_port
 {
 	int etp_minor;
 	int etp_port;
 	int etp_recvconf;
-	iovec_t etp_wr_iovec[IOVEC_NR];
-	iovec_t etp_rd_iovec[RD_IOVEC];
+	iovec_t etp_wr_iovec[WR_IOVEC_NR];
+	iovec_t etp_rd_iovec[RD_FRAMES * RD_IOVEC];
 	event_t etp_recvev;
 	message etp_sendrepl;
 	message etp_recvrepl;
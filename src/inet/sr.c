@@ -691,7 +691,15 @@ char *dest;
 	{
 		size= (vir_bytes)acc->acc_length;
 
-		if (size)
+		if (size && i > 0 && cpvec[i-1].cpv_src +
+			cpvec[i-1].cpv_size == (vir_bytes)ptr2acc_data(acc))
+		{
+			/* Continues the previous piece in memory, extend that
+			 * entry instead of using a new one.
+			 */
+			cpvec[i-1].cpv_size += size;
+		}
+		else if (size)
 		{
 			cpvec[i].cpv_src= (vir_bytes)ptr2acc_data(acc);
 			cpvec[i].cpv_dst= (vir_bytes)dest;
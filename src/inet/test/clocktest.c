@@ -0,0 +1,267 @@
+/*
+clocktest.c
+
+Check and time the timing wheel of ../clock.c on any system with an ANSI C
+compiler.  Clock.c is compiled in unchanged, with small stand-ins for the
+inet headers and for the clock task.
+
+	cc -O -o clocktest clocktest.c
+	./clocktest [seed]
+
+The check drives the timers the way the main loop of inet does.  Timers
+are set from a few ticks to days ahead, some in the past, reset and
+canceled at random, and some timer functions set their timer again.  Time
+moves forward in small and large steps, and the alarm clock.c asks the
+clock task for is delivered when it is due.  The due time of each timer is
+kept in a reference list next to the wheel.  A timer must not fire before
+it is due, and once an alarm has been handled no timer may be overdue.
+
+The benchmark sets and cancels 10000 timers spread over 30000 ticks, which
+is all three levels of the wheel, and prints the time per pair.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <time.h>
+
+/* Stand-ins for inet.h and the kernel interface that clock.c uses. */
+#define INET__INET_H
+#define BUF_H
+#define INET_TYPE_H
+#define timer_t		inet_timer_t
+
+#define _PROTOTYPE(f, a) f a
+#define ARGS(x)		x
+#define PUBLIC
+#define PRIVATE		static
+#define FORWARD		static
+#define ZERO		0
+#define THIS_FILE	static char *this_file= __FILE__;
+#define ip_panic(print_list)	(printf print_list, printf("\n"), abort())
+
+typedef struct
+{
+	int m_type;
+	int m6_i1;
+	long m6_l1;
+} message;
+
+#define OK		0
+#define CLOCK		-3
+#define GET_UPTIME	5
+#define SET_SYNC_AL	6
+#define CLOCK_PROC_NR	m6_i1
+#define DELTA_TICKS	m6_l1
+#define NEW_TIME	m6_l1
+#define this_proc	0
+
+void bad_assertion(char *file, int line, char *what);
+void bad_compare(char *file, int line, int lhs, char *what, int rhs);
+int sendrec(int dst, message *m);
+
+#include "../clock.c"
+
+#define NR_CHECK	2000		/* timers in the check */
+#define CHECK_ROUNDS	200000L		/* random operations */
+#define NR_BENCH	10000		/* timers in the benchmark */
+#define BENCH_ROUNDS	100		/* times they are set and canceled */
+
+static time_t now= 1000;		/* the clock of the clock task */
+static time_t alarm_time;		/* alarm asked for, 0 if none */
+
+static timer_t timers[NR_BENCH];
+static time_t due[NR_BENCH];		/* reference list of due times */
+static int armed[NR_BENCH];
+static long fired;
+
+static void set(int i, time_t when);
+static void fire(int i, timer_t *timer);
+static void run(void);
+static void advance(time_t when);
+static void overdue(void);
+
+int sendrec(dst, m)
+int dst;
+message *m;
+{
+	/* The two calls clock.c makes to the clock task. */
+	if (m->m_type == GET_UPTIME)
+		m->NEW_TIME= now;
+	else if (m->m_type == SET_SYNC_AL)
+		alarm_time= now + m->DELTA_TICKS;
+	else
+		return -1;
+	m->m_type= OK;
+	return 0;
+}
+
+void bad_assertion(file, line, what)
+char *file;
+int line;
+char *what;
+{
+	printf("assertion \"%s\" failed at %s, line %d\n", what, file, line);
+	abort();
+}
+
+void bad_compare(file, line, lhs, what, rhs)
+char *file;
+int line;
+int lhs;
+char *what;
+int rhs;
+{
+	printf("compare (%d) %s (%d) failed at %s, line %d\n",
+		lhs, what, rhs, file, line);
+	abort();
+}
+
+static void set(i, when)
+int i;
+time_t when;
+{
+	due[i]= when;
+	armed[i]= 1;
+	clck_timer(&timers[i], when, fire, i);
+}
+
+static void fire(i, timer)
+int i;
+timer_t *timer;
+{
+	if (timer != &timers[i] || !armed[i])
+	{
+		printf("timer %d fired while not set\n", i);
+		exit(1);
+	}
+	if (due[i] > now)
+	{
+		printf("timer %d fired at %ld, due at %ld\n",
+			i, (long)now, (long)due[i]);
+		exit(1);
+	}
+	armed[i]= 0;
+	fired++;
+
+	/* Some timer functions set their timer again. */
+	if (rand() % 4 == 0)
+		set(i, now + rand() % 100);
+}
+
+static void run()
+{
+	/* The main loop of inet expires timers while clock.c asks for it. */
+	while (clck_call_expire)
+		clck_expire_timers();
+}
+
+static void advance(when)
+time_t when;
+{
+	/* Move the time forward, and deliver the alarms on the way. */
+	message mess;
+
+	while (alarm_time != 0 && alarm_time <= when)
+	{
+		now= alarm_time;
+		alarm_time= 0;
+		reset_time();
+		clck_tick(&mess);
+		run();
+		overdue();
+	}
+	now= when;
+	reset_time();
+}
+
+static void overdue()
+{
+	int i;
+
+	for (i= 0; i<NR_CHECK; i++)
+	{
+		if (armed[i] && due[i] <= now)
+		{
+			printf("timer %d due at %ld did not fire at %ld\n",
+				i, (long)due[i], (long)now);
+			exit(1);
+		}
+	}
+}
+
+int main(argc, argv)
+int argc;
+char **argv;
+{
+	long n;
+	int i, r;
+	time_t d;
+	clock_t start;
+	double ns;
+
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+
+	for (n= 0; n<CHECK_ROUNDS; n++)
+	{
+		i= rand() % NR_CHECK;
+		r= rand() % 10;
+		if (r < 5)
+		{
+			/* Near, a few blocks ahead, or far beyond the
+			 * second level.
+			 */
+			switch (rand() % 3)
+			{
+			case 0:	d= rand() % 300;		break;
+			case 1:	d= rand() % 20000;		break;
+			default: d= (long)rand() % 2000000;	break;
+			}
+			set(i, now + d - 10);
+			run();
+		}
+		else if (r < 7)
+		{
+			if (armed[i])
+			{
+				clck_untimer(&timers[i]);
+				armed[i]= 0;
+			}
+		}
+		else
+		{
+			advance(now + (rand() % 5 == 0 ? rand() % 30000 :
+							rand() % 50));
+			run();
+			overdue();
+		}
+	}
+	printf("check: %ld timers fired, none early or late\n", fired);
+
+	for (i= 0; i<NR_CHECK; i++)
+	{
+		if (armed[i])
+		{
+			clck_untimer(&timers[i]);
+			armed[i]= 0;
+		}
+	}
+
+	start= clock();
+	for (n= 0; n<BENCH_ROUNDS; n++)
+	{
+		for (i= 0; i<NR_BENCH; i++)
+		{
+			clck_timer(&timers[i], now + 1 + (i * 7919L) % 30000,
+				fire, i);
+		}
+		for (i= 0; i<NR_BENCH; i++)
+			clck_untimer(&timers[i]);
+	}
+	ns= (double)(clock() - start) / CLOCKS_PER_SEC * 1e9 /
+					((double)BENCH_ROUNDS * NR_BENCH);
+	printf("benchmark: %d timers set and canceled %d times, %.1f ns per pair\n",
+		NR_BENCH, BENCH_ROUNDS, ns);
+	return 0;
+}
@@ -0,0 +1,549 @@
+/*
+fragtest.c
+
+A fragment storm for the IP reassembly code in ../generic/ip_read.c, run on
+any system with an ANSI C compiler.  Ip_read.c and the buffer code in
+../buf.c are compiled in unchanged, with small stand-ins for the headers
+and the rest of inet.  (-I.. lets ip_read.c find inet.h, which is skipped.)
+
+	cc -O -I.. -o fragtest fragtest.c
+	./fragtest [seed]
+
+200 datagrams of up to 8000 bytes from a few sources on two ports arrive as
+fragments cut for a few different MTUs and as random pieces, so fragments
+overlap and are duplicated.  Most fragments go to a window of datagrams
+that moves through the list, the others are strays.  Time moves on, so
+strays time out, and one time in four the window is wider while the rest of
+inet holds on to part of the buffers, so the reassembly code is asked to
+give its buffers back.  A fragment of up to BUF_S bytes must still get a
+single buffer.  Every datagram that comes out must be the one that was
+sent.  After each fragment the following must hold:
+- every entry in use is on its port's age list, oldest first, and in its
+  hash chain, and the others are on the free list,
+- the fragments of an entry are sorted, touching fragments are merged, and
+  their size adds up to ia_size; the sizes add up to ip_ass_mem, which
+  stays within IP_ASS_MEM,
+- a port's timer is set for its oldest entry, and only if it has one, and
+  no entry is older than IP_ASS_TIMEOUT.
+At the end every buffer and accessor must be back on its free list.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <sys/types.h>
+
+/* Stand-ins for inet.h. */
+#define INET__INET_H
+#define timer_t		inet_timer_t
+
+#define _PROTOTYPE(f, a) f a
+#define _ARGS(x)	x
+#define ARGS(x)		x
+#define PUBLIC
+#define EXTERN		extern
+#define PRIVATE		static
+#define FORWARD		static
+#define ZERO		0
+#define CRAMPED		(INT_MAX == 32767)
+#define THIS_FILE
+#define ip_panic(print_list)	(printf print_list, printf("\n"), abort())
+#define ip_warning(print_list)	0
+#define DBLOCK(level, code)	0
+#define DIFBLOCK(level, condition, code)	0
+
+#define BUF_S		(CRAMPED ? 512 : 2048)
+#define HZ		60
+#define TRUE		1
+#define FALSE		0
+#define IP_PORT_NR	2
+#define HTONS(x)	htons(x)
+#define HTONL(x)	htonl(x)
+#define htons(x)	hton16(x)
+#define ntohs(x)	ntoh16(x)
+#define htonl(x)	hton32(x)
+#define OK		0
+#define NW_OK		0
+#define NW_SUSPEND	(-998)
+#define EBADMODE	(-1000)
+#define EPACKSIZE	(-1001)
+#define size_t		unsigned	/* as on Minix, for K&R definitions */
+
+typedef unsigned char u8_t;
+typedef unsigned short u16_t;
+typedef unsigned int u32_t;
+typedef int i32_t;
+typedef unsigned int U16_t;
+typedef int ioreq_t;
+
+static char *this_file= "fragtest";
+
+/* Network byte order, whatever the order of this machine. */
+static u16_t hton16(x)
+unsigned x;
+{
+	u16_t n;
+	u8_t *p= (u8_t *)&n;
+
+	p[0]= x >> 8;
+	p[1]= x;
+	return n;
+}
+
+static u16_t ntoh16(n)
+unsigned n;
+{
+	u16_t x= n;
+	u8_t *p= (u8_t *)&x;
+
+	return (p[0] << 8) | p[1];
+}
+
+static u32_t hton32(x)
+u32_t x;
+{
+	u32_t n;
+	u8_t *p= (u8_t *)&n;
+
+	p[0]= x >> 24;
+	p[1]= x >> 16;
+	p[2]= x >> 8;
+	p[3]= x;
+	return n;
+}
+
+#include "../../../include/net/gen/in.h"
+#include "../../../include/net/gen/ip_hdr.h"
+#include "../../../include/net/gen/ip_io.h"
+#include "../../../include/net/gen/icmp.h"
+#include "../../../include/net/gen/ether.h"
+#include "../../../include/net/gen/route.h"
+#include "../../../include/net/gen/oneCsum.h"
+
+void bad_assertion(char *file, int line, char *what);
+void bad_compare(char *file, int line, int lhs, char *what, int rhs);
+
+#include "../buf.c"
+#include "../generic/ip_read.c"
+
+#define NR_DGRAMS	200		/* datagrams in the storm */
+#define DGRAM_MAX	8000		/* largest datagram */
+#define NR_FRAGS	200000L		/* fragments sent */
+#define WINDOW		8		/* datagrams sent at the same time */
+#define WINDOW_TIME	2000		/* fragments before it moves */
+#define HOG_SIZE	(BUF_S == 512 ? 8*1024 : 32*1024)	/* buffers held */
+
+/* The parts of ip.c, clock.c and icmp.c that ip_read.c uses. */
+PUBLIC ip_port_t ip_port_table[IP_PORT_NR];
+PUBLIC ip_fd_t ip_fd_table[IP_FD_NR];
+PUBLIC ip_ass_t ip_ass_table[IP_ASS_NR];
+
+/* Fragment data sizes for a few MTUs: ethernet, 1006, 576. */
+static int mtu[]= { 1480, 984, 552 };
+
+static time_t now= 1;
+static timer_t *timers[IP_PORT_NR];	/* timers set, by port */
+static long timeouts;
+static long flushes;
+
+struct dgram
+{
+	u8_t data[DGRAM_MAX];
+	int len;
+	int id;
+	ipaddr_t src;
+	int port;
+} dgrams[NR_DGRAMS];
+
+PUBLIC time_t get_time()
+{
+	return now;
+}
+
+PUBLIC void clck_timer(timer, timeout, func, fd)
+timer_t *timer;
+time_t timeout;
+timer_func_t func;
+int fd;
+{
+	timer->tim_time= timeout;
+	timer->tim_func= func;
+	timer->tim_ref= fd;
+	timer->tim_active= 1;
+	timers[fd]= timer;
+}
+
+PUBLIC void clck_untimer(timer)
+timer_t *timer;
+{
+	timer->tim_active= 0;
+}
+
+PUBLIC void icmp_snd_time_exceeded(port_nr, pack, code)
+int port_nr;
+acc_t *pack;
+int code;
+{
+	timeouts++;
+	bf_afree(pack);
+}
+
+PRIVATE void ip_buffree(priority)
+int priority;
+{
+	/* Like ip.c, drop the datagrams being reassembled when buffers are
+	 * short.
+	 */
+	if (priority == IP_PRI_ASSBUFS)
+	{
+		flushes++;
+		ip_ass_flush();
+	}
+}
+
+/* The rest of ip_read.c is not called by the test. */
+#define UNUSED(f)	{ printf("%s called\n", f); abort(); }
+PUBLIC void writeIpAddr(addr) ipaddr_t addr; UNUSED("writeIpAddr")
+PUBLIC void ev_enqueue(ev, func, ev_arg) event_t *ev; ev_func_t func;
+	ev_arg_t ev_arg; UNUSED("ev_enqueue")
+PUBLIC int ip_chk_hdropt(opt, optlen) u8_t *opt; int optlen;
+	UNUSED("ip_chk_hdropt")
+PUBLIC iroute_t *iroute_frag(port_nr, dest) int port_nr; ipaddr_t dest;
+	UNUSED("iroute_frag")
+PUBLIC int ip_forward(ip_port, pack) ip_port_t *ip_port; acc_t *pack;
+	UNUSED("ip_forward")
+PUBLIC void ip_hdr_chksum(ip_hdr, ip_hdr_len) ip_hdr_t *ip_hdr;
+	int ip_hdr_len; UNUSED("ip_hdr_chksum")
+PUBLIC ipaddr_t ip_get_netmask(hostaddr) ipaddr_t hostaddr;
+	UNUSED("ip_get_netmask")
+PUBLIC nettype_t ip_nettype(ipaddr) ipaddr_t ipaddr; UNUSED("ip_nettype")
+PUBLIC u16_t oneC_sum(prev, data, data_len) U16_t prev; void *data;
+	size_t data_len; UNUSED("oneC_sum")
+PUBLIC void icmp_snd_parameter_problem(port_nr, pack, ptr) int port_nr;
+	acc_t *pack; int ptr; UNUSED("icmp_snd_parameter_problem")
+PUBLIC void icmp_snd_unreachable(port_nr, pack, code) int port_nr;
+	acc_t *pack; int code; UNUSED("icmp_snd_unreachable")
+
+void bad_assertion(file, line, what)
+char *file;
+int line;
+char *what;
+{
+	printf("assertion \"%s\" failed at %s, line %d\n", what, file, line);
+	abort();
+}
+
+void bad_compare(file, line, lhs, what, rhs)
+char *file;
+int line;
+int lhs;
+char *what;
+int rhs;
+{
+	printf("compare (%d) %s (%d) failed at %s, line %d\n",
+		lhs, what, rhs, file, line);
+	abort();
+}
+
+static void fail(what)
+char *what;
+{
+	printf("%s\n", what);
+	exit(1);
+}
+
+static acc_t *fragment(dg, offset, len)
+struct dgram *dg;
+int offset;
+int len;
+{
+	/* Make fragment of a datagram, as it arrives from the wire. */
+	acc_t *pack, *acc;
+	ip_hdr_t *ip_hdr;
+	u8_t *data;
+	int n;
+
+	pack= bf_memreq(IP_MIN_HDR_SIZE + len);
+	if (IP_MIN_HDR_SIZE + len <= BUF_S && pack->acc_next != NULL)
+		fail("a request of up to BUF_S bytes got more than one buffer");
+	ip_hdr= (ip_hdr_t *)ptr2acc_data(pack);
+	memset(ip_hdr, 0, IP_MIN_HDR_SIZE);
+	ip_hdr->ih_vers_ihl= 0x45;
+	ip_hdr->ih_ttl= 30;
+	ip_hdr->ih_proto= IPPROTO_UDP;
+	ip_hdr->ih_length= htons(IP_MIN_HDR_SIZE + len);
+	ip_hdr->ih_id= htons(dg->id);
+	ip_hdr->ih_src= dg->src;
+	ip_hdr->ih_dst= 1;
+	ip_hdr->ih_flags_fragoff= htons((offset / 8) |
+		(offset + len < dg->len ? IH_MORE_FRAGS : 0));
+
+	/* The data may be spread over several buffers. */
+	data= dg->data + offset;
+	n= pack->acc_length - IP_MIN_HDR_SIZE;
+	memcpy(ip_hdr+1, data, n);
+	data += n;
+	for (acc= pack->acc_next; acc; acc= acc->acc_next)
+	{
+		memcpy(ptr2acc_data(acc), data, acc->acc_length);
+		data += acc->acc_length;
+	}
+	return pack;
+}
+
+static int same(pack, dg)
+acc_t *pack;
+struct dgram *dg;
+{
+	/* Is a reassembled packet the datagram that was sent? */
+	ip_hdr_t *ip_hdr;
+	acc_t *acc;
+	u8_t *data;
+	int n, r;
+
+	pack= bf_packIffLess(pack, IP_MIN_HDR_SIZE);
+	ip_hdr= (ip_hdr_t *)ptr2acc_data(pack);
+	r= 0;
+	if (ntohs(ip_hdr->ih_length) == IP_MIN_HDR_SIZE + dg->len &&
+		ntohs(ip_hdr->ih_id) == dg->id && ip_hdr->ih_src == dg->src &&
+		bf_bufsize(pack) == IP_MIN_HDR_SIZE + dg->len)
+	{
+		r= 1;
+		data= dg->data;
+		n= pack->acc_length - IP_MIN_HDR_SIZE;
+		if (memcmp(ip_hdr+1, data, n) != 0)
+			r= 0;
+		data += n;
+		for (acc= pack->acc_next; acc; acc= acc->acc_next)
+		{
+			if (memcmp(ptr2acc_data(acc), data, acc->acc_length)
+				!= 0)
+			{
+				r= 0;
+			}
+			data += acc->acc_length;
+		}
+	}
+	bf_afree(pack);
+	return r;
+}
+
+static void check()
+{
+	/* Check the invariants of the reassembly tables. */
+	ip_ass_t *ass_ent, *hash_ent;
+	acc_t *frag;
+	int port_nr, used, nfree, prev_end;
+	u32_t size, mem;
+	time_t last;
+
+	used= 0;
+	mem= 0;
+	for (port_nr= 0; port_nr<IP_PORT_NR; port_nr++)
+	{
+		last= 0;
+		for (ass_ent= ip_ass_head[port_nr]; ass_ent;
+			ass_ent= ass_ent->ia_age_next)
+		{
+			used++;
+			if (ass_ent->ia_port != &ip_port_table[port_nr])
+				fail("wrong port");
+			if (ass_ent->ia_first_time < last)
+				fail("age list order");
+			last= ass_ent->ia_first_time;
+			if (last + IP_ASS_TIMEOUT <= now)
+				fail("timed out");
+			if (ass_ent->ia_age_next == NULL &&
+				ip_ass_tail[port_nr] != ass_ent)
+			{
+				fail("age list tail");
+			}
+
+			for (hash_ent= ip_ass_hash[ass_hash(ass_ent->ia_id,
+				ass_ent->ia_proto, ass_ent->ia_srcaddr,
+				ass_ent->ia_dstaddr)];
+				hash_ent && hash_ent != ass_ent;
+				hash_ent= hash_ent->ia_hash_next)
+			{
+			}
+			if (hash_ent == NULL)
+				fail("hash chain");
+
+			if (ass_ent->ia_frags == NULL)
+				fail("no fragments");
+			size= 0;
+			prev_end= -1;
+			for (frag= ass_ent->ia_frags; frag;
+				frag= frag->acc_ext_link)
+			{
+				if ((int)frag_offset(frag) <= prev_end)
+				{
+					fail("fragments overlap or touch");
+				}
+				prev_end= frag_offset(frag) + bf_bufsize(frag) -
+					IP_MIN_HDR_SIZE;
+				size += bf_bufsize(frag);
+			}
+			if (size != ass_ent->ia_size)
+				fail("ia_size");
+			mem += size;
+		}
+		if (ip_ass_head[port_nr] == NULL)
+		{
+			if (ip_ass_tail[port_nr] != NULL)
+				fail("tail");
+			if (ip_ass_timer[port_nr].tim_active)
+				fail("idle timer");
+		}
+		else if (!ip_ass_timer[port_nr].tim_active ||
+			ip_ass_timer[port_nr].tim_time !=
+			ip_ass_head[port_nr]->ia_first_time + IP_ASS_TIMEOUT)
+		{
+			fail("timer");
+		}
+	}
+	if (mem != ip_ass_mem)
+		fail("ip_ass_mem");
+	if (mem > IP_ASS_MEM)
+		fail("IP_ASS_MEM");
+
+	nfree= 0;
+	for (ass_ent= ip_ass_freelist; ass_ent; ass_ent= ass_ent->ia_hash_next)
+		nfree++;
+	if (used + nfree != IP_ASS_NR)
+		fail("lost entries");
+}
+
+static int count(list)
+acc_t *list;
+{
+	int n;
+
+	for (n= 0; list; list= list->acc_next)
+		n++;
+	return n;
+}
+
+int main(argc, argv)
+int argc;
+char **argv;
+{
+	struct dgram *dg;
+	acc_t *pack, *hog;
+	ip_ass_t *ass_ent;
+	long n, whole;
+	int i, offset, len, port_nr, accs, window, left;
+
+	setbuf(stdout, NULL);
+	srand(argc > 1 ? atoi(argv[1]) : 1);
+	bf_init();
+	bf_logon(ip_buffree);
+	ip_ass_init();
+	accs= count(acc_freelist);
+
+	for (i= 0, dg= dgrams; i<NR_DGRAMS; i++, dg++)
+	{
+		dg->len= rand() % 3 == 0 ? DGRAM_MAX : 8 + 8 * (rand() % 1000);
+		for (offset= 0; offset<dg->len; offset++)
+			dg->data[offset]= rand();
+		dg->id= i;
+		dg->src= rand() % 4;
+		dg->port= rand() % IP_PORT_NR;
+	}
+
+	whole= 0;
+	hog= NULL;
+	for (n= 0; n<NR_FRAGS; n++)
+	{
+		/* Most fragments belong to a window of datagrams that moves
+		 * through the list, and that is five times as wide one time
+		 * in four.  The others are strays.
+		 */
+		window= (n / WINDOW_TIME) % 4 == 3 ? 5 * WINDOW : WINDOW;
+
+		/* During the wide window the rest of inet holds buffers too,
+		 * so the reassembly code gets asked to free its buffers.
+		 */
+		if (n % WINDOW_TIME == 0)
+		{
+			if (hog != NULL)
+				bf_afree(hog);
+			hog= window == WINDOW ? NULL : bf_memreq(HOG_SIZE);
+		}
+		if (rand() % 10 != 0)
+		{
+			i= (n / WINDOW_TIME * (WINDOW/2) + rand() % window) %
+								NR_DGRAMS;
+		}
+		else
+			i= rand() % NR_DGRAMS;
+		dg= &dgrams[i];
+
+		/* Now and then a second passes, and timers go off. */
+		if (rand() % 20 == 0)
+		{
+			now += HZ;
+			for (port_nr= 0; port_nr<IP_PORT_NR; port_nr++)
+			{
+				if (timers[port_nr] &&
+					timers[port_nr]->tim_active &&
+					timers[port_nr]->tim_time <= now)
+				{
+					timers[port_nr]->tim_active= 0;
+					(*timers[port_nr]->tim_func)(port_nr,
+						timers[port_nr]);
+				}
+			}
+		}
+
+		/* A fragment as cut on a path with one of a few MTUs, so that
+		 * fragments of different paths overlap, and now and then a
+		 * random piece.
+		 */
+		if (rand() % 4 != 0)
+		{
+			len= mtu[rand() % (sizeof(mtu) / sizeof(mtu[0]))];
+			offset= len * (rand() % ((dg->len + len-1) / len));
+		}
+		else
+		{
+			offset= 8 * (rand() % (dg->len / 8));
+			len= 8 * (1 + rand() % 185);
+		}
+		if (offset + len > dg->len)
+			len= dg->len - offset;
+		pack= fragment(dg, offset, len);
+
+		pack= reassemble(&ip_port_table[dg->port], pack,
+			(ip_hdr_t *)ptr2acc_data(pack));
+		if (pack != NULL)
+		{
+			if (!same(pack, dg))
+				fail("datagram reassembled wrong");
+			whole++;
+		}
+		check();
+	}
+
+	left= IP_ASS_NR;
+	for (ass_ent= ip_ass_freelist; ass_ent; ass_ent= ass_ent->ia_hash_next)
+		left--;
+	if (hog != NULL)
+		bf_afree(hog);
+	ip_ass_flush();
+	check();
+	if (ip_ass_mem != 0)
+		fail("memory left after flush");
+	if (count(buf512_freelist) != BUF512_NR
+#if BUF2K_NR
+		|| count(buf2K_freelist) != BUF2K_NR
+#endif
+		|| count(acc_freelist) != accs)
+	{
+		fail("buffers leaked");
+	}
+	printf("%ld fragments: %ld datagrams reassembled, %ld timed out, %ld flushes, %d left over\n",
+		NR_FRAGS, whole, timeouts, flushes, left);
+	return 0;
+}
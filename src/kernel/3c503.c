@@ -64,8 +64,8 @@ dpeth_t * dep;
   dep->de_16bit = (inb_el2(dep, DP_DCR) & DCR_WTS) != 0;
   outb_el2(dep, DP_CR, CR_PS_P0|CR_DM_ABORT|CR_STP);
 
-  /* Allocate one send buffer (1.5KB) per 8KB of on board memory. */
-  sendq_nr = (dep->de_ramsize - dep->de_offset_page) / 0x2000;
+  /* Allocate one send buffer (1.5KB) per 4KB of on board memory. */
+  sendq_nr = (dep->de_ramsize - dep->de_offset_page) / SENDQ_RAM;
   if (sendq_nr < 1)
 	sendq_nr = 1;
   else if (sendq_nr > SENDQ_NR)
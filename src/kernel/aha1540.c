@@ -482,7 +482,8 @@ PRIVATE struct driver s_dtab = {
   s_schedule,	/* precompute SCSI transfer parameters, etc. */
   s_finish,	/* do the I/O */
   nop_cleanup,	/* no cleanup needed */
-  s_geometry	/* tell the geometry of the disk */
+  s_geometry,	/* tell the geometry of the disk */
+  nop_alarm	/* ignore leftover interrupts */
 };
 
 
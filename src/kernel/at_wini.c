@@ -183,6 +183,7 @@ PRIVATE struct driver w_dtab = {
   w_finish,		/* do the I/O */
   nop_cleanup,		/* nothing to clean up */
   w_geometry,		/* tell the geometry of the disk */
+  nop_alarm,		/* ignore leftover interrupts */
 };
 
 #if ENABLE_ATAPI
@@ -56,10 +56,9 @@
 
 /* Clock parameters. */
 #if (CHIP == INTEL)
-#define COUNTER_FREQ (2*TIMER_FREQ)	/* counter frequency using sqare wave*/
 #define LATCH_COUNT     0x00	/* cc00xxxx, c = channel, x = any */
-#define SQUARE_WAVE     0x36	/* ccaammmb, a = access, m = mode, b = BCD */
-				/*   11x11, 11 = LSB then MSB, x11 = sq wave */
+#define RATE_GENERATOR  0x34	/* ccaammmb, a = access, m = mode, b = BCD */
+				/*   11x10, 11 = LSB then MSB, x10 = rate gen */
 #define TIMER_COUNT ((unsigned) (TIMER_FREQ/HZ)) /* initial value for counter*/
 #define TIMER_FREQ  1193182L	/* clock frequency for timer in PC and AT */
 
@@ -86,6 +85,10 @@ PRIVATE int syn_table[NR_TASKS+NR_PROCS]; /* which tasks get CLOCK_INT*/
 PRIVATE clock_t pending_ticks;	/* ticks seen by low level only */
 PRIVATE int sched_ticks = SCHED_RATE;	/* counter: when 0, call scheduler */
 PRIVATE struct proc *prev_ptr;	/* last user process run by clock task */
+#if (CHIP == INTEL)
+PRIVATE clock_t bill_ticks;	/* uptime and timer count when the process */
+PRIVATE unsigned bill_count;	/*   that runs now was last billed */
+#endif
 
 FORWARD _PROTOTYPE( void common_setalarm, (int proc_nr,
 		long delta_ticks, watchdog_t fuction) );
@@ -98,6 +101,9 @@ FORWARD _PROTOTYPE( void init_clock, (void) );
 FORWARD _PROTOTYPE( void cause_alarm, (void) );
 FORWARD _PROTOTYPE( void do_setsyn_alrm, (message *m_ptr) );
 FORWARD _PROTOTYPE( int clock_handler, (int irq) );
+#if ENABLE_PROFILING
+FORWARD _PROTOTYPE( void profile, (struct proc *rp) );
+#endif
 
 /*===========================================================================*
  *				clock_task				     *
@@ -442,6 +448,18 @@ int irq;
 	outb(PORT_B, inb(PORT_B) | CLOCK_ACK_BIT);
   }
 
+  ticks = lost_ticks + 1;
+  lost_ticks = 0;
+  pending_ticks += ticks;
+  now = realtime + pending_ticks;
+
+#if (CHIP == INTEL)
+  /* Bill the time of the running process up to now, so that a process that
+   * runs for a long time is seen to do so.  If the kernel was interrupted,
+   * then it may be billing right now, so leave it to the next switch.
+   */
+  if (k_reenter == 0) bill_time();
+#else
   /* Update user and system accounting times.
    * First charge the current process for user time.
    * If the current process is not the billable process (usually because it
@@ -452,13 +470,15 @@ int irq;
 	rp = proc_addr(HARDWARE);
   else
 	rp = proc_ptr;
-  ticks = lost_ticks + 1;
-  lost_ticks = 0;
   rp->user_time += ticks;
   if (rp != bill_ptr && rp != proc_addr(IDLE)) bill_ptr->sys_time += ticks;
+#endif
+
+#if ENABLE_PROFILING
+  /* Sample the program counter of a process that is being profiled. */
+  if (k_reenter == 0 && proc_ptr->p_prof_scale != 0) profile(proc_ptr);
+#endif
 
-  pending_ticks += ticks;
-  now = realtime + pending_ticks;
   if (tty_timeout <= now) tty_wakeup(now);	/* possibly wake up TTY */
 #if (CHIP != M68000)
   pr_restart();					/* possibly restart printer */
@@ -488,6 +508,39 @@ int irq;
   return 1;	/* Reenable clock interrupt */
 }
 
+#if ENABLE_PROFILING
+
+/*===========================================================================*
+ *				profile					     *
+ *===========================================================================*/
+PRIVATE void profile(rp)
+register struct proc *rp;	/* process interrupted by the clock */
+{
+/* Add one to the counter for the interrupted program counter in the profile
+ * buffer, the way profil(2) describes it: the pc minus the offset is halved
+ * and multiplied by the scale / 65536 to find the counter.  The buffer is in
+ * the data segment of the owner, which may be the process itself.
+ */
+  vir_bytes pc;
+  vir_bytes n;			/* byte offset of the counter */
+  u16_t count;
+  phys_bytes phys;
+
+  pc = (vir_bytes) rp->p_reg.pc;
+  if (pc < rp->p_prof_off) return;
+  n = (vir_bytes) (((pc - rp->p_prof_off) >> 1)
+				* (unsigned long) rp->p_prof_scale >> 16);
+  n *= sizeof(count);
+  if (n > rp->p_prof_size - sizeof(count)) return;
+
+  phys = ((phys_bytes) rp->p_prof_owner->p_map[D].mem_phys << CLICK_SHIFT)
+					+ rp->p_prof_buf + n;
+  phys_copy(phys, vir2phys(&count), (phys_bytes) sizeof(count));
+  count++;
+  phys_copy(vir2phys(&count), phys, (phys_bytes) sizeof(count));
+}
+#endif /* ENABLE_PROFILING */
+
 #if (CHIP == INTEL)
 
 /*===========================================================================*
@@ -495,9 +548,12 @@ int irq;
  *===========================================================================*/
 PRIVATE void init_clock()
 {
-/* Initialize channel 0 of the 8253A timer to e.g. 60 Hz. */
+/* Initialize channel 0 of the 8253A timer to e.g. 60 Hz.  As a rate
+ * generator it counts down once per tick, so that read_clock() can tell how
+ * far into a tick we are.
+ */
 
-  outb(TIMER_MODE, SQUARE_WAVE);	/* set timer to run continuously */
+  outb(TIMER_MODE, RATE_GENERATOR);	/* set timer to run continuously */
   outb(TIMER0, TIMER_COUNT);	/* load timer low byte */
   outb(TIMER0, TIMER_COUNT >> 8);	/* load timer high byte */
   put_irq_handler(CLOCK_IRQ, clock_handler);	/* set the interrupt handler */
@@ -557,10 +613,10 @@ struct milli_state *msp;
   unsigned count;
 
   /* Read the counter for channel 0 of the 8253A timer.  The counter
-   * decrements at twice the timer frequency (one full cycle for each
-   * half of square wave).  The counter normally has a value between 0
-   * and TIMER_COUNT, but before the clock task has been initialized,
-   * its maximum value is 65535, as set by the BIOS.
+   * decrements at the timer frequency.  The counter normally has a value
+   * between 1 and TIMER_COUNT, but before the clock task has been
+   * initialized, its maximum value is 65535, and it decrements twice as
+   * fast in the square wave mode set by the BIOS.
    */
   outb(TIMER_MODE, LATCH_COUNT);	/* make chip copy count to latch */
   count = inb(TIMER0);	/* countdown continues during 2-step read */
@@ -575,6 +631,97 @@ struct milli_state *msp;
 
   return msp->accum_count / (TIMER_FREQ / 1000);
 }
+
+
+/*==========================================================================*
+ *				read_clock				    *
+ *==========================================================================*/
+PUBLIC clock_t read_clock(countp)
+unsigned *countp;		/* timer counts since the last tick */
+{
+/* Return the uptime in ticks, and how far the timer has counted into the
+ * current tick.  There is no locking, so interrupt handlers may use this.
+ * If a tick has passed whose interrupt has not been handled yet, the time
+ * seems to go back by a tick.
+ */
+  clock_t uptime;
+  unsigned count;
+
+  uptime = realtime + pending_ticks;
+  outb(TIMER_MODE, LATCH_COUNT);	/* make chip copy count to latch */
+  count = inb(TIMER0);
+  count |= inb(TIMER0) << 8;
+
+  /* Until init_clock() has run the count may be out of range. */
+  *countp = count > TIMER_COUNT ? 0 : TIMER_COUNT - count;
+  return(uptime);
+}
+
+
+/*==========================================================================*
+ *				bill_time				    *
+ *==========================================================================*/
+PUBLIC void bill_time()
+{
+/* Charge the time since the last call to the process that is running, before
+ * proc_ptr is changed, or on a clock tick.  A task or server also bills the
+ * user process it presumably works for, bill_ptr, for system time.  Thus the
+ * unbillable tasks' user time is the billable users' system time.  The time
+ * comes from the timer, so even a process that runs only for a moment
+ * between two ticks is billed for it.
+ */
+  register struct proc *rp = proc_ptr;
+  clock_t now;
+  long ticks;
+  unsigned count;
+  unsigned long counts;
+
+  now = read_clock(&count);
+  ticks = now - bill_ticks;
+  if (ticks < 0 || (ticks == 0 && count < bill_count)) {
+	/* The timer has started a new tick that the clock interrupt has not
+	 * counted yet.
+	 */
+	now++;
+	ticks++;
+  }
+  if (ticks == 0)
+	counts = count - bill_count;
+  else if (ticks == 1)
+	counts = (TIMER_COUNT - bill_count) + count;
+  else
+	counts = ticks * TIMER_COUNT - bill_count + count;
+  bill_ticks = now;
+  bill_count = count;
+
+  add_time(&rp->user_time, &rp->p_user_count, counts);
+  if (rp != bill_ptr && rp != proc_addr(IDLE))
+	add_time(&bill_ptr->sys_time, &bill_ptr->p_sys_count, counts);
+}
+
+
+/*==========================================================================*
+ *				add_time				    *
+ *==========================================================================*/
+PUBLIC void add_time(timep, countp, counts)
+clock_t *timep;			/* time in ticks */
+unsigned *countp;		/* and the part of a tick in timer counts */
+unsigned long counts;		/* timer counts to add */
+{
+/* Add a number of timer counts to a time kept as ticks plus counts. */
+
+  if (counts < TIMER_COUNT) {
+	/* The usual case, without a long division. */
+	if ((*countp += (unsigned) counts) >= TIMER_COUNT) {
+		*countp -= TIMER_COUNT;
+		(*timep)++;
+	}
+	return;
+  }
+  counts += *countp;
+  *timep += counts / TIMER_COUNT;
+  *countp = counts % TIMER_COUNT;
+}
 #endif /* (CHIP == INTEL) */
 
 
@@ -98,6 +98,22 @@ PRIVATE int nr_cons= 1;		/* actual number of consoles */
 PRIVATE console_t cons_table[NR_CONS];
 PRIVATE console_t *curcons;	/* currently visible */
 
+#if CONS_SHADOW_LINES > 0
+/* While a write is in progress scrolling up is only counted, and the new
+ * lines are kept in a shadow buffer.  At the end of the write, or when
+ * output goes elsewhere on the screen, the old lines are moved up by the net
+ * scroll in one copy and the new lines are copied from the shadow.  This
+ * saves a copy of the whole screen per line when scrolling in software.
+ */
+PRIVATE u16_t shadow[CONS_SHADOW_LINES * 80];	/* ring of new lines */
+PRIVATE unsigned sh_lines;	/* # lines of scr_width the shadow holds */
+PRIVATE unsigned sh_first;	/* shadow line that is first on the screen */
+PRIVATE unsigned sh_scroll;	/* # lines scrolled, but not on the screen */
+PRIVATE console_t *sh_cons;	/* console being written, or NULL */
+
+#define sh_line(n)	(&shadow[(sh_first + (n)) % sh_lines * scr_width])
+#endif
+
 /* Color if using a color controller. */
 #define color	(vid_port == C_6845)
 
@@ -119,6 +135,10 @@ FORWARD _PROTOTYPE( void do_escape, (console_t *cons, int c)		);
 FORWARD _PROTOTYPE( void flush, (console_t *cons)			);
 FORWARD _PROTOTYPE( void parse_escape, (console_t *cons, int c)		);
 FORWARD _PROTOTYPE( void scroll_screen, (console_t *cons, int dir)	);
+#if CONS_SHADOW_LINES > 0
+FORWARD _PROTOTYPE( int shadow_copy, (console_t *cons)			);
+FORWARD _PROTOTYPE( void scroll_commit, (console_t *cons)		);
+#endif
 FORWARD _PROTOTYPE( void set_6845, (int reg, unsigned val)		);
 FORWARD _PROTOTYPE( void stop_beep, (void)				);
 FORWARD _PROTOTYPE( void cons_org0, (void)				);
@@ -148,6 +168,10 @@ register struct tty *tp;	/* tells which terminal is to be used */
    */
   if ((count = tp->tty_outleft) == 0 || tp->tty_inhibited) return;
 
+#if CONS_SHADOW_LINES > 0
+  sh_cons = cons;		/* collect scrolls until the end of the write */
+#endif
+
   /* Copy the user bytes to buf[] for decent addressing. Loop over the
    * copies, since the user buffer may be much larger than buf[].
    */
@@ -181,6 +205,10 @@ register struct tty *tp;	/* tells which terminal is to be used */
   } while ((count = tp->tty_outleft) != 0 && !tp->tty_inhibited);
 
   flush(cons);			/* transfer anything buffered to the screen */
+#if CONS_SHADOW_LINES > 0
+  scroll_commit(cons);		/* and the lines scrolled in */
+  sh_cons = NULL;
+#endif
 
   /* Reply to the writer if all output is finished. */
   if (tp->tty_outleft == 0) {
@@ -301,8 +329,31 @@ register console_t *cons;	/* pointer to console struct */
 int dir;			/* SCROLL_UP or SCROLL_DOWN */
 {
   unsigned new_line, new_org, chars;
+#if CONS_SHADOW_LINES > 0
+  u16_t *lp;
+#endif
 
   flush(cons);
+#if CONS_SHADOW_LINES > 0
+  if (dir == SCROLL_UP && cons == sh_cons && sh_lines > 0) {
+	/* Count the scroll and start a blank new line in the shadow. */
+	if (sh_scroll == sh_lines) {
+		if (sh_lines == scr_lines) {
+			/* The oldest new line scrolls off the screen. */
+			if (++sh_first == sh_lines) sh_first = 0;
+			sh_scroll--;
+		} else {
+			scroll_commit(cons);
+		}
+	}
+	lp = sh_line(sh_scroll);
+	sh_scroll++;
+	chars = scr_width;
+	do *lp++ = cons->c_blank; while (--chars > 0);
+	return;
+  }
+  scroll_commit(cons);		/* the rest works on the real screen */
+#endif
   chars = scr_size - scr_width;	/* one screen minus one line */
 
   /* Scrolling the screen is a real nuisance due to the various incompatible
@@ -362,6 +413,9 @@ register console_t *cons;	/* pointer to console struct */
 
   /* Have the characters in 'ramqueue' transferred to the screen. */
   if (cons->c_rwords > 0) {
+#if CONS_SHADOW_LINES > 0
+	if (!shadow_copy(cons))
+#endif
 	mem_vid_copy(cons->c_ramqueue, cons->c_cur, cons->c_rwords);
 	cons->c_rwords = 0;
 
@@ -383,6 +437,82 @@ register console_t *cons;	/* pointer to console struct */
 }
 
 
+#if CONS_SHADOW_LINES > 0
+/*===========================================================================*
+ *				shadow_copy				     *
+ *===========================================================================*/
+PRIVATE int shadow_copy(cons)
+register console_t *cons;	/* pointer to console struct */
+{
+/* Put the characters in 'ramqueue' in the shadow if they go on one of the
+ * new lines of a pending scroll.  Otherwise put the scroll on the screen, so
+ * that flush() can copy them to video memory.  Return TRUE if done here.
+ */
+  unsigned off, row, n;
+  u16_t *src, *dst;
+
+  if (cons != sh_cons || sh_scroll == 0) return(FALSE);
+
+  off = cons->c_cur - cons->c_org;
+  row = off / scr_width;
+  if (row < scr_lines - sh_scroll || row >= scr_lines) {
+	scroll_commit(cons);
+	return(FALSE);
+  }
+  dst = sh_line(row - (scr_lines - sh_scroll)) + off % scr_width;
+  src = cons->c_ramqueue;
+  n = cons->c_rwords;
+  do *dst++ = *src++; while (--n > 0);
+  return(TRUE);
+}
+
+
+/*===========================================================================*
+ *				scroll_commit				     *
+ *===========================================================================*/
+PRIVATE void scroll_commit(cons)
+register console_t *cons;	/* pointer to console struct */
+{
+/* Scroll the screen up by the number of lines counted since the write began,
+ * and fill the bottom with the new lines from the shadow.  The screen is
+ * scrolled like scroll_screen() does it, only by more lines at once.
+ */
+  unsigned n, chars, old_org, dst;
+
+  if (cons != sh_cons || sh_scroll == 0) return;
+
+  n = sh_scroll * scr_width;
+  chars = scr_size - n;		/* old lines that stay on the screen */
+  old_org = cons->c_org;
+  if (softscroll) {
+	if (chars > 0) vid_vid_copy(cons->c_start + n, cons->c_start, chars);
+  } else
+  if (!wrap && cons->c_org + scr_size + n >= cons->c_limit) {
+	if (chars > 0) vid_vid_copy(cons->c_org + n, cons->c_start, chars);
+	cons->c_org = cons->c_start;
+  } else {
+	cons->c_org = (cons->c_org + n) & vid_mask;
+  }
+
+  /* Copy the new lines, in two pieces if they wrap around the shadow. */
+  dst = cons->c_org + chars;
+  n = sh_lines - sh_first;
+  if (n > sh_scroll) n = sh_scroll;
+  mem_vid_copy(sh_line(0), dst, n * scr_width);
+  if (n < sh_scroll)
+	mem_vid_copy(shadow, dst + n * scr_width, (sh_scroll - n) * scr_width);
+  sh_scroll = sh_first = 0;
+
+  /* The cursor stays where it is relative to the origin. */
+  cons->c_cur = cons->c_org + (cons->c_cur - old_org);
+  if (cons == curcons) {
+	set_6845(VID_ORG, cons->c_org);
+	set_6845(CURSOR, cons->c_cur);
+  }
+}
+#endif /* CONS_SHADOW_LINES > 0 */
+
+
 /*===========================================================================*
  *				parse_escape				     *
  *===========================================================================*/
@@ -456,6 +586,9 @@ char c;				/* next character in escape sequence */
 
   /* Some of these things hack on screen RAM, so it had better be up to date */
   flush(cons);
+#if CONS_SHADOW_LINES > 0
+  if (c != 'm') scroll_commit(cons);
+#endif
 
   if (cons->c_esc_intro == '\0') {
 	/* Handle a sequence beginning with just ESC */
@@ -818,6 +951,12 @@ tty_t *tp;
   cons->c_org = cons->c_start;
   cons->c_attr = cons->c_blank = BLANK_COLOR;
 
+#if CONS_SHADOW_LINES > 0
+  /* How many lines of new output can be collected per write. */
+  sh_lines = buflen(shadow) / scr_width;
+  if (sh_lines > scr_lines) sh_lines = scr_lines;
+#endif
+
   /* Clear the screen. */
   blank_color = BLANK_COLOR;
   mem_vid_copy(BLANK_MEM, cons->c_start, scr_size);
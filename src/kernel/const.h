@@ -136,6 +136,32 @@
 #define EP_ON		2	/* var = on (or field left blank) */
 #define EP_SET		3	/* var = 1:2:3 (nonblank field) */
 
+/* The kernel trace ring needs the clock of the PC. */
+#if (CHIP == INTEL)
+#define ENABLE_KTRACE	(KTRACE_SIZE > 0)
+#else
+#define ENABLE_KTRACE	   0
+#endif
+
+/* Record an event in the kernel trace ring if tracing is on.  The arguments
+ * are only evaluated then.
+ */
+#if ENABLE_KTRACE
+#define KTRACE(event, proc, peer, type)	\
+	(kt_on ? ktrace(event, proc, peer, type) : (void) 0)
+#else
+#define KTRACE(event, proc, peer, type)	((void) 0)
+#endif
+
+/* Process times are billed with sub-tick precision at each process switch on
+ * the PC, elsewhere a whole tick is billed by the clock interrupt.
+ */
+#if (CHIP == INTEL)
+#define BILL_TIME()	bill_time()
+#else
+#define BILL_TIME()	((void) 0)
+#endif
+
 /* To translate an address in kernel space to a physical address.  This is
  * the same as umap(proc_ptr, D, vir, sizeof(*vir)), but a lot less costly.
  */
@@ -174,6 +174,7 @@ static struct driver dd_dtab=
 	dd_finish,
 	nop_cleanup,
 	dd_geometry,
+	nop_alarm,
 };
 
 void dosfat_task()
@@ -71,7 +71,8 @@ PRIVATE struct driver d_dtab = {
   d_schedule,	/* precompute cylinder, head, sector, etc. */
   d_finish,	/* do the I/O */
   nop_cleanup,	/* no cleanup needed */
-  d_geometry	/* tell the geometry of the disk */
+  d_geometry,	/* tell the geometry of the disk */
+  nop_alarm	/* ignore leftover interrupts */
 };
 
 
@@ -18,6 +18,10 @@
  * |------------|----------|---------|----------|---------|---------|
  * | DL_READV	| port nr  | proc nr | count    |         | address |
  * |------------|----------|---------|----------|---------|---------|
+ * | DL_READMV	| port nr  | proc nr | count    | stride  | address |
+ * |------------|----------|---------|----------|---------|---------|
+ * | DL_WRITEMV	| port nr  | proc nr | count    | stride  | address |
+ * |------------|----------|---------|----------|---------|---------|
  * | DL_INIT	| port nr  | proc nr | mode     |         | address |
  * |------------|----------|---------|----------|---------|---------|
  * | DL_GETSTAT	| port nr  | proc nr |          |         | address |
@@ -32,6 +36,17 @@
  * |DL_TASK_REPL| port nr  | proc nr | rd-count | err|stat| clock   |
  * |------------|----------|---------|----------|---------|---------|
  *
+ * DL_READMV hands the driver an array of count iovecs that is divided in
+ * slots of stride entries, one slot per frame. All frames that are
+ * waiting in the receive ring are copied out in one go. The rd-count of
+ * the reply is then the number of frames, and the length of each frame
+ * is stored in the iov_size of the first entry of its slot.
+ *
+ * DL_WRITEMV is the sending counterpart. Each slot of stride entries
+ * holds one frame, and a slot whose entries are all empty ends the list.
+ * The frames are copied to free send buffers as these become available,
+ * and a single DL_PACK_SEND reply is sent when the last one is copied.
+ *
  *   m_type	  m3_i1     m3_i2       m3_ca1
  * |------------+---------+-----------+---------------|
  * |DL_INIT_REPL| port nr | last port | ethernet addr |
@@ -115,6 +130,11 @@ extern int ___dummy[DE_PORT_NR == sizeof(dp_conf)/sizeof(dp_conf[0]) ? 1 : -1];
 _PROTOTYPE( static void do_vwrite, (message *mp, int from_int,
 							int vectored)	);
 _PROTOTYPE( static void do_vread, (message *mp, int vectored)		);
+_PROTOTYPE( static void do_readmv, (message *mp)			);
+_PROTOTYPE( static void dp_read_slot, (dpeth_t *dep)			);
+_PROTOTYPE( static void do_writemv, (message *mp)			);
+_PROTOTYPE( static void dp_write_slots, (dpeth_t *dep)			);
+_PROTOTYPE( static void dp_sendq_put, (dpeth_t *dep, int size)		);
 _PROTOTYPE( static void do_init, (message *mp)				);
 _PROTOTYPE( static void do_int, (dpeth_t *dep)				);
 _PROTOTYPE( static void do_getstat, (message *mp)			);
@@ -197,6 +217,8 @@ void dp8390_task()
 		case DL_WRITEV:	do_vwrite(&m, FALSE, TRUE);	break;
 		case DL_READ:	do_vread(&m, FALSE);		break;
 		case DL_READV:	do_vread(&m, TRUE);		break;
+		case DL_READMV:	do_readmv(&m);			break;
+		case DL_WRITEMV: do_writemv(&m);		break;
 		case DL_INIT:	do_init(&m);			break;
 		case DL_GETSTAT: do_getstat(&m);		break;
 		case DL_STOP:	do_stop(&m);			break;
@@ -265,6 +287,8 @@ void dp_dump()
 		printf("CDheartbeat:%8ld\n", dep->de_stat.ets_CDheartbeat);
 
 		printf("OWC        :%8ld\t", dep->de_stat.ets_OWC);
+		printf("sendqFull  :%8ld\t", dep->de_stat.ets_sendqFull);
+		printf("sendq_nr   :%8d\n", dep->de_sendq_nr);
 
 		isr= inb_reg0(dep, DP_ISR);
 		printf("dp_isr = 0x%x + 0x%x, de_flags = 0x%x\n", isr,
@@ -328,6 +352,7 @@ int vectored;
 	{
 		if (from_int)
 			panic("dp8390: should not be sending\n", NO_NUM);
+		dep->de_stat.ets_sendqFull++;
 		dep->de_sendmsg= *mp;
 		dep->de_flags |= DEF_SEND_AVAIL;
 		reply(dep, OK, FALSE);
@@ -358,10 +383,128 @@ int vectored;
 		dep->de_write_iovec.iod_iovec_addr = 0;
 		size= mp->DL_COUNT;
 	}
+	dp_sendq_put(dep, size);
+
+	dep->de_flags |= DEF_PACK_SEND;
+
+	/* If the interrupt handler called, don't send a reply. The reply
+	 * will be sent after all interrupts are handled. 
+	 */
+	if (from_int)
+		return;
+	reply(dep, OK, FALSE);
+
+	assert(dep->de_mode == DEM_ENABLED);
+	assert(dep->de_flags & DEF_ENABLED);
+}
+
+
+/*===========================================================================*
+ *				do_writemv				     *
+ *===========================================================================*/
+static void do_writemv(mp)
+message *mp;
+{
+	int port, count, stride;
+	dpeth_t *dep;
+
+	port = mp->DL_PORT;
+	count = mp->DL_COUNT;
+	stride = mp->DL_STRIDE;
+	if (port < 0 || port >= DE_PORT_NR)
+		panic("dp8390: illegal port", port);
+	dep= &de_table[port];
+	dep->de_client= mp->DL_PROC;
+
+	if (dep->de_mode == DEM_SINK)
+	{
+		dep->de_flags |= DEF_PACK_SEND;
+		reply(dep, OK, FALSE);
+		return;
+	}
+	assert(dep->de_mode == DEM_ENABLED);
+	assert(dep->de_flags & DEF_ENABLED);
+	if (dep->de_flags & DEF_SEND_AVAIL)
+		panic("dp8390: send already in progress", NO_NUM);
+	if (stride < 1 || stride > IOVEC_NR || count < stride ||
+		count % stride != 0)
+	{
+		panic("dp8390: wrong DL_WRITEMV stride", stride);
+	}
+	assert(!(dep->de_flags & DEF_PACK_SEND));
+
+	dep->de_write_iovec.iod_proc_nr = mp->DL_PROC;
+	dep->de_wrm_addr= (vir_bytes) mp->DL_ADDR;
+	dep->de_wrm_stride= stride;
+	dep->de_wrm_left= count / stride;
+	dep->de_sendmsg= *mp;
+	dp_write_slots(dep);
+
+	reply(dep, OK, FALSE);
+}
+
+
+/*===========================================================================*
+ *				dp_write_slots				     *
+ *===========================================================================*/
+static void dp_write_slots(dep)
+dpeth_t *dep;
+{
+	/* Copy the frames of a DL_WRITEMV to the send queue until either
+	 * all frames are copied or the queue is full. In the latter case
+	 * dp_send continues after the next transmit interrupt.
+	 */
+	iovec_dat_t *iovp;
+	int i, size;
+
+	iovp= &dep->de_write_iovec;
+	while (dep->de_wrm_left > 0)
+	{
+		if (dep->de_sendq[dep->de_sendq_head].sq_filled)
+		{
+			dep->de_stat.ets_sendqFull++;
+			dep->de_flags |= DEF_SEND_AVAIL;
+			return;
+		}
+		get_userdata(iovp->iod_proc_nr, dep->de_wrm_addr,
+			dep->de_wrm_stride * sizeof(iovec_t), iovp->iod_iovec);
+		iovp->iod_iovec_s = dep->de_wrm_stride;
+		iovp->iod_iovec_addr = dep->de_wrm_addr;
+
+		size= 0;
+		for (i= 0; i<iovp->iod_iovec_s; i++)
+			size += iovp->iod_iovec[i].iov_size;
+		if (size == 0)
+			break;		/* End of the list */
+		dp_sendq_put(dep, size);
+
+		dep->de_wrm_addr += dep->de_wrm_stride * sizeof(iovec_t);
+		dep->de_wrm_left--;
+	}
+	dep->de_wrm_left= 0;
+	dep->de_flags |= DEF_PACK_SEND;
+}
+
+
+/*===========================================================================*
+ *				dp_sendq_put				     *
+ *===========================================================================*/
+static void dp_sendq_put(dep, size)
+dpeth_t *dep;
+int size;
+{
+	/* Copy the frame described by de_write_iovec to the buffer at the
+	 * head of the send queue, and start the transmitter if it is idle.
+	 */
+	int sendq_head;
+
 	if (size < ETH_MIN_PACK_SIZE || size > ETH_MAX_PACK_SIZE)
 	{
 		panic("dp8390: invalid packet size", size);
 	}
+	sendq_head= dep->de_sendq_head;
+	assert(!dep->de_sendq[sendq_head].sq_filled);
+
 	(dep->de_user2nicf)(dep, &dep->de_write_iovec, 0,
 		dep->de_sendq[sendq_head].sq_sendpage * DP_PAGESIZE,
 		size);
@@ -380,18 +523,6 @@ int vectored;
 		sendq_head= 0;
 	assert(sendq_head < SENDQ_NR);
 	dep->de_sendq_head= sendq_head;
-
-	dep->de_flags |= DEF_PACK_SEND;
-
-	/* If the interrupt handler called, don't send a reply. The reply
-	 * will be sent after all interrupts are handled. 
-	 */
-	if (from_int)
-		return;
-	reply(dep, OK, FALSE);
-
-	assert(dep->de_mode == DEM_ENABLED);
-	assert(dep->de_flags & DEF_ENABLED);
 }
 
 
@@ -464,6 +595,86 @@ int vectored;
 }
 
 
+/*===========================================================================*
+ *				do_readmv				     *
+ *===========================================================================*/
+static void do_readmv(mp)
+message *mp;
+{
+	int port, count, stride;
+	dpeth_t *dep;
+
+	port = mp->DL_PORT;
+	count = mp->DL_COUNT;
+	stride = mp->DL_STRIDE;
+	if (port < 0 || port >= DE_PORT_NR)
+		panic("dp8390: illegal port", port);
+	dep= &de_table[port];
+	dep->de_client= mp->DL_PROC;
+	if (dep->de_mode == DEM_SINK)
+	{
+		reply(dep, OK, FALSE);
+		return;
+	}
+	assert(dep->de_mode == DEM_ENABLED);
+	assert(dep->de_flags & DEF_ENABLED);
+
+	if(dep->de_flags & DEF_READING)
+		panic("dp8390: read already in progress", NO_NUM);
+	if (stride < 1 || stride > IOVEC_NR || count < stride ||
+		count % stride != 0)
+	{
+		panic("dp8390: wrong DL_READMV stride", stride);
+	}
+
+	dep->de_read_iovec.iod_proc_nr = mp->DL_PROC;
+	dep->de_rdm_addr= (vir_bytes) mp->DL_ADDR;
+	dep->de_rdm_stride= stride;
+	dep->de_rdm_left= count / stride;
+	dp_read_slot(dep);
+	dep->de_flags |= DEF_READING | DEF_READ_MULTI;
+
+	dp_recv(dep);
+
+	if ((dep->de_flags & (DEF_READING|DEF_STOPPED)) ==
+		(DEF_READING|DEF_STOPPED))
+	{
+		/* The chip is stopped, and all arrived packets are 
+		 * delivered.
+		 */
+		dp_reset(dep);
+	}
+	reply(dep, OK, FALSE);
+}
+
+
+/*===========================================================================*
+ *				dp_read_slot				     *
+ *===========================================================================*/
+static void dp_read_slot(dep)
+dpeth_t *dep;
+{
+	/* Fetch the iovecs of the current DL_READMV slot. A slot never has
+	 * more than IOVEC_NR entries, so dp_next_iovec is not needed.
+	 */
+	iovec_dat_t *iovp;
+	int i;
+	vir_bytes size;
+
+	iovp= &dep->de_read_iovec;
+	get_userdata(iovp->iod_proc_nr, dep->de_rdm_addr,
+		dep->de_rdm_stride * sizeof(iovec_t), iovp->iod_iovec);
+	iovp->iod_iovec_s = dep->de_rdm_stride;
+	iovp->iod_iovec_addr = dep->de_rdm_addr;
+
+	size= 0;
+	for (i= 0; i<iovp->iod_iovec_s; i++)
+		size += iovp->iod_iovec[i].iov_size;
+	if (size < ETH_MAX_PACK_SIZE)
+		panic("dp8390: wrong packet size", size);
+}
+
+
 /*===========================================================================*
  *				do_init					     *
  *===========================================================================*/
@@ -1023,7 +1234,10 @@ dpeth_t *dep;
 
 		pageno = next;
 	}
-	while (!packet_processed);
+	while (!packet_processed || (dep->de_flags & DEF_READING));
+	/* A DL_READMV keeps DEF_READING until all its slots are filled, so
+	 * the loop only stops when the receive ring is empty.
+	 */
 }
 
 
@@ -1041,6 +1255,7 @@ dpeth_t *dep;
 	{
 	case DL_WRITE:	do_vwrite(&dep->de_sendmsg, TRUE, FALSE);	break;
 	case DL_WRITEV:	do_vwrite(&dep->de_sendmsg, TRUE, TRUE);	break;
+	case DL_WRITEMV: dp_write_slots(dep);			break;
 	default:
 		panic("dp8390: wrong type:", dep->de_sendmsg.m_type);
 		break;
@@ -1153,6 +1368,30 @@ int page, length;
 			sizeof(dp_rcvhdr_t), &dep->de_read_iovec, 0, length);
 	}
 
+	if (dep->de_flags & DEF_READ_MULTI)
+	{
+		/* Report the length in the slot and move on to the next
+		 * slot, if any.
+		 */
+		vir_bytes size;
+
+		size= length;
+		put_userdata(dep->de_read_iovec.iod_proc_nr, (vir_bytes)
+			&((iovec_t *) dep->de_rdm_addr)->iov_size,
+			(vir_bytes) sizeof(size), &size);
+		dep->de_read_s++;
+		dep->de_flags |= DEF_PACK_RECV;
+		if (--dep->de_rdm_left > 0)
+		{
+			dep->de_rdm_addr += dep->de_rdm_stride *
+				sizeof(iovec_t);
+			dp_read_slot(dep);
+		}
+		else
+			dep->de_flags &= ~(DEF_READING | DEF_READ_MULTI);
+		return OK;
+	}
+
 	dep->de_read_s = length;
 	dep->de_flags |= DEF_PACK_RECV;
 	dep->de_flags &= ~DEF_READING;
@@ -1758,6 +1997,12 @@ int may_block;
 	
 	dep->de_read_s = 0;
 	dep->de_flags &= ~(DEF_PACK_SEND | DEF_PACK_RECV);
+
+	/* A DL_READMV that delivered frames is finished by this reply, even
+	 * if not all slots are used.
+	 */
+	if (status & DL_PACK_RECV)
+		dep->de_flags &= ~(DEF_READING | DEF_READ_MULTI);
 }
 
 
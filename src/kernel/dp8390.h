@@ -196,7 +196,13 @@ typedef struct iovec_dat
   vir_bytes iod_iovec_addr;
 } iovec_dat_t;
 
-#define SENDQ_NR	2	/* Maximum size of the send queue */
+/* The send queue gets one buffer per SENDQ_RAM bytes of on board memory,
+ * but never more than SENDQ_NR buffers. SENDQ_NR may be set at compile time.
+ */
+#ifndef SENDQ_NR
+#define SENDQ_NR	4	/* Maximum size of the send queue */
+#endif
+#define SENDQ_RAM	0x1000	/* One send buffer per 4KB of memory */
 #define SENDQ_PAGES	6	/* 6 * DP_PAGESIZE >= 1514 bytes */
 
 typedef struct dpeth
@@ -253,6 +259,12 @@ typedef struct dpeth
 	iovec_dat_t de_write_iovec;
 	iovec_dat_t de_tmp_iovec;
 	vir_bytes de_read_s;
+	vir_bytes de_rdm_addr;		/* DL_READMV: next frame slot */
+	int de_rdm_stride;		/* iovec entries per slot */
+	int de_rdm_left;		/* slots left */
+	vir_bytes de_wrm_addr;		/* DL_WRITEMV: next frame slot */
+	int de_wrm_stride;		/* iovec entries per slot */
+	int de_wrm_left;		/* slots left */
 	int de_client;
 	message de_sendmsg;
 	dp_user2nicf_t de_user2nicf; 
@@ -267,6 +279,7 @@ typedef struct dpeth
 #define DEF_PACK_RECV	0x002
 #define DEF_SEND_AVAIL	0x004
 #define DEF_READING	0x010
+#define DEF_READ_MULTI	0x020
 #define DEF_PROMISC	0x040
 #define DEF_MULTI	0x080
 #define DEF_BROAD	0x100
@@ -51,6 +51,13 @@ phys_bytes tmp_phys;		/* phys address of DMA buffer */
 
 #endif /* CHIP != INTEL */
 
+#if TRACK_SECTORS > 0
+/* The track cache, one sector extra to align it on a sector boundary. */
+PRIVATE u8_t track_space[TRACK_BUF_SIZE + SECTOR_SIZE];
+u8_t *track_buf;		/* sector aligned track cache */
+phys_bytes track_phys;		/* phys address of track_buf */
+#endif
+
 FORWARD _PROTOTYPE( void init_buffer, (void) );
 
 
@@ -96,7 +103,8 @@ struct driver *dp;	/* Device dependent entry points. */
 
 	    case SCATTERED_IO:	r = do_vrdwt(dp, &mess);	break;
 
-	    case HARD_INT:	/* Leftover interrupt. */	continue;
+	    case HARD_INT:	/* Alarm or leftover interrupt. */
+				(*dp->dr_alarm)(dp);		continue;
 
 	    default:		r = EINVAL;			break;
 	}
@@ -123,6 +131,9 @@ PRIVATE void init_buffer()
  * be used to read partition tables and such.  Its absolute address is
  * 'tmp_phys', the normal address is 'tmp_buf'.
  */
+#if TRACK_SECTORS > 0
+  unsigned skip;
+#endif
 
 #if (CHIP == INTEL)
   tmp_buf = buffer;
@@ -138,6 +149,14 @@ PRIVATE void init_buffer()
 #else /* CHIP != INTEL */
   tmp_phys = vir2phys(tmp_buf);
 #endif /* CHIP != INTEL */
+
+#if TRACK_SECTORS > 0
+  /* No sector of the track cache may cross a 64K boundary. */
+  track_phys = vir2phys(track_space);
+  skip = (SECTOR_SIZE - (unsigned) (track_phys & SECTOR_MASK)) & SECTOR_MASK;
+  track_buf = track_space + skip;
+  track_phys += skip;
+#endif
 }
 
 
@@ -271,6 +290,16 @@ PUBLIC void nop_cleanup()
 }
 
 
+/*===========================================================================*
+ *				nop_alarm				     *
+ *===========================================================================*/
+PUBLIC void nop_alarm(dp)
+struct driver *dp;
+{
+/* Ignore the leftover interrupt. */
+}
+
+
 /*===========================================================================*
  *				clock_mess				     *
  *===========================================================================*/
@@ -18,6 +18,7 @@ struct driver {
   _PROTOTYPE( int (*dr_finish), (void) );
   _PROTOTYPE( void (*dr_cleanup), (void) );
   _PROTOTYPE( void (*dr_geometry), (struct partition *entry) );
+  _PROTOTYPE( void (*dr_alarm), (struct driver *dp) );
 };
 
 #if (CHIP == INTEL)
@@ -44,6 +45,7 @@ _PROTOTYPE( char *no_name, (void) );
 _PROTOTYPE( int do_nop, (struct driver *dp, message *m_ptr) );
 _PROTOTYPE( int nop_finish, (void) );
 _PROTOTYPE( void nop_cleanup, (void) );
+_PROTOTYPE( void nop_alarm, (struct driver *dp) );
 _PROTOTYPE( void clock_mess, (int ticks, watchdog_t func) );
 _PROTOTYPE( int do_diocntl, (struct driver *dr, message *m_ptr) );
 
@@ -61,3 +63,11 @@ extern u8_t *tmp_buf;			/* the DMA buffer */
 extern u8_t tmp_buf[];			/* the DMA buffer */
 #endif
 extern phys_bytes tmp_phys;		/* phys address of DMA buffer */
+
+#if TRACK_SECTORS > 0
+/* Size of the track cache buffer in bytes. */
+#define TRACK_BUF_SIZE	(TRACK_SECTORS * SECTOR_SIZE)
+
+extern u8_t *track_buf;			/* the track cache buffer */
+extern phys_bytes track_phys;		/* phys address of track_buf */
+#endif
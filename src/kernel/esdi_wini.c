@@ -143,7 +143,8 @@ PRIVATE struct driver w_dtab = {
   w_schedule,	/* precompute cylinder, head, sector, etc. */
   w_finish,	/* do the I/O */
   nop_cleanup,	/* no cleanup needed */
-  w_geometry	/* tell the geometry of the disk */
+  w_geometry,	/* tell the geometry of the disk */
+  nop_alarm	/* ignore leftover interrupts */
 };
 
 
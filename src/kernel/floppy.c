@@ -16,9 +16,15 @@
  *	14 Feb  1992 by Andy Tanenbaum: check drive density on opens only
  *	27 Mar  1992 by Kees J. Bot: last details on density checking
  *	04 Apr  1992 by Kees J. Bot: device dependent/independent split
+ *
+ * With TRACK_SECTORS > 0 reads and writes go through a track cache: a
+ * sequential read miss fetches the whole track, writes are kept in the cache
+ * and written back just before the motor is turned off, on a close, or on a
+ * sync.
  */
 
 #include "kernel.h"
+#include <sys/ioctl.h>
 #include "driver.h"
 #include "drvlib.h"
 #include <ibm/diskparm.h>
@@ -68,7 +74,7 @@
 /* ST2. */
 #define BAD_CYL         0x1F	/* if any of these bits are set, recalibrate */
 
-/* ST3 (not used). */
+/* ST3. */
 #define ST3_FAULT       0x80	/* if this bit is set, drive is sick */
 #define ST3_WR_PROTECT  0x40	/* set when diskette is write protected */
 #define ST3_READY       0x20	/* set when drive is ready */
@@ -82,6 +88,7 @@
 #define FDC_SPECIFY     0x03	/* command the drive to accept params */
 #define FDC_READ_ID     0x4A	/* command the drive to read sector identity */
 #define FDC_FORMAT      0x4D	/* command the drive to format a track */
+#define FDC_SENSE_DRIVE 0x04	/* command the drive to tell its status */
 
 /* DMA channel commands. */
 #define DMA_READ        0x46	/* DMA read opcode */
@@ -171,6 +178,35 @@ PRIVATE struct device *f_dv;	/* device's base and size */
 PRIVATE struct disk_parameter_s fmt_param; /* parameters for format */
 PRIVATE char f_results[MAX_RESULTS];/* the controller can give lots of output */
 
+#if TRACK_SECTORS > 0
+/* The track cache.  Track_buf[] is cut into slots of a track each for the
+ * diskette in use.  A slot only holds data while the motor of its drive
+ * runs, because the diskette may be exchanged once the motor is off.
+ */
+#define NR_TRACKS	(TRACK_SECTORS / 9)	/* most tracks that fit */
+#define NO_DRIVE	(-1)			/* slot not in use */
+#define NIL_TRACK	((struct track *) 0)
+#define tc_bit(s)	(1L << (s))		/* bit for sector s */
+
+PRIVATE struct track {
+  int tc_drive;			/* drive of the track, or NO_DRIVE */
+  int tc_density;		/* density it was read or written with */
+  unsigned tc_track;		/* cylinder * NR_HEADS + head */
+  unsigned long tc_valid;	/* bitmap of sectors present */
+  unsigned long tc_dirty;	/* bitmap of sectors to write back */
+  unsigned long tc_used;	/* time of last use, for LRU replacement */
+  phys_bytes tc_phys;		/* address of the slot in track_buf[] */
+} track[NR_TRACKS];
+
+PRIVATE int tc_nr;		/* number of slots for the current geometry */
+PRIVATE int tc_sectors;		/* sectors per track of the slots */
+PRIVATE unsigned long tc_clock;	/* LRU clock */
+PRIVATE int tc_flush;		/* motor timer waits for a write back */
+PRIVATE unsigned tc_next[NR_DRIVES];	/* sector after the last one read */
+PRIVATE int tc_wrcheck;		/* drives checked for write protect */
+PRIVATE int tc_bypass;		/* set while probing the diskette type */
+#endif /* TRACK_SECTORS > 0 */
+
 
 /* Seven combinations of diskette/drive are supported.
  *
@@ -251,19 +287,35 @@ FORWARD _PROTOTYPE( int read_id, (struct floppy *fp) );
 FORWARD _PROTOTYPE( int f_do_open, (struct driver *dp, message *m_ptr) );
 FORWARD _PROTOTYPE( int test_read, (int density) );
 FORWARD _PROTOTYPE( void f_geometry, (struct partition *entry));
+FORWARD _PROTOTYPE( int f_do_close, (struct driver *dp, message *m_ptr) );
+FORWARD _PROTOTYPE( int f_ioctl, (struct driver *dp, message *m_ptr) );
+FORWARD _PROTOTYPE( void f_alarm, (struct driver *dp) );
+#if TRACK_SECTORS > 0
+FORWARD _PROTOTYPE( int tc_schedule, (struct iorequest_s *iop, int opcode,
+		phys_bytes user_phys, unsigned block, unsigned nbytes) );
+FORWARD _PROTOTYPE( void tc_layout, (void) );
+FORWARD _PROTOTYPE( struct track *tc_find, (unsigned trk) );
+FORWARD _PROTOTYPE( struct track *tc_alloc, (unsigned trk) );
+FORWARD _PROTOTYPE( int tc_writeback, (struct track *tcp) );
+FORWARD _PROTOTYPE( int tc_sync, (int drives, int forget) );
+FORWARD _PROTOTYPE( int tc_io, (struct track *tcp, int opcode,
+						unsigned long map) );
+FORWARD _PROTOTYPE( int tc_wrprot, (void) );
+#endif
 
 
 /* Entry points to this driver. */
 PRIVATE struct driver f_dtab = {
   f_name,	/* current device's name */
   f_do_open,	/* open or mount request, sense type of diskette */
-  do_nop,	/* nothing on a close */
-  do_diocntl,	/* get or set a partitions geometry */
+  f_do_close,	/* write back cached tracks on a close */
+  f_ioctl,	/* get or set a partitions geometry, flush the cache */
   f_prepare,	/* prepare for I/O on a given minor device */
   f_schedule,	/* precompute cylinder, head, sector, etc. */
   f_finish,	/* do the I/O */
   f_cleanup,	/* cleanup before sending reply to user process */
-  f_geometry	/* tell the geometry of the diskette */
+  f_geometry,	/* tell the geometry of the diskette */
+  f_alarm	/* write back cached tracks before the motor stops */
 };
 
 
@@ -275,12 +327,19 @@ PUBLIC void floppy_task()
 /* Initialize the floppy structure. */
 
   struct floppy *fp;
+#if TRACK_SECTORS > 0
+  struct track *tcp;
+#endif
 
   for (fp = &floppy[0]; fp < &floppy[NR_DRIVES]; fp++) {
 	fp->fl_curcyl = NO_CYL;
 	fp->fl_density = NO_DENS;
 	fp->fl_class = ~0;
   }
+#if TRACK_SECTORS > 0
+  for (tcp = &track[0]; tcp < &track[NR_TRACKS]; tcp++)
+	tcp->tc_drive = NO_DRIVE;
+#endif
 
   put_irq_handler(FLOPPY_IRQ, f_handler);
   enable_irq(FLOPPY_IRQ);		/* ready for floppy interrupts */
@@ -406,6 +465,11 @@ struct iorequest_s *iop;	/* pointer to read or write request */
 	if (fmt_param.sectors_per_cylinder == 0)
 		return(iop->io_nbytes = EIO);
 
+#if TRACK_SECTORS > 0
+	/* Forget what is cached of the old format. */
+	if (tc_sync(1 << f_drive, TRUE) != OK) return(iop->io_nbytes = EIO);
+#endif
+
 	/* Only the first sector of the parameters now needed. */
 	iop->io_nbytes = nbytes = SECTOR_SIZE;
   }
@@ -415,6 +479,12 @@ struct iorequest_s *iop;	/* pointer to read or write request */
   if (pos + nbytes > f_dv->dv_size) nbytes = f_dv->dv_size - pos;
   block = (f_dv->dv_base + pos) >> SECTOR_SHIFT;
 
+#if TRACK_SECTORS > 0
+  /* Read or write through the track cache if a track fits in. */
+  if (!(f_device & FORMAT_DEV_BIT) && !tc_bypass && f_sectors <= TRACK_SECTORS)
+	return(tc_schedule(iop, opcode, user_phys, block, nbytes));
+#endif
+
   spanning = FALSE;	/* set if the block spans a track */
 
   /* While there are "unscheduled" bytes in the request: */
@@ -630,6 +700,347 @@ PRIVATE void defuse()
 }
 
 
+#if TRACK_SECTORS > 0
+/*===========================================================================*
+ *				tc_schedule				     *
+ *===========================================================================*/
+PRIVATE int tc_schedule(iop, opcode, user_phys, block, nbytes)
+struct iorequest_s *iop;	/* pointer to read or write request */
+int opcode;			/* DEV_READ or DEV_WRITE */
+phys_bytes user_phys;		/* user buffer */
+unsigned block;			/* first sector on the diskette */
+unsigned nbytes;		/* bytes to transfer */
+{
+/* Carry out a request through the track cache.  A read that misses fetches
+ * the whole track if it follows the last read or is read ahead, so that the
+ * next requests for the track are for free.  A random read only fetches what
+ * it asks for, a whole track would cost it an extra revolution and push out
+ * tracks that may be used again.  A write only changes the cached track, the
+ * write back is done by f_alarm().
+ */
+
+  struct track *tcp;
+  unsigned trk, sector, count;
+  unsigned long map;
+  int r, spanning;
+
+  tc_layout();
+
+  /* A write error is not noticed until the track is written back, that is
+   * too late to tell the user about a write protected diskette.
+   */
+  if (opcode == DEV_WRITE && !(tc_wrcheck & (1 << f_drive))) {
+	if ((r = tc_wrprot()) != OK) return(iop->io_nbytes = r);
+  }
+
+  spanning = FALSE;	/* set if the block spans a track */
+
+  do {
+	trk = block / f_sectors;
+	sector = block % f_sectors;
+	count = nbytes;
+	if (sector + (count >> SECTOR_SHIFT) > f_sectors)
+		count = (f_sectors - sector) << SECTOR_SHIFT;
+	map = (tc_bit(count >> SECTOR_SHIFT) - 1) << sector;
+
+	tcp = tc_find(trk);
+	if (opcode == DEV_READ
+		&& (tcp == NIL_TRACK || (tcp->tc_valid & map) != map)) {
+		/* Only read a new track for optional requests if it is the
+		 * first one (see f_finish).
+		 */
+		if ((iop->io_request & OPTIONAL_IO) && !f_must && !spanning)
+			return(EAGAIN);
+		if (tcp == NIL_TRACK) tcp = tc_alloc(trk);
+		if (block == tc_next[f_drive] || (iop->io_request & OPTIONAL_IO))
+			map = tc_bit(f_sectors) - 1;
+		r = tc_io(tcp, DEV_READ, map & ~tcp->tc_valid);
+		if (r != OK) return(iop->io_nbytes = EIO);
+		tcp->tc_valid |= map;
+		f_must = FALSE;
+	}
+
+	if (opcode == DEV_READ) {
+		phys_copy(tcp->tc_phys + ((phys_bytes) sector << SECTOR_SHIFT),
+					user_phys, (phys_bytes) count);
+		tc_next[f_drive] = block + (count >> SECTOR_SHIFT);
+	} else {
+		if (tcp == NIL_TRACK) tcp = tc_alloc(trk);
+		phys_copy(user_phys, tcp->tc_phys +
+			((phys_bytes) sector << SECTOR_SHIFT),
+			(phys_bytes) count);
+		tcp->tc_valid |= map;
+		tcp->tc_dirty |= map;
+	}
+	tcp->tc_used = ++tc_clock;
+
+	iop->io_nbytes -= count;
+	user_phys += count;
+	block += count >> SECTOR_SHIFT;
+	nbytes -= count;
+	spanning = TRUE;	/* the rest of the block may span a track */
+  } while (nbytes > 0);
+
+  return(OK);
+}
+
+
+/*===========================================================================*
+ *				tc_layout				     *
+ *===========================================================================*/
+PRIVATE void tc_layout()
+{
+/* Cut the track cache into slots for the diskette about to be used.  Tracks
+ * cached for a different geometry have to go.
+ */
+
+  struct track *tcp;
+  int change;
+
+  change = (f_sectors != tc_sectors);
+
+  for (tcp = &track[0]; tcp < &track[NR_TRACKS]; tcp++) {
+	if (tcp->tc_drive == NO_DRIVE) continue;
+	if (change || (tcp->tc_drive == f_drive && tcp->tc_density != d)) {
+		(void) tc_writeback(tcp);
+		tcp->tc_drive = NO_DRIVE;
+	}
+  }
+  if (!change) return;
+
+  tc_sectors = f_sectors;
+  tc_nr = TRACK_SECTORS / f_sectors;
+  for (tcp = &track[0]; tcp < &track[tc_nr]; tcp++) {
+	tcp->tc_phys = track_phys +
+		((phys_bytes) (tcp - track) * f_sectors << SECTOR_SHIFT);
+  }
+}
+
+
+/*===========================================================================*
+ *				tc_find					     *
+ *===========================================================================*/
+PRIVATE struct track *tc_find(trk)
+unsigned trk;			/* track of the current drive */
+{
+/* Return the cache slot holding a track, or NIL_TRACK. */
+
+  struct track *tcp;
+
+  for (tcp = &track[0]; tcp < &track[tc_nr]; tcp++) {
+	if (tcp->tc_drive == f_drive && tcp->tc_track == trk) return(tcp);
+  }
+  return(NIL_TRACK);
+}
+
+
+/*===========================================================================*
+ *				tc_alloc				     *
+ *===========================================================================*/
+PRIVATE struct track *tc_alloc(trk)
+unsigned trk;			/* track of the current drive */
+{
+/* Find a free slot for a track, or reuse the least recently used one.  A
+ * clean slot goes first, a dirty one costs a write back, often with a seek
+ * away from the track wanted and back.
+ */
+
+  struct track *tcp, *victim;
+
+  victim = NIL_TRACK;
+  for (tcp = &track[0]; tcp < &track[tc_nr]; tcp++) {
+	if (tcp->tc_drive == NO_DRIVE) {
+		victim = tcp;
+		break;
+	}
+	if (victim == NIL_TRACK) {
+		victim = tcp;
+	} else
+	if ((tcp->tc_dirty == 0) != (victim->tc_dirty == 0)) {
+		if (tcp->tc_dirty == 0) victim = tcp;
+	} else
+	if (tcp->tc_used < victim->tc_used) {
+		victim = tcp;
+	}
+  }
+  if (victim->tc_drive != NO_DRIVE) (void) tc_writeback(victim);
+
+  victim->tc_drive = f_drive;
+  victim->tc_density = d;
+  victim->tc_track = trk;
+  victim->tc_valid = 0;
+  victim->tc_dirty = 0;
+  return(victim);
+}
+
+
+/*===========================================================================*
+ *				tc_writeback				     *
+ *===========================================================================*/
+PRIVATE int tc_writeback(tcp)
+struct track *tcp;		/* slot to write back */
+{
+/* Write the dirty sectors of a track back to the diskette.  The writes that
+ * put them there have long been reported done, so if this fails the data is
+ * lost.  Complain and forget about it, the diskette is likely gone anyway.
+ */
+
+  int r;
+
+  if (tcp->tc_dirty == 0) return(OK);
+
+  r = tc_io(tcp, DEV_WRITE, tcp->tc_dirty);
+  if (r != OK) {
+	printf("fd%d: write back of cylinder %u head %u failed\n",
+		tcp->tc_drive, tcp->tc_track / NR_HEADS,
+		tcp->tc_track % NR_HEADS);
+  }
+  tcp->tc_dirty = 0;
+  return(r);
+}
+
+
+/*===========================================================================*
+ *				tc_sync					     *
+ *===========================================================================*/
+PRIVATE int tc_sync(drives, forget)
+int drives;			/* bitmap of drives */
+int forget;			/* drop the tracks after writing them back? */
+{
+/* Write back the cached tracks of some drives. */
+
+  struct track *tcp;
+  int r;
+
+  r = OK;
+  for (tcp = &track[0]; tcp < &track[NR_TRACKS]; tcp++) {
+	if (tcp->tc_drive == NO_DRIVE) continue;
+	if (!(drives & (1 << tcp->tc_drive))) continue;
+
+	if (tc_writeback(tcp) != OK) r = EIO;
+	if (forget) tcp->tc_drive = NO_DRIVE;
+  }
+  return(r);
+}
+
+
+/*===========================================================================*
+ *				tc_io					     *
+ *===========================================================================*/
+PRIVATE int tc_io(tcp, opcode, map)
+struct track *tcp;		/* slot to transfer to or from */
+int opcode;			/* DEV_READ or DEV_WRITE */
+unsigned long map;		/* bitmap of sectors to transfer */
+{
+/* Transfer sectors between a cache slot and the diskette.  The runs of
+ * sectors in the map are put in ftrans[] and handed to f_finish(), that
+ * does them in the order they pass under the head, so a whole track is read
+ * or written in about one revolution.  The slot may belong to another drive
+ * than the current request, so the current state is saved and restored.
+ */
+
+  struct floppy *fp, *s_fp;
+  struct trans *tp;
+  struct iorequest_s ioreq;
+  phys_bytes dma_phys;
+  unsigned s, e, count, dma_count;
+  int r, s_device, s_drive, s_d, s_sectors, s_opcode, s_must;
+
+  if (map == 0) return(OK);
+
+  s_device = f_device;
+  s_drive = f_drive;
+  s_fp = f_fp;
+  s_d = d;
+  s_sectors = f_sectors;
+  s_opcode = f_opcode;
+  s_must = f_must;
+
+  f_device = f_drive = tcp->tc_drive;
+  f_fp = fp = &floppy[f_drive];
+  d = tcp->tc_density;
+  f_sectors = nr_sectors[d];
+  f_opcode = opcode;
+  fp->fl_cylinder = tcp->tc_track / NR_HEADS;
+  fp->fl_hardcyl = fp->fl_cylinder * steps_per_cyl[d];
+  fp->fl_head = tcp->tc_track % NR_HEADS;
+
+  ioreq.io_request = opcode;
+  ioreq.io_nbytes = 0;
+
+  for (s = 0; s < f_sectors; s = e) {
+	if (!(map & tc_bit(s))) {
+		e = s + 1;
+		continue;
+	}
+	for (e = s + 1; e < f_sectors && (map & tc_bit(e)); e++) {}
+
+	/* The slot is sector aligned, but may cross a 64K boundary. */
+	dma_phys = tcp->tc_phys + ((phys_bytes) s << SECTOR_SHIFT);
+	count = (e - s) << SECTOR_SHIFT;
+	dma_count = dma_bytes_left(dma_phys);
+	if (dma_count != 0 && dma_count < count) {
+		count = dma_count;
+		e = s + (count >> SECTOR_SHIFT);
+	}
+	ioreq.io_nbytes += count;
+	f_count += count;
+
+	tp = &ftrans[s];
+	do {
+		tp->tr_count = count;
+		tp->tr_iop = &ioreq;
+		tp->tr_phys = dma_phys;
+		tp->tr_dma = dma_phys;
+		tp++;
+
+		dma_phys += SECTOR_SIZE;
+		count -= SECTOR_SIZE;
+	} while (count > 0);
+  }
+
+  f_must = TRUE;
+  r = f_finish();
+  if (r != OK) defuse();
+  if (r == OK && ioreq.io_nbytes != 0) r = EIO;
+
+  f_device = s_device;
+  f_drive = s_drive;
+  f_fp = s_fp;
+  d = s_d;
+  f_sectors = s_sectors;
+  f_opcode = s_opcode;
+  f_must = s_must;
+  return(r);
+}
+
+
+/*===========================================================================*
+ *				tc_wrprot				     *
+ *===========================================================================*/
+PRIVATE int tc_wrprot()
+{
+/* Ask the drive if the diskette is write protected.  This is done once for
+ * each time the motor is started, the diskette can't change while it runs.
+ */
+
+  if (need_reset) f_reset();
+  start_motor();
+
+  fdc_out(FDC_SENSE_DRIVE);
+  fdc_out(f_drive);
+  if (fdc_results() != OK) return(EIO);
+
+  if (f_results[ST3] & ST3_WR_PROTECT) {
+	printf("%s: diskette is write protected.\n", f_name());
+	return(EIO);
+  }
+  tc_wrcheck |= 1 << f_drive;
+  return(OK);
+}
+#endif /* TRACK_SECTORS > 0 */
+
+
 /*===========================================================================*
  *				dma_setup				     *
  *===========================================================================*/
@@ -704,7 +1115,32 @@ PRIVATE void stop_motor()
  * supposed to be turned off, and if so, turns them off.
  */
 
+#if TRACK_SECTORS > 0
+  struct track *tcp;
+  struct proc *rp;
+#endif
+
   if (motor_goal != motor_status) {
+#if TRACK_SECTORS > 0
+	/* The floppy task must first write back and forget the tracks
+	 * cached for the drives that are to stop, see f_alarm().  It is
+	 * only told so while it waits for a request.  An interrupt sent to
+	 * a busy task is kept until it waits for the FDC, and taken for the
+	 * real one.  A busy task restarts the timer when it is done.
+	 */
+	for (tcp = &track[0]; tcp < &track[NR_TRACKS]; tcp++) {
+		if (tcp->tc_drive != NO_DRIVE && (motor_status & ~motor_goal
+					& (1 << tcp->tc_drive)) != 0) {
+			rp = proc_addr(FLOPPY);
+			if ((rp->p_flags & (RECEIVING | SENDING)) != RECEIVING
+						|| rp->p_getfrom != ANY) return;
+			tc_flush = TRUE;
+			interrupt(FLOPPY);
+			return;
+		}
+	}
+	tc_wrcheck &= motor_goal;
+#endif
 	outb(DOR, (motor_goal << MOTOR_SHIFT) | ENABLE_INT);
 	motor_status = motor_goal;
   }
@@ -716,8 +1152,14 @@ PRIVATE void stop_motor()
  *===========================================================================*/
 PUBLIC void floppy_stop()
 {
-/* Stop all activity. */
+/* Stop all activity.  It is too late to write back cached tracks. */
+
+#if TRACK_SECTORS > 0
+  struct track *tcp;
 
+  for (tcp = &track[0]; tcp < &track[NR_TRACKS]; tcp++)
+	tcp->tc_drive = NO_DRIVE;
+#endif
   motor_goal = 0;
   stop_motor();
 }
@@ -1003,6 +1445,9 @@ PRIVATE void f_reset()
   }
   for (i = 0; i < NR_DRIVES; i++)	/* clear each drive */
 	floppy[i].fl_calibration = UNCALIBRATED;
+#if TRACK_SECTORS > 0
+  tc_wrcheck = 0;		/* motors were stopped */
+#endif
 
   /* The current timing parameters must be specified again. */
   current_spec1 = 0;
@@ -1185,7 +1630,13 @@ int density;
   m.COUNT = SECTOR_SIZE;
   m.POSITION = (long) test_sector[density] * SECTOR_SIZE;
   m.ADDRESS = (char *) tmp_buf;
+#if TRACK_SECTORS > 0
+  tc_bypass = TRUE;		/* don't cache a probe of the wrong type */
   r = do_rdwt(&f_dtab, &m);
+  tc_bypass = FALSE;
+#else
+  r = do_rdwt(&f_dtab, &m);
+#endif
   if (r != SECTOR_SIZE) return(EIO);
 
   partition(&f_dtab, f_drive, P_FLOPPY);
@@ -1203,3 +1654,86 @@ struct partition *entry;
   entry->heads = NR_HEADS;
   entry->sectors = f_sectors;
 }
+
+
+/*============================================================================*
+ *				f_do_close				      *
+ *============================================================================*/
+PRIVATE int f_do_close(dp, m_ptr)
+struct driver *dp;
+message *m_ptr;
+{
+/* Write back what is cached for the drive, the diskette may be taken out
+ * soon after a close.
+ */
+
+  if (f_prepare(m_ptr->DEVICE) == NIL_DEV) return(ENXIO);
+#if TRACK_SECTORS > 0
+  return(tc_sync(1 << f_drive, FALSE));
+#else
+  return(OK);
+#endif
+}
+
+
+/*============================================================================*
+ *				f_ioctl					      *
+ *============================================================================*/
+PRIVATE int f_ioctl(dp, m_ptr)
+struct driver *dp;
+message *m_ptr;
+{
+/* DIOCFLUSH writes back the cached tracks (FS does this on a sync), other
+ * requests are the usual partition ioctls.
+ */
+
+  if (m_ptr->REQUEST != DIOCFLUSH) return(do_diocntl(dp, m_ptr));
+
+  if (f_prepare(m_ptr->DEVICE) == NIL_DEV) return(ENXIO);
+#if TRACK_SECTORS > 0
+  return(tc_sync(1 << f_drive, FALSE));
+#else
+  return(OK);
+#endif
+}
+
+
+/*============================================================================*
+ *				f_alarm					      *
+ *============================================================================*/
+PRIVATE void f_alarm(dp)
+struct driver *dp;
+{
+/* Stop_motor() found cached tracks for the drives it was about to turn off,
+ * and sent an interrupt to let us write them back first.  It only does so
+ * while we wait in driver_task(), so it is never mistaken for the FDC.  The
+ * tracks are forgotten, because the diskette may be exchanged once the
+ * motor is off.
+ */
+
+#if TRACK_SECTORS > 0
+  int stop;
+
+  if (!tc_flush) {
+	/* A leftover interrupt.  Stop_motor() may have gone off meanwhile,
+	 * and found us too busy to be told.
+	 */
+	if (motor_goal != motor_status) clock_mess(MOTOR_OFF, stop_motor);
+	return;
+  }
+  tc_flush = FALSE;
+
+  /* Leftover jobs after an I/O error must be removed */
+  if (f_count > 0) defuse();
+
+  /* Any new request since then has restarted the timer. */
+  stop = motor_status & ~motor_goal;
+  if (stop != 0) {
+	(void) tc_sync(stop, TRUE);
+
+	/* The write back may have turned motors on again. */
+	motor_goal = motor_status & ~stop;
+  }
+  stop_motor();
+#endif
+}
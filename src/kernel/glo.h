@@ -57,6 +57,12 @@ EXTERN int mon_return;		/* true if return to the monitor possible */
 EXTERN phys_bytes reboot_code;	/* program for the boot monitor */
 EXTERN union reg86 reg86;	/* registers used in an 8086 interrupt */
 
+#if ENABLE_KTRACE
+/* Kernel trace ring. */
+EXTERN int kt_on;		/* nonzero while events are recorded */
+EXTERN irq_handler_t kt_handler[NR_IRQ_VECTORS];  /* handlers being traced */
+#endif
+
 /* Variables that are initialized elsewhere are just extern here. */
 extern struct segdesc_s gdt[];	/* global descriptor table for protected mode*/
 
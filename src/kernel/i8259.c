@@ -117,6 +117,10 @@ irq_handler_t handler;
 
   if (irq_table[irq] == handler)
 	return;		/* extra initialization */
+#if ENABLE_KTRACE
+  if (kt_handler[irq] == handler)
+	return;		/* extra initialization while being traced */
+#endif
 
   if (irq_table[irq] != spurious_irq)
 	panic("attempt to register second irq handler for irq", irq);
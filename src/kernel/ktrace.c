@@ -0,0 +1,173 @@
+/* This file contains the kernel trace ring.  While tracing is on, interrupt
+ * handler calls, messages, process switches and held up interrupts are
+ * recorded in a ring of KTRACE_SIZE events, each stamped with the time from
+ * the clock.  The ktrace(8) command turns tracing on and reads the events out
+ * through MM, which uses the SYS_KTRACE call of the system task.
+ *
+ * The entry points into this file are:
+ *   ktrace:		record an event (use the KTRACE macro)
+ *   ktrace_type:	get the type of a message in a process
+ *   do_ktrace:		start, stop or read out the trace for SYS_KTRACE
+ *
+ * Interrupt handlers are traced by putting ktrace_irq() in front of them in
+ * irq_table while tracing is on, so they cost nothing extra otherwise.  An
+ * event is stored without locking, so an interrupt that is recorded while
+ * another event is being stored may garble one of the two.
+ */
+
+#include "kernel.h"
+#include <minix/com.h>
+#include "proc.h"
+
+#if ENABLE_KTRACE
+
+PRIVATE struct ktrace kt_ring[KTRACE_SIZE];	/* the last events */
+PRIVATE unsigned long kt_next;	/* number of events since tracing began */
+
+FORWARD _PROTOTYPE( int ktrace_irq, (int irq) );
+FORWARD _PROTOTYPE( void kt_switch, (int on) );
+
+
+/*===========================================================================*
+ *				ktrace					     *
+ *===========================================================================*/
+PUBLIC void ktrace(event, proc, peer, type)
+int event;			/* KT_IRQ, KT_SEND, ... */
+int proc;			/* process or irq the event is about */
+int peer;			/* other side of a message */
+int type;			/* message type */
+{
+/* Store an event in the ring, overwriting the oldest. */
+
+  register struct ktrace *ktp;
+  unsigned count;
+
+  ktp = &kt_ring[(unsigned) kt_next++ & (KTRACE_SIZE - 1)];
+  ktp->kt_ticks = read_clock(&count);
+  ktp->kt_count = count;
+  ktp->kt_event = event;
+  ktp->kt_proc = proc;
+  ktp->kt_peer = peer;
+  ktp->kt_type = type;
+}
+
+
+/*===========================================================================*
+ *				ktrace_type				     *
+ *===========================================================================*/
+PUBLIC int ktrace_type(rp, m_ptr)
+struct proc *rp;		/* process the message is in */
+message *m_ptr;			/* virtual address of the message */
+{
+/* Return the type of a message.  The address is in the data segment of the
+ * process, the same way cp_mess() finds it.
+ */
+
+  int type;
+
+  phys_copy(((phys_bytes) rp->p_map[D].mem_phys << CLICK_SHIFT)
+					+ (vir_bytes) &m_ptr->m_type,
+	vir2phys(&type), (phys_bytes) sizeof(type));
+  return(type);
+}
+
+
+/*===========================================================================*
+ *				ktrace_irq				     *
+ *===========================================================================*/
+PRIVATE int ktrace_irq(irq)
+int irq;
+{
+/* Call the real interrupt handler, and record when it starts and ends. */
+
+  int r;
+
+  ktrace(KT_IRQ, irq, 0, 0);
+  r = (*kt_handler[irq])(irq);
+  ktrace(KT_IRQ_DONE, irq, 0, 0);
+  return(r);
+}
+
+
+/*===========================================================================*
+ *				kt_switch				     *
+ *===========================================================================*/
+PRIVATE void kt_switch(on)
+int on;				/* turn tracing on or off */
+{
+/* Turn tracing on or off, and put ktrace_irq() in front of the interrupt
+ * handlers in use, or take it away again.
+ */
+
+  int irq;
+
+  lock();
+  for (irq = 0; irq < NR_IRQ_VECTORS; irq++) {
+	if (!(irq_use & (1 << irq))) continue;
+	if (on && irq_table[irq] != ktrace_irq) {
+		kt_handler[irq] = irq_table[irq];
+		irq_table[irq] = ktrace_irq;
+	}
+	if (!on && irq_table[irq] == ktrace_irq) {
+		irq_table[irq] = kt_handler[irq];
+	}
+  }
+  kt_on = on;
+  unlock();
+}
+
+
+/*===========================================================================*
+ *				do_ktrace				     *
+ *===========================================================================*/
+PUBLIC int do_ktrace(m_ptr)
+register message *m_ptr;	/* pointer to request message */
+{
+/* Handle sys_ktrace().  Start or stop tracing, or stop and copy at most
+ * m2_l1 of the last events to the buffer of process m2_i1.  The number of
+ * events copied is returned, the number recorded since tracing was started
+ * is put in m2_l2.
+ */
+
+  unsigned n, first, part;
+  phys_bytes dst_phys;
+
+  switch (m_ptr->m2_i2) {
+  case KTRACE_START:
+	kt_switch(FALSE);
+	kt_next = 0;
+	kt_switch(TRUE);
+	return(OK);
+
+  case KTRACE_STOP:
+	kt_switch(FALSE);
+	return(OK);
+
+  case KTRACE_READ:
+	kt_switch(FALSE);
+	n = kt_next < KTRACE_SIZE ? (unsigned) kt_next : KTRACE_SIZE;
+	if (m_ptr->m2_l1 < n) n = m_ptr->m2_l1;
+	m_ptr->m2_l2 = kt_next;
+	if (n == 0) return(0);
+	dst_phys = numap(m_ptr->m2_i1, (vir_bytes) m_ptr->m2_p1,
+				(vir_bytes) (n * sizeof(kt_ring[0])));
+	if (dst_phys == 0) return(EFAULT);
+
+	/* Copy the oldest events, the part up to the end of the ring first. */
+	first = (unsigned) (kt_next - n) & (KTRACE_SIZE - 1);
+	part = KTRACE_SIZE - first;
+	if (part > n) part = n;
+	phys_copy(vir2phys(&kt_ring[first]), dst_phys,
+				(phys_bytes) (part * sizeof(kt_ring[0])));
+	if (n > part) {
+		phys_copy(vir2phys(&kt_ring[0]),
+				dst_phys + part * sizeof(kt_ring[0]),
+				(phys_bytes) ((n - part) * sizeof(kt_ring[0])));
+	}
+	return(n);
+
+  default:
+	return(EINVAL);
+  }
+}
+#endif /* ENABLE_KTRACE */
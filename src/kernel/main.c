@@ -67,6 +67,11 @@ PUBLIC void main()
    * is in low memory, the rest is loaded in extended memory.
    */
 
+  /* These have to point somewhere, the time until the first process runs
+   * is billed to the idle task.
+   */
+  proc_ptr = bill_ptr = proc_addr(IDLE);
+
   /* Task stacks. */
   ktsb = (reg_t) t_stack;
 
@@ -134,7 +139,6 @@ PUBLIC void main()
   }
 
   proc[NR_TASKS+INIT_PROC_NR].p_pid = 1;/* INIT of course has pid 1 */
-  bill_ptr = proc_addr(IDLE);		/* it has to point somewhere */
   lock_pick_proc();
 
   /* Now go to the assembly code to start running the current process. */
@@ -143,7 +143,8 @@ PRIVATE struct driver mcd_dtab =
   mcd_schedule,	/* Precompute blocks */
   mcd_finish,	/* Do the I/O */
   nop_cleanup,	/* No cleanup to do */
-  mcd_geometry	/* Tell geometry */
+  mcd_geometry,	/* Tell geometry */
+  nop_alarm	/* Ignore leftover interrupts */
 };
 
 
@@ -11,23 +11,50 @@
  *
  *  Changes:
  *	20 Apr  1992 by Kees J. Bot: device dependent/independent split
+ *
+ * The RAM disk normally occupies one chunk of memory as big as the disk.  If
+ * the boot variable 'rampool' is set to fewer kilobytes than that, the disk
+ * is sparse: blocks get memory from a pool of that size when they are first
+ * written, and blocks never written read as zeros.  The pool starts with a
+ * block of zeros and the map from disk blocks to pool blocks.  Only a RAM disk
+ * loaded with the root file system is made sparse, because FS then marks the
+ * zones that don't fit in the pool in use, so the pool never runs out.
  */
 
 #include "kernel.h"
 #include "driver.h"
 #include <sys/ioctl.h>
+#include <signal.h>
+#include <minix/boot.h>
+#include "../mm/mproc.h"	/* for the process table snapshot */
+#include "../fs/fproc.h"
 
 #define NR_RAMS            4	/* number of RAM-type devices */
 
 PRIVATE struct device m_geom[NR_RAMS];	/* Base and size of each RAM disk */
 PRIVATE int m_device;		/* current device */
 
+PRIVATE phys_bytes ram_pool;	/* base of the sparse RAM disk pool, or 0 */
+PRIVATE unsigned ram_next;	/* next free pool block */
+PRIVATE unsigned ram_limit;	/* number of blocks in the pool */
+
+/* Where the process tables are, for ps(1). */
+PRIVATE struct psinfo psinfo = { NR_TASKS, NR_PROCS, (vir_bytes) proc, 0, 0 };
+
+#define ram_map(b)	(ram_pool + BLOCK_SIZE + (phys_bytes) (b) * sizeof(u16_t))
+#define ram_block(n)	(ram_pool + (phys_bytes) (n) * BLOCK_SIZE)
+
 FORWARD _PROTOTYPE( struct device *m_prepare, (int device) );
 FORWARD _PROTOTYPE( int m_schedule, (int proc_nr, struct iorequest_s *iop) );
+FORWARD _PROTOTYPE( int m_sparse, (int opcode, off_t position,
+					phys_bytes user_phys, unsigned count) );
+FORWARD _PROTOTYPE( unsigned m_pool, (unsigned long blocks) );
+FORWARD _PROTOTYPE( void m_zero, (phys_bytes dst) );
 FORWARD _PROTOTYPE( int m_do_open, (struct driver *dp, message *m_ptr) );
 FORWARD _PROTOTYPE( void m_init, (void) );
 FORWARD _PROTOTYPE( int m_ioctl, (struct driver *dp, message *m_ptr) );
 FORWARD _PROTOTYPE( void m_geometry, (struct partition *entry) );
+FORWARD _PROTOTYPE( int m_pstab, (int proc_nr, vir_bytes addr) );
 
 
 /* Entry points to this driver. */
@@ -41,6 +68,7 @@ PRIVATE struct driver m_dtab = {
   nop_finish,	/* schedule does the work, no need to be smart */
   nop_cleanup,	/* nothing's dirty */
   m_geometry,	/* memory device "geometry" */
+  nop_alarm,	/* ignore leftover interrupts */
 };
 
 
@@ -78,7 +106,7 @@ struct iorequest_s *iop;	/* pointer to read or write request */
 {
 /* Read or write /dev/null, /dev/mem, /dev/kmem, or /dev/ram. */
 
-  int device, count, opcode;
+  int device, count, opcode, r;
   phys_bytes mem_phys, user_phys;
   struct device *dv;
 
@@ -115,6 +143,11 @@ struct iorequest_s *iop;	/* pointer to read or write request */
   if (count == 0) return(OK);
 
   /* Copy the data. */
+  if (device == RAM_DEV && ram_pool != 0) {
+	/* Sparse RAM disk, blocks are scattered over the pool. */
+	r = m_sparse(opcode, iop->io_position, user_phys, (unsigned) count);
+	if (r != OK) return(iop->io_nbytes = r);
+  } else
   if (opcode == DEV_READ)
 	phys_copy(mem_phys, user_phys, (phys_bytes) count);
   else
@@ -124,6 +157,52 @@ struct iorequest_s *iop;	/* pointer to read or write request */
 }
 
 
+/*===========================================================================*
+ *				m_sparse				     *
+ *===========================================================================*/
+PRIVATE int m_sparse(opcode, position, user_phys, count)
+int opcode;			/* DEV_READ or DEV_WRITE */
+off_t position;			/* offset on the RAM disk */
+phys_bytes user_phys;		/* user buffer */
+unsigned count;			/* number of bytes */
+{
+/* Read or write the sparse RAM disk one block at a time, looking up each
+ * block in the map.  Unmapped blocks read as the zero block, and are given a
+ * pool block when written.  Return OK, or ENOSPC if the pool is used up.
+ */
+  unsigned long block;
+  unsigned offset, chunk;
+  u16_t n;
+
+  while (count > 0) {
+	block = position / BLOCK_SIZE;
+	offset = position % BLOCK_SIZE;
+	chunk = BLOCK_SIZE - offset;
+	if (chunk > count) chunk = count;
+
+	phys_copy(ram_map(block), vir2phys(&n), (phys_bytes) sizeof(n));
+	if (n == 0 && opcode == DEV_WRITE) {
+		/* First write to this block, give it memory. */
+		if (ram_next == ram_limit) return(ENOSPC);
+		n = ram_next++;
+		if (chunk < BLOCK_SIZE)
+			phys_copy(ram_block(0), ram_block(n), (phys_bytes) BLOCK_SIZE);
+		phys_copy(vir2phys(&n), ram_map(block), (phys_bytes) sizeof(n));
+	}
+
+	if (opcode == DEV_READ)
+		phys_copy(ram_block(n) + offset, user_phys, (phys_bytes) chunk);
+	else
+		phys_copy(user_phys, ram_block(n) + offset, (phys_bytes) chunk);
+
+	position += chunk;
+	user_phys += chunk;
+	count -= chunk;
+  }
+  return(OK);
+}
+
+
 /*============================================================================*
  *				m_do_open				      *
  *============================================================================*/
@@ -187,9 +266,8 @@ message *m_ptr;			/* pointer to read or write message */
 /* Set parameters for one of the RAM disks. */
 
   unsigned long bytesize;
-  unsigned base, size;
+  unsigned base, size, pool;
   struct memory *memp;
-  static struct psinfo psinfo = { NR_TASKS, NR_PROCS, (vir_bytes) proc, 0, 0 };
   phys_bytes psinfo_phys;
 
   switch (m_ptr->REQUEST) {
@@ -200,6 +278,10 @@ message *m_ptr;			/* pointer to read or write message */
 	bytesize = m_ptr->POSITION * BLOCK_SIZE;
 	size = (bytesize + CLICK_SHIFT-1) >> CLICK_SHIFT;
 
+	/* A smaller pool of memory for a sparse RAM disk? */
+	if ((pool = m_pool(m_ptr->POSITION)) != 0)
+		size = ((unsigned long) pool * BLOCK_SIZE) >> CLICK_SHIFT;
+
 	/* Find a memory chunk big enough for the RAM disk. */
 	memp= &mem[NR_MEMS];
 	while ((--memp)->size < size) {
@@ -211,6 +293,23 @@ message *m_ptr;			/* pointer to read or write message */
 
 	m_geom[RAM_DEV].dv_base = (unsigned long) base << CLICK_SHIFT;
 	m_geom[RAM_DEV].dv_size = bytesize;
+
+	if (pool != 0) {
+		/* Zero the zero block and the map, the rest comes on demand. */
+		ram_pool = m_geom[RAM_DEV].dv_base;
+		ram_limit = pool;
+		ram_next = 1 + (m_ptr->POSITION * sizeof(u16_t) + BLOCK_SIZE-1)
+								/ BLOCK_SIZE;
+		m_zero(ram_block(0));
+		for (base = 1; base < ram_next; base++) {
+			phys_copy(ram_block(0), ram_block(base),
+						(phys_bytes) BLOCK_SIZE);
+		}
+		m_geom[RAM_DEV].dv_base = 0;
+	}
+
+	/* Tell FS how many blocks of memory the RAM disk takes. */
+	if (pool != 0) m_ptr->POSITION = pool;
 	break;
   case MIOCSPSINFO:
 	/* MM or FS set the address of their process table. */
@@ -230,6 +329,9 @@ message *m_ptr;			/* pointer to read or write message */
 	if (psinfo_phys == 0) return(EFAULT);
 	phys_copy(vir2phys(&psinfo), psinfo_phys, (phys_bytes) sizeof(psinfo));
 	break;
+  case MIOCGPSTAB:
+	/* Ps or top wants a snapshot of the process tables. */
+	return(m_pstab(m_ptr->PROC_NR, (vir_bytes) m_ptr->ADDRESS));
   default:
   	return(do_diocntl(&m_dtab, m_ptr));
   }
@@ -237,6 +339,145 @@ message *m_ptr;			/* pointer to read or write message */
 }
 
 
+/*===========================================================================*
+ *				m_pstab					     *
+ *===========================================================================*/
+PRIVATE int m_pstab(proc_nr, addr)
+int proc_nr;			/* process that wants the snapshot */
+vir_bytes addr;			/* address of its pstab array */
+{
+/* Merge the kernel, MM and FS entries of each process into a pstab record
+ * for the caller.  FS is waiting for this reply, and MM can't run while a
+ * task does, so the three tables are seen as they are at one moment.  Only
+ * interrupts can change a flag or a time meanwhile.
+ */
+  register struct proc *rp;
+  static struct mproc mp;
+  static struct fproc fp;
+  static struct pstab ps;
+  phys_bytes user_phys, mm_phys, fs_phys;
+  int n;
+
+  if (psinfo.mproc == 0 || psinfo.fproc == 0) return(EAGAIN);
+  user_phys = numap(proc_nr, addr,
+		(vir_bytes) ((NR_TASKS + NR_PROCS) * sizeof(ps)));
+  mm_phys = numap(MM_PROC_NR, psinfo.mproc,
+		(vir_bytes) (NR_PROCS * sizeof(mp)));
+  fs_phys = numap(FS_PROC_NR, psinfo.fproc,
+		(vir_bytes) (NR_PROCS * sizeof(fp)));
+  if (user_phys == 0 || mm_phys == 0 || fs_phys == 0) return(EFAULT);
+
+  for (rp = BEG_PROC_ADDR; rp < END_PROC_ADDR; rp++) {
+	n = proc_number(rp);
+	memset((void *) &ps, 0, sizeof(ps));
+
+	/* Tasks and servers have no real MM or FS entry. */
+	if (n >= INIT_PROC_NR) {
+		phys_copy(mm_phys + (phys_bytes) n * sizeof(mp),
+				vir2phys(&mp), (phys_bytes) sizeof(mp));
+		phys_copy(fs_phys + (phys_bytes) n * sizeof(fp),
+				vir2phys(&fp), (phys_bytes) sizeof(fp));
+	} else {
+		mp.mp_flags = 0;
+		fp.fp_suspended = NOT_SUSPENDED;
+	}
+
+	if ((rp->p_flags & P_SLOT_FREE) && !(mp.mp_flags & IN_USE)) {
+		ps.ps_state = PS_FREE;
+		phys_copy(vir2phys(&ps), user_phys, (phys_bytes) sizeof(ps));
+		user_phys += sizeof(ps);
+		continue;
+	}
+
+	memcpy(ps.ps_name, rp->p_name, sizeof(ps.ps_name));
+	ps.ps_flags = rp->p_flags;
+	ps.ps_recv = rp->p_getfrom;
+	ps.ps_utime = rp->user_time;
+	ps.ps_stime = rp->sys_time;
+	memcpy((void *) ps.ps_map, (void *) rp->p_map, sizeof(ps.ps_map));
+
+	if (n >= INIT_PROC_NR) {
+		ps.ps_mflags = mp.mp_flags;
+		ps.ps_ftask = fp.fp_task;
+		ps.ps_pid = mp.mp_pid;
+		if (isoksusern(mp.mp_parent))
+			ps.ps_ppid = proc_addr(mp.mp_parent)->p_pid;
+		ps.ps_pgrp = mp.mp_procgrp;
+		ps.ps_ruid = mp.mp_realuid;
+		ps.ps_euid = mp.mp_effuid;
+		ps.ps_tty = fp.fp_tty;
+		ps.ps_procargs = mp.mp_procargs;
+	}
+
+	/* The state as ps(1) has always shown it. */
+	if (mp.mp_flags & HANGING)
+		ps.ps_state = PS_ZOMBIE;
+	else if (mp.mp_flags & STOPPED)
+		ps.ps_state = PS_STOP;
+	else if (rp->p_flags == 0)
+		ps.ps_state = PS_RUN;
+	else if (n >= INIT_PROC_NR && ((mp.mp_flags & (WAITING | PAUSED))
+					|| fp.fp_suspended == SUSPENDED))
+		ps.ps_state = PS_SLEEP;
+	else
+		ps.ps_state = PS_WAIT;
+
+	/* Who it waits for: a send or receive partner, or the task FS
+	 * suspended it on.
+	 */
+	ps.ps_blocked = ANY;
+	if (rp->p_flags & SENDING)
+		ps.ps_blocked = rp->p_sendto;
+	else if (rp->p_flags & RECEIVING) {
+		ps.ps_blocked = rp->p_getfrom;
+		if (ps.ps_blocked == FS_PROC_NR && fp.fp_suspended == SUSPENDED
+			&& -fp.fp_task >= -NR_TASKS && -fp.fp_task < 0)
+			ps.ps_blocked = -fp.fp_task;
+	}
+
+	phys_copy(vir2phys(&ps), user_phys, (phys_bytes) sizeof(ps));
+	user_phys += sizeof(ps);
+  }
+  return(OK);
+}
+
+
+/*===========================================================================*
+ *				m_pool					     *
+ *===========================================================================*/
+PRIVATE unsigned m_pool(blocks)
+unsigned long blocks;		/* size of the RAM disk */
+{
+/* Return the number of blocks in the pool of a sparse RAM disk of the given
+ * size, including the zero block and the map, or 0 if it is not sparse.
+ */
+  long v;
+  unsigned long overhead;
+
+  overhead = 1 + (blocks * sizeof(u16_t) + BLOCK_SIZE-1) / BLOCK_SIZE;
+  if (ROOT_DEV != DEV_RAM) return(0);
+  if (env_parse("rampool", "d", 0, &v, 0L, 0xFFFFL) != EP_SET) return(0);
+  if (v >= blocks || overhead + 1 > 0xFFFF) return(0);
+  if (v < overhead + 1) v = overhead + 1;
+  return((unsigned) v);
+}
+
+
+/*===========================================================================*
+ *				m_zero					     *
+ *===========================================================================*/
+PRIVATE void m_zero(dst)
+phys_bytes dst;			/* block to clear */
+{
+/* Fill a block of memory with zeros. */
+  static u16_t zeros[64];
+  unsigned n;
+
+  for (n = 0; n < BLOCK_SIZE; n += sizeof(zeros))
+	phys_copy(vir2phys(zeros), dst + n, (phys_bytes) sizeof(zeros));
+}
+
+
 /*============================================================================*
  *				m_geometry				      *
  *============================================================================*/
@@ -164,8 +164,8 @@ dpeth_t *dep;
 	dep->de_ramsize= NE1000_SIZE;
 	dep->de_offset_page= NE1000_START / DP_PAGESIZE;
 
-	/* Allocate one send buffer (1.5KB) per 8KB of on board memory. */
-	sendq_nr= dep->de_ramsize / 0x2000;
+	/* Allocate one send buffer (1.5KB) per 4KB of on board memory. */
+	sendq_nr= dep->de_ramsize / SENDQ_RAM;
 	if (sendq_nr < 1)
 		sendq_nr= 1;
 	else if (sendq_nr > SENDQ_NR)
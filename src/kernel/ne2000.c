@@ -252,8 +252,12 @@ dpeth_t *dep;
 	dep->de_ramsize= NE2000_SIZE;
 	dep->de_offset_page= NE2000_START / DP_PAGESIZE;
 
-	/* Allocate one send buffer (1.5KB) per 8KB of on board memory. */
-	sendq_nr= dep->de_ramsize / 0x2000;
+	/* Allocate one send buffer (1.5KB) per 4KB of on board memory.
+	 * An RTL8019AS also probes as an NE2000. The SRAM that umb_init
+	 * maps as upper memory sits in the boot ROM window, so it does
+	 * not take anything from the 16KB packet buffer.
+	 */
+	sendq_nr= dep->de_ramsize / SENDQ_RAM;
 	if (sendq_nr < 1)
 		sendq_nr= 1;
 	else if (sendq_nr > SENDQ_NR)
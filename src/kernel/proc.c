@@ -73,6 +73,7 @@ int task;			/* number of task to be started */
    *     interrupt handler might call interrupt and pass the k_reenter test.
    */
   if (k_reenter != 0 || switching) {
+	KTRACE(KT_HOLD, task, 0, 0);
 	lock();
 	if (!rp->p_int_held) {
 		rp->p_int_held = TRUE;
@@ -103,14 +104,18 @@ int task;			/* number of task to be started */
   rp->p_messbuf->m_type = HARD_INT;
   rp->p_flags &= ~RECEIVING;
   rp->p_int_blocked = FALSE;
+  KTRACE(KT_RECEIVE, task, HARDWARE, HARD_INT);
 
    /* Make rp ready and run it unless a task is already running.  This is
     * ready(rp) in-line for speed.
     */
   if (rdy_head[TASK_Q] != NIL_PROC)
 	rdy_tail[TASK_Q]->p_nextready = rp;
-  else
+  else {
+	BILL_TIME();
+	KTRACE(KT_SWITCH, task, 0, 0);
 	proc_ptr = rdy_head[TASK_Q] = rp;
+  }
   rdy_tail[TASK_Q] = rp;
   rp->p_nextready = NIL_PROC;
 }
@@ -207,6 +212,9 @@ message *m_ptr;			/* pointer to message buffer */
 	}
   }
 
+  KTRACE(KT_SEND, proc_number(caller_ptr), dest,
+					ktrace_type(caller_ptr, m_ptr));
+
   /* Check to see if 'dest' is blocked waiting for this message. */
   if ( (dest_ptr->p_flags & (RECEIVING | SENDING)) == RECEIVING &&
        (dest_ptr->p_getfrom == ANY ||
@@ -214,6 +222,8 @@ message *m_ptr;			/* pointer to message buffer */
 	/* Destination is indeed waiting for this message. */
 	CopyMess(proc_number(caller_ptr), caller_ptr, m_ptr, dest_ptr,
 		 dest_ptr->p_messbuf);
+	KTRACE(KT_RECEIVE, dest, proc_number(caller_ptr),
+				ktrace_type(dest_ptr, dest_ptr->p_messbuf));
 	dest_ptr->p_flags &= ~RECEIVING;	/* deblock destination */
 	if (dest_ptr->p_flags == 0) ready(dest_ptr);
   } else {
@@ -263,6 +273,8 @@ message *m_ptr;			/* pointer to message buffer */
 		/* An acceptable message has been found. */
 		CopyMess(proc_number(sender_ptr), sender_ptr,
 			 sender_ptr->p_messbuf, caller_ptr, m_ptr);
+		KTRACE(KT_RECEIVE, proc_number(caller_ptr),
+			proc_number(sender_ptr), ktrace_type(caller_ptr, m_ptr));
 		if (sender_ptr == caller_ptr->p_callerq)
 			caller_ptr->p_callerq = sender_ptr->p_sendlink;
 		else
@@ -278,6 +290,7 @@ message *m_ptr;			/* pointer to message buffer */
 	m_ptr->m_source = HARDWARE;
 	m_ptr->m_type = HARD_INT;
 	caller_ptr->p_int_blocked = FALSE;
+	KTRACE(KT_RECEIVE, proc_number(caller_ptr), HARDWARE, HARD_INT);
 	return(OK);
     }
   }
@@ -308,23 +321,21 @@ PRIVATE void pick_proc()
 
   register struct proc *rp;	/* process to run */
 
-  if ( (rp = rdy_head[TASK_Q]) != NIL_PROC) {
-	proc_ptr = rp;
-	return;
+  if ( (rp = rdy_head[TASK_Q]) == NIL_PROC &&
+       (rp = rdy_head[SERVER_Q]) == NIL_PROC &&
+       (rp = rdy_head[USER_Q]) == NIL_PROC) {
+	/* No one is ready.  Run the idle task.  The idle task might be made an
+	 * always-ready user task to avoid this special case.
+	 */
+	rp = proc_addr(IDLE);
   }
-  if ( (rp = rdy_head[SERVER_Q]) != NIL_PROC) {
+  if (rp != proc_ptr) {
+	/* Bill the process that ran until now, for whom bill_ptr is right. */
+	BILL_TIME();
+	KTRACE(KT_SWITCH, proc_number(rp), 0, 0);
 	proc_ptr = rp;
-	return;
   }
-  if ( (rp = rdy_head[USER_Q]) != NIL_PROC) {
-	proc_ptr = rp;
-	bill_ptr = rp;
-	return;
-  }
-  /* No one is ready.  Run the idle task.  The idle task might be made an
-   * always-ready user task to avoid this special case.
-   */
-  bill_ptr = proc_ptr = proc_addr(IDLE);
+  if (isuserp(rp) || rp == proc_addr(IDLE)) bill_ptr = rp;
 }
 
 /*===========================================================================*
@@ -345,6 +356,8 @@ register struct proc *rp;	/* this process is now runnable */
 		/* Add to tail of nonempty queue. */
 		rdy_tail[TASK_Q]->p_nextready = rp;
 	else {
+		BILL_TIME();
+		KTRACE(KT_SWITCH, proc_number(rp), 0, 0);
 		proc_ptr =		/* run fresh task next */
 		rdy_head[TASK_Q] = rp;	/* add to empty queue */
 	}
@@ -563,6 +576,7 @@ PUBLIC void unhold()
 	if ( (held_head = rp->p_nextheld) == NIL_PROC) held_tail = NIL_PROC;
 	rp->p_int_held = FALSE;
 	unlock();		/* reduce latency; held queue may change! */
+	KTRACE(KT_UNHOLD, proc_number(rp), 0, 0);
 	interrupt(proc_number(rp));
 	lock();			/* protect the held queue again */
   }
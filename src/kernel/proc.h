@@ -48,10 +48,22 @@ struct proc {
 
   clock_t user_time;		/* user time in ticks */
   clock_t sys_time;		/* sys time in ticks */
+  unsigned p_user_count;	/* user time in timer counts, less than a tick */
+  unsigned p_sys_count;		/* sys time in timer counts, less than a tick */
   clock_t child_utime;		/* cumulative user time of children */
   clock_t child_stime;		/* cumulative sys time of children */
+  unsigned p_child_ucount;	/* cumulative child times in timer counts, */
+  unsigned p_child_scount;	/*   less than a tick */
   clock_t p_alarm;		/* time of next alarm in ticks, or 0 */
 
+#if ENABLE_PROFILING
+  struct proc *p_prof_owner;	/* process with the profile buffer */
+  vir_bytes p_prof_buf;		/* profile buffer in its data segment */
+  vir_bytes p_prof_size;	/* size of the buffer in bytes */
+  vir_bytes p_prof_off;		/* lowest pc that is counted */
+  unsigned p_prof_scale;	/* pc to counter scale, 0 if not profiled */
+#endif
+
   struct proc *p_callerq;	/* head of list of procs wishing to send */
   struct proc *p_sendlink;	/* link to next proc wishing to send */
   message *p_messbuf;		/* pointer to message buffer */
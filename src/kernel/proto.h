@@ -116,6 +116,10 @@ _PROTOTYPE( int el2_probe, (struct dpeth *dep)				);
 _PROTOTYPE( void milli_start, (struct milli_state *msp)			);
 _PROTOTYPE( unsigned milli_elapsed, (struct milli_state *msp)		);
 _PROTOTYPE( void milli_delay, (unsigned millisec)			);
+_PROTOTYPE( clock_t read_clock, (unsigned *countp)			);
+_PROTOTYPE( void bill_time, (void)					);
+_PROTOTYPE( void add_time, (clock_t *timep, unsigned *countp,
+						unsigned long counts)	);
 
 /* console.c */
 _PROTOTYPE( void cons_stop, (void)					);
@@ -139,6 +143,11 @@ _PROTOTYPE( irq_handler_t get_irq_handler, (int irq)			);
 _PROTOTYPE( void put_irq_handler, (int irq, irq_handler_t handler)	);
 _PROTOTYPE( void intr_init, (int mine)					);
 
+/* ktrace.c */
+_PROTOTYPE( void ktrace, (int event, int proc, int peer, int type)	);
+_PROTOTYPE( int ktrace_type, (struct proc *rp, message *m_ptr)		);
+_PROTOTYPE( int do_ktrace, (message *m_ptr)				);
+
 /* keyboard.c */
 _PROTOTYPE( void kb_init, (struct tty *tp)				);
 _PROTOTYPE( int kbd_loadmap, (phys_bytes user_phys)			);
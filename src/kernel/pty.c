@@ -334,12 +334,14 @@ pty_t *pp;
 PRIVATE void pty_read(tp)
 tty_t *tp;
 {
-/* Offer bytes from the PTY writer for input on the TTY.  (Do it one byte at
- * a time, 99% of the writes will be for one byte, so no sense in being smart.)
+/* Offer bytes from the PTY writer for input on the TTY.  Most writes are for
+ * one byte, but a raw mode reader takes bulk data (file transfers, rlogin
+ * sessions) a chunk at a time without processing.
  */
   pty_t *pp = tp->tty_priv;
   phys_bytes user_phys;
-  char c;
+  char buf[64];
+  int count;
 
   if (pp->state & PTY_CLOSED) {
 	if (tp->tty_inleft > 0) {
@@ -351,17 +353,19 @@ tty_t *tp;
   }
 
   while (pp->wrleft > 0) {
-	/* Transfer one character to 'c'. */
+	/* Transfer a chunk of characters to 'buf'. */
+	count = pp->wrleft;
+	if (count > sizeof(buf)) count = sizeof(buf);
 	user_phys = proc_vir2phys(proc_addr(pp->wrproc), pp->wrvir);
-	phys_copy(user_phys, vir2phys(&c), 1L);
+	phys_copy(user_phys, vir2phys(buf), (phys_bytes) count);
 
 	/* Input processing. */
-	if (in_process(tp, &c, 1) == 0) break;
+	if ((count = in_process(tp, buf, count)) == 0) break;
 
 	/* PTY writer bookkeeping. */
-	pp->wrvir++;
-	pp->wrcum++;
-	if (--pp->wrleft == 0) {
+	pp->wrvir += count;
+	pp->wrcum += count;
+	if ((pp->wrleft -= count) == 0) {
 		tty_reply(pp->wrrepcode, pp->wrcaller, pp->wrproc, pp->wrcum);
 		pp->wrcum = 0;
 	}
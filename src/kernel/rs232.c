@@ -1,5 +1,5 @@
 /*==========================================================================*
- *		rs232.c - serial driver for 8250 and 16450 UARTs	    *
+ *	rs232.c - serial driver for 8250, 16450 and 16550A UARTs	    *
  *		Added support for Atari ST M68901 and YM-2149	--kub	    *
  *==========================================================================*/
 
@@ -40,6 +40,18 @@
 #define IS_TRANSMITTER_READY    2
 #define IS_RECEIVER_READY       4
 #define IS_LINE_STATUS_CHANGE   6
+#define IS_CHAR_TIMEOUT      0x0C	/* 16550: data left in receive FIFO */
+#define IS_ID_BITS           0x0F	/* mask out the FIFO bits */
+#define IS_FIFO_BITS         0xC0	/* FIFO state: */
+#define IS_FIFO_16550A       0xC0	/* FIFOs enabled and working */
+
+/* FIFO control bits (16550A). */
+#define FC_ENABLE            0x01
+#define FC_CLEAR_RECV        0x02
+#define FC_CLEAR_XMIT        0x04
+#define FC_TRIGGER_SHIFT        6	/* receive trigger level 1, 4, 8, 14 */
+#define FIFO_SIZE              16	/* bytes in each FIFO */
+#define DEF_FIFO_TRIGGER        8	/* default receive trigger level */
 
 /* Line control bits. */
 #define LC_2STOP_BITS        0x04
@@ -49,6 +61,7 @@
 #define LC_ADDRESS_DIVISOR   0x80
 
 /* Line status bits. */
+#define LS_DATA_READY           1
 #define LS_OVERRUN_ERR          2
 #define LS_PARITY_ERR           4
 #define LS_FRAMING_ERR          8
@@ -84,6 +97,9 @@
 
 #endif /* MACHINE == ATARI */
 
+#define LS_ERRORS	(LS_OVERRUN_ERR | LS_PARITY_ERR | LS_FRAMING_ERR \
+				| LS_BREAK_INTERRUPT)
+
 #define DATA_BITS_SHIFT         8	/* amount data bits shifted in mode */
 #define DEF_BAUD             1200	/* default baud rate */
 
@@ -183,6 +199,7 @@ typedef struct rs232 {
   char *itail;			/* first byte to give to TTY */
   bool_t idevready;		/* nonzero if we are ready to receive (RTS) */
   char cts;			/* normally 0, but MS_CTS if CLOCAL is set */
+  unsigned char fifo_size;	/* bytes moved per interrupt, 1 if no FIFO */
 
   unsigned char ostate;		/* combination of flags: */
 #define ODONE          1	/* output completed (< output enable bits) */
@@ -212,6 +229,7 @@ typedef struct rs232 {
   port_t div_hi_port;
   port_t int_enab_port;
   port_t int_id_port;
+  port_t fifo_ctl_port;
   port_t line_ctl_port;
   port_t modem_ctl_port;
   port_t line_status_port;
@@ -220,10 +238,11 @@ typedef struct rs232 {
 
   unsigned char lstatus;	/* last line status */
   unsigned char pad;		/* ensure alignment for 16-bit ints */
-  unsigned framing_errors;	/* error counts (no reporting yet) */
+  unsigned framing_errors;	/* error counts (see TIOCGSERSTAT) */
   unsigned overrun_errors;
   unsigned parity_errors;
   unsigned break_interrupts;
+  unsigned dropped;		/* input lost because ibuf was full */
 
   char ibuf[RS_IBUFSIZE];	/* input buffer */
   char obuf[RS_OBUFSIZE];	/* output buffer */
@@ -248,6 +267,7 @@ FORWARD _PROTOTYPE( int rs232_1handler, (int irq)			);
 FORWARD _PROTOTYPE( int rs232_2handler, (int irq)			);
 FORWARD _PROTOTYPE( void in_int, (rs232_t *rs)				);
 FORWARD _PROTOTYPE( void line_int, (rs232_t *rs)			);
+FORWARD _PROTOTYPE( void line_errors, (rs232_t *rs)			);
 FORWARD _PROTOTYPE( void modem_int, (rs232_t *rs)			);
 FORWARD _PROTOTYPE( void rs_write, (tty_t *tp)				);
 FORWARD _PROTOTYPE( void rs_echo, (tty_t *tp, int c)			);
@@ -258,6 +278,7 @@ FORWARD _PROTOTYPE( void rs_icancel, (tty_t *tp)			);
 FORWARD _PROTOTYPE( void rs_ocancel, (tty_t *tp)			);
 FORWARD _PROTOTYPE( void rs_ostart, (rs232_t *rs)			);
 FORWARD _PROTOTYPE( void rs_break, (tty_t *tp)				);
+FORWARD _PROTOTYPE( void rs_serstat, (tty_t *tp, struct serstat *ssp)	);
 FORWARD _PROTOTYPE( void out_int, (rs232_t *rs)				);
 
 
@@ -489,7 +510,7 @@ tty_t *tp;			/* which TTY */
   int line;
 #if (MACHINE == IBM_PC)
   port_t this_8250;
-  int irq;
+  int irq, trigger;
   long v;
 #endif
 
@@ -510,6 +531,7 @@ tty_t *tp;			/* which TTY */
   rs->div_hi_port = this_8250 + 1;
   rs->int_enab_port = this_8250 + 1;
   rs->int_id_port = this_8250 + 2;
+  rs->fifo_ctl_port = this_8250 + 2;
   rs->line_ctl_port = this_8250 + 3;
   rs->modem_ctl_port = this_8250 + 4;
   rs->line_status_port = this_8250 + 5;
@@ -531,8 +553,28 @@ tty_t *tp;			/* which TTY */
    */
   istop(rs);			/* sets modem_ctl_port */
   rs_config(rs);
+  rs->fifo_size = 1;
 #if (MACHINE == IBM_PC)
   outb(rs->int_enab_port, 0);
+
+  /* Enable the FIFOs of a 16550A, so that up to 16 bytes can be moved per
+   * interrupt.  The FIFOs of the original 16550 don't work, it can be told
+   * apart by the FIFO bits of the interrupt id register.  The boot variable
+   * RSFIFO sets the receive trigger level (1, 4, 8 or 14), or turns the
+   * FIFOs off.
+   */
+  v = DEF_FIFO_TRIGGER;
+  if (env_parse("RSFIFO", "d", 0, &v, 1L, 14L) != EP_OFF) {
+	outb(rs->fifo_ctl_port, FC_ENABLE);
+	if ((inb(rs->int_id_port) & IS_FIFO_BITS) == IS_FIFO_16550A) {
+		trigger = v >= 14 ? 3 : v >= 8 ? 2 : v >= 4 ? 1 : 0;
+		outb(rs->fifo_ctl_port, FC_ENABLE | FC_CLEAR_RECV
+				| FC_CLEAR_XMIT | (trigger << FC_TRIGGER_SHIFT));
+		rs->fifo_size = FIFO_SIZE;
+	} else {
+		outb(rs->fifo_ctl_port, 0);
+	}
+  }
 #endif
 
   /* Clear any harmful leftover interrupts.  An output interrupt is harmless
@@ -587,6 +629,7 @@ tty_t *tp;			/* which TTY */
   tp->tty_ocancel = rs_ocancel;
   tp->tty_ioctl = rs_ioctl;
   tp->tty_break = rs_break;
+  tp->tty_serstat = rs_serstat;
 
   /* Tell external device we are ready. */
   istart(rs);
@@ -693,6 +736,27 @@ tty_t *tp;			/* which tty */
 }
 
 
+/*==========================================================================*
+ *				rs_serstat				    *
+ *==========================================================================*/
+PRIVATE void rs_serstat(tp, ssp)
+tty_t *tp;			/* which tty */
+struct serstat *ssp;		/* put the counts here */
+{
+/* Report the error counts of the line. */
+  rs232_t *rs = tp->tty_priv;
+
+  lock();
+  ssp->ss_framing = rs->framing_errors;
+  ssp->ss_overrun = rs->overrun_errors;
+  ssp->ss_parity = rs->parity_errors;
+  ssp->ss_break = rs->break_interrupts;
+  ssp->ss_dropped = rs->dropped;
+  unlock();
+  ssp->ss_fifo = rs->fifo_size;
+}
+
+
 /* Low level (interrupt) routines. */
 
 #if (MACHINE == IBM_PC)
@@ -712,10 +776,12 @@ int irq;
 	/* Loop to pick up ALL pending interrupts for device.
 	 * This usually just wastes time unless the hardware has a buffer
 	 * (and then we have to worry about being stuck in the loop too long).
-	 * Unfortunately, some serial cards lock up without this.
+	 * Unfortunately, some serial cards lock up without this.  A 16550A
+	 * is drained or filled a FIFO at a time by in_int() and out_int().
 	 */
-	switch (inb(rs->int_id_port)) {
+	switch (inb(rs->int_id_port) & IS_ID_BITS) {
 	case IS_RECEIVER_READY:
+	case IS_CHAR_TIMEOUT:
 		in_int(rs);
 		continue;
 	case IS_TRANSMITTER_READY:
@@ -746,8 +812,9 @@ int irq;
   register rs232_t *rs = &rs_lines[1];
 
   while (TRUE) {
-	switch (inb(rs->int_id_port)) {
+	switch (inb(rs->int_id_port) & IS_ID_BITS) {
 	case IS_RECEIVER_READY:
+	case IS_CHAR_TIMEOUT:
 		in_int(rs);
 		continue;
 	case IS_TRANSMITTER_READY:
@@ -813,40 +880,57 @@ int    type;	       /* interrupt type */
 PRIVATE void in_int(rs)
 register rs232_t *rs;		/* line with input interrupt */
 {
-/* Read the data which just arrived.
+/* Read the data which just arrived, all of it if the UART has a FIFO.
  * If it is the oxoff char, clear OSWREADY, else if OSWREADY was clear, set
  * it and restart output (any char does this, not just xon).
  * Put data in the buffer if room, otherwise discard it.
  * Set a flag for the clock interrupt handler to eventually notify TTY.
  */
 
-  int c;
+  int c, n;
 
+  n = rs->fifo_size;
+  do {
 #if (MACHINE == IBM_PC)
-  c = inb(rs->recv_port);
+	c = inb(rs->recv_port);
 #else /* MACHINE == ATARI */
-  c = MFP->mf_udr;
+	c = MFP->mf_udr;
 #endif
 
-  if (!(rs->ostate & ORAW)) {
-	if (c == rs->oxoff) {
-		rs->ostate &= ~OSWREADY;
-	} else
-	if (!(rs->ostate & OSWREADY)) {
-		rs->ostate |= OSWREADY;
-		if (txready(rs)) out_int(rs);
+	if (!(rs->ostate & ORAW)) {
+		if (c == rs->oxoff) {
+			rs->ostate &= ~OSWREADY;
+		} else
+		if (!(rs->ostate & OSWREADY)) {
+			rs->ostate |= OSWREADY;
+			if (txready(rs)) out_int(rs);
+		}
 	}
-  }
 
-  if (rs->icount == buflen(rs->ibuf)) return;	/* input buffer full, discard */
+	if (rs->icount == buflen(rs->ibuf)) {
+		/* Input buffer full, discard. */
+		rs->dropped++;
+	} else {
+		if (++rs->icount == RS_IHIGHWATER && rs->idevready) istop(rs);
+		*rs->ihead = c;
+		if (++rs->ihead == bufend(rs->ibuf)) rs->ihead = rs->ibuf;
+		if (rs->icount == 1) {
+			rs->tty->tty_events = 1;
+			force_timeout();
+		}
+	}
+	if (--n == 0) break;
 
-  if (++rs->icount == RS_IHIGHWATER && rs->idevready) istop(rs);
-  *rs->ihead = c;
-  if (++rs->ihead == bufend(rs->ibuf)) rs->ihead = rs->ibuf;
-  if (rs->icount == 1) {
-	rs->tty->tty_events = 1;
-	force_timeout();
-  }
+#if (MACHINE == IBM_PC)
+	/* More in the FIFO?  Reading the line status clears the error bits,
+	 * so count the errors here.
+	 */
+	rs->lstatus = inb(rs->line_status_port);
+	if (rs->lstatus & LS_ERRORS) line_errors(rs);
+  } while (rs->lstatus & LS_DATA_READY);
+#else
+  } while (0);
+#endif
 }
 
 
@@ -865,6 +949,16 @@ register rs232_t *rs;		/* line with line status interrupt */
   MFP->mf_rsr &= R_ENA;
   rs->pad = MFP->mf_udr;	/* discard char in case of LS_OVERRUN_ERR */
 #endif /* MACHINE == ATARI */
+  line_errors(rs);
+}
+
+
+/*==========================================================================*
+ *				line_errors				    *
+ *==========================================================================*/
+PRIVATE void line_errors(rs)
+register rs232_t *rs;		/* line with errors in lstatus */
+{
   if (rs->lstatus & LS_FRAMING_ERR) ++rs->framing_errors;
   if (rs->lstatus & LS_OVERRUN_ERR) ++rs->overrun_errors;
   if (rs->lstatus & LS_PARITY_ERR) ++rs->parity_errors;
@@ -910,27 +1004,34 @@ PRIVATE void out_int(rs)
 register rs232_t *rs;		/* line with output interrupt */
 {
 /* If there is output to do and everything is ready, do it (local device is
- * known ready).
+ * known ready).  The transmitter is empty, so a 16550A takes a FIFO full.
  * Notify TTY when the buffer goes empty.
  */
 
+  int n;
+
   if (rs->ostate >= (ODEVREADY | OQUEUED | OSWREADY)) {
 	/* Bit test allows ORAW and requires the others. */
+	n = rs->fifo_size;
+	do {
 #if (MACHINE == IBM_PC)
-	outb(rs->xmit_port, *rs->otail);
+		outb(rs->xmit_port, *rs->otail);
 #else /* MACHINE == ATARI */
-	MFP->mf_udr = *rs->otail;
+		MFP->mf_udr = *rs->otail;
 #endif
-	if (++rs->otail == bufend(rs->obuf)) rs->otail = rs->obuf;
-	if (--rs->ocount == 0) {
-		rs->ostate ^= (ODONE | OQUEUED);  /* ODONE on, OQUEUED off */
-		rs->tty->tty_events = 1;
-		force_timeout();
-	} else
-	if (rs->ocount == RS_OLOWWATER) {	/* running low? */
-		rs->tty->tty_events = 1;
-		force_timeout();
-	}
+		if (++rs->otail == bufend(rs->obuf)) rs->otail = rs->obuf;
+		if (--rs->ocount == 0) {
+			/* ODONE on, OQUEUED off */
+			rs->ostate ^= (ODONE | OQUEUED);
+			rs->tty->tty_events = 1;
+			force_timeout();
+			break;
+		}
+		if (rs->ocount == RS_OLOWWATER) {	/* running low? */
+			rs->tty->tty_events = 1;
+			force_timeout();
+		}
+	} while (--n > 0);
   }
 }
 #endif /* NR_RS_LINES > 0 */
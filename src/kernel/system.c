@@ -24,6 +24,8 @@
  *   SYS_MEM	 returns the next free chunk of physical memory
  *   SYS_UMAP	 compute the physical address for a given virtual address
  *   SYS_TRACE	 request a trace operation
+ *   SYS_KTRACE	 start, stop or read out the kernel trace ring
+ *   SYS_PROFIL	 start or stop profiling a process
  *
  * Message types and parameters:
  *
@@ -64,8 +66,15 @@
  *    m_type       m2_i1     m2_i2     m2_l1     m2_l2
  * ------------------------------------------------------
  * | SYS_TRACE  | proc_nr | request |  addr   |  data   |
+ * |------------+---------+---------+---------+---------|
+ * | SYS_KTRACE | proc_nr | request | max evs | events  |
  * ------------------------------------------------------
  *
+ *    m_type       m2_i1     m2_i2     m2_i3     m2_l1     m2_l2     m2_p1
+ * ------------------------------------------------------------------------
+ * | SYS_PROFIL | proc_nr | owner   |  scale  | offset  | buf siz | buf ptr |
+ * ------------------------------------------------------------------------
+ *
  *
  *    m_type       m6_i1     m6_i2     m6_i3     m6_f1
  * ------------------------------------------------------
@@ -132,6 +141,10 @@ FORWARD _PROTOTYPE( int do_umap, (message *m_ptr) );
 FORWARD _PROTOTYPE( int do_xit, (message *m_ptr) );
 FORWARD _PROTOTYPE( int do_vcopy, (message *m_ptr) );
 FORWARD _PROTOTYPE( int do_getmap, (message *m_ptr) );
+#if ENABLE_PROFILING
+FORWARD _PROTOTYPE( int do_profil, (message *m_ptr) );
+FORWARD _PROTOTYPE( void prof_stop, (struct proc *rp) );
+#endif
 
 #if (SHADOWING == 1)
 FORWARD _PROTOTYPE( int do_fresh, (message *m_ptr) );
@@ -171,6 +184,12 @@ PUBLIC void sys_task()
 	    case SYS_MEM:	r = do_mem(&m);		break;
 	    case SYS_UMAP:	r = do_umap(&m);	break;
 	    case SYS_TRACE:	r = do_trace(&m);	break;
+#if ENABLE_KTRACE
+	    case SYS_KTRACE:	r = do_ktrace(&m);	break;
+#endif
+#if ENABLE_PROFILING
+	    case SYS_PROFIL:	r = do_profil(&m);	break;
+#endif
 	    default:		r = E_BAD_FCN;
 	}
 
@@ -225,8 +244,15 @@ register message *m_ptr;	/* pointer to request message */
 
   rpc->user_time = 0;		/* set all the accounting times to 0 */
   rpc->sys_time = 0;
+  rpc->p_user_count = 0;
+  rpc->p_sys_count = 0;
   rpc->child_utime = 0;
   rpc->child_stime = 0;
+  rpc->p_child_ucount = 0;
+  rpc->p_child_scount = 0;
+#if ENABLE_PROFILING
+  rpc->p_prof_scale = 0;	/* child is not profiled */
+#endif
 
 #if (SHADOWING == 1)
   rpc->p_nflips = 0;
@@ -341,6 +367,9 @@ register message *m_ptr;	/* pointer to request message */
 #endif
   rp->p_reg.pc = (reg_t) m_ptr->IP_PTR;	/* set pc */
   rp->p_alarm = 0;		/* reset alarm timer */
+#if ENABLE_PROFILING
+  prof_stop(rp);		/* profile buffers are gone */
+#endif
   rp->p_flags &= ~RECEIVING;	/* MM does not reply to EXEC call */
   if (rp->p_flags == 0) lock_ready(rp);
 
@@ -378,9 +407,20 @@ message *m_ptr;			/* pointer to request message */
   lock();
   rp->child_utime += rc->user_time + rc->child_utime;	/* accum child times */
   rp->child_stime += rc->sys_time + rc->child_stime;
+#if (CHIP == INTEL)
+  /* The parts of a tick too, or short lived children are never seen. */
+  add_time(&rp->child_utime, &rp->p_child_ucount,
+			(unsigned long) rc->p_user_count + rc->p_child_ucount);
+  add_time(&rp->child_stime, &rp->p_child_scount,
+			(unsigned long) rc->p_sys_count + rc->p_child_scount);
+#endif
   unlock();
   rc->p_alarm = 0;		/* turn off alarm timer */
   if (rc->p_flags == 0) lock_unready(rc);
+#if ENABLE_PROFILING
+  rc->p_prof_scale = 0;		/* no longer profiled */
+  prof_stop(rc);		/* nor are those it profiles */
+#endif
 
 #if (SHADOWING == 1)
   rmshadow(rc, &base, &size);
@@ -959,6 +999,64 @@ register message *m_ptr;
   return(OK);
 }
 
+#if ENABLE_PROFILING
+
+/*===========================================================================*
+ *				do_profil				     *
+ *===========================================================================*/
+PRIVATE int do_profil(m_ptr)
+register message *m_ptr;	/* pointer to request message */
+{
+/* Handle sys_profil().  Start profiling a process into a buffer of counters
+ * in the data segment of the owner, or stop if the scale is 0 or 1.  MM has
+ * checked that the owner may profile the process.
+ */
+
+  register struct proc *rp;
+  vir_bytes size;
+  unsigned scale;
+
+  if (!isoksusern(m_ptr->m2_i1) || !isoksusern(m_ptr->m2_i2))
+	return(E_BAD_PROC);
+  rp = proc_addr(m_ptr->m2_i1);
+  scale = (unsigned) m_ptr->m2_i3;
+  if (scale <= 1) {
+	rp->p_prof_scale = 0;
+	return(OK);
+  }
+
+  size = (vir_bytes) m_ptr->m2_l2;
+  if (size < sizeof(u16_t) || size != m_ptr->m2_l2) return(EINVAL);
+  if (numap(m_ptr->m2_i2, (vir_bytes) m_ptr->m2_p1, size) == 0)
+	return(EFAULT);
+
+  lock();			/* the clock interrupt uses these */
+  rp->p_prof_owner = proc_addr(m_ptr->m2_i2);
+  rp->p_prof_buf = (vir_bytes) m_ptr->m2_p1;
+  rp->p_prof_size = size;
+  rp->p_prof_off = (vir_bytes) m_ptr->m2_l1;
+  rp->p_prof_scale = scale;
+  unlock();
+  return(OK);
+}
+
+
+/*===========================================================================*
+ *				prof_stop				     *
+ *===========================================================================*/
+PRIVATE void prof_stop(rp)
+struct proc *rp;		/* process whose memory goes away */
+{
+/* Stop the profiles that collect their counts in the memory of 'rp'. */
+
+  register struct proc *xp;
+
+  for (xp = BEG_SERV_ADDR; xp < END_PROC_ADDR; xp++) {
+	if (xp->p_prof_owner == rp) xp->p_prof_scale = 0;
+  }
+}
+#endif /* ENABLE_PROFILING */
+
 /*===========================================================================*
  *				cause_sig				     *
  *===========================================================================*/
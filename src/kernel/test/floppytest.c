@@ -0,0 +1,727 @@
+/*
+floppytest.c
+
+Check and time the floppy driver, ../floppy.c, on any system with an ANSI C
+compiler.  Floppy.c is compiled in unchanged against the stand-in headers
+in host/ and a simulated PD765 controller and DMA chip.  It is included
+through host/floppy.c, a symbolic link to ../../floppy.c, so that its own
+includes find the stand-ins instead of the kernel headers next to it:
+
+	cc -O -Ihost -o floppytest floppytest.c -lm
+	./floppytest [ms]
+
+Build it again with -DTRACK_SECTORS=0 to compare with the driver without
+the track cache.
+
+The simulated diskette is a 720K one in a 720K drive.  It turns at 300 rpm,
+a sector can only be read or written when it passes under the head, and a
+seek takes 15 ms plus 3 ms per cylinder.  Controller commands, DMA set up
+and the 64K DMA limit are checked as a real chip would see them.  Time only
+passes in the simulation, so the times printed are those of the drive, not
+of the host.  Between two requests the file system and the user process
+take 'ms' milliseconds, 10 if not given.
+
+Each workload compares what it reads with what was written, and the
+diskette image with a shadow copy once the motor has stopped.  The track
+cache may keep written sectors while the motor runs, but they must be on
+the diskette once it is off, without a close or a sync.  Stop_motor() may
+only interrupt the task while it waits for a request, one workload has the
+motor timer go off just after a request came in.  The test exits with
+status 1 on the first difference.
+*/
+
+#include <math.h>
+
+#include "host/floppy.c"
+
+#define CYLINDERS	80
+#define SECTORS		9		/* sectors per track */
+#define NR_BLOCKS	720		/* 1K blocks on the diskette */
+#define DISK_SIZE	(CYLINDERS * NR_HEADS * SECTORS * SECTOR_SIZE)
+#define ROTATION	200.0		/* ms per turn */
+#define MEM_SIZE	0x100000L	/* simulated memory, the DMA can reach */
+#define TEST_DEV	(4 << 2)	/* fd0 as type 4: 720K in a 720K drive */
+#define IDLE		5000.0		/* ms to let the motor stop */
+#define RA_BLOCKS	18		/* blocks FS reads at once */
+
+int pc_at = 1;
+struct proc task_proc;			/* the floppy task, for proc_addr() */
+u8_t *mem;				/* simulated memory */
+u8_t *tmp_buf;
+phys_bytes tmp_phys;
+u8_t *track_buf;
+phys_bytes track_phys;
+
+PRIVATE u8_t *ubuf;			/* user buffer */
+PRIVATE u8_t disk[DISK_SIZE];		/* the diskette */
+PRIVATE u8_t shadow[DISK_SIZE];		/* what should be on it */
+PRIVATE int wprot;			/* diskette is write protected */
+PRIVATE double now;			/* time in ms */
+PRIVATE double think = 10.0;		/* ms between requests */
+
+PRIVATE int cur_cyl;			/* cylinder under the heads */
+PRIVATE int dor;			/* digital output register */
+PRIVATE int irq_pending;		/* controller interrupt */
+PRIVATE int alarm_pending;		/* interrupt from stop_motor() */
+PRIVATE int cmd[9], cmd_len, cmd_need;	/* command being sent */
+PRIVATE int res[7], res_len, res_next;	/* results being read */
+PRIVATE int dma_mode, dma_aflip, dma_cflip;
+PRIVATE unsigned long dma_addr;
+PRIVATE unsigned dma_count;
+PRIVATE watchdog_t wd_func;		/* clock_mess() alarm */
+PRIVATE double wd_time;			/* when it is due */
+PRIVATE long nr_seeks, nr_cmds, nr_read, nr_written;
+
+FORWARD _PROTOTYPE( int cmd_length, (int c) );
+FORWARD _PROTOTYPE( void fdc_command, (void) );
+FORWARD _PROTOTYPE( void wait_sector, (int sector) );
+FORWARD _PROTOTYPE( void fail, (char *what, long block) );
+FORWARD _PROTOTYPE( void idle, (double ms) );
+FORWARD _PROTOTYPE( void motor_timer, (void) );
+FORWARD _PROTOTYPE( int dev_io, (int opcode, long block) );
+FORWARD _PROTOTYPE( void dev_call, (int opcode, long block) );
+FORWARD _PROTOTYPE( int read_ahead, (long block, int n) );
+FORWARD _PROTOTYPE( void write_block, (long block, int fill) );
+FORWARD _PROTOTYPE( void read_block, (long block) );
+FORWARD _PROTOTYPE( void on_disk, (char *what) );
+FORWARD _PROTOTYPE( void report, (char *what, double start) );
+
+
+/*===========================================================================*
+ *				The controller				     *
+ *===========================================================================*/
+PRIVATE int cmd_length(c)
+int c;
+{
+/* The number of bytes of a controller command. */
+
+  switch (c & 0x1F) {
+  case FDC_SENSE & 0x1F:		return 1;
+  case FDC_RECALIBRATE & 0x1F:	return 2;
+  case FDC_READ_ID & 0x1F:	return 2;
+  case FDC_SENSE_DRIVE & 0x1F:	return 2;
+  case FDC_SPECIFY & 0x1F:	return 3;
+  case FDC_SEEK & 0x1F:		return 3;
+  case FDC_FORMAT & 0x1F:	return 6;
+  case FDC_READ & 0x1F:
+  case FDC_WRITE & 0x1F:	return 9;
+  }
+  fprintf(stderr, "unknown controller command 0x%02x\n", c);
+  exit(1);
+}
+
+PRIVATE void wait_sector(sector)
+int sector;
+{
+/* Wait until a sector (0-based) comes under the head. */
+
+  double w;
+
+  w = sector * (ROTATION / SECTORS) - fmod(now, ROTATION);
+  if (w < 0) w += ROTATION;
+  now += w;
+}
+
+PRIVATE void fdc_command()
+{
+/* Execute the command in cmd[]. */
+
+  int c = cmd[0] & 0x1F, drive = cmd[1] & 3, head = (cmd[1] >> 2) & 1;
+  int n, next;
+  long sector;
+  double pos;
+
+  nr_cmds++;
+  res_len = res_next = 0;
+  switch (c) {
+  case FDC_SPECIFY & 0x1F:
+	return;
+  case FDC_SEEK & 0x1F:
+	if (cmd[2] != cur_cyl) {
+		nr_seeks++;
+		now += 15 + 3 * abs(cmd[2] - cur_cyl);
+	}
+	cur_cyl = cmd[2];
+	irq_pending = 1;
+	return;
+  case FDC_RECALIBRATE & 0x1F:
+	if (cur_cyl != 0) {
+		nr_seeks++;
+		now += 15 + 3 * cur_cyl;
+	}
+	cur_cyl = 0;
+	irq_pending = 1;
+	return;
+  case FDC_SENSE & 0x1F:
+	res[0] = 0x20 | drive;
+	res[1] = cur_cyl;
+	res_len = 2;
+	return;
+  case FDC_SENSE_DRIVE & 0x1F:
+	res[0] = (wprot ? 0x40 : 0) | 0x20 | (head << 2) | drive;
+	res_len = 1;
+	return;
+  case FDC_READ_ID & 0x1F:
+	/* The next sector that passes. */
+	pos = fmod(now, ROTATION);
+	next = (int) ceil(pos / (ROTATION / SECTORS) - 1e-9);
+	now += next * (ROTATION / SECTORS) - pos + ROTATION / SECTORS;
+	res[0] = (head << 2) | drive;
+	res[1] = res[2] = 0;
+	res[3] = cur_cyl;
+	res[4] = head;
+	res[5] = next % SECTORS + 1;
+	res[6] = 2;
+	res_len = 7;
+	irq_pending = 1;
+	return;
+  case FDC_READ & 0x1F:
+  case FDC_WRITE & 0x1F:
+	n = (dma_count + 1) / SECTOR_SIZE;
+	if ((dor & (0x10 << drive)) == 0) {
+		fprintf(stderr, "transfer with the motor off\n");
+		exit(1);
+	}
+	if ((dma_count + 1) % SECTOR_SIZE != 0
+			|| (dma_addr & 0xFFFF) + dma_count + 1 > 0x10000) {
+		fprintf(stderr, "bad DMA: address 0x%lx, count %u\n",
+			dma_addr, dma_count + 1);
+		exit(1);
+	}
+	if ((c == (FDC_WRITE & 0x1F)) != (dma_mode == DMA_WRITE)) {
+		fprintf(stderr, "DMA in the wrong direction\n");
+		exit(1);
+	}
+	res[0] = (head << 2) | drive;
+	res[1] = res[2] = 0;
+	res[3] = cmd[2];
+	res[4] = cmd[3];
+	res[5] = cmd[4];
+	res[6] = 2;
+	res_len = 7;
+	irq_pending = 1;
+	if (cmd[2] != cur_cyl) {
+		/* Sector not found. */
+		res[0] |= 0x40;
+		res[1] = 0x04;
+		now += ROTATION;
+		return;
+	}
+	if (c == (FDC_WRITE & 0x1F) && wprot) {
+		res[0] |= 0x40;
+		res[1] = 0x02;
+		return;
+	}
+	if (cmd[4] - 1 + n > SECTORS) {
+		fprintf(stderr, "transfer past the end of the track\n");
+		exit(1);
+	}
+	wait_sector(cmd[4] - 1);
+	sector = ((long) cmd[2] * NR_HEADS + cmd[3]) * SECTORS + cmd[4] - 1;
+	if (c == (FDC_READ & 0x1F)) {
+		memcpy(mem + dma_addr, disk + sector * SECTOR_SIZE,
+			n * SECTOR_SIZE);
+		nr_read += n;
+	} else {
+		memcpy(disk + sector * SECTOR_SIZE, mem + dma_addr,
+			n * SECTOR_SIZE);
+		nr_written += n;
+	}
+	now += n * (ROTATION / SECTORS);
+	sector += n;
+	res[3] = sector / (NR_HEADS * SECTORS);
+	res[4] = sector / SECTORS % NR_HEADS;
+	res[5] = sector % SECTORS + 1;
+	return;
+  }
+  fprintf(stderr, "controller command 0x%02x not simulated\n", c);
+  exit(1);
+}
+
+PUBLIC void outb(port, value)
+int port;
+int value;
+{
+  value &= 0xFF;
+  switch (port) {
+  case DOR:
+	/* Leaving reset interrupts. */
+	if ((dor & ENABLE_INT) == 0 && (value & ENABLE_INT)) irq_pending = 1;
+	dor = value;
+	return;
+  case FDC_DATA:
+	if (cmd_len == 0) cmd_need = cmd_length(value);
+	cmd[cmd_len++] = value;
+	if (cmd_len == cmd_need) {
+		cmd_len = 0;
+		fdc_command();
+	}
+	return;
+  case DMA_MODE:
+	dma_mode = value;
+	return;
+  case DMA_FLIPFLOP:
+	dma_aflip = dma_cflip = 0;
+	return;
+  case DMA_ADDR:
+	if (dma_aflip++ == 0)
+		dma_addr = (dma_addr & ~0xFFL) | value;
+	else
+		dma_addr = (dma_addr & ~0xFF00L) | (value << 8);
+	return;
+  case DMA_TOP:
+	dma_addr = (dma_addr & 0xFFFF) | ((unsigned long) (value & 0xF) << 16);
+	return;
+  case DMA_COUNT:
+	if (dma_cflip++ == 0)
+		dma_count = (dma_count & 0xFF00) | value;
+	else
+		dma_count = (dma_count & 0xFF) | (value << 8);
+	return;
+  }
+}
+
+PUBLIC int inb(port)
+int port;
+{
+  if (port == FDC_STATUS) return res_next < res_len ? 0xD0 : 0x80;
+  if (port == FDC_DATA) return res[res_next++];
+  return 0;
+}
+
+
+/*===========================================================================*
+ *				The kernel				     *
+ *===========================================================================*/
+PUBLIC void lock() {}
+PUBLIC void unlock() {}
+PUBLIC void enable_irq(irq) int irq; {}
+PUBLIC void put_irq_handler(irq, handler) int irq; int (*handler)(); {}
+PUBLIC void partition(dp, device, style) struct driver *dp; int device, style; {}
+PUBLIC void driver_task(dp) struct driver *dp; {}
+
+PUBLIC void milli_start(msp)
+struct milli_state *msp;
+{
+  msp->ms_count = 0;
+}
+
+PUBLIC unsigned milli_elapsed(msp)
+struct milli_state *msp;
+{
+  return msp->ms_count++;
+}
+
+PUBLIC void interrupt(task)
+int task;
+{
+/* Stop_motor() tells the task it has a track cache to write back, or
+ * f_timeout() ends a wait for the FDC.  A task that waits for neither keeps
+ * the interrupt, and takes it for the FDC the next time it waits for one.
+ */
+
+  if (task != FLOPPY) return;
+  if ((task_proc.p_flags & RECEIVING) == 0 || (task_proc.p_getfrom != ANY
+				&& task_proc.p_getfrom != HARDWARE)) {
+	fprintf(stderr, "interrupt for a task that does not wait for it\n");
+	exit(1);
+  }
+  alarm_pending = irq_pending = 1;
+}
+
+PUBLIC int send(dst, m_ptr)
+int dst;
+message *m_ptr;
+{
+  return OK;
+}
+
+PUBLIC void clock_mess(ticks, func)
+int ticks;
+watchdog_t func;
+{
+  wd_func = func;
+  wd_time = now + ticks * 1000.0 / HZ;
+}
+
+PUBLIC int receive(src, m_ptr)
+int src;
+message *m_ptr;
+{
+  watchdog_t func;
+
+  if (src == CLOCK) {
+	/* The task waits for its own alarm. */
+	if (wd_time > now) now = wd_time;
+	wd_func = 0;
+	return OK;
+  }
+  alarm_pending = 0;
+  if (irq_pending) {
+	irq_pending = 0;
+	return OK;
+  }
+  if (wd_func != 0) {
+	/* Timeout. */
+	now = wd_time;
+	func = wd_func;
+	wd_func = 0;
+	task_proc.p_flags = RECEIVING;
+	task_proc.p_getfrom = src;
+	(*func)();
+	task_proc.p_flags = 0;
+	irq_pending = alarm_pending = 0;
+	return OK;
+  }
+  fprintf(stderr, "the driver waits for an interrupt that never comes\n");
+  exit(1);
+}
+
+PUBLIC phys_bytes numap(proc_nr, vir_addr, bytes)
+int proc_nr;
+vir_bytes vir_addr;
+vir_bytes bytes;
+{
+  return vir2phys(vir_addr);
+}
+
+PUBLIC void phys_copy(src, dst, bytes)
+phys_bytes src;
+phys_bytes dst;
+phys_bytes bytes;
+{
+  memmove(mem + dst, mem + src, bytes);
+}
+
+PUBLIC int do_nop(dp, m_ptr)
+struct driver *dp;
+message *m_ptr;
+{
+  return m_ptr->m_type == DEV_IOCTL ? ENOTTY : OK;
+}
+
+PUBLIC int do_diocntl(dp, m_ptr)
+struct driver *dp;
+message *m_ptr;
+{
+  return ENOTTY;
+}
+
+PUBLIC int do_rdwt(dp, m_ptr)
+struct driver *dp;
+message *m_ptr;
+{
+/* As in driver.c. */
+
+  struct iorequest_s ioreq;
+  int r;
+
+  if (m_ptr->COUNT <= 0) return(EINVAL);
+  if ((*dp->dr_prepare)(m_ptr->DEVICE) == NIL_DEV) return(ENXIO);
+
+  ioreq.io_request = m_ptr->m_type;
+  ioreq.io_buf = m_ptr->ADDRESS;
+  ioreq.io_position = m_ptr->POSITION;
+  ioreq.io_nbytes = m_ptr->COUNT;
+
+  r = (*dp->dr_schedule)(m_ptr->PROC_NR, &ioreq);
+  if (r == OK) (void) (*dp->dr_finish)();
+
+  r = ioreq.io_nbytes;
+  return(r < 0 ? r : m_ptr->COUNT - r);
+}
+
+
+/*===========================================================================*
+ *				The workloads				     *
+ *===========================================================================*/
+PRIVATE void fail(what, block)
+char *what;
+long block;
+{
+  printf("%s, block %ld\n", what, block);
+  exit(1);
+}
+
+PRIVATE void idle(ms)
+double ms;
+{
+/* The task waits for work for a while.  Alarms go off, and a floppy
+ * interrupt from stop_motor() makes driver_task() call dr_alarm.
+ */
+
+  double end = now + ms;
+  watchdog_t func;
+
+  while (wd_func != 0 && wd_time <= end) {
+	now = wd_time;
+	func = wd_func;
+	wd_func = 0;
+	task_proc.p_flags = RECEIVING;
+	task_proc.p_getfrom = ANY;
+	(*func)();
+	task_proc.p_flags = 0;
+	if (alarm_pending) {
+		alarm_pending = irq_pending = 0;
+		(*f_dtab.dr_alarm)(&f_dtab);
+	}
+  }
+  if (end > now) now = end;
+}
+
+PRIVATE void motor_timer()
+{
+/* FS sends a request just as the motor timer goes off.  The clock task runs
+ * stop_motor() when the floppy task has the request, but has not yet started
+ * on it.
+ */
+
+  watchdog_t func;
+
+  if (wd_func == 0) fail("no motor timer", 0L);
+  now = wd_time;
+  func = wd_func;
+  wd_func = 0;
+  (*func)();
+}
+
+PRIVATE int dev_io(opcode, block)
+int opcode;
+long block;
+{
+/* A request from FS, as driver_task() would handle it.  Opcode is
+ * DEV_READ, DEV_WRITE, DEV_OPEN or DEV_CLOSE.
+ */
+
+  message m;
+  int r;
+
+  m.m_type = opcode;
+  m.m_source = 1;
+  m.DEVICE = TEST_DEV;
+  m.PROC_NR = 1;
+  m.POSITION = block * 1024;
+  m.ADDRESS = (char *) ubuf;
+  m.COUNT = 1024;
+  switch (opcode) {
+  case DEV_OPEN:	r = (*f_dtab.dr_open)(&f_dtab, &m);	break;
+  case DEV_CLOSE:	r = (*f_dtab.dr_close)(&f_dtab, &m);	break;
+  default:		r = do_rdwt(&f_dtab, &m);
+  }
+  (*f_dtab.dr_cleanup)();
+  idle(think);
+  return r;
+}
+
+PRIVATE void dev_call(opcode, block)
+int opcode;
+long block;
+{
+  int r;
+
+  r = dev_io(opcode, block);
+  if (opcode == DEV_READ || opcode == DEV_WRITE ? r != 1024 : r != OK)
+	fail("request failed", block);
+}
+
+PRIVATE int read_ahead(block, n)
+long block;
+int n;
+{
+/* Read a block and up to n-1 more as FS does, with the ones after the
+ * first optional.  Return how many were read.
+ */
+
+  struct iorequest_s iov[RA_BLOCKS];
+  int i, r = OK;
+
+  if (n > NR_BLOCKS - block) n = NR_BLOCKS - block;
+  for (i = 0; i < n; i++) {
+	iov[i].io_position = (block + i) * 1024;
+	iov[i].io_buf = (char *) ubuf + i * 1024;
+	iov[i].io_nbytes = 1024;
+	iov[i].io_request = DEV_READ | (i == 0 ? 0 : OPTIONAL_IO);
+  }
+
+  /* As do_vrdwt() in driver.c. */
+  if ((*f_dtab.dr_prepare)(TEST_DEV) == NIL_DEV) fail("no device", block);
+  for (i = 0; i < n; i++) {
+	if ((r = (*f_dtab.dr_schedule)(1, &iov[i])) != OK) break;
+  }
+  if (r == OK) (void) (*f_dtab.dr_finish)();
+  (*f_dtab.dr_cleanup)();
+  idle(think);
+
+  for (i = 0; i < n && iov[i].io_nbytes == 0; i++) {
+	if (memcmp(ubuf + i * 1024, shadow + (block + i) * 1024, 1024) != 0)
+		fail("read ahead data differs", block + i);
+  }
+  if (i == 0) fail("read ahead failed", block);
+  return i;
+}
+
+PRIVATE void write_block(block, fill)
+long block;
+int fill;
+{
+  memset(ubuf, fill, 1024);
+  memcpy(shadow + block * 1024, ubuf, 1024);
+  dev_call(DEV_WRITE, block);
+}
+
+PRIVATE void read_block(block)
+long block;
+{
+  dev_call(DEV_READ, block);
+  if (memcmp(ubuf, shadow + block * 1024, 1024) != 0)
+	fail("read data differs", block);
+}
+
+PRIVATE void on_disk(what)
+char *what;
+{
+/* The motor is off, the diskette must hold all that was written. */
+
+  long i;
+
+  for (i = 0; i < DISK_SIZE; i += 1024) {
+	if (memcmp(disk + i, shadow + i, 1024) != 0) fail(what, i / 1024);
+  }
+}
+
+PRIVATE void report(what, start)
+char *what;
+double start;
+{
+  printf("%-32s %6.1f s %5ld seeks %5ld cmds %5ld read %5ld written\n",
+	what, (now - start) / 1000, nr_seeks, nr_cmds, nr_read, nr_written);
+  nr_seeks = nr_cmds = nr_read = nr_written = 0;
+}
+
+
+/*===========================================================================*
+ *				main					     *
+ *===========================================================================*/
+int main(argc, argv)
+int argc;
+char **argv;
+{
+  u8_t *space;
+  unsigned long seed = 1;
+  long block, i, written;
+  int span;
+  double start;
+  char what[64];
+
+  if (argc > 1) think = atof(argv[1]);
+  setbuf(stdout, NULL);
+
+  /* Memory starts on a 1M boundary, so that a host address and its offset
+   * in mem[] are the same modulo 64K.
+   */
+  if ((space = malloc(2 * MEM_SIZE)) == NULL) {
+	fprintf(stderr, "out of memory\n");
+	exit(1);
+  }
+  mem = space + (MEM_SIZE - (phys_bytes) space % MEM_SIZE);
+  tmp_buf = mem + 0x1000;
+  tmp_phys = vir2phys(tmp_buf);
+  track_buf = mem + 0x10000 - 0x1200;	/* across a 64K boundary */
+  track_phys = vir2phys(track_buf);
+  ubuf = mem + 0x20000;
+
+  for (i = 0; i < DISK_SIZE; i++) disk[i] = (u8_t) (i * 7 + i / SECTOR_SIZE);
+  memcpy(shadow, disk, DISK_SIZE);
+
+  printf("floppy driver, TRACK_SECTORS %d, %.0f ms between requests\n",
+	TRACK_SECTORS, think);
+  floppy_task();
+  dev_call(DEV_OPEN, 0L);
+
+  /* Readall: long reads that FS turns into read-ahead. */
+  start = now;
+  for (block = 0; block < NR_BLOCKS; block += read_ahead(block, RA_BLOCKS)) {}
+  idle(IDLE);
+  report("readall, FS read-ahead", start);
+
+  /* Reads of single blocks, like a raw device. */
+  start = now;
+  for (block = 0; block < NR_BLOCKS; block++) read_block(block);
+  idle(IDLE);
+  report("1K reads, no read-ahead", start);
+
+  /* Copying a file: data blocks, with the inode and the bitmap written
+   * every few blocks.
+   */
+  start = now;
+  for (block = 100; block < 300; block++) {
+	write_block(block, (int) block);
+	if (block % 8 == 0) {
+		write_block(2L, (int) block + 1);
+		write_block(5L, (int) block + 2);
+	}
+  }
+  dev_call(DEV_CLOSE, 0L);
+  idle(IDLE);
+  report("file copy with inode/bitmap", start);
+  on_disk("file copy not on the diskette");
+  dev_call(DEV_OPEN, 0L);
+
+  /* Random reads and writes in one and in four cylinders.  Every 100
+   * requests the motor is allowed to stop.
+   */
+  for (span = 9; span <= 36; span *= 4) {
+	start = now;
+	for (i = 0; i < 400; i++) {
+		seed = seed * 1103515245 + 12345;
+		block = 198 + (seed >> 16) % span;
+		if ((seed >> 8) & 1)
+			write_block(block, (int) i);
+		else
+			read_block(block);
+		if (i % 100 == 99) {
+			idle(IDLE);
+			on_disk("not written back when the motor stopped");
+		}
+	}
+	sprintf(what, "random r/w in %d cylinder%s", span / 9,
+		span == 9 ? "" : "s");
+	report(what, start);
+  }
+
+  /* Write back when the motor stops, without a close: nine blocks that
+   * fill cylinder 45.
+   */
+  start = now;
+  for (block = 405; block < 414; block++) write_block(block, (int) block);
+  written = nr_written;
+  idle(IDLE);
+  on_disk("not written back when the motor stopped");
+  written = nr_written - written;
+  report("9 writes in one cylinder", start);
+  printf("  %ld sectors written when the motor stopped\n", written);
+
+  /* A request that comes in as the motor timer goes off finds the motor
+   * still running, and its tracks still cached.
+   */
+  start = now;
+  for (block = 500; block < 504; block++) write_block(block, (int) block);
+  idle(MOTOR_OFF * 1000.0 / HZ - 1 - think);
+  motor_timer();
+  read_block(600L);
+  written = nr_written;
+  idle(IDLE);
+  on_disk("not written back after a late request");
+  written = nr_written - written;
+  report("request as the motor stops", start);
+  printf("  %ld sectors written when the motor stopped\n", written);
+
+  /* A write to a write protected diskette must fail at once. */
+  wprot = 1;
+  if (dev_io(DEV_WRITE, 0L) != EIO) fail("write protect not noticed", 0L);
+  idle(IDLE);
+  on_disk("written while write protected");
+
+  printf("all data verified\n");
+  return 0;
+}
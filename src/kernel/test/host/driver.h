@@ -0,0 +1,57 @@
+/* Stand-in for driver.h, see kernel.h.  Driver.c is not used, floppytest.c
+ * has its own do_rdwt() and friends.
+ */
+
+struct device {
+  unsigned long dv_base;
+  unsigned long dv_size;
+};
+#define NIL_DEV		((struct device *) 0)
+
+struct driver {
+  char *(*dr_name)(void);
+  int (*dr_open)(struct driver *dp, message *m_ptr);
+  int (*dr_close)(struct driver *dp, message *m_ptr);
+  int (*dr_ioctl)(struct driver *dp, message *m_ptr);
+  struct device *(*dr_prepare)(int device);
+  int (*dr_schedule)(int proc_nr, struct iorequest_s *request);
+  int (*dr_finish)(void);
+  void (*dr_cleanup)(void);
+  void (*dr_geometry)(struct partition *entry);
+  void (*dr_alarm)(struct driver *dp);
+};
+
+#define dma_bytes_left(phys)	\
+	((unsigned) 0x10000 - (unsigned) ((phys) & 0xFFFF))
+
+/* What stop_motor() looks at of the task, from "proc.h". */
+struct proc {
+  int p_flags;
+  int p_getfrom;
+};
+#define SENDING		004
+#define RECEIVING	010
+#define ANY		200
+#define proc_addr(n)	(&task_proc)
+
+extern struct proc task_proc;
+
+void driver_task(struct driver *dp);
+int do_rdwt(struct driver *dp, message *m_ptr);
+int do_nop(struct driver *dp, message *m_ptr);
+int do_diocntl(struct driver *dp, message *m_ptr);
+void clock_mess(int ticks, watchdog_t func);
+
+#define SECTOR_SIZE	512
+#define SECTOR_SHIFT	9
+#define SECTOR_MASK	511
+
+extern u8_t *tmp_buf;
+extern phys_bytes tmp_phys;
+
+#if TRACK_SECTORS > 0
+#define TRACK_BUF_SIZE	(TRACK_SECTORS * SECTOR_SIZE)
+
+extern u8_t *track_buf;
+extern phys_bytes track_phys;
+#endif
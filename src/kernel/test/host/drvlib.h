@@ -0,0 +1,3 @@
+/* Stand-in for drvlib.h, see kernel.h. */
+
+void partition(struct driver *dp, int device, int style);
@@ -0,0 +1 @@
+../../floppy.c
\ No newline at end of file
@@ -0,0 +1,3 @@
+/* The real <ibm/diskparm.h>, see ../kernel.h. */
+
+#include "../../../../../include/ibm/diskparm.h"
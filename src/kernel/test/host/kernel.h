@@ -0,0 +1,106 @@
+/* Stand-in for the kernel headers, to compile floppy.c on the host for
+ * floppytest.c.  Only what floppy.c uses is here.  A physical address is an
+ * offset in the simulated memory, mem[].  The port I/O and the kernel calls
+ * are in floppytest.c.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#ifndef TRACK_SECTORS
+#define TRACK_SECTORS	18	/* as in <minix/config.h> */
+#endif
+
+#define PUBLIC
+#define PRIVATE		static
+#define FORWARD		static
+#define _PROTOTYPE(f, a)	f a
+#define TRUE		1
+#define FALSE		0
+#define NIL_PTR		((char *) 0)
+#define NO_NUM		0
+#define HZ		60
+#define BLOCK_SIZE	1024
+
+/* Error numbers are negative in the kernel. */
+#undef EIO
+#define EIO		(-5)
+#undef ENXIO
+#define ENXIO		(-6)
+#undef EAGAIN
+#define EAGAIN		(-11)
+#undef EINVAL
+#define EINVAL		(-22)
+#undef ENOTTY
+#define ENOTTY		(-25)
+#define OK		0
+
+typedef unsigned char u8_t;
+typedef unsigned long phys_bytes;
+typedef unsigned long vir_bytes;
+typedef void (*watchdog_t)(void);
+
+typedef struct {
+  int m_source;
+  int m_type;
+  int DEVICE;
+  int PROC_NR;
+  int COUNT;
+  long POSITION;
+  char *ADDRESS;
+} message;
+#define REQUEST		COUNT
+
+#define DEV_READ	3
+#define DEV_WRITE	4
+#define DEV_IOCTL	5
+#define DEV_OPEN	6
+#define DEV_CLOSE	7
+#define OPTIONAL_IO	16
+
+struct iorequest_s {
+  long io_position;
+  char *io_buf;
+  int io_nbytes;
+  unsigned short io_request;
+};
+
+struct partition {
+  unsigned long base;
+  unsigned long size;
+  unsigned cylinders;
+  unsigned heads;
+  unsigned sectors;
+};
+
+#define NR_PARTITIONS	4
+#define MINOR_fd0a	(28 << 2)
+#define P_FLOPPY	0
+#define HARDWARE	(-1)
+#define CLOCK		(-3)
+#define FLOPPY		(-5)
+#define FLOPPY_IRQ	6
+
+struct milli_state { long ms_count; };
+
+extern int pc_at;
+extern u8_t *mem;
+
+#define vir2phys(vir)	((phys_bytes) ((u8_t *) (vir) - mem))
+#define panic(mess, nr)	(fprintf(stderr, "panic: %s\n", mess), exit(1))
+
+void outb(int port, int value);
+int inb(int port);
+void lock(void);
+void unlock(void);
+void milli_start(struct milli_state *msp);
+unsigned milli_elapsed(struct milli_state *msp);
+void enable_irq(int irq);
+void put_irq_handler(int irq, int (*handler)(int irq));
+void interrupt(int task);
+int receive(int src, message *m_ptr);
+int send(int dst, message *m_ptr);
+phys_bytes numap(int proc_nr, vir_bytes vir_addr, vir_bytes bytes);
+void phys_copy(phys_bytes src, phys_bytes dst, phys_bytes bytes);
@@ -0,0 +1,5 @@
+/* Stand-in for <sys/ioctl.h>, see ../kernel.h. */
+
+#define DIOCSETP	1
+#define DIOCGETP	2
+#define DIOCFLUSH	3
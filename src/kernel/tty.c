@@ -350,6 +350,7 @@ message *m_ptr;			/* pointer to message sent to task */
 	struct sgttyb sg;
 	struct tchars tc;
 #endif
+	struct serstat ss;
   } param;
   phys_bytes user_phys;
   size_t size;
@@ -376,6 +377,10 @@ message *m_ptr;			/* pointer to message sent to task */
         size = sizeof(struct winsize);
         break;
 
+    case TIOCGSERSTAT:	/* get serial line statistics (Minix extension) */
+	size = sizeof(struct serstat);
+	break;
+
 #if ENABLE_SRCCOMPAT
     case TIOCGETP:      /* BSD-style get terminal properties */
     case TIOCSETP:	/* BSD-style set terminal properties */
@@ -479,6 +484,15 @@ message *m_ptr;			/* pointer to message sent to task */
 	/* SIGWINCH... */
 	break;
 
+    case TIOCGSERSTAT:
+	if (tp->tty_serstat == NULL) {
+		r = ENOTTY;
+		break;
+	}
+	(*tp->tty_serstat)(tp, &param.ss);
+	phys_copy(vir2phys(&param.ss), user_phys, (phys_bytes) size);
+	break;
+
 #if ENABLE_SRCCOMPAT
     case TIOCGETP:
 	compat_getp(tp, &param.sg);
@@ -746,10 +760,45 @@ int count;			/* number of input characters */
  * the number of characters processed.
  */
 
-  int ch, sig, ct;
+  int ch, sig, ct, n;
+  u16_t *inp;
   int timeset = FALSE;
   static unsigned char csize_mask[] = { 0x1F, 0x3F, 0x7F, 0xFF };
 
+  if (tp->tty_transparent) {
+	/* Raw input without echo or special characters.  Copy the bytes into
+	 * the input queue as runs up to the end of the circular buffer.
+	 */
+	ct = 0;
+	while (ct < count && tp->tty_incount < buflen(tp->tty_inbuf)) {
+		if (!timeset && tp->tty_termios.c_cc[VMIN] > 0
+				&& tp->tty_termios.c_cc[VTIME] > 0) {
+			lock();
+			settimer(tp, TRUE);
+			unlock();
+			timeset = TRUE;
+		}
+		n = count - ct;
+		if (n > buflen(tp->tty_inbuf) - tp->tty_incount)
+			n = buflen(tp->tty_inbuf) - tp->tty_incount;
+		if (n > bufend(tp->tty_inbuf) - tp->tty_inhead)
+			n = bufend(tp->tty_inbuf) - tp->tty_inhead;
+		ct += n;
+		tp->tty_incount += n;
+		tp->tty_eotct += n;
+		inp = tp->tty_inhead;
+		do {
+			*inp++ = (*buf++ & BYTE) | IN_EOT;
+		} while (--n > 0);
+		if (inp == bufend(tp->tty_inbuf)) inp = tp->tty_inbuf;
+		tp->tty_inhead = inp;
+
+		/* Try to finish input if the queue is full. */
+		if (tp->tty_incount == buflen(tp->tty_inbuf)) in_transfer(tp);
+	}
+	return ct;
+  }
+
   for (ct = 0; ct < count; ct++) {
 	/* Take one character. */
 	ch = *buf++ & BYTE;
@@ -1204,6 +1253,13 @@ tty_t *tp;
 	tp->tty_events = 1;
   }
 
+  /* Can in_process() store input as is?  Only if no input character is
+   * special, mapped or echoed.
+   */
+  tp->tty_transparent =
+	!(tp->tty_termios.c_lflag & (ICANON|IEXTEN|ISIG|ECHO|ECHONL))
+	&& !(tp->tty_termios.c_iflag & (ISTRIP|IGNCR|ICRNL|INLCR|IXON));
+
   /* Setting the output speed to zero hangs up the phone. */
   if (tp->tty_termios.c_ospeed == B0) sigchar(tp, SIGHUP);
 
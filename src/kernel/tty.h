@@ -39,6 +39,7 @@ typedef struct tty {
   char tty_inhibited;		/* 1 when STOP (^S) just seen (stops output) */
   char tty_pgrp;		/* slot number of controlling process */
   char tty_openct;		/* count of number of opens of this tty */
+  char tty_transparent;		/* 1 if input needs no processing, else 0 */
 
   /* Information about incomplete I/O requests is stored here. */
   char tty_inrepcode;		/* reply code, TASK_REPLY or REVIVE */
@@ -61,6 +62,8 @@ typedef struct tty {
   /* Miscellaneous. */
   devfun_t tty_ioctl;		/* set line speed, etc. at the device level */
   devfun_t tty_close;		/* tell the device that the tty is closed */
+  _PROTOTYPE( void (*tty_serstat), (struct tty *tp, struct serstat *ssp) );
+				/* report serial line error counts */
   void *tty_priv;		/* pointer to per device private data */
   struct termios tty_termios;	/* terminal attributes */
   struct winsize tty_winsize;	/* window size (#lines and #columns) */
@@ -26,90 +26,247 @@
 #endif
 #define	PTRSIZE		((int) sizeof(void *))
 #define Align(x,a)	(((x) + (a - 1)) & ~(a - 1))
-#define NextSlot(p)	(* (void **) ((p) - PTRSIZE))
-#define NextFree(p)	(* (void **) (p))
+
+#define	INUSE		1		/* block is allocated */
+#define	PINUSE		2		/* block before it is allocated */
+#define	FLAGS		(INUSE | PINUSE)
+#define	BINSTEP		(2 * PTRSIZE)	/* block sizes are a multiple */
+#define	MINBLOCK	(4 * PTRSIZE)	/* header, two links, footer */
+#define	NSMALL		32		/* exact fit bins */
+#define	NBINS		(NSMALL + 8 * PTRSIZE)	/* and doubling ones */
+
+#define Hdr(b)		(* (unsigned ptrint *) (b))
+#define Size(b)		((size_t) (Hdr(b) & ~FLAGS))
+#define Foot(b,n)	(* (unsigned ptrint *) ((b) + (n) - PTRSIZE))
+#define PrevSize(b)	((size_t) * (unsigned ptrint *) ((b) - PTRSIZE))
+#define NextFree(b)	(* (char **) ((b) + PTRSIZE))
+#define PrevFree(b)	(* (char **) ((b) + 2 * PTRSIZE))
+#define Mem(b)		((void *) ((b) + PTRSIZE))
+#define Block(p)	((char *) (p) - PTRSIZE)
 
 /*
  * A short explanation of the data structure and algorithms.
- * An area returned by malloc() is called a slot. Each slot
- * contains the number of bytes requested, but preceeded by
- * an extra pointer to the next the slot in memory.
- * '_bottom' and '_top' point to the first/last slot.
+ * The heap is a row of blocks from '_bottom' up to '_top'.
+ * Each block starts with a header word that holds its size
+ * and two flags: whether the block is in use, and whether
+ * the block before it is.  An area returned by malloc() is
+ * the rest of an allocated block.  '_top' is a header of
+ * size zero that is always in use, it ends the row.
  * More memory is asked for using brk() and appended to top.
- * The list of free slots is maintained to keep malloc() fast.
- * '_empty' points the the first free slot. Free slots are
- * linked together by a pointer at the start of the
- * user visable part, so just after the next-slot pointer.
- * Free slots are merged together by free().
+ *
+ * A free block has a doubly linked list pointer pair just
+ * after the header, and a copy of its size in its last word
+ * (a boundary tag), so free() can find the block before
+ * and merge with both neighbours without searching.  Free
+ * blocks are kept in bins by size: one bin for each size
+ * below NSMALL * BINSTEP, and bins for each doubling of the
+ * size above that, kept sorted so that the first block
+ * that fits is also the best fit in its bin.  'binmap' has
+ * a bit for each small bin that is not empty.
  */
 
 extern void *_sbrk(int);
 extern int _brk(void *);
-static void *_bottom, *_top, *_empty;
+static void *_bottom, *_top;
+static char *bin[NBINS];
+static unsigned long binmap;
 
-static int grow(size_t len)
+static int binof(size_t n)
+{
+/* The bin for blocks of 'n' bytes. */
+  register int i;
+  register size_t m;
+
+  if (n < NSMALL * BINSTEP)
+	return (int) (n / BINSTEP);
+  for (i = NSMALL, m = NSMALL * BINSTEP * 2;
+		m != 0 && n >= m && i < NBINS - 1; i++, m <<= 1) {
+  }
+  return i;
+}
+
+static void addfree(register char *b)
+{
+/* Put free block 'b' in its bin. */
+  register char *p, *prev;
+  size_t n = Size(b);
+  int i = binof(n);
+
+  prev = 0;
+  p = bin[i];
+  if (i < NSMALL) {
+	binmap |= (unsigned long) 1 << i;
+  } else {
+	while (p != 0 && Size(p) < n) {
+		prev = p;
+		p = NextFree(p);
+	}
+  }
+  NextFree(b) = p;
+  PrevFree(b) = prev;
+  if (p != 0)
+	PrevFree(p) = b;
+  if (prev != 0)
+	NextFree(prev) = b;
+  else
+	bin[i] = b;
+}
+
+static void delfree(register char *b)
+{
+/* Take free block 'b' out of its bin. */
+  register char *next = NextFree(b), *prev = PrevFree(b);
+  int i;
+
+  if (next != 0)
+	PrevFree(next) = prev;
+  if (prev != 0) {
+	NextFree(prev) = next;
+  } else {
+	i = binof(Size(b));
+	bin[i] = next;
+	if (next == 0 && i < NSMALL)
+		binmap &= ~((unsigned long) 1 << i);
+  }
+}
+
+static void release(register char *b, register size_t n)
 {
+/* Make the 'n' bytes at 'b' a free block, merged with free neighbours.
+ * The header of 'b' must still tell whether the block before is in use.
+ */
+  register char *next = b + n;
+
+  if (!(Hdr(next) & INUSE)) {
+	delfree(next);
+	n += Size(next);
+  }
+  if (!(Hdr(b) & PINUSE)) {
+	b -= PrevSize(b);
+	delfree(b);
+	n += Size(b);
+  }
+  Hdr(b) = n | PINUSE;
+  Foot(b, n) = n;
+  Hdr(b + n) &= ~PINUSE;
+  addfree(b);
+}
+
+static void split(register char *b, size_t len)
+{
+/* Keep the first 'len' bytes of block 'b' in use, free the rest if that
+ * can be a block of its own.
+ */
+  register size_t n = Size(b);
+
+  if (n - len < MINBLOCK) {
+	Hdr(b) |= INUSE;
+	Hdr(b + n) |= PINUSE;
+	return;
+  }
+  Hdr(b) = len | INUSE | (Hdr(b) & PINUSE);
+  Hdr(b + len) = PINUSE;
+  release(b + len, n - len);
+}
+
+static char *find(size_t len)
+{
+/* Take the smallest free block of at least 'len' bytes out of the bins. */
   register char *p;
+  register unsigned long bits;
+  register int i;
+
+  i = binof(len);
+  if (i < NSMALL) {
+	if ((bits = binmap >> i) != 0) {
+		while (!(bits & 1)) {
+			bits >>= 1;
+			i++;
+		}
+		p = bin[i];
+		delfree(p);
+		return p;
+	}
+	i = NSMALL;
+  }
+  for (; i < NBINS; i++) {
+	for (p = bin[i]; p != 0; p = NextFree(p)) {
+		if (Size(p) >= len) {
+			delfree(p);
+			return p;
+		}
+	}
+  }
+  return 0;
+}
+
+static int grow(size_t len)
+{
+  register char *p, *b;
 
-  assert(NextSlot((char *)_top) == 0);
-  if ((char *) _top + len < (char *) _top
-      || (p = (char *)Align((ptrint)_top + len, BRKSIZE)) < (char *) _top ) {
+  if (_top == 0) {
+	if ((p = _sbrk(2 * PTRSIZE)) == (char *) -1)
+		return(0);
+	p = (char *) Align((ptrint)p, PTRSIZE);
+	_top = _bottom = p;
+	Hdr(p) = INUSE | PINUSE;
+  }
+  b = _top;
+  if (b + len + PTRSIZE < b
+      || (p = (char *)Align((ptrint)b + len + PTRSIZE, BRKSIZE)) < b) {
 	errno = ENOMEM;
 	return(0);
   }
   if (_brk(p) != 0)
 	return(0);
-  NextSlot((char *)_top) = p;
-  NextSlot(p) = 0;
-  free(_top);
+
+  /* The old end becomes a free block, a new end is put behind it. */
+  p = b + ((size_t) (p - PTRSIZE - b) & ~(BINSTEP - 1));
+  Hdr(p) = INUSE;
   _top = p;
+  release(b, (size_t) (p - b));
   return 1;
 }
 
+#ifdef SLOWDEBUG
+static void check(void)
+{
+  register char *p, *next;
+
+  for (p = _bottom; p != _top; p = next) {
+	next = p + Size(p);
+	assert(next > p && Size(p) % BINSTEP == 0);
+	assert(!(Hdr(p) & INUSE) == !(Hdr(next) & PINUSE));
+	assert((Hdr(p) & INUSE) || Foot(p, Size(p)) == Size(p));
+	assert((Hdr(p) & INUSE) || (Hdr(next) & INUSE));
+  }
+}
+#endif
+
 void *
 malloc(size_t size)
 {
-  register char *prev, *p, *next, *new;
-  register unsigned len, ntries;
+  register char *p;
+  register size_t len;
+  register unsigned ntries;
 
   if (size == 0)
 	return NULL;
 
-  for (ntries = 0; ntries < 2; ntries++) {
-	if ((len = Align(size, PTRSIZE) + PTRSIZE) < 2 * PTRSIZE) {
-		errno = ENOMEM;
-		return NULL;
-	}
-	if (_bottom == 0) {
-		if ((p = _sbrk(2 * PTRSIZE)) == (char *) -1)
-			return NULL;
-		p = (char *) Align((ptrint)p, PTRSIZE);
-		p += PTRSIZE;
-		_top = _bottom = p;
-		NextSlot(p) = 0;
-	}
+  if ((len = Align(size + PTRSIZE, BINSTEP)) < size) {
+	errno = ENOMEM;
+	return NULL;
+  }
+  if (len < MINBLOCK)
+	len = MINBLOCK;
 #ifdef SLOWDEBUG
-	for (p = _bottom; (next = NextSlot(p)) != 0; p = next)
-		assert(next > p);
-	assert(p == _top);
+  if (_top != 0)
+	check();
 #endif
-	for (prev = 0, p = _empty; p != 0; prev = p, p = NextFree(p)) {
-		next = NextSlot(p);
-		new = p + len;	/* easily overflows!! */
-		if (new > next || new <= p)
-			continue;		/* too small */
-		if (new + PTRSIZE < next) {	/* too big, so split */
-			/* + PTRSIZE avoids tiny slots on free list */
-			NextSlot(new) = next;
-			NextSlot(p) = new;
-			NextFree(new) = NextFree(p);
-			NextFree(p) = new;
-		}
-		if (prev)
-			NextFree(prev) = NextFree(p);
-		else
-			_empty = NextFree(p);
-		return p;
+  for (ntries = 0; ntries < 2; ntries++) {
+	if ((p = find(len)) != 0) {
+		split(p, len);
+		return Mem(p);
 	}
 	if (grow(len) == 0)
 		break;
@@ -121,85 +278,56 @@ malloc(size_t size)
 void *
 realloc(void *oldp, size_t size)
 {
-  register char *prev, *p, *next, *new;
-  char *old = oldp;
+  register char *b, *next, *new;
   register size_t len, n;
 
-  if (old == 0)
+  if (oldp == 0)
 	return malloc(size);
   if (size == 0) {
-	free(old);
+	free(oldp);
 	return NULL;
   }
-  len = Align(size, PTRSIZE) + PTRSIZE;
-  next = NextSlot(old);
-  n = (int)(next - old);			/* old length */
+  if ((len = Align(size + PTRSIZE, BINSTEP)) < size) {
+	errno = ENOMEM;
+	return NULL;
+  }
+  if (len < MINBLOCK)
+	len = MINBLOCK;
+  b = Block(oldp);
+  assert(Hdr(b) & INUSE);
+  n = Size(b);				/* old length */
   /*
-   * extend old if there is any free space just behind it
+   * extend old if there is a free block just behind it
    */
-  for (prev = 0, p = _empty; p != 0; prev = p, p = NextFree(p)) {
-	if (p > next)
-		break;
-	if (p == next) {	/* 'next' is a free slot: merge */
-		NextSlot(old) = NextSlot(p);
-		if (prev)
-			NextFree(prev) = NextFree(p);
-		else
-			_empty = NextFree(p);
-		next = NextSlot(old);
-		break;
-	}
+  next = b + n;
+  if (n < len && !(Hdr(next) & INUSE) && n + Size(next) >= len) {
+	delfree(next);
+	n += Size(next);
+	Hdr(b) = n | INUSE | (Hdr(b) & PINUSE);
   }
-  new = old + len;
   /*
-   * Can we use the old, possibly extended slot?
+   * Can we use the old, possibly extended block?
    */
-  if (new <= next && new >= old) {		/* it does fit */
-	if (new + PTRSIZE < next) {		/* too big, so split */
-		/* + PTRSIZE avoids tiny slots on free list */
-		NextSlot(new) = next;
-		NextSlot(old) = new;
-		free(new);
-	}
-	return old;
+  if (n >= len) {
+	split(b, len);
+	return oldp;
   }
-  if ((new = malloc(size)) == NULL)		/* it didn't fit */
+  if ((new = malloc(size)) == NULL)	/* it didn't fit */
 	return NULL;
-  memcpy(new, old, n);				/* n < size */
-  free(old);
+  memcpy(new, oldp, n - PTRSIZE);	/* n - PTRSIZE < size */
+  free(oldp);
   return new;
 }
 
 void
 free(void *ptr)
 {
-  register char *prev, *next;
-  char *p = ptr;
+  register char *b;
 
-  if (p == 0)
+  if (ptr == 0)
 	return;
 
-  assert(NextSlot(p) > p);
-  for (prev = 0, next = _empty; next != 0; prev = next, next = NextFree(next))
-	if (p < next)
-		break;
-  NextFree(p) = next;
-  if (prev)
-	NextFree(prev) = p;
-  else
-	_empty = p;
-  if (next) {
-	assert(NextSlot(p) <= next);
-	if (NextSlot(p) == next) {		/* merge p and next */
-		NextSlot(p) = NextSlot(next);
-		NextFree(p) = NextFree(next);
-	}
-  }
-  if (prev) {
-	assert(NextSlot(prev) <= p);
-	if (NextSlot(prev) == p) {		/* merge prev and p */
-		NextSlot(prev) = NextSlot(p);
-		NextFree(prev) = NextFree(p);
-	}
-  }
+  b = Block(ptr);
+  assert(Hdr(b) & INUSE);
+  release(b, Size(b));
 }
@@ -5,15 +5,80 @@
 /* $Header: strstr.c,v 1.3 90/08/28 13:54:28 eck Exp $ */
 
 #include	<string.h>
+#include	<limits.h>
+
+/* The string is searched a window at a time, so that a match near its
+ * start is found without first running to its end.  A window holds every
+ * place a match can start in the next WINDOW bytes, and the end of the
+ * string is only looked for as far as that window reaches.
+ */
+#define WINDOW		1024
+
+void *_memmem(const void *hay, size_t hlen, const void *pat, size_t plen);
 
 char *
 strstr(register const char *s, register const char *wanted)
 {
 	register const size_t len = strlen(wanted);
+	size_t step;
+	const char *end, *found;
 
 	if (len == 0) return (char *)s;
-	while (*s != *wanted || strncmp(s, wanted, len))
-		if (*s++ == '\0')
-			return (char *)NULL;
-	return (char *)s;
+	if (len == 1) return strchr(s, *wanted);
+
+	step = len < WINDOW ? WINDOW : len;
+	for (;;) {
+		if ((end = memchr(s, '\0', step + len - 1)) != NULL)
+			return (char *)_memmem(s, (size_t)(end - s), wanted, len);
+		if ((found = _memmem(s, step + len - 1, wanted, len)) != NULL)
+			return (char *)found;
+		s += step;
+	}
+}
+
+/* Find 'pat' in 'hay' with the Boyer-Moore-Horspool algorithm.  The last
+ * byte of each window is looked at first, on a mismatch the window is
+ * shifted until that byte meets its last occurrence in the pattern.  With
+ * short patterns or little to search, building the shift table costs more
+ * than it saves, so memchr() looks for the first byte instead.
+ */
+void *
+_memmem(const void *hay, size_t hlen, const void *pat, size_t plen)
+{
+	register const unsigned char *h = hay;
+	register const unsigned char *p = pat;
+	register size_t i, n;
+	const unsigned char *end;
+	unsigned char skip[UCHAR_MAX + 1];
+	unsigned char c, last;
+
+	if (plen == 0) return (void *)h;
+	if (plen > hlen) return NULL;
+	n = hlen - plen;		/* last window */
+
+	if (plen < 3 || n <= UCHAR_MAX) {
+		end = h + n;
+		while ((h = memchr(h, *p, (size_t)(end - h) + 1)) != NULL) {
+			if (memcmp(h + 1, p + 1, plen - 1) == 0)
+				return (void *)h;
+			if (h++ == end) break;
+		}
+		return NULL;
+	}
+
+	/* Shifts longer than UCHAR_MAX are cut short, that's still safe. */
+	memset(skip, plen < UCHAR_MAX ? (int)plen : UCHAR_MAX, sizeof(skip));
+	for (i = plen > UCHAR_MAX ? plen - UCHAR_MAX : 0; i < plen - 1; i++)
+		skip[p[i]] = plen - 1 - i;
+	last = p[plen - 1];
+
+	i = 0;
+	for (;;) {
+		c = h[i + plen - 1];
+		if (c == last && memcmp(h + i, p, plen - 1) == 0)
+			return (void *)(h + i);
+		if (skip[c] > n - i) break;
+		i += skip[c];
+	}
+	return NULL;
 }
@@ -13,7 +13,7 @@ int LINES, COLS;
 bool NONL;
 
 char termcap[1024];		/* termcap buffer */
-char tc[200];			/* area to hold string capabilities */
+char tc[400];			/* area to hold string capabilities */
 char *ttytype;			/* terminal type from env */
 char *arp;			/* pointer for use in tgetstr */
 char *cp;			/* character pointer */
@@ -35,6 +35,18 @@ char *as;			/* alternative charset start */
 char *ae;			/* alternative charset end */
 char *bl;			/* ring the bell */
 char *vb;			/* visual bell */
+char *ho;			/* cursor home */
+char *cr;			/* carriage return */
+char *up;			/* cursor up */
+char *dn;			/* cursor down */
+char *le;			/* cursor left */
+char *nd;			/* cursor right */
+char *ce;			/* clear to end of line */
+char *al;			/* insert line */
+char *dl;			/* delete line */
+char *cs;			/* set scrolling region */
+char *sf;			/* scroll forward */
+char *sr;			/* scroll reverse */
 
 /* fatal - report error and die. Never returns */
 void fatal(s)
@@ -56,6 +68,8 @@ void poscur(r, c)
 int r, c;
 {
   tputs(tgoto(cm, c, r), 1, outc);
+  _cursvar.cursrow = r;
+  _cursvar.curscol = c;
 }
 
 /* Clear the screen */
@@ -172,6 +186,23 @@ char *type;
   ac = (unsigned char *) tgetstr("ac", &arp);
   bl = tgetstr("bl", &arp);
   vb = tgetstr("vb", &arp);
+  ho = tgetstr("ho", &arp);
+  cr = tgetstr("cr", &arp);
+  up = tgetstr("up", &arp);
+  dn = tgetstr("do", &arp);
+  le = tgetstr("le", &arp);
+  nd = tgetstr("nd", &arp);
+  ce = tgetstr("ce", &arp);
+  al = tgetstr("al", &arp);
+  dl = tgetstr("dl", &arp);
+  cs = tgetstr("cs", &arp);
+  sf = tgetstr("sf", &arp);
+  sr = tgetstr("sr", &arp);
+  if (cr == NULL && !tgetflag("nc")) cr = "\r";
+  if (le == NULL && tgetflag("bs")) le = "\b";
+  if (sf == NULL && !tgetflag("ns")) sf = "\n";
+  _curscosts();
+  _cursvar.cursrow = -1;		/* don't know where the cursor is */
 
   if (ac) {
 	while (*ac) {
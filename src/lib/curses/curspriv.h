@@ -25,8 +25,9 @@
 
 typedef	struct {
   WINDOW  *tmpwin;			/* window used for updates */
-  int	   cursrow;			/* position of physical cursor */
-  int	   curscol;
+  int	   cursrow;			/* position of physical cursor, */
+  int	   curscol;			/* cursrow -1 if not known */
+  int	   attrs;			/* attributes set on the terminal */
   bool     rawmode;
   bool     cbrkmode;
   bool     echoit;
@@ -34,3 +35,8 @@ typedef	struct {
 
 /* External variables */
 extern	cursv   _cursvar;		/* curses variables */
+
+/* Internal functions */
+_PROTOTYPE( void _cursmove, (int row, int col));
+_PROTOTYPE( int _curscost, (char *str));
+_PROTOTYPE( void _curscosts, (void));
@@ -10,6 +10,7 @@ int endwin()
   poscur(LINES - 1, 0);
   refresh();
   tputs(me, 1, outc);
+  _cursvar.attrs = ATR_NRM;
   delwin(stdscr);
   delwin(curscr);
   delwin(_cursvar.tmpwin);
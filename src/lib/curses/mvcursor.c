@@ -1,6 +1,178 @@
 #include <curses.h>
+#include <termcap.h>
 #include "curspriv.h"
 
+/* The cursor is moved the cheapest way the terminal has: with an absolute
+ * move, with steps from where it is, or with steps from the start of the
+ * line or from home.  Moving right is done by writing the characters that
+ * are already there again, when they need no change of attributes.  The
+ * bytes each way takes are counted by running it through tputs().
+ */
+
+#define BIG		10000	/* cost of a move that can't be done */
+
+extern char *cm, *ho, *cr, *up, *dn, *le, *nd;
+
+static int count;		/* bytes counted by countc() */
+static int upcost, dncost, lecost, ndcost, crcost, hocost;
+static bool dnnl;		/* cursor down is a newline */
+
+/* The tty turns that newline into CR LF */
+#define nlcr	(dnnl && (_tty.c_oflag & (OPOST | ONLCR)) == (OPOST | ONLCR))
+
+_PROTOTYPE( static void countc, (int c));
+_PROTOTYPE( static int rewrite, (int row, int col, int tocol));
+_PROTOTYPE( static int relcost, (int row, int col, int torow, int tocol));
+_PROTOTYPE( static void relmove, (int row, int col, int torow, int tocol));
+
+static void countc(c)
+int c;
+{
+  count++;
+}
+
+/* Number of bytes sent for string capability str */
+int _curscost(str)
+char *str;
+{
+  if (str == NULL) return(BIG);
+  count = 0;
+  tputs(str, 1, countc);
+  return(count);
+}
+
+/* Cost the motion capabilities, once for each terminal */
+void _curscosts()
+{
+  upcost = _curscost(up);
+  dncost = _curscost(dn);
+  lecost = _curscost(le);
+  ndcost = _curscost(nd);
+  crcost = _curscost(cr);
+  hocost = _curscost(ho);
+  dnnl = dn != NULL && dn[0] == '\n' && dn[1] == '\0';
+}
+
+/* Can the cursor go right from col to tocol by writing the line again? */
+static int rewrite(row, col, tocol)
+int row, col, tocol;
+{
+  register int *p, *end;
+
+  p = curscr->_line[row] + col;
+  end = curscr->_line[row] + tocol;
+  while (p < end)
+	if ((*p++ & ATR_MSK) != _cursvar.attrs) return(FALSE);
+  return(TRUE);
+}
+
+/* Cost of moving from row,col to torow,tocol a step at a time */
+static int relcost(row, col, torow, tocol)
+int row, col, torow, tocol;
+{
+  int cost, n;
+
+  cost = 0;
+  if (torow > row) {
+	if (dncost >= BIG) return(BIG);
+	cost = (torow - row) * dncost;
+	if (nlcr) col = 0;
+  } else if (torow < row) {
+	if (upcost >= BIG) return(BIG);
+	cost = (row - torow) * upcost;
+  }
+  if (tocol < col) {
+	if (lecost >= BIG) return(BIG);
+	cost += (col - tocol) * lecost;
+  } else if (tocol > col) {
+	n = tocol - col;
+	if (ndcost > 1 && rewrite(torow, col, tocol))
+		cost += n;
+	else if (ndcost < BIG)
+		cost += n * ndcost;
+	else
+		return(BIG);
+  }
+  return(cost);
+}
+
+/* Move from row,col to torow,tocol a step at a time */
+static void relmove(row, col, torow, tocol)
+int row, col, torow, tocol;
+{
+  register int *p;
+
+  while (row < torow) {
+	tputs(dn, 1, outc);
+	if (nlcr) col = 0;
+	row++;
+  }
+  while (row > torow) {
+	tputs(up, 1, outc);
+	row--;
+  }
+  while (col > tocol) {
+	tputs(le, 1, outc);
+	col--;
+  }
+  if (col < tocol && ndcost > 1 && rewrite(row, col, tocol)) {
+	p = curscr->_line[row] + col;
+	while (col < tocol) {
+		putchar(*p++ & CHR_MSK);
+		col++;
+	}
+  }
+  while (col < tocol) {
+	tputs(nd, 1, outc);
+	col++;
+  }
+}
+
+/* Move the physical cursor to row,col */
+void _cursmove(row, col)
+int row, col;
+{
+  int oldrow, oldcol;
+  int best, cost, how;
+
+  oldrow = _cursvar.cursrow;
+  oldcol = _cursvar.curscol;
+  if (oldrow == row && oldcol == col) return;
+
+  /* 0: absolute, 1: from here, 2: from the left margin, 3: from home */
+  how = 0;
+  best = _curscost(tgoto(cm, col, row));
+  if (oldrow >= 0 && oldcol < COLS) {
+	cost = relcost(oldrow, oldcol, row, col);
+	if (cost < best) {
+		best = cost;
+		how = 1;
+	}
+	cost = crcost + relcost(oldrow, 0, row, col);
+	if (cost < best) {
+		best = cost;
+		how = 2;
+	}
+  }
+  cost = hocost + relcost(0, 0, row, col);
+  if (cost < best) how = 3;
+
+  switch (how) {
+      case 0:	poscur(row, col);	return;
+      case 1:	relmove(oldrow, oldcol, row, col);	break;
+      case 2:
+	tputs(cr, 1, outc);
+	relmove(oldrow, 0, row, col);
+	break;
+      case 3:
+	tputs(ho, 1, outc);
+	relmove(0, 0, row, col);
+	break;
+  }
+  _cursvar.cursrow = row;
+  _cursvar.curscol = col;
+}
+
 /****************************************************************/
 /* Mvcur(oldy,oldx,newy,newx) the display cursor to <newy,newx>	*/
 /****************************************************************/
@@ -13,8 +185,8 @@ int newx;
 {
   if ((newy >= LINES) || (newx >= COLS) || (newy < 0) || (newx < 0))
 	return(ERR);
-  poscur(newy, newx);
-  _cursvar.cursrow = newy;
-  _cursvar.curscol = newx;
+  _cursvar.cursrow = oldy;
+  _cursvar.curscol = oldx;
+  _cursmove(newy, newx);
   return(OK);
 }
@@ -1,13 +1,26 @@
+#include <stdlib.h>
 #include <curses.h>
 #include "curspriv.h"
 #include <termcap.h>
 
 static WINDOW *twin;		/* used by many routines */
 
+/* Lines that moved up or down the screen are found by a hash of each line,
+ * of the screen as it is and as it should be.  The run of lines that moved
+ * by the same distance and is worth most, if it is worth more than it
+ * costs, is scrolled in place with insert/delete line or a scrolling
+ * region, and the lines left over are redrawn the usual way.
+ */
+static unsigned *oldhash;	/* hash of each line of curscr */
+static unsigned *newhash;	/* hash of each line of twin */
+static int *weight;		/* chars to write to redraw a twin line */
+static int hashlines;		/* lines the arrays above have room for */
+
+#define BLANK	(' ' | ATR_NRM)
+
 /****************************************************************/
 /* Gotoxy() moves the physical cursor to the desired address on */
-/* The screen. We don't optimize here - on a PC, it takes more  */
-/* Time to optimize than to do things directly.                 */
+/* The screen, the cheapest way the terminal knows.		*/
 /****************************************************************/
 
 _PROTOTYPE(static void gotoxy, (int row, int col ));
@@ -15,13 +28,14 @@ _PROTOTYPE(static void newattr, (int ch ));
 _PROTOTYPE(static void Putchar, (int ch ));
 _PROTOTYPE(static void clrupdate, (WINDOW *scr ));
 _PROTOTYPE(static void transformline, (int lineno ));
+_PROTOTYPE(static unsigned hashline, (int *line ));
+_PROTOTYPE(static int scrollcost, (int top, int bot, int n, bool doit ));
+_PROTOTYPE(static void scrollscreen, (void ));
 
 static void gotoxy(row, col)
 int row, col;
 {
-  poscur(row, col);
-  _cursvar.cursrow = row;
-  _cursvar.curscol = col;
+  _cursmove(row, col);
 }
 
 /* Update attributes */
@@ -29,10 +43,9 @@ static void newattr(ch)
 int ch;
 {
   extern char *me, *as, *ae, *mb, *md, *mr, *so, *us;
-  static int lastattr = 0;
 
-  if (lastattr != (ch &= ATR_MSK)) {
-	lastattr = ch;
+  if (_cursvar.attrs != (ch &= ATR_MSK)) {
+	_cursvar.attrs = ch;
 
 	tputs(me, 1, outc);
 	if (ae) tputs(ae, 1, outc);
@@ -50,6 +63,8 @@ int ch;
 /* Putchar() writes a character, with attributes, to the physical
    screen, but avoids writing to the lower right screen position.
    Should it care about am?
+   Where the cursor goes after the last column depends on am and xn,
+   so from there on it isn't known.
 */
 
 /* Output char with attribute */
@@ -60,6 +75,7 @@ int ch;
 	newattr(ch);
 	putchar(ch);
   }
+  if (++_cursvar.curscol >= COLS) _cursvar.cursrow = -1;
 }
 
 /****************************************************************/
@@ -87,14 +103,16 @@ WINDOW *scr;
   }				/* if */
   newattr(scr->_attrs);
   clrscr();
+  _cursvar.cursrow = 0;		/* clearing homes the cursor */
+  _cursvar.curscol = 0;
   scr->_clear = FALSE;
   for (i = 0; i < LINES; i++) {	/* update physical screen */
 	src = w->_line[i];
 	j = 0;
 	while (j < COLS) {
-		if (*src != (' ' | ATR_NRM)) {
+		if (*src != BLANK) {
 			gotoxy(i, j);
-			while (j < COLS && (*src != (' ' | ATR_NRM))) {
+			while (j < COLS && (*src != BLANK)) {
 				Putchar(*src++);
 				j++;
 			}
@@ -110,27 +128,44 @@ WINDOW *scr;
 /****************************************************************/
 /* Transformline() updates the given physical line to look      */
 /* Like the corresponding line in _cursvar.tmpwin.		*/
+/* A blank end of line is cleared with ce if that is cheaper.	*/
 /****************************************************************/
 
 static void transformline(lineno)
 register int lineno;
 {
+  extern char *ce;
   register int *dstp;
   register int *srcp;
-  register int dstc;
-  register int srcc;
   int x;
   int endx;
+  int blankx;
+  int n, i;
 
   x = twin->_minchng[lineno];
   endx = twin->_maxchng[lineno];
   dstp = curscr->_line[lineno] + x;
   srcp = twin->_line[lineno] + x;
 
+  /* Where the blanks at the end of the new line start, and how many
+   * chars would have to be written over to blank the old line there.
+   */
+  blankx = COLS;
+  if (ce != NULL) {
+	while (blankx > x && twin->_line[lineno][blankx - 1] == BLANK)
+		blankx--;
+	for (n = 0, i = blankx; i <= endx; i++)
+		if (curscr->_line[lineno][i] != BLANK) n++;
+	if (n > 0 && n > _curscost(ce))
+		endx = blankx - 1;
+	else
+		blankx = COLS;
+  }
+
   while (x <= endx) {
-	if ((*dstp != *srcp) || (dstc != srcc)) {
+	if (*dstp != *srcp) {
 		gotoxy(lineno, x);
-		while (x <= endx && ((*dstp != *srcp) || (dstc != srcc))) {
+		while (x <= endx && (*dstp != *srcp)) {
 			Putchar(*srcp);
 			*dstp++ = *srcp++;
 			x++;
@@ -140,10 +175,211 @@ register int lineno;
 		x++;
 	}
   }				/* for */
+
+  if (blankx < COLS) {
+	gotoxy(lineno, blankx);
+	newattr(ATR_NRM);
+	tputs(ce, 1, outc);
+	for (dstp = curscr->_line[lineno] + blankx;
+	     dstp < curscr->_line[lineno] + COLS; dstp++)
+		*dstp = BLANK;
+  }
   twin->_minchng[lineno] = _NO_CHANGE;
   twin->_maxchng[lineno] = _NO_CHANGE;
 }				/* transformline */
 
+/* Hash of the characters on a line */
+static unsigned hashline(line)
+register int *line;
+{
+  register int *end;
+  register unsigned h;
+
+  h = 0;
+  for (end = line + COLS; line < end; line++) h = (h << 5) + h + *line;
+  return(h);
+}
+
+/****************************************************************/
+/* Scrollcost() is the number of chars sent to move the lines	*/
+/* Top to bot up n lines, or down -n lines, and it moves them	*/
+/* If doit is TRUE.  The lines below bot stay where they are.	*/
+/****************************************************************/
+
+static int scrollcost(top, bot, n, doit)
+int top, bot, n;
+bool doit;
+{
+  extern char *cm, *al, *dl, *cs, *sf, *sr;
+  char *s;
+  int lines, cost, best, how, i;
+  bool needdl, needal;
+
+  lines = n < 0 ? -n : n;
+  best = 10000;
+  how = 0;
+
+  /* Scroll a region, or the whole screen without one. */
+  s = n > 0 ? sf : sr;
+  if (s != NULL && (cs != NULL || (top == 0 && bot == LINES - 1))) {
+	cost = lines * _curscost(s) + _curscost(tgoto(cm, 0, bot));
+	if (cs != NULL && (top != 0 || bot != LINES - 1))
+		cost += _curscost(tgoto(cs, bot, top))
+			+ _curscost(tgoto(cs, LINES - 1, 0));
+	if (cost < best) {
+		best = cost;
+		how = 1;
+	}
+  }
+
+  /* Delete lines, then insert as many elsewhere.  At the bottom of the
+   * screen, lines fall off and come in by themselves.
+   */
+  needdl = n > 0 || bot < LINES - 1;
+  needal = n < 0 || bot < LINES - 1;
+  if ((dl != NULL || !needdl) && (al != NULL || !needal)) {
+	cost = 0;
+	if (needdl)
+		cost += lines * _curscost(dl) + _curscost(tgoto(cm, 0, top));
+	if (needal)
+		cost += lines * _curscost(al) + _curscost(tgoto(cm, 0, bot));
+	if (cost < best) {
+		best = cost;
+		how = 2;
+	}
+  }
+  if (!doit || how == 0) return(best);
+
+  newattr(ATR_NRM);
+  if (how == 1) {
+	if (cs != NULL && (top != 0 || bot != LINES - 1)) {
+		tputs(tgoto(cs, bot, top), 1, outc);
+		_cursvar.cursrow = -1;
+	}
+	gotoxy(n > 0 ? bot : top, 0);
+	for (i = 0; i < lines; i++) tputs(s, 1, outc);
+	if (cs != NULL && (top != 0 || bot != LINES - 1))
+		tputs(tgoto(cs, LINES - 1, 0), 1, outc);
+  } else {
+	if (needdl) {
+		gotoxy(n > 0 ? top : bot + 1 - lines, 0);
+		for (i = 0; i < lines; i++) tputs(dl, 1, outc);
+		_cursvar.cursrow = -1;
+	}
+	if (needal) {
+		gotoxy(n > 0 ? bot + 1 - lines : top, 0);
+		for (i = 0; i < lines; i++) tputs(al, 1, outc);
+	}
+  }
+  _cursvar.cursrow = -1;
+  return(best);
+}
+
+/****************************************************************/
+/* Scrollscreen() finds lines of _cursvar.tmpwin that are on	*/
+/* The screen already, but on another line, and scrolls them	*/
+/* Into place if that is cheaper than drawing them again.	*/
+/****************************************************************/
+
+static void scrollscreen()
+{
+  register int *p;
+  register int i;
+  int *end, **line;
+  int d, s, worth, best, bestd, bests, beste, top, bot, n, j;
+
+  if (hashlines < LINES) {
+	free(oldhash);
+	free(newhash);
+	free(weight);
+	oldhash = (unsigned *) malloc(LINES * sizeof(unsigned));
+	newhash = (unsigned *) malloc(LINES * sizeof(unsigned));
+	weight = (int *) malloc(LINES * sizeof(int));
+	if (oldhash == NULL || newhash == NULL || weight == NULL) {
+		hashlines = 0;
+		return;
+	}
+	hashlines = LINES;
+  }
+
+  /* The weight of a line is what drawing it from blank would cost. */
+  for (i = 0; i < LINES; i++) {
+	oldhash[i] = hashline(curscr->_line[i]);
+	if (twin->_minchng[i] == _NO_CHANGE)
+		newhash[i] = oldhash[i];
+	else
+		newhash[i] = hashline(twin->_line[i]);
+	weight[i] = 0;
+	for (p = twin->_line[i], end = p + COLS; p < end; p++)
+		if (*p != BLANK) weight[i]++;
+  }
+
+  /* Find the run of lines worth most, new line i is old line i + d. */
+  best = 0;
+  for (d = 1 - LINES; d < LINES; d++) {
+	if (d == 0) continue;
+	i = d < 0 ? -d : 0;
+	while (i < LINES && i + d < LINES) {
+		if (newhash[i] != oldhash[i + d]) {
+			i++;
+			continue;
+		}
+		s = i;
+		worth = 0;
+		while (i < LINES && i + d < LINES
+					&& newhash[i] == oldhash[i + d]) {
+			if (newhash[i] != oldhash[i]) worth += weight[i];
+			i++;
+		}
+
+		/* It saves drawing the lines that changed, but the ones
+		 * that scroll in blank must be drawn too.
+		 */
+		top = d > 0 ? s : s + d;
+		bot = d > 0 ? i - 1 + d : i - 1;
+		n = d > 0 ? d : -d;
+		for (j = d > 0 ? bot + 1 - n : top; n > 0; j++, n--)
+			if (newhash[j] == oldhash[j]) worth -= weight[j];
+		if (worth <= best) continue;
+		worth -= scrollcost(top, bot, d, FALSE);
+		if (worth > best) {
+			best = worth;
+			bestd = d;
+			bests = s;
+			beste = i - 1;
+		}
+	}
+  }
+  if (best == 0) return;
+
+  d = bestd;
+  top = d > 0 ? bests : bests + d;
+  bot = d > 0 ? beste + d : beste;
+  scrollcost(top, bot, d, TRUE);
+
+  /* Move curscr's lines the same way, the new ones are blank. */
+  n = d > 0 ? d : -d;
+  line = curscr->_line;
+  for (j = 0; j < n; j++) {
+	if (d > 0) {
+		p = line[top];
+		for (i = top; i < bot; i++) line[i] = line[i + 1];
+		line[bot] = p;
+	} else {
+		p = line[bot];
+		for (i = bot; i > top; i--) line[i] = line[i - 1];
+		line[top] = p;
+	}
+	for (end = p + COLS; p < end; p++) *p = BLANK;
+  }
+
+  /* Let transformline() look at every line that moved. */
+  for (i = top; i <= bot; i++) {
+	twin->_minchng[i] = 0;
+	twin->_maxchng[i] = COLS - 1;
+  }
+}
+
 /****************************************************************/
 /* Doupdate() updates the physical screen to look like _curs-   */
 /* Var.tmpwin if curscr is not 'Clear-marked'. Otherwise it     */
@@ -152,7 +388,7 @@ register int lineno;
 
 void doupdate()
 {
-  int i;
+  int i, n;
 
   twin = _cursvar.tmpwin;
   if (curscr->_clear)
@@ -161,6 +397,9 @@ void doupdate()
 	if (twin->_clear)
 		clrupdate(twin);
 	else {
+		for (i = n = 0; i < LINES; i++)
+			if (twin->_minchng[i] != _NO_CHANGE) n++;
+		if (n >= 2) scrollscreen();
 		for (i = 0; i < LINES; i++)
 			if (twin->_minchng[i] != _NO_CHANGE)
 				transformline(i);
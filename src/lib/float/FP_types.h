@@ -106,7 +106,7 @@ _PROTOTYPE( void fef8, (struct fef8_returns *r, DOUBLE s1));
 _PROTOTYPE( void fif4, (struct fif4_returns *p, SINGLE x, SINGLE y));
 _PROTOTYPE( void fif8, (struct fif8_returns *p, DOUBLE x, DOUBLE y));
 
-_PROTOTYPE( void b64_sft, (B64 *, int));
+_PROTOTYPE( int b64_sft, (B64 *, int));
 _PROTOTYPE( void b64_lsft, (B64 *));
 _PROTOTYPE( void b64_rsft, (B64 *));
 _PROTOTYPE( int b64_add, (B64 *, B64 *));
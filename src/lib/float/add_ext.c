@@ -47,9 +47,12 @@ register EXTEND	*e1,*e2;
 	}
 	else {
 		if (b64_add(&e1->mantissa,&e2->mantissa)) {	/* addition carry */
+			int sticky = e1->m2 & 1;
+
 			b64_rsft(&e1->mantissa);	/* shift mantissa one bit RIGHT */
 			e1->m1 |= 0x80000000L;	/* set max bit	*/
 			e1->exp++;		/* increase the exponent */
+			e1->m2 |= sticky;	/* a bit shifted out */
 		}
 	}
 	nrm_ext(e1);
@@ -43,11 +43,10 @@ dbl_over:			trap(EFOVFL);
 				return;
 		}
 		else if (f->exp < DBL_MIN)	{
-			b64_rsft(&(f->mantissa));
-			if (f->exp < 0) {
-				b64_sft(&(f->mantissa), -f->exp);
-				f->exp = 0;
-			}
+			/* denormalized; keep a sticky bit for rounding */
+			if (b64_sft(&(f->mantissa), 1 - f->exp))
+				f->m2 |= 1;
+			f->exp = 0;
 			/* underflow ??? */
 		}
 			
@@ -144,11 +143,10 @@ sgl_over:			trap(EFOVFL);
 				return;
 		}
 		else if (f->exp < SGL_MIN)	{
-			b64_rsft(&(f->mantissa));
-			if (f->exp < 0) {
-				b64_sft(&(f->mantissa), -f->exp);
-				f->exp = 0;
-			}
+			/* denormalized; keep a sticky bit for rounding */
+			if (b64_sft(&(f->mantissa), 1 - f->exp))
+				f->m2 |= 1;
+			f->exp = 0;
 			/* underflow ??? */
 		}
 
@@ -157,6 +155,7 @@ sgl_over:			trap(EFOVFL);
 
 		/* check for rounding to nearest	*/
 		/* on a tie, round to even		*/
+		/* (it is no tie if m2 has bits set)	*/
 #ifdef EXCEPTION_INEXACT
 		if (f->m2 != 0 ||
 		    (f->m1 & SGL_EXACT) != 0L) {
@@ -164,7 +163,8 @@ sgl_over:			trap(EFOVFL);
 #endif
 		        if (((f->m1 & SGL_EXACT) > SGL_ROUNDUP)
 			    || ((f->m1 & SGL_EXACT) == SGL_ROUNDUP
-			        && (f->m1 & (SGL_ROUNDUP << 1)))) {
+			        && (f->m2 != 0
+				    || (f->m1 & (SGL_ROUNDUP << 1))))) {
 				(*SGL)++;
 				if (f->exp == 0 && (*SGL & ~SGL_MASK)) {
 					f->exp++;
@@ -14,15 +14,18 @@
 #include "FP_types.h"
 
 /*
-	November 15, 1984
-
-	This is a routine to do the work.
-	There are two versions: 
-	One is based on the partial products method
-	and makes no use possible machine instructions
-	to divide (hardware dividers).
-	The other is used when USE_DIVIDE is defined. It is much faster on
-	machines with fast 4 byte operations.
+	The mantissas are divided 16 bits at a time with the algorithm
+	of Knuth (The art of programming, Seminumerical algorithms),
+	seen as numbers with base 65536.  Each quotient digit is guessed
+	from the top digits with one 32 by 16 bit divide, is then at
+	most one too big, and is put right by adding the divisor back
+	in the rare case that it is.  This takes four steps where the
+	old partial products method took a shift, compare and subtract
+	for each of the 64 bits.
+	If the remainder is not zero, the lowest bit of the quotient is
+	set (a "sticky" bit), so that compact() rounds it correctly.
+	The mantissas are normalized, so the quotient is between 1/2
+	and 2: its integer bit is found first.
 */
 /********************************************************/
 
@@ -30,17 +33,11 @@ void
 div_ext(e1,e2)
 EXTEND	*e1,*e2;
 {
-	short	error = 0;
-	B64		result;
-	register	unsigned long	*lp;
-#ifndef USE_DIVIDE
-	short	count;
-#else
-	unsigned short u[9], v[5];
-	register int j;
-	register unsigned short *u_p = u;
-	int maxv = 4;
-#endif
+	unsigned short	u[8], v[4], q[5];
+	register unsigned short *u_p;
+	register int	i;
+	int		j, borrow;
+	unsigned long	q_est, r_est, temp, k;
 
 	if ((e2->m1 | e2->m2) == 0) {
                 /*
@@ -55,182 +52,89 @@ EXTEND	*e1,*e2;
 		e1->exp = 0;	/* make sure */
 		return;
 	}
-#ifndef USE_DIVIDE
-	/*
-	 * numbers are right shifted one bit to make sure
-	 * that m1 is quaranteed to be larger if its
-	 * maximum bit is set
-	 */
-	b64_rsft(&e1->mantissa);	/* 64 bit shift right */
-	b64_rsft(&e2->mantissa);	/* 64 bit shift right */
-	e1->exp++;
-	e2->exp++;
-#endif
-	/*	check for underflow, divide by zero, etc	*/
 	e1->sign ^= e2->sign;
 	e1->exp -= e2->exp;
 
-#ifndef USE_DIVIDE
-		/* do division of mantissas	*/
-		/* uses partial product method	*/
-		/* init control variables	*/
-
-	count = 64;
-	result.h_32 = 0L;
-	result.l_32 = 0L;
-
-		/* partial product division loop */
-
-	while (count--)	{
-		/* first left shift result 1 bit	*/
-		/* this is ALWAYS done			*/
-
-		b64_lsft(&result);
-
-		/* compare dividend and divisor		*/
-		/* if dividend >= divisor add a bit	*/
-		/* and subtract divisior from dividend	*/
-
-		if ( (e1->m1 < e2->m1) ||
-			((e1->m1 == e2->m1) && (e1->m2 < e2->m2) ))
-			;	/* null statement */
-				/* i.e., don't add or subtract */
-		else	{
-			result.l_32++;	/* ADD	*/
-			if (e2->m2 > e1->m2)
-				e1->m1 -= 1;	/* carry in */
-			e1->m1 -= e2->m1;	/* do SUBTRACTION */
-			e1->m2 -= e2->m2;	/*    SUBTRACTION */
-		}
-
-		/*	shift dividend left one bit OR	*/
-		/*	IF it equals ZERO we can break out	*/
-		/*	of the loop, but still must shift	*/
-		/*	the quotient the remaining count bits	*/
-		/* NB	save the results of this test in error	*/
-		/*	if not zero, then the result is inexact. */
-		/* 	this would be reported in IEEE standard	*/
-
-		/*	lp points to dividend			*/
-		lp = &e1->m1;
-
-		error = ((*lp | *(lp+1)) != 0L) ? 1 : 0;
-		if (error)	{	/* more work */
-			/*	assume max bit == 0 (see above)	*/
-			b64_lsft(&e1->mantissa);
-			continue;
-		}
-		else
-			break;	/* leave loop	*/
-	}	/* end of divide by subtraction loop	*/
-
-	if (count > 0)	{
-		lp = &result.h_32;
-		if (count > 31) {	/* move to higher word */
-			*lp = *(lp+1);
-			count -= 32;
-			*(lp+1) = 0L;	/* clear low word	*/
-		}
-		if (*lp)
-			*lp <<= count;	/* shift rest of way	*/
-		lp++;	/*  == &result.l_32	*/
-		if (*lp) {
-			result.h_32 |= (*lp >> 32-count);
-			*lp <<= count;
-		}
-	}
-#else /* USE_DIVIDE */
-
-	u[4] = (e1->m2 & 1) << 15;
-	b64_rsft(&(e1->mantissa));
 	u[0] = e1->m1 >> 16;
 	u[1] = e1->m1;
 	u[2] = e1->m2 >> 16;
 	u[3] = e1->m2;
-	u[5] = 0; u[6] = 0; u[7] = 0;
-	v[1] = e2->m1 >> 16;
-	v[2] = e2->m1;
-	v[3] = e2->m2 >> 16;
-	v[4] = e2->m2;
-	while (! v[maxv]) maxv--;
-	result.h_32 = 0;
-	result.l_32 = 0;
-	lp = &result.h_32;
-
-	/*
-	 * Use an algorithm of Knuth (The art of programming, Seminumerical
-	 * algorithms), to divide u by v. u and v are both seen as numbers
-	 * with base 65536. 
-	 */
-	for (j = 0; j <= 3; j++, u_p++) {
-		unsigned long q_est, temp;
+	u[4] = 0; u[5] = 0; u[6] = 0; u[7] = 0;
+	v[0] = e2->m1 >> 16;
+	v[1] = e2->m1;
+	v[2] = e2->m2 >> 16;
+	v[3] = e2->m2;
+
+	q[0] = 0;
+	if (e1->m1 > e2->m1 || (e1->m1 == e2->m1 && e1->m2 >= e2->m2)) {
+		/* the integer bit */
+		borrow = 0;
+		for (i = 3; i >= 0; i--) {
+			temp = (unsigned long) u[i] - v[i] - borrow;
+			u[i] = temp;
+			borrow = (temp >> 16) != 0;
+		}
+		q[0] = 1;
+	}
 
-		if (j == 2) lp++;
-		if (u_p[0] == 0 && u_p[1] < v[1]) continue;
+	for (j = 1, u_p = u; j <= 4; j++, u_p++) {
+		/* u_p[0..4] / v < 65536, so u_p[0] <= v[0] */
 		temp = ((unsigned long)u_p[0] << 16) + u_p[1];
-		if (u_p[0] >= v[1]) {
+		if (u_p[0] >= v[0]) {
 			q_est = 0x0000FFFFL;
+			r_est = temp - q_est * v[0];
 		}
 		else {
-			q_est = temp / v[1];
+			q_est = temp / v[0];
+			r_est = temp - q_est * v[0];
 		}
-		temp -= q_est * v[1];
-		while (temp < 0x10000 && v[2]*q_est > ((temp<<16)+u_p[2])) {
+		while (r_est < 0x10000L &&
+		       q_est * v[1] > (r_est << 16) + u_p[2]) {
 			q_est--;
-			temp += v[1];
+			r_est += v[0];
 		}
-		/*	Now, according to Knuth, we have an estimate of the
-			quotient, that is either correct or one too big, but
-			almost always correct.
-		*/
-		if (q_est != 0)  {
-			int i;
-			unsigned long k = 0;
-			int borrow = 0;
 
-			for (i = maxv; i > 0; i--) {
-				unsigned long tmp = q_est * v[i] + k + borrow;
-				unsigned short md = tmp;
-
-				borrow = (md > u_p[i]);
-				u_p[i] -= md;
-				k = tmp >> 16;
-			}
-			k += borrow;
-			borrow = u_p[0] < k;
-			u_p[0] -= k;
-
-			if (borrow) {
-				/* So, this does not happen often; the estimate
-				   was one too big; correct this
-				*/
-				*lp |= (j & 1) ? (q_est - 1) : ((q_est-1)<<16);
-				borrow = 0;
-				for (i = maxv; i > 0; i--) {
-					unsigned long tmp 
-					    = v[i]+(unsigned long)u_p[i]+borrow;
-					
-					u_p[i] = tmp;
-					borrow = tmp >> 16;
-				}
-				u_p[0] += borrow;
-			}
-			else *lp |= (j & 1) ? q_est : (q_est<<16);
+		/* u_p -= q_est * v */
+		k = 0;
+		borrow = 0;
+		for (i = 3; i >= 0; i--) {
+			temp = q_est * v[i] + k;
+			k = temp >> 16;
+			temp = (unsigned long) u_p[i+1] - (unsigned short) temp
+				- borrow;
+			u_p[i+1] = temp;
+			borrow = (temp >> 16) != 0;
 		}
-	}
-#ifdef	EXCEPTION_INEXACT
-	u_p = &u[0];
-	for (j = 7; j >= 0; j--) {
-		if (*u_p++) {
-			error = 1;
-			break;
+		temp = (unsigned long) u_p[0] - k - borrow;
+		u_p[0] = temp;
+		if ((temp >> 16) != 0) {
+			/* the estimate was one too big; add v back */
+			q_est--;
+			k = 0;
+			for (i = 3; i >= 0; i--) {
+				temp = (unsigned long) u_p[i+1] + v[i] + k;
+				u_p[i+1] = temp;
+				k = temp >> 16;
+			}
+			u_p[0] += k;
 		}
+		q[j] = q_est;
 	}
-#endif
-#endif
 
+	/* the remainder is left in u[4..7] */
+	if (q[0]) {
+		e1->m1 = 0x80000000L | ((unsigned long)q[1] << 15) | (q[2] >> 1);
+		e1->m2 = ((unsigned long)q[2] << 31)
+			| ((unsigned long)q[3] << 15) | (q[4] >> 1);
+		if (q[4] & 1) u[4] = 1;
+	}
+	else {
+		e1->exp--;
+		e1->m1 = ((unsigned long)q[1] << 16) + q[2];
+		e1->m2 = ((unsigned long)q[3] << 16) + q[4];
+	}
+	if ((u[4] | u[5] | u[6] | u[7]) != 0) {
 #ifdef  EXCEPTION_INEXACT
-        if (error)      {
                 /*
                  * report here exception 8.5 - Inexact
                  * from Draft 8.0 of IEEE P754:
@@ -242,9 +146,9 @@ EXTEND	*e1,*e2;
                  */
                 INEXACT();
 #endif
-	e1->mantissa = result;
+		e1->m2 |= 1;	/* sticky */
+	}
 
-	nrm_ext(e1);
 	if (e1->exp < EXT_MIN)	{
 		/*
 		 * Exception 8.4 - Underflow
@@ -14,71 +14,84 @@
 # include "FP_types.h"
 # include "FP_shift.h"
 
+/*
+	The mantissas are taken as four 16 bit digits each, so that a
+	product of two digits fits in an unsigned long, and the 128 bit
+	product is made a column at a time: all the digit products of
+	one weight are summed before a digit of the result is stored.
+	Low digits that are zero (a float has only two) are skipped.
+	The top 64 bits are kept, and if any of the bits below them are
+	set, so is the lowest bit (a "sticky" bit); then compact() can
+	round the product correctly, not the product rounded once more.
+*/
+
 void
 mul_ext(e1,e2)
 EXTEND	*e1,*e2;
 {
-	register int	i,j;		/* loop control	*/
-	unsigned short	mp[4];		/* multiplier */
+	register int	i, k;
+	int		la, lb;
+	unsigned short	mp[4];		/* multiplier, least significant first */
 	unsigned short	mc[4];		/* multipcand */
 	unsigned short	result[8];	/* result */
-	register unsigned short *pres;
+	unsigned long	acc, p;
+	unsigned	carry;
+	unsigned short	lost;
 
 	/* first save the sign (XOR)			*/
 	e1->sign ^= e2->sign;
 
+	if ((e1->m1 | e1->m2) == 0L || (e2->m1 | e2->m2) == 0L) {
+		e1->m1 = e1->m2 = 0L;
+		e1->exp = 0;
+		return;
+	}
+
 	/* compute new exponent */
 	e1->exp += e2->exp + 1;
-	/* 128 bit multiply of mantissas			*/
 
-		/* assign unknown long formats		*/
-		/* to known unsigned word formats	*/
-	mp[0] = e1->m1 >> 16;
-	mp[1] = (unsigned short) e1->m1;
-	mp[2] = e1->m2 >> 16;
-	mp[3] = (unsigned short) e1->m2;
-	mc[0] = e2->m1 >> 16;
-	mc[1] = (unsigned short) e2->m1;
-	mc[2] = e2->m2 >> 16;
-	mc[3] = (unsigned short) e2->m2;
-	for (i = 8; i--;) {
-		result[i] = 0;
+	mp[3] = e1->m1 >> 16;
+	mp[2] = (unsigned short) e1->m1;
+	mp[1] = e1->m2 >> 16;
+	mp[0] = (unsigned short) e1->m2;
+	mc[3] = e2->m1 >> 16;
+	mc[2] = (unsigned short) e2->m1;
+	mc[1] = e2->m2 >> 16;
+	mc[0] = (unsigned short) e2->m2;
+	for (la = 0; mp[la] == 0; la++) result[la] = 0;
+	for (lb = 0; mc[lb] == 0; lb++) result[la + lb] = 0;
+
+	/* 128 bit multiply of mantissas, a column at a time		*/
+	acc = 0;
+	for (k = la + lb; k < 8; k++) {
+		carry = 0;
+		i = k - 3 > la ? k - 3 : la;
+		for (; i <= 3 && k - i >= lb; i++) {
+			p = (unsigned long) mp[i] * mc[k - i];
+			acc += p;
+			if (acc < p) carry++;
+		}
+		result[k] = acc;
+		acc = (acc >> 16) + ((unsigned long) carry << 16);
 	}
-	/*
-	 *	fill registers with their components
-	 */
-	for(i=4, pres = &result[4];i--;pres--) if (mp[i]) {
-		unsigned short k = 0;
-		unsigned long mpi = mp[i];
-		for(j=4;j--;) {
-			unsigned long tmp = (unsigned long)pres[j] + k;
-			if (mc[j]) tmp += mpi * mc[j];
-			pres[j] = tmp;
-			k = tmp >> 16;
+
+	lost = result[3] | result[2] | result[1] | result[0];
+	if (! (result[7] & 0x8000)) {
+		e1->exp--;
+		lost = (result[3] & 0x7FFF) | result[2] | result[1] | result[0];
+		for (i = 7; i >= 4; i--) {
+			result[i] <<= 1;
+			if (result[i-1]&0x8000) result[i] |= 1;
 		}
-		pres[-1] = k;
 	}
-        if (! (result[0] & 0x8000)) {
-                e1->exp--;
-                for (i = 0; i <= 3; i++) {
-                        result[i] <<= 1;
-                        if (result[i+1]&0x8000) result[i] |= 1;
-                }
-                result[4] <<= 1;
-        }
 
 	/*
 	 *	combine the registers to a total
 	 */
-	e1->m1 = ((unsigned long)(result[0]) << 16) + result[1];
-	e1->m2 = ((unsigned long)(result[2]) << 16) + result[3];
-	if (result[4] & 0x8000) {
-		if (++e1->m2 == 0)
-			if (++e1->m1 == 0) {
-				e1->m1 = NORMBIT;
-				e1->exp++;
-			}
-	}
+	e1->m1 = ((unsigned long)(result[7]) << 16) + result[6];
+	e1->m2 = ((unsigned long)(result[5]) << 16) + result[4];
+	if (lost != 0)
+		e1->m2 |= 1;	/* sticky */
 
 					/* check for overflow	*/
 	if (e1->exp >= EXT_MAX)	{
@@ -14,10 +14,19 @@
 #include "FP_shift.h"
 #include "FP_types.h"
 
+/* The number of leading zero bits in a nibble.  The leading zeros of the
+ * mantissa are counted with it in three tests and a lookup, and the mantissa
+ * is shifted once, instead of a bit at a time.
+ */
+static char lz[16] = { 4, 3, 2, 2, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0 };
+
 void
 nrm_ext(e1)
 EXTEND	*e1;
 {
+	register int	cnt;
+	register unsigned long	x;
+
 		/* we assume that the mantissa != 0	*/
 		/* if it is then just return		*/
 		/* to let it be a problem elsewhere	*/
@@ -37,14 +46,23 @@ EXTEND	*e1;
 		e1->exp -= 32;
 	}
 	if ((e1->m1 & NORMBIT) == 0) {
-		unsigned long l = ((unsigned long)NORMBIT >> 1);
-		int cnt = -1;
-
-		while (! (l & e1->m1)) {
-			l >>= 1;
-			cnt--;
+		x = e1->m1;
+		cnt = 0;
+		if ((x & 0xFFFF0000L) == 0) {
+			x <<= 16;
+			cnt = 16;
+		}
+		if ((x & 0xFF000000L) == 0) {
+			x <<= 8;
+			cnt += 8;
+		}
+		if ((x & 0xF0000000L) == 0) {
+			x <<= 4;
+			cnt += 4;
 		}
-		e1->exp += cnt;
-		b64_sft(&(e1->mantissa), cnt);
+		cnt += lz[(int) (x >> 28)];
+		e1->exp -= cnt;
+		e1->m1 = (e1->m1 << cnt) | (e1->m2 >> (32 - cnt));
+		e1->m2 <<= cnt;
 	}
 }
@@ -9,6 +9,12 @@
 	SHIFT TWO EXTENDED NUMBERS INTO PROPER
 	ALIGNMENT FOR ADDITION (exponents are equal)
 	Numbers should not be zero on entry.
+
+	If bits are shifted out, the lowest bit is set (a "sticky"
+	bit), so that the sum still rounds the right way in compact().
+	The operands come from floats and doubles, so there are at
+	least 11 bits below the ones kept, and the sticky bit can not
+	move up into them.
 */
 
 #include "FP_types.h"
@@ -35,5 +41,6 @@ EXTEND	*e1,*e2;
 		s = e2;
 
 	s->exp += diff;
-	b64_sft(&(s->mantissa), diff);
+	if (b64_sft(&(s->mantissa), diff))
+		s->m2 |= 1;
 }
@@ -7,37 +7,46 @@
 
 # include "FP_types.h"
 
-void
+/* Shift right n bits (left -n bits).  A right shift returns nonzero if
+ * ones were shifted out, so that the caller can keep a sticky bit.
+ */
+int
 b64_sft(e1,n)
 B64	*e1;
 int	n;
 {
+	unsigned long	lost;
+
 	if (n > 0) {
 		if (n > 63) {
+			lost = e1->l_32 | e1->h_32;
 			e1->l_32 = 0;
 			e1->h_32 = 0;
-			return;
+			return lost != 0;
 		}
+		lost = 0;
 		if (n >= 32) {
+			lost = e1->l_32;
 			e1->l_32 = e1->h_32;
 			e1->h_32 = 0;
 			n -= 32;
 		}
 		if (n > 0) {
+			lost |= e1->l_32 << (32 - n);
 			e1->l_32 >>= n;
 			if (e1->h_32 != 0) {
 				e1->l_32 |= (e1->h_32 << (32 - n));
 				e1->h_32 >>= n;
 			}
 		}
-		return;
+		return lost != 0;
 	}
 	n = -n;
 	if (n > 0) {
 		if (n > 63) {
 			e1->l_32 = 0;
 			e1->h_32 = 0;
-			return;
+			return 0;
 		}
 		if (n >= 32) {
 			e1->h_32 = e1->l_32;
@@ -52,6 +61,7 @@ int	n;
 			}
 		}
 	}
+	return 0;
 }
 
 void
@@ -27,10 +27,13 @@ EXTEND	*e1,*e2;
 	if (e1->sign != e2->sign) {
 		/* e1 - e2 = e1 + (-e2) */
 		if (b64_add(&e1->mantissa,&e2->mantissa)) { /* addition carry */
-                	b64_rsft(&e1->mantissa);      /* shift mantissa one bit RIGHT */
-                	e1->m1 |= 0x80000000L;  /* set max bit  */
-                	e1->exp++;              /* increase the exponent */
-        	}
+			int sticky = e1->m2 & 1;
+
+			b64_rsft(&e1->mantissa);      /* shift mantissa one bit RIGHT */
+			e1->m1 |= 0x80000000L;  /* set max bit  */
+			e1->exp++;              /* increase the exponent */
+			e1->m2 |= sticky;	/* a bit shifted out */
+		}
 	}
         else if (e2->m1 > e1->m1 ||
                  (e2->m1 == e1->m1 && e2->m2 > e1->m2)) {
@@ -12,19 +12,52 @@ _memchr:
 	push	ebp
 	mov	ebp, esp
 	push	edi
+	push	ebx
 	mov	edi, 8(ebp)	! edi = string
-	movb	al, 12(ebp)	! The character to look for
+	movzxb	eax, 12(ebp)	! The character to look for
 	mov	ecx, 16(ebp)	! Length
+	cmp	ecx, 16
+	jb	cbyte		! Don't bother being smart with short arrays
+	movb	ah, al
+	mov	edx, eax
+	sal	edx, 16
+	or	edx, eax	! One byte to four bytes
+	test	edi, 3
+	jz	lword
+sbyte:	cmpb	(edi), al	! Bytes up to a longword boundary
+	je	found
+	inc	edi
+	dec	ecx
+	test	edi, 3
+	jnz	sbyte
+lword:	cmp	ecx, 4
+	jb	cbyte		! Less than a longword left
+	mov	ebx, (edi)
+	xor	ebx, edx	! Bytes equal to c become zero
+	mov	eax, ebx
+	sub	eax, 0x01010101	! A zero byte borrows, setting its top bit
+	not	ebx
+	and	eax, ebx	! Unless the top bit was set before
+	and	eax, 0x80808080
+	jnz	clword		! It is in this longword
+	add	edi, 4
+	sub	ecx, 4
+	jmp	lword
+clword:	mov	ecx, 4		! Find out where
+cbyte:	movb	al, 12(ebp)	! The character to look for
 	cmpb	cl, 1		! 'Z' bit must be clear if ecx = 0
 	cld
 	repne
 	scasb
 	jne	failure
-	lea	eax, -1(edi)	! Found
+	dec	edi		! Found
+found:	mov	eax, edi
+	pop	ebx
 	pop	edi
 	pop	ebp
 	ret
 failure:xor	eax, eax
+	pop	ebx
 	pop	edi
 	pop	ebp
 	ret
@@ -11,31 +11,50 @@
 _strchr:
 	push	ebp
 	mov	ebp, esp
+	push	esi
 	push	edi
-	cld
+	push	ebx
 	mov	edi, 8(ebp)	! edi = string
-	mov	edx, 16		! Look at small chunks of the string
-next:	shl	edx, 1		! Chunks become bigger each time
-	mov	ecx, edx
-	xorb	al, al		! Look for the zero at the end
-	repne
-	scasb
-	pushf			! Remember the flags
-	sub	ecx, edx
-	neg	ecx		! Some or all of the chunk
-	sub	edi, ecx	! Step back
-	movb	al, 12(ebp)	! The character to look for
-	repne
-	scasb
+	movzxb	eax, 12(ebp)	! The character to look for
+	movb	ah, al
+	mov	edx, eax
+	sal	edx, 16
+	or	edx, eax	! One byte to four bytes
+	test	edi, 3
+	jz	lword
+sbyte:	movb	cl, (edi)	! Bytes up to a longword boundary
+	cmpb	cl, al
 	je	found
-	popf			! Did we find the end of string earlier?
-	jne	next		! No, try again
-	xor	eax, eax	! Return NULL
+	testb	cl, cl
+	jz	failure		! End of string
+	inc	edi
+	test	edi, 3
+	jnz	sbyte
+lword:	mov	ecx, (edi)	! Four bytes at a time
+	mov	ebx, ecx
+	sub	ebx, 0x01010101	! A zero byte borrows, setting its top bit
+	not	ecx
+	and	ebx, ecx	! Unless the top bit was set before
+	not	ecx
+	xor	ecx, edx	! The same for bytes equal to c
+	mov	esi, ecx
+	sub	esi, 0x01010101
+	not	ecx
+	and	esi, ecx
+	or	ebx, esi
+	and	ebx, 0x80808080
+	jnz	sbyte		! The end or c is in here, look bytewise
+	add	edi, 4
+	jmp	lword
+found:	mov	eax, edi
+	pop	ebx
 	pop	edi
+	pop	esi
 	pop	ebp
 	ret
-found:	pop	eax		! Get rid of those flags
-	lea	eax, -1(edi)	! Address of byte found
+failure:xor	eax, eax
+	pop	ebx
 	pop	edi
+	pop	esi
 	pop	ebp
 	ret
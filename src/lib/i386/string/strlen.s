@@ -9,5 +9,37 @@
 .define _strlen
 	.align	16
 _strlen:
-	mov	ecx, -1		! Unlimited length
-	jmp	__strnlen	! Common code
+	push	ebp
+	mov	ebp, esp
+	push	ebx
+	mov	eax, 8(ebp)	! eax = string
+	mov	edx, eax	! Remember where it starts
+	test	eax, 3
+	jz	lword		! Aligned already
+sbyte:	cmpb	(eax), 0	! Bytes up to a longword boundary
+	je	done
+	inc	eax
+	test	eax, 3
+	jnz	sbyte
+lword:	mov	ecx, (eax)	! Four bytes at a time
+	add	eax, 4
+	mov	ebx, ecx
+	sub	ebx, 0x01010101	! A zero byte borrows, setting its top bit
+	not	ecx
+	and	ebx, ecx	! Unless the top bit was set before
+	and	ebx, 0x80808080
+	jz	lword		! No zero byte
+	sub	eax, 4		! The lowest bit set marks the first zero
+	testb	bl, bl
+	jnz	done
+	inc	eax
+	testb	bh, bh
+	jnz	done
+	inc	eax
+	test	ebx, 0x00800000
+	jnz	done
+	inc	eax
+done:	sub	eax, edx	! Length is end - start
+	pop	ebx
+	pop	ebp
+	ret
@@ -0,0 +1,18 @@
+/* ktrace.c - Systemcall interface to mm/trace.c::do_ktrace() */
+
+#include <lib.h>
+#define ktrace	_ktrace
+#include <unistd.h>
+
+int ktrace(int req, void *buf, long count, long *total)
+{
+  message m;
+  int r;
+
+  m.m2_i2 = req;
+  m.m2_p1 = (char *) buf;
+  m.m2_l1 = count;
+  r = _syscall(MM, KTRACE, &m);
+  if (r >= 0 && total != NULL) *total = m.m2_l2;
+  return r;
+}
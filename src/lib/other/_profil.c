@@ -0,0 +1,38 @@
+/* profil.c - Systemcall interface to mm/trace.c::do_profil() */
+
+#include <lib.h>
+#define profil	_profil
+#define pprofil	_pprofil
+#include <minix/com.h>
+#include <unistd.h>
+
+/* Profile the program counter of the caller, or for pprofil() of process
+ * 'who', into an array of counters.  A process profiled by someone else
+ * stays profiled when it execs, so that prof(1) can profile a command.
+ */
+PUBLIC int pprofil(who, buf, bufsiz, offset, scale)
+int who;
+unsigned short *buf;
+size_t bufsiz;
+size_t offset;
+unsigned scale;
+{
+  message m;
+
+  m.m2_i1 = who;
+  m.m2_i3 = scale;
+  m.m2_l1 = offset;
+  m.m2_l2 = bufsiz;
+  m.m2_p1 = (char *) buf;
+  return(_syscall(MM, PROFIL, &m));
+}
+
+
+PUBLIC int profil(buf, bufsiz, offset, scale)
+unsigned short *buf;
+size_t bufsiz;
+size_t offset;
+unsigned scale;
+{
+  return(pprofil(PROF_SELF, buf, bufsiz, offset, scale));
+}
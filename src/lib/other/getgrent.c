@@ -10,6 +10,7 @@
 #define close _close
 #include <sys/types.h>
 #include <grp.h>
+#include <minix/hashdb.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -96,12 +97,31 @@ static char *scan_punct(int punct)
 	return field;
 }
 
-struct group *getgrent(void)
-/* Read one entry from the group file. */
+static int scan_entry(void)
+/* Split the line into the fields of entry, return 0 if it is bad. */
 {
 	char *p;
 	char **mem;
 
+	if ((entry.gr_name= scan_punct(':')) == nil) return 0;
+	if ((entry.gr_passwd= scan_punct(':')) == nil) return 0;
+	if ((p= scan_punct(':')) == nil) return 0;
+	entry.gr_gid= strtol(p, nil, 0);
+
+	entry.gr_mem= mem= members;
+	if (*lineptr != '\n') {
+		do {
+			if ((*mem= scan_punct(',')) == nil) return 0;
+			if (mem < arraylimit(members) - 1) mem++;
+		} while (*lineptr != 0);
+	}
+	*mem= nil;
+	return 1;
+}
+
+struct group *getgrent(void)
+/* Read one entry from the group file. */
+{
 	/* Open the file if not yet open. */
 	if (grfd < 0 && setgrent() < 0) return nil;
 
@@ -109,30 +129,37 @@ struct group *getgrent(void)
 	for (;;) {
 		if (!getline()) return nil;	/* EOF or corrupt. */
 
-		if ((entry.gr_name= scan_punct(':')) == nil) continue;
-		if ((entry.gr_passwd= scan_punct(':')) == nil) continue;
-		if ((p= scan_punct(':')) == nil) continue;
-		entry.gr_gid= strtol(p, nil, 0);
-
-		entry.gr_mem= mem= members;
-		if (*lineptr != '\n') {
-			do {
-				if ((*mem= scan_punct(',')) == nil) goto again;
-				if (mem < arraylimit(members) - 1) mem++;
-			} while (*lineptr != 0);
-		}
-		*mem= nil;
-		return &entry;
-	again:;
+		if (scan_entry()) return &entry;
 	}
 }
 
+static int match_gid(char *rec, const void *key)
+/* Is this database record the entry of the group-id? */
+{
+	lineptr= rec;
+	return scan_entry() && entry.gr_gid == *(const gid_t *) key;
+}
+
+static int match_name(char *rec, const void *key)
+/* Is this database record the entry of the group name? */
+{
+	lineptr= rec;
+	return scan_entry() && strcmp(entry.gr_name, (const char *) key) == 0;
+}
+
 struct group *getgrgid(Gid_t gid)
 /* Return the group file entry belonging to the user-id. */
 {
 	struct group *gr;
+	gid_t key= gid;
+	int r;
 
 	endgrent();
+	if (grfile == nil) grfile= GROUP;
+	r= _hdbfind(grfile, HDB_GRGID, (unsigned) key, match_gid, &key,
+							grline, sizeof(grline));
+	if (r >= 0) return r > 0 ? &entry : nil;
+
 	while ((gr= getgrent()) != nil && gr->gr_gid != gid) {}
 	endgrent();
 	return gr;
@@ -142,8 +169,14 @@ struct group *getgrnam(const char *name)
 /* Return the group file entry belonging to the user name. */
 {
 	struct group *gr;
+	int r;
 
 	endgrent();
+	if (grfile == nil) grfile= GROUP;
+	r= _hdbfind(grfile, HDB_GRNAME, _hdbhash(name, strlen(name)),
+				match_name, name, grline, sizeof(grline));
+	if (r >= 0) return r > 0 ? &entry : nil;
+
 	while ((gr= getgrent()) != nil && strcmp(gr->gr_name, name) != 0) {}
 	endgrent();
 	return gr;
@@ -10,6 +10,7 @@
 #define close _close
 #include <sys/types.h>
 #include <pwd.h>
+#include <minix/hashdb.h>
 #include <string.h>
 #include <stdlib.h>
 #include <unistd.h>
@@ -94,11 +95,27 @@ static char *scan_colon(void)
 	return field;
 }
 
-struct passwd *getpwent(void)
-/* Read one entry from the password file. */
+static int scan_entry(void)
+/* Split the line into the fields of entry, return 0 if it is bad. */
 {
 	char *p;
 
+	if ((entry.pw_name= scan_colon()) == nil) return 0;
+	if ((entry.pw_passwd= scan_colon()) == nil) return 0;
+	if ((p= scan_colon()) == nil) return 0;
+	entry.pw_uid= strtol(p, nil, 0);
+	if ((p= scan_colon()) == nil) return 0;
+	entry.pw_gid= strtol(p, nil, 0);
+	if ((entry.pw_gecos= scan_colon()) == nil) return 0;
+	if ((entry.pw_dir= scan_colon()) == nil) return 0;
+	if ((entry.pw_shell= scan_colon()) == nil) return 0;
+
+	return *lineptr == 0;
+}
+
+struct passwd *getpwent(void)
+/* Read one entry from the password file. */
+{
 	/* Open the file if not yet open. */
 	if (pwfd < 0 && setpwent() < 0) return nil;
 
@@ -106,26 +123,37 @@ struct passwd *getpwent(void)
 	for (;;) {
 		if (!getline()) return nil;	/* EOF or corrupt. */
 
-		if ((entry.pw_name= scan_colon()) == nil) continue;
-		if ((entry.pw_passwd= scan_colon()) == nil) continue;
-		if ((p= scan_colon()) == nil) continue;
-		entry.pw_uid= strtol(p, nil, 0);
-		if ((p= scan_colon()) == nil) continue;
-		entry.pw_gid= strtol(p, nil, 0);
-		if ((entry.pw_gecos= scan_colon()) == nil) continue;
-		if ((entry.pw_dir= scan_colon()) == nil) continue;
-		if ((entry.pw_shell= scan_colon()) == nil) continue;
-
-		if (*lineptr == 0) return &entry;
+		if (scan_entry()) return &entry;
 	}
 }
 
+static int match_uid(char *rec, const void *key)
+/* Is this database record the entry of the user-id? */
+{
+	lineptr= rec;
+	return scan_entry() && entry.pw_uid == *(const uid_t *) key;
+}
+
+static int match_name(char *rec, const void *key)
+/* Is this database record the entry of the user name? */
+{
+	lineptr= rec;
+	return scan_entry() && strcmp(entry.pw_name, (const char *) key) == 0;
+}
+
 struct passwd *getpwuid(Uid_t uid)
 /* Return the password file entry belonging to the user-id. */
 {
 	struct passwd *pw;
+	uid_t key= uid;
+	int r;
 
 	endpwent();
+	if (pwfile == nil) pwfile= PASSWD;
+	r= _hdbfind(pwfile, HDB_PWUID, (unsigned) key, match_uid, &key,
+							pwline, sizeof(pwline));
+	if (r >= 0) return r > 0 ? &entry : nil;
+
 	while ((pw= getpwent()) != nil && pw->pw_uid != uid) {}
 	endpwent();
 	return pw;
@@ -135,8 +163,14 @@ struct passwd *getpwnam(const char *name)
 /* Return the password file entry belonging to the user name. */
 {
 	struct passwd *pw;
+	int r;
 
 	endpwent();
+	if (pwfile == nil) pwfile= PASSWD;
+	r= _hdbfind(pwfile, HDB_PWNAME, _hdbhash(name, strlen(name)),
+				match_name, name, pwline, sizeof(pwline));
+	if (r >= 0) return r > 0 ? &entry : nil;
+
 	while ((pw= getpwent()) != nil && strcmp(pw->pw_name, name) != 0) {}
 	endpwent();
 	return pw;
@@ -0,0 +1,96 @@
+/*	_hdbhash(), _hdbfind() - lookups in a hashed database
+ *
+ * The databases are made by mkdb(8) and described in <minix/hashdb.h>.
+ */
+#define nil 0
+#define open _open
+#define read _read
+#define lseek _lseek
+#define close _close
+#define stat _stat
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <minix/hashdb.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+unsigned _hdbhash(const char *key, size_t len)
+/* Hash a key, only the low 16 bits are kept in the database. */
+{
+	unsigned h= 0;
+
+	while (len > 0) {
+		h= (h << 5) + h + (unsigned char) *key++;
+		len--;
+	}
+	return h & 0xFFFF;
+}
+
+int _hdbfind(const char *file, int tab, unsigned hash,
+	int (*match)(char *rec, const void *key), const void *key,
+	char *buf, size_t size)
+/* Look in table 'tab' of the database of 'file' for a record with the hash
+ * of the key that 'match' says is the one.  The record is left in buf as a
+ * string.  Return its length, 0 if the key isn't there, or -1 if there is
+ * no database or it is older than the text file, and the text file must
+ * be searched instead.
+ */
+{
+	char dbname[64];
+	struct stat st;
+	struct hdb_head head;
+	struct hdb_slot slot;
+	unsigned i, n;
+	off_t base;
+	int fd, r;
+
+	if (strlen(file) + sizeof(HDB_SUFFIX) > sizeof(dbname)) return -1;
+	strcpy(dbname, file);
+	strcat(dbname, HDB_SUFFIX);
+
+	if (stat(file, &st) < 0) return -1;
+	if ((fd= open(dbname, O_RDONLY)) < 0) return -1;
+
+	if (read(fd, (char *) &head, sizeof(head)) != sizeof(head)
+		|| head.h_magic != HDB_MAGIC
+		|| tab >= head.h_ntab
+		|| head.h_nslot == 0
+		|| head.h_mtime != st.st_mtime
+		|| head.h_size != st.st_size
+	) {
+		(void) close(fd);
+		return -1;
+	}
+	base= sizeof(head) + (off_t) tab * head.h_nslot * sizeof(slot);
+	hash&= 0xFFFF;
+
+	r= 0;
+	i= hash & (head.h_nslot - 1);
+	for (n= 0; n < head.h_nslot; n++) {
+		if (lseek(fd, base + (off_t) i * sizeof(slot), SEEK_SET) == -1
+			|| read(fd, (char *) &slot, sizeof(slot)) != sizeof(slot)
+		) {
+			r= -1;
+			break;
+		}
+		if (slot.s_off == 0) break;		/* Not there. */
+
+		if (slot.s_hash == hash && slot.s_len < size) {
+			if (lseek(fd, slot.s_off, SEEK_SET) == -1
+				|| read(fd, buf, slot.s_len) != slot.s_len
+			) {
+				r= -1;
+				break;
+			}
+			buf[slot.s_len]= 0;
+			if ((*match)(buf, key)) {
+				r= slot.s_len;
+				break;
+			}
+		}
+		i= (i + 1) & (head.h_nslot - 1);
+	}
+	(void) close(fd);
+	return r;
+}
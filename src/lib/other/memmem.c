@@ -0,0 +1,19 @@
+#include <lib.h>
+/* memmem - find a block of bytes in another
+ *
+ * The search itself is shared with strstr(3).
+ */
+
+#include <string.h>
+
+_PROTOTYPE( void *_memmem, (const void *hay, size_t hlen,
+			    const void *pat, size_t plen));
+
+void *memmem(hay, hlen, pat, plen)
+_CONST void *hay;
+size_t hlen;
+_CONST void *pat;
+size_t plen;
+{
+  return(_memmem(hay, hlen, pat, plen));
+}
@@ -23,6 +23,7 @@
  *
  *	The third parameter to regexec was added by Martin C. Atkins.
  *	Andy Tanenbaum also made some changes.
+ *	The lazy DFA in front of the backtracking matcher is a MINIX addition.
  */
 
 #include <minix/config.h>
@@ -634,11 +635,114 @@ PRIVATE char *regbol;		/* Beginning of input, for ^ check. */
 PRIVATE char **regstartp;	/* Pointer to startp array. */
 PRIVATE char **regendp;		/* Ditto for endp. */
 
+/* The backtracking matcher can take time exponential in the length of the
+ * string on patterns like "(a+)+b", and even on simple ones it tries every
+ * starting point over again.  So regexec() first runs the program as a DFA,
+ * a deterministic automaton whose states are sets of positions in the
+ * program.  States are only made when the input leads to them, and they are
+ * kept with their transitions, so a program used on many strings soon runs
+ * by table lookup alone.  The DFA tells in one pass over the string whether
+ * there is a match.  If there is, a second one over the same positions runs
+ * back from the end of the string to its start.  Its states are the
+ * positions from which the rest of the string leads to END, so it sees each
+ * place where a match starts, and the last it sees is the first.  Only then
+ * does the backtracking matcher run, from that place, to find the end and
+ * the subexpressions the way it always did.  Every match it tries there
+ * exists, so it does not go astray.  All in all the string is read three
+ * times: up to the first match, by strlen(), and backwards.
+ *
+ * A position is a place in the program where the next character is to be
+ * matched, one for each character of an EXACTLY, or where EOL or END is.
+ * Characters that no node tells apart share a class, so the transition table
+ * of a state has a column per class instead of one per character.  When the
+ * room for states is full it is emptied and the DFA starts anew, so it never
+ * needs more than DFAMEM bytes; the few programs too big even for that are
+ * matched by backtracking only.  The DFAs of the last DFASLOTS programs are
+ * kept, found again by comparing the programs, as there is no regfree().
+ */
+#if _EM_WSIZE == 2
+#define	DFAMEM		4096	/* room for states of one DFA */
+#else
+#define	DFAMEM		32768
+#endif
+#define	DFASLOTS	4	/* DFAs kept */
+#define	MINSTATES	8	/* fewer states is not worth it */
+
+/* Kinds of position. */
+#define	P_CHAR		0	/* ANY, ANYOF or ANYBUT */
+#define	P_STR		1	/* a character of an EXACTLY */
+#define	P_STAR		2	/* STAR, goes back to itself */
+#define	P_PLUS		3	/* first character of a PLUS */
+#define	P_LOOP		4	/* next characters of a PLUS */
+#define	P_EOL		5	/* EOL */
+#define	P_END		6	/* END */
+#define	P_NONE		7	/* operand of a STAR or PLUS, never used */
+
+/* State flags. */
+#define	D_FLOAT		01	/* unanchored: a match may start anywhere */
+#define	D_ACCEPT	02	/* END is reached, there is a match */
+#define	D_DEAD		04	/* no positions left, there can't be */
+#define	D_BACK		010	/* runs backwards, see dfaback() */
+#define	D_START		020	/* backwards: a match starts here */
+
+#define	SETBIT(set, i)	((set)[(i) >> 3] |= 1 << ((i) & 7))
+#define	ISBIT(set, i)	((set)[(i) >> 3] & (1 << ((i) & 7)))
+
+struct pos {
+  char kind;			/* P_CHAR etc. */
+  char *node;			/* node of the position */
+  char *test;			/* what the next character must match */
+};
+
+struct dfa {
+  char *prog;			/* copy of the program */
+  unsigned plen;		/* its length */
+  int nnodes;			/* number of nodes */
+  char **node;			/* the nodes, in order */
+  int *first;			/* first position of each node */
+  char *mark;			/* nodes seen while adding positions */
+  int npos;			/* number of positions */
+  struct pos *pos;		/* the positions */
+  int endpos;			/* position of END */
+  int setlen;			/* bytes in a set of positions */
+  unsigned char *work;		/* set being made */
+  unsigned char *begin;		/* positions a match starts with */
+  unsigned char *back;		/* backwards set being made */
+  int nclass;			/* classes of characters */
+  unsigned char class[256];	/* class of each character */
+  int nstate, maxstate;		/* states made, room for */
+  int nflush;			/* times the states were thrown away */
+  int start[2][2];		/* start states by ^ and D_FLOAT */
+  int bstart[2];		/* backwards start states by ^ */
+  short *trans;			/* next state by class, -1 not known */
+  char *flags;			/* D_FLOAT etc. of each state */
+  unsigned char *sets;		/* positions of each state */
+};
+
+PRIVATE struct dfa *dfacache[DFASLOTS];	/* most recently used first */
+PRIVATE short newclass[2 * 256];	/* work array of dfabuild() */
+
 /* Forwards.
  */
 STATIC _PROTOTYPE( int regtry, (regexp *prog, char *string)		);
 STATIC _PROTOTYPE( int regmatch, (char *prog)				);
 STATIC _PROTOTYPE( int regrepeat, (char *p)				);
+STATIC _PROTOTYPE( struct dfa *regdfa, (regexp *prog)			);
+STATIC _PROTOTYPE( struct dfa *dfabuild, (char *prog, unsigned plen)	);
+STATIC _PROTOTYPE( int dfanpos, (char *p)				);
+STATIC _PROTOTYPE( int dfatest, (struct pos *pp, int c)			);
+STATIC _PROTOTYPE( int dfanode, (struct dfa *d, char *p)		);
+STATIC _PROTOTYPE( void dfaclear, (struct dfa *d)			);
+STATIC _PROTOTYPE( void dfaadd, (struct dfa *d, char *p, int atbol,
+							int ateol)	);
+STATIC _PROTOTYPE( void dfafollow, (struct dfa *d, int i)		);
+STATIC _PROTOTYPE( int dfastate, (struct dfa *d, int kind)		);
+STATIC _PROTOTYPE( int dfastart, (struct dfa *d, int atbol, int flt)	);
+STATIC _PROTOTYPE( int dfamove, (struct dfa *d, int st, int c)		);
+STATIC _PROTOTYPE( int dfarun, (struct dfa *d, char *s, int flt)	);
+STATIC _PROTOTYPE( int dfabstart, (struct dfa *d, int atbol)		);
+STATIC _PROTOTYPE( int dfaback, (struct dfa *d, int st, int c)		);
+STATIC _PROTOTYPE( char *dfafirst, (struct dfa *d, char *string)	);
 
 #ifdef DEBUG
 int regnarrate = 0;
@@ -655,6 +759,7 @@ register char *string;
 int bolflag;
 {
   register char *s;
+  register struct dfa *d;
 
   /* Be paranoid... */
   if (prog == (regexp *)NULL || string == (char *)NULL) {
@@ -686,6 +791,15 @@ int bolflag;
   else
 	regbol = (char *)NULL;
 
+  /* Let the DFA find out if and where the first match starts. */
+  if ((d = regdfa(prog)) != (struct dfa *)NULL) {
+	if (!dfarun(d, string, prog->reganch ? 0 : D_FLOAT)) return(0);
+	s = string;
+	if (!prog->reganch && (s = dfafirst(d, string)) == (char *)NULL)
+		return(0);	/* "Can't happen". */
+	return(regtry(prog, s));
+  }
+
   /* Simplest case:  anchored match need be tried only once. */
   if (prog->reganch) return(regtry(prog, string));
 
@@ -975,6 +1089,571 @@ register char *p;
 	return(p + offset);
 }
 
+/*
+ - regdfa - find the DFA of a program, or build it
+ */
+PRIVATE struct dfa *regdfa(prog)
+regexp *prog;
+{
+  register struct dfa *d;
+  register char *s;
+  register int i;
+  int op;
+  unsigned plen;
+
+  /* The program ends with its END node. */
+  s = prog->program + 1;
+  do {
+	op = OP(s);
+	s += 3;
+	if (op == ANYOF || op == ANYBUT || op == EXACTLY) s += strlen(s) + 1;
+  } while (op != END);
+  plen = s - prog->program;
+
+  for (i = 0; i < DFASLOTS && (d = dfacache[i]) != (struct dfa *)NULL; i++) {
+	if (d->plen == plen && memcmp(d->prog, prog->program, plen) == 0)
+		break;
+  }
+  if (i == DFASLOTS || d == (struct dfa *)NULL) {
+	if (i == DFASLOTS) {		/* throw the oldest one away */
+		i--;
+		free((void *) dfacache[i]->trans);
+		free((void *) dfacache[i]);
+		dfacache[i] = (struct dfa *)NULL;
+	}
+	if ((d = dfabuild(prog->program, plen)) == (struct dfa *)NULL)
+		return((struct dfa *)NULL);
+  }
+  for (; i > 0; i--) dfacache[i] = dfacache[i - 1];
+  dfacache[0] = d;
+  return(d->trans == (short *)NULL ? (struct dfa *)NULL : d);
+}
+
+/*
+ - dfabuild - make the positions of a program, and room for its states
+ */
+PRIVATE struct dfa *dfabuild(prog, plen)
+char *prog;
+unsigned plen;
+{
+  register struct dfa *d;
+  register struct pos *pp;
+  register char *s;
+  register int c;
+  char *t;
+  int nnodes, npos, i, n, k, op;
+  unsigned per;
+  long size;
+
+  /* Count the nodes and the positions. */
+  nnodes = npos = 0;
+  s = prog + 1;
+  do {
+	op = OP(s);
+	nnodes++;
+	npos += dfanpos(s);
+	s += 3;
+	if (op == ANYOF || op == ANYBUT || op == EXACTLY) s += strlen(s) + 1;
+  } while (op != END);
+
+  /* One block for all, the types with the largest alignment first. */
+  size = sizeof(struct dfa) + nnodes * (long) sizeof(char *)
+	+ npos * (long) sizeof(struct pos) + nnodes * (long) sizeof(int)
+	+ plen + nnodes + 3 * ((npos + 7) / 8);
+  if ((size_t) size != size) return((struct dfa *)NULL);
+  if ((d = (struct dfa *) malloc((size_t) size)) == (struct dfa *)NULL)
+	return((struct dfa *)NULL);
+  d->node = (char **) (d + 1);
+  d->pos = (struct pos *) (d->node + nnodes);
+  d->first = (int *) (d->pos + npos);
+  d->prog = (char *) (d->first + nnodes);
+  d->mark = d->prog + plen;
+  d->work = (unsigned char *) (d->mark + nnodes);
+  d->begin = d->work + (npos + 7) / 8;
+  d->back = d->begin + (npos + 7) / 8;
+  d->plen = plen;
+  d->nnodes = nnodes;
+  d->npos = npos;
+  d->setlen = (npos + 7) / 8;
+  memcpy(d->prog, prog, plen);
+
+  /* Number the nodes and make their positions. */
+  pp = d->pos;
+  s = d->prog + 1;
+  for (i = 0; i < nnodes; i++) {
+	d->node[i] = s;
+	d->first[i] = pp - d->pos;
+	op = OP(s);
+	switch (op) {
+	    case ANY:
+	    case ANYOF:
+	    case ANYBUT:
+		pp->kind = P_CHAR;
+		pp->test = s;
+		pp++->node = s;
+		break;
+	    case EXACTLY:
+		for (t = OPERAND(s); *t != '\0'; t++) {
+			pp->kind = P_STR;
+			pp->test = t;
+			pp++->node = s;
+		}
+		break;
+	    case STAR:
+	    case PLUS:
+		pp->kind = op == STAR ? P_STAR : P_PLUS;
+		pp->test = OPERAND(s);
+		pp++->node = s;
+		if (op == STAR) break;
+		pp->kind = P_LOOP;
+		pp->test = OPERAND(s);
+		pp++->node = s;
+		break;
+	    case EOL:
+	    case END:
+		if (op == END) d->endpos = pp - d->pos;
+		pp->kind = op == END ? P_END : P_EOL;
+		pp->test = s;
+		pp++->node = s;
+		break;
+	}
+	if (i > 0 && (OP(d->node[i - 1]) == STAR || OP(d->node[i - 1]) == PLUS)) {
+		/* The STAR or PLUS has the positions, not its operand. */
+		for (k = d->first[i]; k < pp - d->pos; k++)
+			d->pos[k].kind = P_NONE;
+	}
+	s += 3;
+	if (op == ANYOF || op == ANYBUT || op == EXACTLY) s += strlen(s) + 1;
+  }
+
+  /* The positions a match starts with, when not at the beginning of the
+   * line.
+   */
+  dfaclear(d);
+  dfaadd(d, d->prog + 1, 0, 0);
+  memcpy((void *) d->begin, (void *) d->work, (size_t) d->setlen);
+
+  /* Split the characters in classes, by what each position matches. */
+  memset((void *) d->class, 0, sizeof(d->class));
+  n = 1;
+  for (pp = d->pos; pp < d->pos + npos; pp++) {
+	if (pp->kind >= P_EOL) continue;
+	memset((void *) newclass, 0, 2 * n * sizeof(newclass[0]));
+	n = 0;
+	for (c = 1; c < 256; c++) {
+		k = 2 * d->class[c] + dfatest(pp, c);
+		if (newclass[k] == 0) newclass[k] = ++n;
+		d->class[c] = newclass[k] - 1;
+	}
+  }
+  d->nclass = n;
+
+  /* Room for as many states as fit in DFAMEM. */
+  per = d->setlen + 1 + n * sizeof(short);
+  d->maxstate = DFAMEM / per;
+  d->trans = (short *)NULL;
+  if (d->maxstate >= MINSTATES) {
+	d->trans = (short *) malloc((size_t) d->maxstate * per);
+  }
+  if (d->trans != (short *)NULL) {
+	d->flags = (char *) (d->trans + d->maxstate * n);
+	d->sets = (unsigned char *) (d->flags + d->maxstate);
+  }
+  d->nstate = 0;
+  d->nflush = 0;
+  d->start[0][0] = d->start[0][1] = d->start[1][0] = d->start[1][1] = -1;
+  d->bstart[0] = d->bstart[1] = -1;
+  return(d);
+}
+
+/*
+ - dfanpos - number of positions of a node
+ */
+PRIVATE int dfanpos(p)
+char *p;
+{
+  switch (OP(p)) {
+      case ANY:
+      case ANYOF:
+      case ANYBUT:
+      case STAR:
+      case EOL:
+      case END:	return(1);
+      case PLUS:	return(2);
+      case EXACTLY:	return(strlen(OPERAND(p)));
+      default:	return(0);
+  }
+}
+
+/*
+ - dfatest - does character c match at a position?
+ */
+PRIVATE int dfatest(pp, c)
+struct pos *pp;
+int c;
+{
+  register char *t = pp->test;
+
+  if (pp->kind == P_STR) return(c == UCHARAT(t));
+  switch (OP(t)) {
+      case ANY:	return(1);
+      case ANYOF:	return(strchr(OPERAND(t), c) != (char *)NULL);
+      case ANYBUT:	return(strchr(OPERAND(t), c) == (char *)NULL);
+      case EXACTLY:	return(c == UCHARAT(OPERAND(t)));
+  }
+  return(0);
+}
+
+/*
+ - dfanode - number of a node
+ */
+PRIVATE int dfanode(d, p)
+register struct dfa *d;
+register char *p;
+{
+  register int lo, hi, mid;
+
+  lo = 0;
+  hi = d->nnodes - 1;
+  while (lo < hi) {
+	mid = (lo + hi) / 2;
+	if (d->node[mid] < p) lo = mid + 1; else hi = mid;
+  }
+  return(lo);
+}
+
+/*
+ - dfaclear - start a new set of positions
+ */
+PRIVATE void dfaclear(d)
+register struct dfa *d;
+{
+  memset((void *) d->work, 0, (size_t) d->setlen);
+  memset((void *) d->mark, 0, (size_t) d->nnodes);
+}
+
+/*
+ - dfaadd - add the positions reached from node p without input
+ *
+ * Atbol tells whether we are at the beginning of the line, ateol whether at
+ * its end; at the end EOL is passed instead of kept as a position.
+ */
+PRIVATE void dfaadd(d, p, atbol, ateol)
+register struct dfa *d;
+register char *p;
+int atbol, ateol;
+{
+  register int i;
+
+  for (;;) {
+	i = dfanode(d, p);
+	if (d->mark[i]) return;
+	d->mark[i] = 1;
+	switch (OP(p)) {
+	    case BOL:
+		if (!atbol) return;
+		break;
+	    case EOL:
+		if (ateol) break;
+		SETBIT(d->work, d->first[i]);
+		return;
+	    case BRANCH:
+		if (OP(regnext(p)) != BRANCH) {	/* No choice. */
+			p = OPERAND(p);
+			continue;
+		}
+		do {
+			dfaadd(d, OPERAND(p), atbol, ateol);
+			p = regnext(p);
+		} while (p != (char *)NULL && OP(p) == BRANCH);
+		return;
+	    case STAR:
+		SETBIT(d->work, d->first[i]);
+		break;
+	    case ANY:
+	    case ANYOF:
+	    case ANYBUT:
+	    case EXACTLY:
+	    case PLUS:
+	    case END:
+		SETBIT(d->work, d->first[i]);
+		return;
+	    default:		/* NOTHING, BACK, OPEN, CLOSE */
+		break;
+	}
+	p = regnext(p);
+  }
+}
+
+/*
+ - dfastate - find the state of the set just made, or make it
+ *
+ * Kind is 0 or D_FLOAT for a state of the forward DFA, D_BACK for one of the
+ * backward DFA.
+ */
+PRIVATE int dfastate(d, kind)
+register struct dfa *d;
+int kind;
+{
+  register int st, n;
+  register unsigned char *set;
+  short *tp;
+
+  n = d->setlen;
+  for (st = 0, set = d->sets; st < d->nstate; st++, set += n) {
+	if ((d->flags[st] & (D_FLOAT | D_BACK)) == kind
+					&& memcmp(set, d->work, n) == 0)
+		return(st);
+  }
+  if (d->nstate == d->maxstate) {
+	/* Full, start over. */
+	d->nstate = 0;
+	d->nflush++;
+	d->start[0][0] = d->start[0][1] = d->start[1][0] = d->start[1][1] = -1;
+	d->bstart[0] = d->bstart[1] = -1;
+  }
+  st = d->nstate++;
+  set = d->sets + st * n;
+  memcpy(set, d->work, n);
+  d->flags[st] = kind;
+  if (kind == D_BACK) {
+	while (--n >= 0) {
+		if (set[n] & d->begin[n]) {
+			d->flags[st] |= D_START;
+			break;
+		}
+	}
+  } else {
+	if (ISBIT(set, d->endpos)) d->flags[st] |= D_ACCEPT;
+	while (n > 0 && set[n - 1] == 0) n--;
+	if (n == 0) d->flags[st] |= D_DEAD;
+  }
+  for (tp = d->trans + st * d->nclass, n = d->nclass; n > 0; n--) *tp++ = -1;
+  return(st);
+}
+
+/*
+ - dfastart - the state to start a run in
+ */
+PRIVATE int dfastart(d, atbol, flt)
+register struct dfa *d;
+int atbol, flt;
+{
+  register int st;
+
+  if ((st = d->start[atbol][flt]) < 0) {
+	dfaclear(d);
+	dfaadd(d, d->prog + 1, atbol, 0);
+	st = dfastate(d, flt);
+	d->start[atbol][flt] = st;
+  }
+  return(st);
+}
+
+/*
+ - dfafollow - add the positions that follow position i, once it matched
+ */
+PRIVATE void dfafollow(d, i)
+register struct dfa *d;
+int i;
+{
+  register struct pos *pp = &d->pos[i];
+
+  switch (pp->kind) {
+      case P_STR:
+	if (pp->test[1] != '\0')
+		SETBIT(d->work, i + 1);
+	else
+		dfaadd(d, regnext(pp->node), 0, 0);
+	break;
+      case P_STAR:
+	dfaadd(d, pp->node, 0, 0);
+	break;
+      case P_PLUS:		/* the P_LOOP is next */
+	SETBIT(d->work, i + 1);
+	dfaadd(d, regnext(pp->node), 0, 0);
+	break;
+      case P_LOOP:
+	SETBIT(d->work, i);
+	dfaadd(d, regnext(pp->node), 0, 0);
+	break;
+      default:
+	dfaadd(d, regnext(pp->node), 0, 0);
+	break;
+  }
+}
+
+/*
+ - dfamove - make the transition of a state on character c
+ */
+PRIVATE int dfamove(d, st, c)
+register struct dfa *d;
+int st, c;
+{
+  register struct pos *pp;
+  register int i;
+  unsigned char *set;
+  int flt, next, nflush;
+
+  flt = d->flags[st] & D_FLOAT;
+  set = d->sets + st * d->setlen;
+  dfaclear(d);
+  for (i = 0; i < d->npos; i++) {
+	if (set[i >> 3] == 0) {		/* skip empty bytes */
+		i |= 7;
+		continue;
+	}
+	if (!ISBIT(set, i)) continue;
+	pp = &d->pos[i];
+	if (pp->kind >= P_EOL || !dfatest(pp, c)) continue;
+	dfafollow(d, i);
+  }
+  if (flt) dfaadd(d, d->prog + 1, 0, 0);	/* a match may start here */
+
+  nflush = d->nflush;
+  next = dfastate(d, flt);
+  if (d->nflush == nflush) d->trans[st * d->nclass + d->class[c]] = next;
+  return(next);
+}
+
+/*
+ - dfarun - is there a match starting at s, or with flt anywhere after?
+ */
+PRIVATE int dfarun(d, s, flt)
+register struct dfa *d;
+register char *s;
+int flt;
+{
+  register int st, next;
+  register short *trans = d->trans;
+  int i, nclass = d->nclass;
+  unsigned char *set;
+
+  st = dfastart(d, s == regbol, flt);
+  for (;;) {
+	if (d->flags[st] & (D_ACCEPT | D_DEAD))
+		return((d->flags[st] & D_ACCEPT) != 0);
+	if (*s == '\0') break;
+	next = trans[st * nclass + d->class[UCHARAT(s)]];
+	if (next < 0) next = dfamove(d, st, UCHARAT(s));
+	st = next;
+	s++;
+  }
+
+  /* At the end of the string: is END behind one of the EOLs? */
+  set = d->sets + st * d->setlen;
+  dfaclear(d);
+  for (i = 0; i < d->npos; i++) {
+	if (ISBIT(set, i) && d->pos[i].kind == P_EOL)
+		dfaadd(d, regnext(d->pos[i].node), s == regbol, 1);
+  }
+  return(ISBIT(d->work, d->endpos) != 0);
+}
+
+/*
+ - dfabstart - the state to run backwards from, at the end of the string
+ *
+ * The backward DFA is in the state of the positions from which the rest of
+ * the string leads to END.  At the end that is END itself, and the EOLs that
+ * END is behind.
+ */
+PRIVATE int dfabstart(d, atbol)
+register struct dfa *d;
+int atbol;
+{
+  register int i;
+
+  if (d->bstart[atbol] < 0) {
+	memset((void *) d->back, 0, (size_t) d->setlen);
+	SETBIT(d->back, d->endpos);
+	for (i = 0; i < d->npos; i++) {
+		if (d->pos[i].kind != P_EOL) continue;
+		dfaclear(d);
+		dfaadd(d, regnext(d->pos[i].node), atbol, 1);
+		if (ISBIT(d->work, d->endpos)) SETBIT(d->back, i);
+	}
+	memcpy((void *) d->work, (void *) d->back, (size_t) d->setlen);
+	d->bstart[atbol] = dfastate(d, D_BACK);
+  }
+  return(d->bstart[atbol]);
+}
+
+/*
+ - dfaback - make the transition of a backward state on character c
+ *
+ * Going back over c, a position is kept if it matches c and one of the
+ * positions that follow it is in the state.
+ */
+PRIVATE int dfaback(d, st, c)
+register struct dfa *d;
+int st, c;
+{
+  register struct pos *pp;
+  register int i, k;
+  unsigned char *set;
+  int next, nflush;
+
+  set = d->sets + st * d->setlen;
+  memset((void *) d->back, 0, (size_t) d->setlen);
+  SETBIT(d->back, d->endpos);
+  for (i = 0; i < d->npos; i++) {
+	pp = &d->pos[i];
+	if (pp->kind >= P_EOL || !dfatest(pp, c)) continue;
+	dfaclear(d);
+	dfafollow(d, i);
+	for (k = 0; k < d->setlen; k++) {
+		if (d->work[k] & set[k]) {
+			SETBIT(d->back, i);
+			break;
+		}
+	}
+  }
+  memcpy((void *) d->work, (void *) d->back, (size_t) d->setlen);
+
+  nflush = d->nflush;
+  next = dfastate(d, D_BACK);
+  if (d->nflush == nflush) d->trans[st * d->nclass + d->class[c]] = next;
+  return(next);
+}
+
+/*
+ - dfafirst - where does the first match start?
+ */
+PRIVATE char *dfafirst(d, string)
+register struct dfa *d;
+char *string;
+{
+  register char *s;
+  register int st, next;
+  register short *trans = d->trans;
+  int i, nclass = d->nclass;
+  char *first;
+  unsigned char *set;
+
+  s = string + strlen(string);
+  st = dfabstart(d, s == regbol);
+  first = (char *)NULL;
+  for (;;) {
+	if (d->flags[st] & D_START) first = s;
+	if (s == string) break;
+	s--;
+	next = trans[st * nclass + d->class[UCHARAT(s)]];
+	if (next < 0) next = dfaback(d, st, UCHARAT(s));
+	st = next;
+  }
+
+  /* A match that begins with ^ can only start at regbol. */
+  if (s == regbol && first != s) {
+	set = d->sets + st * d->setlen;
+	dfaclear(d);
+	dfaadd(d, d->prog + 1, 1, 0);
+	for (i = 0; i < d->setlen; i++) {
+		if (d->work[i] & set[i]) return(s);
+	}
+  }
+  return(first);
+}
+
 #ifdef DEBUG
 
 STATIC char *regprop();
@@ -27,10 +27,13 @@
  *   - Incorporated Klamer's V1.2 fixes into V1.3
  *   - Added %d, (old %d is now %2)			 [tgoto]
  *   - Allow '#' comments in definition file		 [tgetent]
+ *
+ *   - Look in the hashed database made by mkdb(8) first	 [tgetent]
  */
 
 #include <lib.h>
 #include <termcap.h>
+#include <minix/hashdb.h>
 #include <ctype.h>
 #include <stdlib.h>
 #include <string.h>
@@ -46,6 +49,29 @@ extern char *BC;		/* back cursor movement */
 extern char *UP;		/* up cursor movement */
 #endif
 
+_PROTOTYPE( PRIVATE int tcmatch, (char *entry, const void *name) );
+
+/*
+ *	tcmatch - see if any of the terminal names in entry matches name.
+ */
+
+PRIVATE int tcmatch(entry, name)
+char *entry;
+_CONST void *name;
+{
+  register char *cp = entry;
+  short len = strlen((_CONST char *) name);
+
+  while (isspace(*cp)) cp++;
+  do {
+	if (strncmp((_CONST char *) name, cp, len) == 0 &&
+	    (cp[len] == '|' || cp[len] == ':'))
+		return(1);
+	while ((*cp) && (*cp != '|') && (*cp != ':')) cp++;
+  } while (*cp++ == '|');
+  return(0);
+}
+
 /*
  *	tgetent - get the termcap entry for terminal name, and put it
  *	in bp (which must be an array of 1024 chars). Returns 1 if
@@ -59,7 +85,6 @@ char *name;
   FILE *fp;
   char *file;
   char *term;
-  short len = strlen(name);
 
   capab = bp;
 
@@ -78,6 +103,16 @@ char *name;
 	} else
 		file = "/etc/termcap";
 
+  /* A database made by mkdb has the entry at once, if it is up to date. */
+  switch (_hdbfind(file, HDB_TCNAME, _hdbhash(name, strlen(name)),
+						tcmatch, name, bp, 1024)) {
+      case -1:	break;		/* read the text file */
+      case 0:
+	capab = (char *)NULL;	/* not found */
+	return(0);
+      default:	return(1);
+  }
+
   if ((fp = fopen(file, "r")) == (FILE *) NULL) {
 	capab = (char *)NULL;		/* no valid termcap  */
 	return(-1);
@@ -104,14 +139,10 @@ char *name;
 	/* See if any of the terminal names in this definition */
 	/* Match "name".						 */
 
-	do {
-		if (strncmp(name, cp, len) == 0 &&
-		    (cp[len] == '|' || cp[len] == ':')) {
-			fclose(fp);
-			return(1);
-		}
-		while ((*cp) && (*cp != '|') && (*cp != ':')) cp++;
-	} while (*cp++ == '|');
+	if (tcmatch(cp, name)) {
+		fclose(fp);
+		return(1);
+	}
   }
 }
 
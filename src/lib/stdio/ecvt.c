@@ -2,17 +2,295 @@
 
 #ifndef NOFLOAT
 
-#include	"../ansi/ext_fmt.h"
-void _dbl_ext_cvt(double value, struct EXTEND *e);
-char *_ext_str_cvt(struct EXTEND *e, int ndigit, int *decpt, int * sign, int ecvtflag);
+#include	<float.h>
+#include	<math.h>
+#include	"loc_incl.h"
+
+/*
+ * The digits are made exactly: the value is f * 2^e with an integer f,
+ * so with big integers r, s and the power of ten k, r/s is value / 10^k,
+ * and each digit is the integer part of 10 * r/s.  The last digit is
+ * rounded to nearest, ties to even, like the value would be.
+ *
+ * The rounding interval of the value, the reals that read back as it, is
+ * tracked as well (mp and mm are the distances to its ends).  As soon as
+ * the digits so far, possibly with the last one rounded up, fall inside it,
+ * they are the shortest that give the value back.  When there are no more
+ * of them than asked for, and at most DBL_DIG, they are what rounding the
+ * exact value would give, padded with zeros, and the work stops there.
+ * So 0.1 is done after one digit, not after the 17 that 0.1000000000000000
+ * 055511151231257827 needs to tell the same.
+ */
+
+#define	NDIGITS		340		/* DBL_MAX has 309 digits */
+#define	NLIMB		74		/* 16 bit limbs, > 1150 bits */
+
+struct big {
+	int	n;			/* limbs in use */
+	unsigned short d[NLIMB];	/* least significant first */
+};
+
+static struct big r, s, mp, mm, t;
+
+static void
+big_set(register struct big *b, unsigned long v)
+{
+	b->n = 0;
+	while (v != 0) {
+		b->d[b->n++] = (unsigned short) v;
+		v >>= 16;
+	}
+}
+
+static void
+big_pow2(register struct big *b, int n)
+{
+	register int i;
+
+	b->n = n / 16 + 1;
+	for (i = 0; i < b->n; i++) b->d[i] = 0;
+	b->d[n / 16] = (unsigned) 1 << (n % 16);
+}
+
+static void
+big_shl(register struct big *b, int n)
+{
+	register int i;
+	int w = n / 16;
+	unsigned long v;
+
+	n %= 16;
+	if (b->n == 0) return;
+	b->d[b->n] = 0;
+	for (i = b->n; i >= 0; i--) {
+		v = (unsigned long) b->d[i] << n;
+		if (i > 0 && n > 0) v |= b->d[i - 1] >> (16 - n);
+		b->d[i + w] = (unsigned short) v;
+	}
+	for (i = 0; i < w; i++) b->d[i] = 0;
+	b->n += w + 1;
+	while (b->n > 0 && b->d[b->n - 1] == 0) b->n--;
+}
+
+static void
+big_mul(register struct big *b, unsigned m)
+{
+	/* m is at most 10000 */
+	register int i;
+	unsigned long v = 0;
+
+	for (i = 0; i < b->n; i++) {
+		v += (unsigned long) b->d[i] * m;
+		b->d[i] = (unsigned short) v;
+		v >>= 16;
+	}
+	if (v != 0) b->d[b->n++] = (unsigned short) v;
+}
+
+static void
+big_pow10(register struct big *b, int n)
+{
+	for (; n >= 4; n -= 4) big_mul(b, 10000);
+	while (--n >= 0) big_mul(b, 10);
+}
+
+static int
+big_cmp(register struct big *a, register struct big *b)
+{
+	register int i;
+
+	if (a->n != b->n) return a->n < b->n ? -1 : 1;
+	for (i = a->n - 1; i >= 0; i--)
+		if (a->d[i] != b->d[i]) return a->d[i] < b->d[i] ? -1 : 1;
+	return 0;
+}
+
+static void
+big_sub(register struct big *a, register struct big *b)
+{
+	/* a -= b, a >= b */
+	register int i;
+	long v = 0;
+
+	for (i = 0; i < a->n; i++) {
+		v += (long) a->d[i] - (i < b->n ? b->d[i] : 0);
+		a->d[i] = (unsigned short) v;
+		v = v < 0 ? -1 : 0;
+	}
+	while (a->n > 0 && a->d[a->n - 1] == 0) a->n--;
+}
+
+static void
+big_add(register struct big *c, register struct big *a, register struct big *b)
+{
+	/* c = a + b */
+	register int i;
+	unsigned long v = 0;
+	int n = a->n > b->n ? a->n : b->n;
+
+	for (i = 0; i < n; i++) {
+		v += (unsigned long) (i < a->n ? a->d[i] : 0)
+				+ (i < b->n ? b->d[i] : 0);
+		c->d[i] = (unsigned short) v;
+		v >>= 16;
+	}
+	if (v != 0) c->d[i++] = (unsigned short) v;
+	c->n = i;
+}
+
+/* Add one to the last of the 'n' digits at 'buf', return 1 if that made
+ * them "1000...".
+ */
+static int
+round_up(char *buf, int n)
+{
+	register char *p = buf + n;
+
+	while (--p >= buf) {
+		if (*p != '9') {
+			++*p;
+			return 0;
+		}
+		*p = '0';
+	}
+	*buf = '1';
+	return 1;
+}
 
 static char *
 cvt(long double value, int ndigit, int *decpt, int *sign, int ecvtflag)
 {
-	struct EXTEND e;
+	static char buf[NDIGITS+1];
+	double v;
+	unsigned long hi, lo;
+	int e, be, ue, k, n, i, d, c;
+	int even, low, high, shortest;
+	struct big *mmp;
+
+	*sign = value < 0;
+	v = frexp(*sign ? -value : value, &e);
+	if (ndigit < 0) ndigit = 0;
+	if (v == 0) {
+		if (ndigit > NDIGITS) ndigit = NDIGITS;
+		for (i = 0; i < ndigit; i++) buf[i] = '0';
+		buf[i] = '\0';
+		*decpt = 0;
+		return buf;
+	}
+
+	/* value = (hi * 2^32 + lo) * 2^be, the last place of the mantissa
+	 * is worth 2^ue.
+	 */
+	v *= 4294967296.0;
+	hi = v;
+	lo = (v - hi) * 4294967296.0;
+	be = e - 64;
+	ue = (e < DBL_MIN_EXP ? DBL_MIN_EXP : e) - DBL_MANT_DIG;
+	i = ue - be;
+	even = !((i < 32 ? lo >> i : hi >> (i - 32)) & 1);
+
+	/* r/s = value, mp and mm are half the gaps to the neighbours. */
+	big_set(&r, hi);
+	big_shl(&r, 32);
+	big_set(&t, lo);
+	big_add(&r, &r, &t);
+	if (be >= 0) {
+		big_shl(&r, be);
+		big_set(&s, 1L);
+		be = 0;
+	} else {
+		big_pow2(&s, -be);
+	}
+	big_pow2(&mp, ue - 1 - be);
+	mmp = &mp;
+	if (hi == 0x80000000L && lo == 0 && e > DBL_MIN_EXP) {
+		/* the gap below a power of two is half the one above */
+		big_pow2(&mm, ue - 2 - be);
+		mmp = &mm;
+	}
+
+	/* Scale so that 0.1 <= r/s < 1, k is the decimal exponent. */
+	k = (int) ((long) (e - 1) * 1233 / 4096);	/* about log10(2) */
+	if (k >= 0) {
+		big_pow10(&s, k);
+	} else {
+		big_pow10(&r, -k);
+		big_pow10(&mp, -k);
+		if (mmp == &mm) big_pow10(&mm, -k);
+	}
+	while (big_cmp(&r, &s) >= 0) {
+		big_mul(&s, 10);
+		k++;
+	}
+	for (;;) {
+		t = r;
+		big_mul(&t, 10);
+		if (big_cmp(&t, &s) >= 0) break;
+		r = t;
+		big_mul(&mp, 10);
+		if (mmp == &mm) big_mul(&mm, 10);
+		k--;
+	}
+	*decpt = k;
+
+	n = ecvtflag ? ndigit : k + ndigit;
+	if (n > NDIGITS) n = NDIGITS;
+	shortest = n <= DBL_DIG && e >= DBL_MIN_EXP;
+
+	for (i = 0; i < n; ) {
+		big_mul(&r, 10);
+		d = 0;
+		while (big_cmp(&r, &s) >= 0) {
+			big_sub(&r, &s);
+			d++;
+		}
+		buf[i++] = '0' + d;
+		if (!shortest) continue;
+
+		big_mul(&mp, 10);
+		if (mmp == &mm) big_mul(&mm, 10);
+		c = big_cmp(&r, mmp);
+		low = c < 0 || (even && c == 0);
+		big_add(&t, &r, &mp);
+		c = big_cmp(&t, &s);
+		high = c > 0 || (even && c == 0);
+		if (!low && !high) continue;
+
+		/* Done; with the last digit rounded up if that is closer. */
+		if (high) {
+			big_add(&t, &r, &r);
+			c = big_cmp(&t, &s);
+			if (!low || c > 0 || (c == 0 && (d & 1))) {
+				if (round_up(buf, i)) {
+					++*decpt;
+					if (!ecvtflag && n < NDIGITS) n++;
+				}
+			}
+		}
+		while (i < n) buf[i++] = '0';
+		buf[n] = '\0';
+		return buf;
+	}
 
-	_dbl_ext_cvt(value, &e);
-	return _ext_str_cvt(&e, ndigit, decpt, sign, ecvtflag);
+	/* Round the rest off, to even on a tie. */
+	if (n < 0 || (n == 0 && ecvtflag)) {
+		buf[0] = '\0';
+		return buf;
+	}
+	big_add(&t, &r, &r);
+	c = big_cmp(&t, &s);
+	if (c > 0 || (c == 0 && n > 0 && (buf[n - 1] & 1))) {
+		if (round_up(buf, n)) {
+			++*decpt;
+			if (!ecvtflag) {
+				/* one more digit before the point */
+				if (n == 0) n = 1;
+				else if (n < NDIGITS) buf[n++] = '0';
+			}
+		}
+	}
+	buf[n] = '\0';
+	return buf;
 }
 
 char *
@@ -14,6 +14,7 @@ int
 fflush(FILE *stream)
 {
 	int count, c1, i, retval = 0;
+	char *p;
 
 	if (!stream) {
 	    for(i= 0; i < FOPEN_MAX; i++)
@@ -54,7 +55,12 @@ fflush(FILE *stream)
 			return EOF;
 		}
 	}
-	c1 = _write(stream->_fd, (char *)stream->_buf, count);
+	/* write() may write less than asked for, so loop ... */
+	p = (char *)stream->_buf;
+	while ((c1 = _write(stream->_fd, p, count)) > 0 && c1 < count) {
+		count -= c1;
+		p += c1;
+	}
 
 	stream->_count = 0;
 
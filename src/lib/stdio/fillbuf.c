@@ -7,7 +7,6 @@
 #include	<sys/types.h>
 #endif
 #include	<stdio.h>
-#include	<stdlib.h>
 #include	"loc_incl.h"
 
 ssize_t _read(ssize_t d, char *buf, size_t nbytes);
@@ -30,14 +29,9 @@ __fillbuf(register FILE *stream)
 		stream->_flags |= _IOREADING;
 	
 	if (!io_testflag(stream, _IONBF) && !stream->_buf) {
-		stream->_buf = (unsigned char *) malloc(BUFSIZ);
-		if (!stream->_buf) {
+		if (!__getbuf(stream)) {
 			stream->_flags |= _IONBF;
 		}
-		else {
-			stream->_flags |= _IOMYBUF;
-			stream->_bufsiz = BUFSIZ;
-		}
 	}
 
 	/* flush line-buffered output when filling an input buffer */
@@ -41,7 +41,8 @@ __flushbuf(int c, FILE * stream)
 	stream->_flags |= _IOWRITING;
 	if (!io_testflag(stream, _IONBF)) {
 		if (!stream->_buf) {
-			if (stream == stdout && _isatty(fileno(stdout))) {
+			if (stream == stdout && !io_testflag(stream, _IOSETVBUF)
+			    && _isatty(fileno(stdout))) {
 				if (!(stream->_buf =
 					    (unsigned char *) malloc(BUFSIZ))) {
 					stream->_flags |= _IONBF;
@@ -51,14 +52,11 @@ __flushbuf(int c, FILE * stream)
 					stream->_count = -1;
 				}
 			} else {
-				if (!(stream->_buf =
-					    (unsigned char *) malloc(BUFSIZ))) {
+				if (!__getbuf(stream)) {
 					stream->_flags |= _IONBF;
 				} else {
-					stream->_flags |= _IOMYBUF;
-					stream->_bufsiz = BUFSIZ;
 					if (!io_testflag(stream, _IOLBF))
-						stream->_count = BUFSIZ - 1;
+						stream->_count = stream->_bufsiz - 1;
 					else	stream->_count = -1;
 				}
 			}
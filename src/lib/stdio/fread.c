@@ -3,27 +3,70 @@
  */
 /* $Header: fread.c,v 1.2 89/12/18 15:02:09 eck Exp $ */
 
+#include	<sys/types.h>
 #include	<stdio.h>
+#include	<string.h>
+#include	"loc_incl.h"
+
+ssize_t _read(ssize_t d, char *buf, size_t nbytes);
 
 size_t
 fread(void *ptr, size_t size, size_t nmemb, register FILE *stream)
 {
 	register char *cp = ptr;
-	register int c;
-	size_t ndone = 0;
-	register size_t s;
+	register size_t n;
+	size_t total, left;
+	ssize_t r;
+	int c, i;
+
+	if (size == 0 || nmemb == 0)
+		return 0;
+	if (nmemb > (size_t) -1 / size)
+		nmemb = (size_t) -1 / size;
+	total = left = size * nmemb;
+
+	while (left > 0) {
+		/* Copy what is left in the buffer. */
+		if (io_testflag(stream, _IOREADING) && stream->_count > 0) {
+			n = stream->_count;
+			if (n > left) n = left;
+			memcpy(cp, stream->_ptr, n);
+			stream->_ptr += n;
+			stream->_count -= n;
+			cp += n;
+			left -= n;
+			continue;
+		}
 
-	if (size)
-		while ( ndone < nmemb ) {
-			s = size;
-			do {
-				if ((c = getc(stream)) != EOF)
-					*cp++ = c;
-				else
-					return ndone;
-			} while (--s);
-			ndone++;
+		/* The buffer is empty.  If the rest would fill it anyway, read
+		 * straight into the array, else let __fillbuf() get a buffer
+		 * full, or set the stream up the first time round.
+		 */
+		if (io_testflag(stream, _IOREADING)
+		    && !io_testflag(stream, (_IOEOF | _IOERR))
+		    && stream->_buf && left >= stream->_bufsiz) {
+			for (i = 0; i < FOPEN_MAX; i++) {
+				if (__iotab[i]
+				    && io_testflag(__iotab[i], _IOLBF)
+				    && io_testflag(__iotab[i], _IOWRITING))
+					(void) fflush(__iotab[i]);
+			}
+			stream->_ptr = stream->_buf;
+			stream->_count = 0;
+			if ((r = _read(fileno(stream), cp, left)) <= 0) {
+				if (r == 0) stream->_flags |= _IOEOF;
+				else stream->_flags |= _IOERR;
+				break;
+			}
+			cp += r;
+			left -= r;
+			continue;
 		}
+		if ((c = __fillbuf(stream)) == EOF)
+			break;
+		*cp++ = c;
+		left--;
+	}
 
-	return ndone;
+	return (total - left) / size;
 }
@@ -32,7 +32,8 @@ freopen(const char *name, const char *mode, FILE *stream)
 {
 	register int i;
 	int rwmode = 0, rwflags = 0;
-	int fd, flags = stream->_flags & (_IONBF | _IOFBF | _IOLBF | _IOMYBUF);
+	int fd, flags = stream->_flags & (_IONBF | _IOFBF | _IOLBF | _IOMYBUF
+						| _IOSETVBUF);
 
 	(void) fflush(stream);				/* ignore errors */
 	(void) _close(fileno(stream));
@@ -3,27 +3,87 @@
  */
 /* $Header: fwrite.c,v 1.3 89/12/18 15:02:39 eck Exp $ */
 
+#include	<sys/types.h>
 #include	<stdio.h>
+#include	<string.h>
+#include	"loc_incl.h"
+
+off_t _lseek(int fildes, off_t offset, int whence);
+ssize_t _write(int d, const char *buf, size_t nbytes);
 
 size_t
 fwrite(const void *ptr, size_t size, size_t nmemb,
 	    register FILE *stream)
 {
 	register const unsigned char *cp = ptr;
-	register size_t s;
-	size_t ndone = 0;
-
-	if (size)
-		while ( ndone < nmemb ) {
-			s = size;
-			do {
-				if (putc((int)*cp, stream)
-					== EOF)
-					return ndone;
-				cp++;
-			} 
-			while (--s);
-			ndone++;
+	register size_t n;
+	size_t total, left;
+	ssize_t r;
+
+	if (size == 0 || nmemb == 0)
+		return 0;
+	if (nmemb > (size_t) -1 / size)
+		nmemb = (size_t) -1 / size;
+	total = left = size * nmemb;
+
+	while (left > 0) {
+		/* Line buffered streams and the first byte go through putc(),
+		 * so that __flushbuf() sets the stream up and looks for the
+		 * newlines.
+		 */
+		if (!io_testflag(stream, _IOWRITING)
+		    || io_testflag(stream, _IOLBF)
+		    || (!io_testflag(stream, _IONBF) && !stream->_buf)) {
+			if (putc((int)*cp, stream) == EOF)
+				break;
+			cp++;
+			left--;
+			continue;
+		}
+
+		/* Copy into the room left in the buffer. */
+		if (!io_testflag(stream, _IONBF) && stream->_count > 0) {
+			n = stream->_count;
+			if (n > left) n = left;
+			memcpy(stream->_ptr, cp, n);
+			stream->_ptr += n;
+			stream->_count -= n;
+			cp += n;
+			left -= n;
+			continue;
+		}
+
+		/* A full buffer is written out first. */
+		if (!io_testflag(stream, _IONBF)
+		    && stream->_ptr != stream->_buf) {
+			if (fflush(stream))
+				break;
+			continue;
+		}
+
+		/* The buffer is empty.  Write the rest straight from the array
+		 * if it would fill the buffer, else start a new buffer.
+		 */
+		if (!io_testflag(stream, _IONBF) && left < stream->_bufsiz) {
+			if (putc((int)*cp, stream) == EOF)
+				break;
+			cp++;
+			left--;
+			continue;
 		}
-	return ndone;
+		if (io_testflag(stream, _IOAPPEND)) {
+			if (_lseek(fileno(stream), 0L, SEEK_END) == -1) {
+				stream->_flags |= _IOERR;
+				break;
+			}
+		}
+		if ((r = _write(fileno(stream), (const char *)cp, left)) <= 0) {
+			stream->_flags |= _IOERR;
+			break;
+		}
+		cp += r;
+		left -= r;
+	}
+
+	return (total - left) / size;
 }
@@ -0,0 +1,58 @@
+/*
+ * getbuf.c - give a stream a buffer that suits its file
+ */
+/* $Header$ */
+
+#include	<sys/types.h>
+#include	<sys/stat.h>
+#include	<stdio.h>
+#include	<stdlib.h>
+#include	"loc_incl.h"
+
+int _fstat(int fd, struct stat *buf);
+
+/* Regular files and block devices are read and written in large pieces,
+ * the rest (terminals, pipes) a line or a block at a time.  STDIOBUF in the
+ * environment can make the size for files smaller, a value that is not a
+ * positive number is ignored.
+ */
+#if	_EM_WSIZE == 2
+#define	BIGBUFSIZ	(4 * BUFSIZ)
+#else
+#define	BIGBUFSIZ	(16 * BUFSIZ)
+#endif
+
+int
+__getbuf(register FILE *stream)
+{
+	static int bigsize = 0;
+	struct stat st;
+	int size = BUFSIZ;
+	char *s, *end;
+	long n;
+
+	if (bigsize == 0) {
+		bigsize = BIGBUFSIZ;
+		if ((s = getenv("STDIOBUF")) != NULL) {
+			n = strtol(s, &end, 10);
+			if (end != s && *end == '\0' && n > 0)
+				bigsize = n < BIGBUFSIZ ? (int) n : BIGBUFSIZ;
+		}
+	}
+	if (_fstat(fileno(stream), &st) == 0
+	    && (S_ISREG(st.st_mode) || S_ISBLK(st.st_mode)))
+		size = bigsize;
+
+	/* If the large buffer doesn't fit, a small one will do. */
+	stream->_buf = (unsigned char *) malloc((size_t) size);
+	if (!stream->_buf && size > BUFSIZ) {
+		size = BUFSIZ;
+		stream->_buf = (unsigned char *) malloc((size_t) size);
+	}
+	if (!stream->_buf)
+		return 0;
+	stream->_flags |= _IOMYBUF;
+	stream->_bufsiz = size;
+	stream->_ptr = stream->_buf;
+	return 1;
+}
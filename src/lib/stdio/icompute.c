@@ -3,19 +3,73 @@
  */
 /* $Header: icompute.c,v 1.1 89/12/18 14:59:38 eck Exp $ */
 
+#include	<limits.h>
 #include	"loc_incl.h"
 
 /* This routine is used in doprnt.c as well as in tmpfile.c and tmpnam.c. */
 
+/* The digits are made from the right.  Decimal goes two digits per divide,
+ * by a table of the pairs, in unsigned arithmetic as soon as the value fits
+ * (a long divide is a subroutine call on a 16 bit machine).  The other bases
+ * that printf() uses are powers of two, and need no divide at all.
+ */
+
+static const char pairs[] =
+	"00010203040506070809101112131415161718192021222324252627282930313233"
+	"34353637383940414243444546474849505152535455565758596061626364656667"
+	"6869707172737475767778798081828384858687888990919293949596979899";
+
 char *
 _i_compute(unsigned long val, int base, char *s, int nrdigits)
 {
-	int c;
+	char buf[8 * sizeof(long)];
+	register char *p = buf + sizeof(buf);
+	register unsigned u, i;
+	unsigned long q;
+	int shift;
+
+	switch (base) {
+	case 10:
+		while (val > UINT_MAX) {
+			q = val / 100;
+			i = (unsigned) (val - q * 100) * 2;
+			*--p = pairs[i + 1];
+			*--p = pairs[i];
+			val = q;
+		}
+		for (u = val; u >= 100; u /= 100) {
+			i = u % 100 * 2;
+			*--p = pairs[i + 1];
+			*--p = pairs[i];
+		}
+		if (u >= 10) {
+			*--p = pairs[u * 2 + 1];
+			*--p = pairs[u * 2];
+		} else {
+			*--p = u + '0';
+		}
+		break;
+	case 2:
+	case 8:
+	case 16:
+		shift = base == 16 ? 4 : base == 8 ? 3 : 1;
+		do {
+			*--p = "0123456789abcdef"[(unsigned) val & (base - 1)];
+			val >>= shift;
+		} while (val != 0);
+		break;
+	default:
+		do {
+			i = val % base;
+			*--p = i > 9 ? i - 10 + 'a' : i + '0';
+			val /= base;
+		} while (val != 0);
+		break;
+	}
 
-	c= val % base ;
-	val /= base ;
-	if (val || nrdigits > 1)
-		s = _i_compute(val, base, s, nrdigits - 1);
-	*s++ = (c>9 ? c-10+'a' : c+'0');
+	for (i = buf + sizeof(buf) - p; (int) i < nrdigits; i++)
+		*s++ = '0';
+	while (p < buf + sizeof(buf))
+		*s++ = *p++;
 	return s;
 }
@@ -7,6 +7,8 @@
 
 #define	io_testflag(p,x)	((p)->_flags & (x))
 
+#define	_IOSETVBUF	0x400		/* buffering chosen with setvbuf() */
+
 #include	<stdarg.h>
 
 #ifdef _ANSI
@@ -15,6 +17,7 @@ int _doscan(FILE * stream, const char *format, va_list ap);
 char *_i_compute(unsigned long val, int base, char *s, int nrdigits);
 char *_f_print(va_list *ap, int flags, char *s, char c, int precision);
 void __cleanup(void);
+int __getbuf(FILE *stream);
 
 FILE *popen(const char *command, const char *type);
 FILE *fdopen(int fd, const char *mode);
@@ -22,10 +22,14 @@ setvbuf(register FILE *stream, char *buf, int mode, size_t size)
 		free((void *)stream->_buf);
 
 	stream->_flags &= ~(_IOMYBUF | _IONBF | _IOLBF);
+	stream->_flags |= _IOSETVBUF;
 
+	/* Without a buffer or a size the buffer is made at the first read
+	 * or write, with the size that suits the file.
+	 */
 	if (buf && size <= 0) retval = EOF;
-	if (!buf && (mode != _IONBF)) {
-		if (size <= 0 || (buf = (char *) malloc(size)) == NULL) {
+	if (!buf && (mode != _IONBF) && size > 0) {
+		if ((buf = (char *) malloc(size)) == NULL) {
 			retval = EOF;
 		} else {
 			stream->_flags |= _IOMYBUF;
@@ -0,0 +1,7 @@
+.sect .text
+.extern	__ktrace
+.define	_ktrace
+.align 2
+
+_ktrace:
+	jmp	__ktrace
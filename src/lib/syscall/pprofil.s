@@ -0,0 +1,7 @@
+.sect .text
+.extern	__pprofil
+.define	_pprofil
+.align 2
+
+_pprofil:
+	jmp	__pprofil
@@ -0,0 +1,7 @@
+.sect .text
+.extern	__profil
+.define	_profil
+.align 2
+
+_profil:
+	jmp	__profil
@@ -0,0 +1,21 @@
+#include "syslib.h"
+
+PUBLIC int sys_ktrace(proc, req, buf, count, total_p)
+int proc;			/* process to copy the events to */
+int req;			/* KTRACE_START, KTRACE_STOP, or KTRACE_READ */
+char *buf;			/* buffer for the events */
+long count;			/* room in the buffer, in events */
+long *total_p;			/* events recorded since the start */
+{
+/* Control the kernel trace ring. */
+  message m;
+  int r;
+
+  m.m2_i1 = proc;
+  m.m2_i2 = req;
+  m.m2_p1 = buf;
+  m.m2_l1 = count;
+  r = _taskcall(SYSTASK, SYS_KTRACE, &m);
+  if (total_p) *total_p = m.m2_l2;
+  return(r);
+}
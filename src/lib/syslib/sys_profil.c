@@ -0,0 +1,21 @@
+#include "syslib.h"
+
+PUBLIC int sys_profil(proc, owner, buf, size, offset, scale)
+int proc;			/* process to profile */
+int owner;			/* process with the buffer */
+char *buf;			/* buffer of counters */
+long size;			/* size of the buffer in bytes */
+long offset;			/* lowest pc counted */
+unsigned scale;			/* pc to counter scale, 0 to stop */
+{
+/* Start or stop profiling a process. */
+  message m;
+
+  m.m2_i1 = proc;
+  m.m2_i2 = owner;
+  m.m2_i3 = scale;
+  m.m2_l1 = offset;
+  m.m2_l2 = size;
+  m.m2_p1 = buf;
+  return(_taskcall(SYSTASK, SYS_PROFIL, &m));
+}
@@ -29,10 +29,18 @@
 #define reboot_flag	mm_in.m1_i1
 #define reboot_code	mm_in.m1_p1
 #define reboot_size	mm_in.m1_i2
+#define kt_buf		mm_in.m2_p1
+#define kt_count	mm_in.m2_l1
+#define prof_who	mm_in.m2_i1
+#define prof_scale	mm_in.m2_i3
+#define prof_off	mm_in.m2_l1
+#define prof_size	mm_in.m2_l2
+#define prof_buf	mm_in.m2_p1
 
 /* The following names are synonyms for the variables in the output message. */
 #define reply_type      mm_out.m_type
 #define reply_i1        mm_out.m2_i1
 #define reply_p1        mm_out.m2_p1
 #define ret_mask	mm_out.m2_l1 	
+#define kt_total	mm_out.m2_l2
 
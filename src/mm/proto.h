@@ -61,6 +61,8 @@ _PROTOTYPE( int do_reboot, (void)					);
 
 /* trace.c */
 _PROTOTYPE( int do_trace, (void)					);
+_PROTOTYPE( int do_ktrace, (void)					);
+_PROTOTYPE( int do_profil, (void)					);
 _PROTOTYPE( void stop_proc, (struct mproc *rmp, int sig_nr)		);
 
 /* utility.c */
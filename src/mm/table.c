@@ -92,4 +92,6 @@ _PROTOTYPE (int (*call_vec[NCALLS]), (void) ) = {
 	do_sigprocmask,	/* 74 = sigprocmask */
 	do_sigreturn,	/* 75 = sigreturn   */
 	do_reboot,	/* 76 = reboot	*/
+	do_ktrace,	/* 77 = ktrace	*/
+	do_profil,	/* 78 = profil	*/
 };
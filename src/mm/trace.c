@@ -18,9 +18,14 @@
  * The T_OK and T_EXIT commands are handled here, and the T_RESUME and
  * T_STEP commands are partially handled here and completed by the system
  * task. The rest are handled entirely by the system task. 
+ *
+ * The ktrace call that reads out the kernel trace ring and the profil call
+ * that samples the program counter of a process are passed on to the system
+ * task too.
  */
 
 #include "mm.h"
+#include <minix/com.h>
 #include <sys/ptrace.h>
 #include <signal.h>
 #include "mproc.h"
@@ -107,3 +112,55 @@ int signo;
   }
   return;
 }
+
+
+/*===========================================================================*
+ *				do_ktrace  				     *
+ *===========================================================================*/
+PUBLIC int do_ktrace()
+{
+/* Start, stop or read out the kernel trace ring for the ktrace(8) command.
+ * The number of events recorded is returned next to the number copied.
+ */
+  long total;
+  int r;
+
+  if (mp->mp_effuid != SUPER_USER) return(EPERM);
+
+  r = sys_ktrace(who, request, kt_buf, kt_count, &total);
+  if (r == E_BAD_FCN) return(ENOSYS);	/* kernel without a trace ring */
+  kt_total = total;
+  return(r);
+}
+
+
+/*===========================================================================*
+ *				do_profil  				     *
+ *===========================================================================*/
+PUBLIC int do_profil()
+{
+/* Perform the profil(buf, bufsiz, offset, scale) system call.  The prof(1)
+ * command may also profile a process of the same user, or the superuser may
+ * profile any process or a server.  The counts go into the caller's buffer.
+ */
+  register struct mproc *rmp;
+  int proc_nr, r;
+
+  if (prof_who == PROF_SELF) {
+	proc_nr = who;
+  } else if (prof_who < 0) {
+	proc_nr = -1 - prof_who;
+	if (proc_nr >= LOW_USER) return(ESRCH);
+	if (mp->mp_effuid != SUPER_USER) return(EPERM);
+  } else {
+	if ((rmp = findproc(prof_who)) == NIL_MPROC) return(ESRCH);
+	if (mp->mp_effuid != SUPER_USER && mp->mp_effuid != rmp->mp_effuid)
+		return(EPERM);
+	proc_nr = (int) (rmp - mproc);
+  }
+
+  r = sys_profil(proc_nr, who, prof_buf, prof_size, prof_off,
+						(unsigned) prof_scale);
+  if (r == E_BAD_FCN) return(ENOSYS);	/* kernel without profiling */
+  return(r);
+}
@@ -0,0 +1,56 @@
+/* conspeed: console output speed */
+
+/* Write lines of text to the console, a buffer full at a time like cat(1)
+ * does, and report how many lines per second were put on the screen.  Run
+ * it on the console itself: "conspeed [lines]".
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#define LINES		2000	/* default number of lines */
+
+char buf[4096];
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  long lines, i;
+  int n;
+  clock_t t0, t1;
+  struct tms tms;
+
+  lines = argc == 2 ? atol(argv[1]) : LINES;
+  if (lines <= 0) {
+	fprintf(stderr, "Usage: conspeed [lines]\n");
+	exit(1);
+  }
+
+  n = 0;
+  t0 = times(&tms);
+  for (i = 0; i < lines; i++) {
+	sprintf(buf + n, "line %6ld of a long log file, %s\n", i,
+		"written to see how fast the console scrolls");
+	n += strlen(buf + n);
+	if (n > sizeof(buf) - 100) {
+		(void) write(1, buf, n);
+		n = 0;
+	}
+  }
+  if (n > 0) (void) write(1, buf, n);
+  t1 = times(&tms);
+
+  if (t1 == t0) t1++;
+  printf("%ld lines in %ld.%02ld s, %ld lines/s\n", lines,
+	(long) (t1 - t0) / CLK_TCK, (long) (t1 - t0) * 100 / CLK_TCK % 100,
+	lines * CLK_TCK / (t1 - t0));
+  return(0);
+}
@@ -0,0 +1,169 @@
+/* curspeed: curses output */
+
+/* Run a script of screen updates through curses, the way a pager, a log
+ * viewer and an editor scroll, and count the bytes each part sends to the
+ * terminal.  On a serial line that is what the time goes to.  The output
+ * goes to a scratch file, not to the screen.
+ * Usage: "curspeed [terminal]", the terminal type defaults to $TERM.
+ */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <curses.h>
+#include <stdio.h>
+
+#define NTEXT		300	/* lines of text to show */
+#define STEPS		60	/* updates per part */
+
+char *words[] = {
+  "the", "file", "system", "process", "memory", "kernel", "of", "a", "to",
+  "is", "in", "block", "inode", "buffer", "read", "write", "error", "and",
+  "directory", "0x1F00", "42", "--", "/usr/lib", "mm", "fs", "tty", "{",
+  "}", "int", "char", "return", "EINVAL",
+};
+
+#define NWORDS	(sizeof(words) / sizeof(words[0]))
+
+char *text[NTEXT];
+char *scratch;
+long total, last;
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void maketext, (void));
+_PROTOTYPE(void page, (int top));
+_PROTOTYPE(void report, (char *what));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, k;
+  char *term;
+
+  if (argc > 2) {
+	fprintf(stderr, "Usage: curspeed [terminal]\n");
+	exit(1);
+  }
+  if (argc == 2) {
+	term = (char *) malloc(strlen(argv[1]) + 6);
+	sprintf(term, "TERM=%s", argv[1]);
+	putenv(term);
+  }
+  maketext();
+  scratch = tmpnam((char *) NULL);
+  if (freopen(scratch, "w", stdout) == NULL) {
+	perror(scratch);
+	exit(1);
+  }
+  if (initscr() == NULL) {
+	fprintf(stderr, "curspeed: can't initialize the terminal\n");
+	exit(1);
+  }
+  fprintf(stderr, "%d x %d screen\n", COLS, LINES);
+
+  /* Fill the screen. */
+  page(0);
+  report("paint");
+
+  /* A pager going forward, then back, a line at a time. */
+  for (k = 1; k <= STEPS; k++) page(k);
+  report("line down");
+  for (k = STEPS - 1; k >= 0; k--) page(k);
+  report("line up");
+
+  /* Half a screen at a time. */
+  for (k = 0, i = 0; i < STEPS / 4; i++) page(k += LINES / 2);
+  report("half page");
+
+  /* An editor inserting and deleting lines in the middle. */
+  for (i = 0; i < STEPS; i++) {
+	move(LINES / 3, 0);
+	if (i % 2 == 0) {
+		insertln();
+		mvaddstr(LINES / 3, 0, text[i]);
+	} else {
+		deleteln();
+	}
+	refresh();
+  }
+  report("insert/delete");
+
+  /* Output that scrolls the whole window, like tail -f. */
+  clear();
+  refresh();
+  last = ftell(stdout);
+  scrollok(stdscr, TRUE);
+  move(LINES - 1, 0);
+  for (i = 0; i < STEPS; i++) {
+	addstr(text[i]);
+	addch('\n');
+	refresh();
+  }
+  report("scroll");
+
+  endwin();
+  fclose(stdout);
+  unlink(scratch);
+  fprintf(stderr, "%-16s %8ld bytes\n", "total", total);
+  return(0);
+}
+
+void maketext()
+{
+/* Make lines of words picked at random, the same ones every time. */
+  unsigned long seed = 1;
+  char line[256];
+  int i, len;
+  char *w;
+
+  for (i = 0; i < NTEXT; i++) {
+	sprintf(line, "%3d ", i);
+	len = strlen(line);
+	for (;;) {
+		seed = seed * 1103515245L + 12345;
+		w = words[(int) ((seed >> 16) % NWORDS)];
+		if (len + strlen(w) + 1 > 78 || (seed >> 8) % 17 == 0) break;
+		strcpy(line + len, w);
+		len += strlen(w);
+		line[len++] = ' ';
+		line[len] = '\0';
+	}
+	text[i] = (char *) malloc(len + 1);
+	strcpy(text[i], line);
+  }
+}
+
+void page(top)
+int top;
+{
+/* Show the text from line 'top' on, with a status line at the bottom. */
+  int i;
+  char status[40];
+
+  for (i = 0; i < LINES - 1; i++) {
+	move(i, 0);
+	clrtoeol();
+	if (top + i < NTEXT) mvaddstr(i, 0, text[top + i]);
+  }
+  sprintf(status, "-- line %d --", top);
+  move(LINES - 1, 0);
+  clrtoeol();
+  standout();
+  addstr(status);
+  standend();
+  refresh();
+}
+
+void report(what)
+char *what;
+{
+  long n;
+
+  fflush(stdout);
+  n = ftell(stdout);
+  fprintf(stderr, "%-16s %8ld bytes\n", what, n - last);
+  total += n - last;
+  last = n;
+}
@@ -0,0 +1,131 @@
+/* flospeed: floating point speed */
+
+/* Time the four operations on doubles and floats, conversions between long
+ * and double, and a bit of arithmetic the way awk or bc does it, and report
+ * the operations per second for each.  On a machine without an FPU this is
+ * the speed of the software floating point in libfp.  Each operation is done
+ * on every pair of ten values from 1e-7 to 6e23, of both signs, so the rates
+ * include the loop and the loads of the operands.  The calculator line works
+ * out a cubic and a square root in six Newton steps, and counts that as 25
+ * operations.  The times are in clock ticks of real time, so run it on an
+ * idle system.  Usage: "flospeed [rounds]".
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <time.h>
+#include <stdio.h>
+
+#ifndef CLK_TCK				/* to run it elsewhere too */
+#define CLK_TCK		sysconf(_SC_CLK_TCK)
+#endif
+
+#define ROUNDS		200	/* default number of rounds */
+#define NVAL		10	/* values per round */
+
+double dval[NVAL] = {
+  0.1, 0.5, 1.0, 3.14159265358979, 2.0 / 3, 100.0, 1e-7, 6.02214076e23,
+  -273.15, 1234.5678
+};
+float fval[NVAL];
+long lval[NVAL] = {
+  0, 7, 42, 365, 1024, 32767, 65535L, 123456L, 2147483647L, -86400L
+};
+double dsum;
+float fsum;
+long lsum;
+long rounds;
+clock_t t0;
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void start, (void));
+_PROTOTYPE(void stop, (char *what, long n));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  long r;
+  int i, j;
+  double x, y;
+
+  rounds = argc == 2 ? atol(argv[1]) : ROUNDS;
+  if (rounds <= 0) {
+	fprintf(stderr, "Usage: flospeed [rounds]\n");
+	exit(1);
+  }
+  for (i = 0; i < NVAL; i++) fval[i] = dval[i];
+
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		for (j = 0; j < NVAL; j++) dsum = dval[i] + dval[j];
+  stop("double +", rounds * NVAL * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		for (j = 0; j < NVAL; j++) dsum = dval[i] - dval[j];
+  stop("double -", rounds * NVAL * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		for (j = 0; j < NVAL; j++) dsum = dval[i] * dval[j];
+  stop("double *", rounds * NVAL * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		for (j = 0; j < NVAL; j++) dsum = dval[i] / dval[j];
+  stop("double /", rounds * NVAL * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		for (j = 0; j < NVAL; j++) fsum = fval[i] * fval[j];
+  stop("float *", rounds * NVAL * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		for (j = 0; j < NVAL; j++) fsum = fval[i] / fval[j];
+  stop("float /", rounds * NVAL * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		for (j = 0; j < NVAL; j++) lsum = (long) (dsum = lval[i]);
+  stop("long <-> double", rounds * NVAL * NVAL);
+
+  /* What a calculator does: a polynomial and a square root. */
+  start();
+  for (r = 0; r < rounds; r++) {
+	for (i = 0; i < NVAL; i++) {
+		x = dval[i] < 0 ? -dval[i] : dval[i];
+		y = ((0.25 * x - 1.5) * x + 3.0) * x + 7.0;
+		if (y < 0) y = -y;
+		for (j = 0, x = 1.0; j < 6; j++) x = (x + y / x) * 0.5;
+		dsum += x;
+	}
+  }
+  stop("calculator", rounds * NVAL * 25);
+  return(0);
+}
+
+void start()
+{
+  struct tms tms;
+
+  t0 = times(&tms);
+}
+
+void stop(what, n)
+char *what;
+long n;
+{
+  clock_t t1;
+  struct tms tms;
+
+  t1 = times(&tms);
+  if (t1 == t0) t1++;
+  printf("%-16s %4ld.%02ld s, %8ld operations/s\n", what,
+	(long) (t1 - t0) / CLK_TCK, (long) (t1 - t0) * 100 / CLK_TCK % 100,
+	n * CLK_TCK / (t1 - t0));
+}
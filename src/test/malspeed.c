@@ -0,0 +1,200 @@
+/* malspeed: malloc stress and speed */
+
+/* Allocate, resize and free a lot of blocks of random sizes, check that
+ * the blocks keep their contents, and report how many calls per second
+ * were done and how far the heap grew.  Usage:
+ *
+ *	malspeed [-n calls] [-s slots] [-w trace]	random calls
+ *	malspeed -t trace				replay a trace
+ *
+ * A trace has one call per line: "m slot size" for malloc(), "r slot size"
+ * for realloc() and "f slot" for free().  With -w the random calls are
+ * written to a trace, so that a trace can be taken from one malloc and
+ * replayed with another, or be made by hand from the calls of a program.
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#define CALLS		20000L	/* default number of calls */
+#define SLOTS		100	/* default number of blocks at once */
+#define MAXSLOTS	2000
+
+char *block[MAXSLOTS];		/* the blocks */
+size_t size[MAXSLOTS];		/* and their sizes */
+int slots = SLOTS;
+long ncalls;
+FILE *trace;
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void usage, (void));
+_PROTOTYPE(size_t randsize, (void));
+_PROTOTYPE(int call, (int op, int slot, size_t n));
+_PROTOTYPE(void fill, (int slot, size_t from));
+_PROTOTYPE(int check, (int slot, size_t n));
+_PROTOTYPE(void fail, (char *what, int slot));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  long calls = CALLS, n, line;
+  int i, c, op, slot;
+  char cop;
+  unsigned long sz;
+  char *replay = NULL, *record = NULL, buf[80];
+  char *heap0, *heap1;
+  clock_t t0, t1;
+  struct tms tms;
+
+  for (i = 1; i < argc; i++) {
+	if (argv[i][0] != '-' || argv[i][2] != '\0' || i + 1 == argc) usage();
+	c = argv[i][1];
+	i++;
+	switch (c) {
+	    case 'n':	calls = atol(argv[i]);	break;
+	    case 's':	slots = atoi(argv[i]);	break;
+	    case 't':	replay = argv[i];	break;
+	    case 'w':	record = argv[i];	break;
+	    default:	usage();
+	}
+  }
+  if (calls <= 0 || slots <= 0 || slots > MAXSLOTS) usage();
+
+  heap0 = sbrk(0);
+  if (replay != NULL) {
+	if ((trace = fopen(replay, "r")) == NULL) fail("can't open trace", 0);
+	t0 = times(&tms);
+	line = 0;
+	while (fgets(buf, sizeof(buf), trace) != NULL) {
+		line++;
+		sz = 0;
+		if (sscanf(buf, " %c %d %lu", &cop, &slot, &sz) < 2
+				|| slot < 0 || slot >= MAXSLOTS) {
+			fprintf(stderr, "malspeed: %s, line %ld: bad call\n",
+				replay, line);
+			exit(1);
+		}
+		if (!call(cop, slot, (size_t) sz)) fail("bad call", slot);
+	}
+	fclose(trace);
+	trace = NULL;
+  } else {
+	if (record != NULL && (trace = fopen(record, "w")) == NULL)
+		fail("can't create trace", 0);
+	srand(1);
+	t0 = times(&tms);
+	for (n = 0; n < calls; n++) {
+		slot = rand() % slots;
+		op = block[slot] == NULL ? 'm' : rand() % 4 == 0 ? 'r' : 'f';
+		(void) call(op, slot, op == 'f' ? 0 : randsize());
+	}
+	if (trace != NULL && fclose(trace) != 0) fail("can't write trace", 0);
+	trace = NULL;
+  }
+  for (slot = 0; slot < MAXSLOTS; slot++)
+	if (block[slot] != NULL) (void) call('f', slot, (size_t) 0);
+  t1 = times(&tms);
+  heap1 = sbrk(0);
+
+  if (t1 == t0) t1++;
+  printf("%ld calls in %ld.%02ld s, %ld calls/s, heap grew %ld bytes\n",
+	ncalls, (long) (t1 - t0) / CLK_TCK,
+	(long) (t1 - t0) * 100 / CLK_TCK % 100,
+	ncalls * CLK_TCK / (t1 - t0), (long) (heap1 - heap0));
+  return(0);
+}
+
+void usage()
+{
+  fprintf(stderr,
+	"Usage: malspeed [-n calls] [-s slots] [-w trace] | [-t trace]\n");
+  exit(1);
+}
+
+size_t randsize()
+{
+/* Mostly small blocks, like strings and list nodes, and a few big ones. */
+  switch (rand() % 16) {
+      case 0:		return((size_t) (rand() % 4096 + 1));
+      case 1:
+      case 2:		return((size_t) (rand() % 512 + 1));
+      default:		return((size_t) (rand() % 48 + 1));
+  }
+}
+
+int call(op, slot, n)
+int op, slot;
+size_t n;
+{
+/* Do one call on a slot, and check the contents of the block. */
+  char *p;
+  size_t old;
+
+  if (trace != NULL) {
+	if (op == 'f')
+		fprintf(trace, "f %d\n", slot);
+	else
+		fprintf(trace, "%c %d %lu\n", op, slot, (unsigned long) n);
+  }
+  ncalls++;
+  switch (op) {
+      case 'm':
+	if (block[slot] != NULL || n == 0) return(0);
+	if ((block[slot] = malloc(n)) == NULL) fail("out of memory", slot);
+	size[slot] = n;
+	fill(slot, (size_t) 0);
+	return(1);
+      case 'r':
+	if (block[slot] == NULL || n == 0) return(0);
+	if ((p = realloc(block[slot], n)) == NULL) fail("out of memory", slot);
+	block[slot] = p;
+	old = size[slot];
+	if (!check(slot, n < old ? n : old)) fail("realloc lost data", slot);
+	size[slot] = n;
+	if (n > old) fill(slot, old);
+	return(1);
+      case 'f':
+	if (block[slot] == NULL) return(0);
+	if (!check(slot, size[slot])) fail("block overwritten", slot);
+	free(block[slot]);
+	block[slot] = NULL;
+	return(1);
+  }
+  return(0);
+}
+
+void fill(slot, from)
+int slot;
+size_t from;
+{
+  char *p = block[slot];
+  size_t i;
+
+  for (i = from; i < size[slot]; i++) p[i] = (char) (slot + i);
+}
+
+int check(slot, n)
+int slot;
+size_t n;
+{
+  char *p = block[slot];
+  size_t i;
+
+  for (i = 0; i < n; i++)
+	if (p[i] != (char) (slot + i)) return(0);
+  return(1);
+}
+
+void fail(what, slot)
+char *what;
+int slot;
+{
+  fprintf(stderr, "malspeed: %s (slot %d, call %ld)\n", what, slot, ncalls);
+  exit(1);
+}
@@ -0,0 +1,112 @@
+/* prtspeed: printf speed */
+
+/* Time sprintf() on the kinds of numbers that programs print, the way
+ * log messages and tables print them, and report the conversions per second
+ * for each.  The integers are ten longs from -86400 to 2^31-1 in %d, %ld
+ * and %8lx, and in a log message with a string.  The doubles are ten values
+ * from 1e-7 to 6e23 in %g, %.2f, %e and %.17g.  They get a tenth of the
+ * rounds, because a double takes about ten times as long as a long.
+ * Usage: "prtspeed [rounds]".
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#ifndef CLK_TCK				/* to run it elsewhere too */
+#define CLK_TCK		sysconf(_SC_CLK_TCK)
+#endif
+
+#define ROUNDS		2000	/* default number of rounds */
+#define NVAL		10	/* values per round */
+
+long lval[NVAL] = {
+  0, 7, 42, 365, 1024, 32767, 65535L, 123456L, 2147483647L, -86400L
+};
+double dval[NVAL] = {
+  0.0, 0.1, 0.5, 1.0, 3.14159265358979, 2.0 / 3, 100.0, 1e-7, 6.02214076e23,
+  -273.15
+};
+char buf[400];
+long rounds;
+clock_t t0;
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void start, (void));
+_PROTOTYPE(void stop, (char *what, long n));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  long r;
+  int i;
+
+  rounds = argc == 2 ? atol(argv[1]) : ROUNDS;
+  if (rounds <= 0) {
+	fprintf(stderr, "Usage: prtspeed [rounds]\n");
+	exit(1);
+  }
+
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++) sprintf(buf, "%d", (int) lval[i]);
+  stop("%d     ", rounds * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++) sprintf(buf, "%ld", lval[i]);
+  stop("%ld    ", rounds * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++) sprintf(buf, "%8lx", lval[i]);
+  stop("%8lx   ", rounds * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++)
+		sprintf(buf, "pid %d: %s at %ld", i, "event", lval[i]);
+  stop("message", rounds * NVAL);
+
+  rounds = (rounds + 9) / 10;		/* doubles are slower */
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++) sprintf(buf, "%g", dval[i]);
+  stop("%g     ", rounds * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++) sprintf(buf, "%.2f", dval[i]);
+  stop("%.2f   ", rounds * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++) sprintf(buf, "%e", dval[i]);
+  stop("%e     ", rounds * NVAL);
+  start();
+  for (r = 0; r < rounds; r++)
+	for (i = 0; i < NVAL; i++) sprintf(buf, "%.17g", dval[i]);
+  stop("%.17g  ", rounds * NVAL);
+  return(0);
+}
+
+void start()
+{
+  struct tms tms;
+
+  t0 = times(&tms);
+}
+
+void stop(what, n)
+char *what;
+long n;
+{
+  clock_t t1;
+  struct tms tms;
+
+  t1 = times(&tms);
+  if (t1 == t0) t1++;
+  printf("%s %4ld.%02ld s, %8ld conversions/s\n", what,
+	(long) (t1 - t0) / CLK_TCK, (long) (t1 - t0) * 100 / CLK_TCK % 100,
+	n * CLK_TCK / (t1 - t0));
+}
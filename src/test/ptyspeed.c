@@ -0,0 +1,117 @@
+/* ptyspeed: pty input speed */
+
+/* Let a child write data into a pty, read it from the tty side, and report
+ * how many bytes per second came through.  This is done once in transparent
+ * raw mode, where TTY stores input without looking at it, and once with
+ * ISIG set, where every character is inspected.  "ptyspeed [kbytes]"
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <sys/wait.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <time.h>
+#include <stdio.h>
+
+#define KBYTES		128	/* default kilobytes per run */
+
+int pty_fd, tty_fd;
+char pty_name[] = "/dev/ptyp0";
+char tty_name[] = "/dev/ttyp0";
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void run, (char *what, int lflag, long n));
+_PROTOTYPE(void open_pty, (void));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  long n;
+
+  n = (argc == 2 ? atol(argv[1]) : KBYTES) * 1024;
+  if (n <= 0) {
+	fprintf(stderr, "Usage: ptyspeed [kbytes]\n");
+	exit(1);
+  }
+  open_pty();
+  run("raw:      ", 0, n);
+  run("processed:", ISIG, n);
+  return(0);
+}
+
+void run(what, lflag, n)
+char *what;
+int lflag;
+long n;
+{
+/* Pass n bytes through the pty with the given local flags. */
+  char buf[512];
+  struct termios tc;
+  struct tms tms;
+  clock_t t0, t1;
+  long left, got;
+  int pid, status, r;
+
+  if (tcgetattr(tty_fd, &tc) != 0) {
+	perror("ptyspeed: tcgetattr");
+	exit(1);
+  }
+  tc.c_lflag &= ~(ICANON | IEXTEN | ISIG | ECHO | ECHOE | ECHOK | ECHONL);
+  tc.c_lflag |= lflag;
+  tc.c_iflag &= ~(ISTRIP | IGNCR | ICRNL | INLCR | IXON | IXOFF | IXANY);
+  tc.c_cc[VMIN] = 1;
+  tc.c_cc[VTIME] = 0;
+  if (tcsetattr(tty_fd, TCSANOW, &tc) != 0) {
+	perror("ptyspeed: tcsetattr");
+	exit(1);
+  }
+
+  t0 = times(&tms);
+  switch (pid = fork()) {
+      case -1:
+	perror("ptyspeed: fork");
+	exit(1);
+      case 0:
+	for (left = n; left > 0; left -= r) {
+		r = left < sizeof(buf) ? (int) left : sizeof(buf);
+		if ((r = write(pty_fd, buf, r)) <= 0) exit(1);
+	}
+	exit(0);
+  }
+  for (got = 0; got < n; got += r) {
+	if ((r = read(tty_fd, buf, sizeof(buf))) <= 0) {
+		perror("ptyspeed: read");
+		exit(1);
+	}
+  }
+  (void) wait(&status);
+  t1 = times(&tms);
+
+  if (t1 == t0) t1++;
+  printf("%s %ld bytes in %ld.%02ld s, %ld bytes/s\n", what, n,
+	(long) (t1 - t0) / CLK_TCK, (long) (t1 - t0) * 100 / CLK_TCK % 100,
+	n / (t1 - t0) * CLK_TCK);
+}
+
+void open_pty()
+{
+/* Find a free pty pair. */
+  int i;
+
+  for (i = 0; i < 16; i++) {
+	pty_name[9] = tty_name[9] = i < 10 ? '0' + i : 'a' + i - 10;
+	if ((pty_fd = open(pty_name, O_RDWR)) >= 0) break;
+  }
+  if (pty_fd < 0) {
+	fprintf(stderr, "ptyspeed: can't open a pty\n");
+	exit(1);
+  }
+  if ((tty_fd = open(tty_name, O_RDWR)) < 0) {
+	fprintf(stderr, "ptyspeed: can't open %s\n", tty_name);
+	exit(1);
+  }
+}
@@ -0,0 +1,144 @@
+/* regspeed: regexp speed */
+
+/* Time regexec() with a set of patterns, from plain strings the way grep
+ * is mostly used to ones that make a backtracking matcher work hard, on a
+ * corpus of lines made up here, and report the lines per second for each.
+ * The corpus is 200 lines of up to 80 characters, words picked by a fixed
+ * random sequence.  Every 20th line is a run of a's that "(a+)+b" and
+ * "(a|ab|abab)*bb" nearly match.  Each pattern is compiled once, outside
+ * the timing, so the rates are those of regexec() alone.
+ * Usage: "regspeed [rounds]".
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <regexp.h>
+#include <stdio.h>
+
+#ifndef CLK_TCK				/* to run it elsewhere too */
+#define CLK_TCK		sysconf(_SC_CLK_TCK)
+#endif
+
+#define ROUNDS		10	/* default number of rounds */
+#define LINES		200	/* lines in the corpus */
+#define LINELEN		80	/* longest line */
+
+char *words[] = {
+  "the", "file", "system", "process", "memory", "kernel", "of", "a", "to",
+  "is", "in", "block", "inode", "buffer", "read", "write", "error", "and",
+  "directory", "0x1F00", "42", "3.14", "/usr/lib", "mm", "fs", "tty", "{",
+  "}", "int", "char", "return", "EINVAL", "aaaa", "ab", "abab", "bba",
+};
+
+#define NWORDS	(sizeof(words) / sizeof(words[0]))
+
+char *pats[] = {
+  "kernel",				/* plain string */
+  "inode buffer",			/* two words */
+  "^the",				/* anchored */
+  "error$",				/* at the end */
+  "[0-9]+\\.[0-9]+",			/* a number */
+  "(read|write) (error|block)",		/* alternatives */
+  "[A-Z][A-Z]+",			/* a class */
+  "f.*s.*t",				/* wild cards */
+  "(a+)+b",				/* hard for backtracking */
+  "(a|ab|abab)*bb",			/* that too */
+};
+
+char line[LINES][LINELEN + 1];
+long rounds;
+clock_t t0;
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void corpus, (void));
+_PROTOTYPE(void start, (void));
+_PROTOTYPE(void stop, (char *what, long matches));
+_PROTOTYPE(void regerror, (char *message));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  regexp *r;
+  long n, matches;
+  int i, p;
+
+  rounds = argc == 2 ? atol(argv[1]) : ROUNDS;
+  if (rounds <= 0) {
+	fprintf(stderr, "Usage: regspeed [rounds]\n");
+	exit(1);
+  }
+  corpus();
+
+  for (p = 0; p < sizeof(pats) / sizeof(pats[0]); p++) {
+	if ((r = regcomp(pats[p])) == NULL) exit(1);
+	matches = 0;
+	start();
+	for (n = 0; n < rounds; n++) {
+		for (i = 0; i < LINES; i++) matches += regexec(r, line[i], 1);
+	}
+	stop(pats[p], matches / rounds);
+	free(r);
+  }
+  return(0);
+}
+
+void corpus()
+{
+/* Make lines of words picked at random, the same ones every time. */
+  unsigned long seed = 1;
+  int i, len;
+  char *w;
+
+  for (i = 0; i < LINES; i++) {
+	len = 0;
+	for (;;) {
+		seed = seed * 1103515245L + 12345;
+		w = words[(int) ((seed >> 16) % NWORDS)];
+		if (len + strlen(w) + 1 > LINELEN || (seed >> 8) % 13 == 0)
+			break;
+		if (len > 0) line[i][len++] = ' ';
+		strcpy(line[i] + len, w);
+		len += strlen(w);
+	}
+	line[i][len] = '\0';
+  }
+
+  /* Some lines where backtracking goes wrong. */
+  for (i = 0; i < LINES; i += 20) {
+	memset(line[i], 'a', (size_t) 16);
+	strcpy(line[i] + 16, i % 40 == 0 ? "c" : "ababababbc");
+  }
+}
+
+void start()
+{
+  struct tms tms;
+
+  t0 = times(&tms);
+}
+
+void stop(what, matches)
+char *what;
+long matches;
+{
+  clock_t t1;
+  struct tms tms;
+
+  t1 = times(&tms);
+  if (t1 == t0) t1++;
+  printf("%-28s %3ld of %d lines %4ld.%02ld s, %8ld lines/s\n", what,
+	matches, LINES,
+	(long) (t1 - t0) / CLK_TCK, (long) (t1 - t0) * 100 / CLK_TCK % 100,
+	rounds * LINES * CLK_TCK / (t1 - t0));
+}
+
+void regerror(message)
+char *message;
+{
+  fprintf(stderr, "regspeed: %s\n", message);
+}
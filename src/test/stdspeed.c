@@ -0,0 +1,130 @@
+/* stdspeed: stdio throughput */
+
+/* Write a file through stdio with putc(), then with fwrite() in small and
+ * in large pieces, read it back the same ways, and report how many kilobytes
+ * per second each way moves.  The data read back is checked too.  Usage:
+ * "stdspeed [kilobytes]".
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#define KBYTES		256	/* default file size */
+#define SMALL		100	/* small pieces, less than a buffer */
+#define LARGE		8192	/* large pieces, more than a buffer */
+#define FILENAME	"StdSpeed.tmp"
+
+char buf[LARGE];
+long kbytes;
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void wr, (char *how, size_t piece));
+_PROTOTYPE(void rd, (char *how, size_t piece));
+_PROTOTYPE(void report, (char *how, clock_t t0));
+_PROTOTYPE(void fail, (char *what));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  kbytes = argc == 2 ? atol(argv[1]) : KBYTES;
+  if (kbytes <= 0) {
+	fprintf(stderr, "Usage: stdspeed [kilobytes]\n");
+	exit(1);
+  }
+
+  wr("putc  ", (size_t) 0);
+  rd("getc  ", (size_t) 0);
+  wr("fwrite", (size_t) SMALL);
+  rd("fread ", (size_t) SMALL);
+  wr("fwrite", (size_t) LARGE);
+  rd("fread ", (size_t) LARGE);
+  (void) unlink(FILENAME);
+  return(0);
+}
+
+void wr(how, piece)
+char *how;
+size_t piece;
+{
+/* Write the file, a byte or a piece at a time. */
+  FILE *fp;
+  long n, total;
+  size_t k;
+  clock_t t0;
+  struct tms tms;
+
+  if ((fp = fopen(FILENAME, "w")) == NULL) fail("can't create");
+  total = kbytes * 1024;
+  t0 = times(&tms);
+  for (n = 0; n < total; n += k) {
+	if (piece == 0) {
+		if (putc((int) (n % 251), fp) == EOF) fail("putc");
+		k = 1;
+	} else {
+		k = total - n < piece ? (size_t) (total - n) : piece;
+		memset(buf, (int) (n / piece % 251), k);
+		if (fwrite(buf, (size_t) 1, k, fp) != k) fail("fwrite");
+	}
+  }
+  if (fclose(fp) != 0) fail("fclose");
+  report(how, t0);
+}
+
+void rd(how, piece)
+char *how;
+size_t piece;
+{
+/* Read the file back and check it. */
+  FILE *fp;
+  long n, total;
+  size_t k, i;
+  int c;
+  clock_t t0;
+  struct tms tms;
+
+  if ((fp = fopen(FILENAME, "r")) == NULL) fail("can't open");
+  total = kbytes * 1024;
+  t0 = times(&tms);
+  for (n = 0; n < total; n += k) {
+	if (piece == 0) {
+		if ((c = getc(fp)) != (int) (n % 251)) fail("getc");
+		k = 1;
+	} else {
+		k = total - n < piece ? (size_t) (total - n) : piece;
+		if (fread(buf, (size_t) 1, k, fp) != k) fail("fread");
+		for (i = 0; i < k; i++)
+			if (buf[i] != (char) (n / piece % 251)) fail("fread");
+	}
+  }
+  if (getc(fp) != EOF || !feof(fp)) fail("end of file");
+  (void) fclose(fp);
+  report(how, t0);
+}
+
+void report(how, t0)
+char *how;
+clock_t t0;
+{
+  clock_t t1;
+  struct tms tms;
+
+  t1 = times(&tms);
+  if (t1 == t0) t1++;
+  printf("%s %5ld kb in %3ld.%02ld s, %6ld kb/s\n", how, kbytes,
+	(long) (t1 - t0) / CLK_TCK, (long) (t1 - t0) * 100 / CLK_TCK % 100,
+	kbytes * CLK_TCK / (t1 - t0));
+}
+
+void fail(what)
+char *what;
+{
+  fprintf(stderr, "stdspeed: %s failed\n", what);
+  (void) unlink(FILENAME);
+  exit(1);
+}
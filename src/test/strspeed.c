@@ -0,0 +1,163 @@
+/* strspeed: string routine speed */
+
+/* Time strlen(), strchr(), memchr(), memcmp() and strstr() on a string of
+ * 4000 bytes, each next to a byte loop in C that does the same, and report
+ * the kilobytes per second each one gets through.  Every call has to read
+ * the whole string: strchr() and memchr() look for a byte that is not in
+ * it, memcmp() compares it with an equal copy, and strstr() looks for a
+ * pattern that is not in it, in text made of the pattern's own letters so
+ * that partial matches are frequent.  Usage: "strspeed [rounds]".
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <time.h>
+#include <stdio.h>
+
+#ifndef CLK_TCK				/* to run it elsewhere too */
+#define CLK_TCK		sysconf(_SC_CLK_TCK)
+#endif
+
+#define ROUNDS		200	/* default number of rounds */
+#define LEN		4000	/* length of the string */
+
+char str[LEN + 1], str2[LEN + 1];
+char pat[] = "a pattern that is not in there";
+long rounds;
+clock_t t0;
+volatile long sink;
+
+_PROTOTYPE(int main, (int argc, char *argv[]));
+_PROTOTYPE(void start, (void));
+_PROTOTYPE(void stop, (char *what));
+_PROTOTYPE(size_t b_strlen, (char *s));
+_PROTOTYPE(char *b_strchr, (char *s, int c));
+_PROTOTYPE(char *b_memchr, (char *s, int c, size_t n));
+_PROTOTYPE(int b_memcmp, (char *s, char *t, size_t n));
+_PROTOTYPE(char *b_strstr, (char *s, char *p));
+
+int main(argc, argv)
+int argc;
+char *argv[];
+{
+  long r;
+  int i;
+
+  rounds = argc == 2 ? atol(argv[1]) : ROUNDS;
+  if (rounds <= 0) {
+	fprintf(stderr, "Usage: strspeed [rounds]\n");
+	exit(1);
+  }
+
+  /* Text that looks a bit like the pattern, so that it is no walkover. */
+  for (i = 0; i < LEN; i++) str[i] = pat[i % (sizeof(pat) - 1) / 2 * 2];
+  str[LEN] = 0;
+  strcpy(str2, str);
+
+  start();
+  for (r = 0; r < rounds; r++) sink += strlen(str);
+  stop("strlen       ");
+  start();
+  for (r = 0; r < rounds; r++) sink += b_strlen(str);
+  stop("byte strlen  ");
+
+  start();
+  for (r = 0; r < rounds; r++) sink += strchr(str, 'z') != NULL;
+  stop("strchr       ");
+  start();
+  for (r = 0; r < rounds; r++) sink += b_strchr(str, 'z') != NULL;
+  stop("byte strchr  ");
+
+  start();
+  for (r = 0; r < rounds; r++) sink += memchr(str, 'z', (size_t) LEN) != NULL;
+  stop("memchr       ");
+  start();
+  for (r = 0; r < rounds; r++) sink += b_memchr(str, 'z', (size_t) LEN) != NULL;
+  stop("byte memchr  ");
+
+  start();
+  for (r = 0; r < rounds; r++) sink += memcmp(str, str2, (size_t) LEN);
+  stop("memcmp       ");
+  start();
+  for (r = 0; r < rounds; r++) sink += b_memcmp(str, str2, (size_t) LEN);
+  stop("byte memcmp  ");
+
+  start();
+  for (r = 0; r < rounds; r++) sink += strstr(str, pat) != NULL;
+  stop("strstr       ");
+  start();
+  for (r = 0; r < rounds; r++) sink += b_strstr(str, pat) != NULL;
+  stop("byte strstr  ");
+  return(0);
+}
+
+void start()
+{
+  struct tms tms;
+
+  t0 = times(&tms);
+}
+
+void stop(what)
+char *what;
+{
+  clock_t t1;
+  struct tms tms;
+
+  t1 = times(&tms);
+  if (t1 == t0) t1++;
+  printf("%s %4ld.%02ld s, %8ld kb/s\n", what,
+	(long) (t1 - t0) / CLK_TCK, (long) (t1 - t0) * 100 / CLK_TCK % 100,
+	rounds * (LEN / 1000) * CLK_TCK / (t1 - t0));
+}
+
+size_t b_strlen(s)
+char *s;
+{
+  char *p = s;
+
+  while (*p != 0) p++;
+  return(p - s);
+}
+
+char *b_strchr(s, c)
+char *s;
+int c;
+{
+  for (;; s++) {
+	if (*s == (char) c) return(s);
+	if (*s == 0) return(NULL);
+  }
+}
+
+char *b_memchr(s, c, n)
+char *s;
+int c;
+size_t n;
+{
+  for (; n > 0; n--, s++)
+	if (*s == (char) c) return(s);
+  return(NULL);
+}
+
+int b_memcmp(s, t, n)
+char *s, *t;
+size_t n;
+{
+  for (; n > 0; n--, s++, t++)
+	if (*s != *t) return((*s & 0xFF) - (*t & 0xFF));
+  return(0);
+}
+
+char *b_strstr(s, p)
+char *s, *p;
+{
+  size_t n = strlen(p);
+
+  for (; *s != 0; s++)
+	if (*s == *p && strncmp(s, p, n) == 0) return(s);
+  return(NULL);
+}
@@ -0,0 +1,254 @@
+/* test41: pseudo tty input processing */
+
+/* Test the input processing of TTY through a pty pair, in particular the
+ * path that stores raw input without looking at it.  The test is skipped on
+ * a kernel without ptys (NR_PTYS is 0).  Ptyspeed measures how fast a pty
+ * passes data.
+ */
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <fcntl.h>
+#include <termios.h>
+#include <errno.h>
+#include <stdio.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	3
+#define BULK		1024	/* more than the TTY input queue holds */
+
+int errct = 0;
+int subtest = 1;
+int pty_fd, tty_fd;
+char pty_name[] = "/dev/ptyp0";
+char tty_name[] = "/dev/ttyp0";
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test41a, (void));
+_PROTOTYPE(void test41b, (void));
+_PROTOTYPE(void test41c, (void));
+_PROTOTYPE(long transfer, (long n));
+_PROTOTYPE(int open_pty, (void));
+_PROTOTYPE(void set_mode, (int lflag, int iflag, int vmin));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  sync();
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 41 ");
+  fflush(stdout);
+  if (!open_pty()) {
+	printf("(no ptys configured, test skipped) ok\n");
+	exit(0);
+  }
+
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test41a();
+	if (m & 0002) test41b();
+	if (m & 0004) test41c();
+  }
+  quit();
+}
+
+void test41a()
+{				/* Test transparent raw input. */
+  char buf[8];
+
+  subtest = 1;
+
+  /* All byte values must arrive unchanged, also when the writer has to
+   * wait for the reader to empty the input queue.
+   */
+  set_mode(0, 0, 1);
+  if (transfer((long) BULK) != BULK) e(1);
+
+  /* With MIN set the reader waits until that many bytes are there. */
+  set_mode(0, 0, 4);
+  if (write(pty_fd, "abcd", 4) != 4) e(2);
+  if (read(tty_fd, buf, sizeof(buf)) != 4) e(3);
+  if (strncmp(buf, "abcd", 4) != 0) e(4);
+}
+
+void test41b()
+{				/* Test raw input that still needs processing. */
+  char buf[8];
+  struct termios tc;
+
+  subtest = 2;
+  if (tcgetattr(tty_fd, &tc) != 0) e(1);
+
+  /* ISTRIP strips the eighth bit. */
+  set_mode(0, ISTRIP, 2);
+  buf[0] = 'A' | 0x80;
+  buf[1] = 'b';
+  if (write(pty_fd, buf, 2) != 2) e(2);
+  if (read(tty_fd, buf, sizeof(buf)) != 2) e(3);
+  if (buf[0] != 'A' || buf[1] != 'b') e(4);
+
+  /* IXON eats the STOP and START characters. */
+  set_mode(0, IXON, 2);
+  buf[0] = 'a';
+  buf[1] = tc.c_cc[VSTOP];
+  buf[2] = tc.c_cc[VSTART];
+  buf[3] = 'b';
+  if (write(pty_fd, buf, 4) != 4) e(5);
+  if (read(tty_fd, buf, sizeof(buf)) != 2) e(6);
+  if (buf[0] != 'a' || buf[1] != 'b') e(7);
+
+  /* ICRNL maps CR to LF. */
+  set_mode(0, ICRNL, 2);
+  if (write(pty_fd, "x\r", 2) != 2) e(8);
+  if (read(tty_fd, buf, sizeof(buf)) != 2) e(9);
+  if (buf[0] != 'x' || buf[1] != '\n') e(10);
+
+  /* The transparent mode must see the CR again. */
+  set_mode(0, 0, 2);
+  if (write(pty_fd, "y\r", 2) != 2) e(11);
+  if (read(tty_fd, buf, sizeof(buf)) != 2) e(12);
+  if (buf[0] != 'y' || buf[1] != '\r') e(13);
+}
+
+void test41c()
+{				/* Test canonical input. */
+  char buf[16];
+  struct termios tc;
+
+  subtest = 3;
+  if (tcgetattr(tty_fd, &tc) != 0) e(1);
+
+  /* Erase works, and a line is returned on LF. */
+  set_mode(ICANON, ICRNL, 1);
+  buf[0] = 'a';
+  buf[1] = 'b';
+  buf[2] = 'x';
+  buf[3] = tc.c_cc[VERASE];
+  buf[4] = 'c';
+  buf[5] = '\r';
+  if (write(pty_fd, buf, 6) != 6) e(2);
+  if (read(tty_fd, buf, sizeof(buf)) != 4) e(3);
+  if (strncmp(buf, "abc\n", 4) != 0) e(4);
+
+  /* Typeahead stays in the queue when going to raw mode. */
+  if (write(pty_fd, "de", 2) != 2) e(5);
+  set_mode(0, 0, 2);
+  if (read(tty_fd, buf, sizeof(buf)) != 2) e(6);
+  if (buf[0] != 'd' || buf[1] != 'e') e(7);
+}
+
+long transfer(n)
+long n;
+{
+/* Let a child write n bytes to the pty, read them from the tty, and return
+ * the number of bytes that came through.  The data must arrive unchanged.
+ */
+  char buf[512];
+  long left, got;
+  int pid, status, r, i;
+
+  switch (pid = fork()) {
+      case -1:
+	e(100);
+	return(0);
+      case 0:
+	for (i = 0; i < sizeof(buf); i++) buf[i] = i;
+	for (left = n; left > 0; left -= r) {
+		r = left < sizeof(buf) ? (int) left : sizeof(buf);
+		if ((r = write(pty_fd, buf, r)) <= 0) exit(1);
+	}
+	exit(0);
+  }
+
+  got = 0;
+  while (got < n) {
+	r = read(tty_fd, buf, sizeof(buf));
+	if (r <= 0) {
+		e(101);
+		break;
+	}
+	for (i = 0; i < r; i++) {
+		if ((buf[i] & 0xFF) != ((got + i) & 0xFF)) {
+			e(102);
+			break;
+		}
+	}
+	got += r;
+  }
+  if (wait(&status) != pid) e(103);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) e(104);
+  return(got);
+}
+
+int open_pty()
+{
+/* Find a free pty pair.  Return 0 if the kernel has no ptys. */
+  int i, busy = 0;
+
+  for (i = 0; i < 16; i++) {
+	pty_name[9] = tty_name[9] = i < 10 ? '0' + i : 'a' + i - 10;
+	if ((pty_fd = open(pty_name, O_RDWR)) >= 0) break;
+	if (errno != ENXIO && errno != ENOENT) busy = 1;
+  }
+  if (pty_fd < 0) {
+	if (!busy) return(0);
+	printf("Can't open a pty\n");
+	exit(1);
+  }
+  if ((tty_fd = open(tty_name, O_RDWR)) < 0) {
+	printf("Can't open %s\n", tty_name);
+	exit(1);
+  }
+  return(1);
+}
+
+void set_mode(lflag, iflag, vmin)
+int lflag;
+int iflag;
+int vmin;
+{
+/* Put the tty in a mode without echo and with the given flags. */
+  struct termios tc;
+
+  if (tcgetattr(tty_fd, &tc) != 0) e(200);
+  tc.c_lflag &= ~(ICANON | IEXTEN | ISIG | ECHO | ECHOE | ECHOK | ECHONL);
+  tc.c_lflag |= lflag;
+  tc.c_iflag &= ~(ISTRIP | IGNCR | ICRNL | INLCR | IXON | IXOFF | IXANY);
+  tc.c_iflag |= iflag;
+  tc.c_cc[VMIN] = vmin;
+  tc.c_cc[VTIME] = 0;
+  if (tcsetattr(tty_fd, TCSANOW, &tc) != 0) e(201);
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
@@ -0,0 +1,132 @@
+/* test42: process times */
+
+/* Test the time accounting seen through times().  Processes are billed
+ * for the time between two process switches, so a process that runs for a
+ * moment between two clock ticks is billed too, and a busy process is billed
+ * for about as long as it runs.
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <sys/wait.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <errno.h>
+#include <time.h>
+#include <stdio.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	2
+#define CHILDREN	50	/* number of short lived children */
+
+int errct = 0;
+int subtest = 1;
+volatile long spin;
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test42a, (void));
+_PROTOTYPE(void test42b, (void));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  sync();
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 42 ");
+  fflush(stdout);
+
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test42a();
+	if (m & 0002) test42b();
+  }
+  quit();
+}
+
+void test42a()
+{				/* Test the times of a busy process. */
+  struct tms t0, t1;
+  clock_t start, now, used, prev;
+
+  subtest = 1;
+
+  if ((start = times(&t0)) == (clock_t) -1) e(1);
+  prev = t0.tms_utime + t0.tms_stime;
+
+  /* Run for a second, the time used may never go back. */
+  do {
+	for (spin = 0; spin < 1000; spin++) {}
+	if ((now = times(&t1)) == (clock_t) -1) e(2);
+	used = t1.tms_utime + t1.tms_stime;
+	if (used < prev) e(3);
+	prev = used;
+  } while (now - start < CLK_TCK);
+
+  /* Nearly all of that second must be billed to us, but no more than the
+   * time that has passed.  Half of it is allowed to go to others.
+   */
+  used = (t1.tms_utime + t1.tms_stime) - (t0.tms_utime + t0.tms_stime);
+  if (used > now - start + 1) e(4);
+  if (used < (now - start) / 2) e(5);
+}
+
+void test42b()
+{				/* Test the times of short lived children. */
+  struct tms t0, t1;
+  int i, pid, status;
+
+  subtest = 2;
+
+  if (times(&t0) == (clock_t) -1) e(1);
+  for (i = 0; i < CHILDREN; i++) {
+	switch (pid = fork()) {
+	    case -1:
+		e(2);
+		break;
+	    case 0:
+		/* Run much less than a tick. */
+		for (spin = 0; spin < 100; spin++) {}
+		exit(0);
+	    default:
+		if (wait(&status) != pid) e(3);
+		if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) e(4);
+	}
+	if (errct > 0) break;
+  }
+  if (times(&t1) == (clock_t) -1) e(5);
+
+  /* The children ran between the clock ticks, but they are billed. */
+  if (t1.tms_cutime + t1.tms_cstime <= t0.tms_cutime + t0.tms_cstime) e(6);
+  if (t1.tms_cutime < t0.tms_cutime) e(7);
+  if (t1.tms_cstime < t0.tms_cstime) e(8);
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
@@ -0,0 +1,171 @@
+/* test43: profil() */
+
+/* Test the profiling of the program counter by the clock interrupt.  The
+ * test spins in a loop for a while and checks that the samples land in the
+ * counters, that they stop when profiling is turned off, and that a process
+ * can only profile its own.
+ */
+
+#include <sys/types.h>
+#include <sys/times.h>
+#include <sys/wait.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <stdio.h>
+#include <minix/config.h>
+#include <minix/const.h>
+#include <minix/com.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	2
+#define NCOUNT		1024
+
+int errct = 0;
+int subtest = 1;
+unsigned short count[NCOUNT];
+volatile long spin;
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test43a, (void));
+_PROTOTYPE(void test43b, (void));
+_PROTOTYPE(long busy, (int ticks));
+_PROTOTYPE(long sum, (void));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  sync();
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 43 ");
+  fflush(stdout);
+
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test43a();
+	if (m & 0002) test43b();
+  }
+  quit();
+}
+
+void test43a()
+{				/* Test profiling ourselves. */
+  long ticks, n;
+
+  subtest = 1;
+
+  /* Scale 0x2000 gives a counter for every 16 bytes of text. */
+  memset(count, 0, sizeof(count));
+  if (profil(count, sizeof(count), 0, 0x2000) != 0) e(1);
+  ticks = busy(CLK_TCK / 2);
+  if (profil(count, sizeof(count), 0, 0) != 0) e(2);
+
+  /* The samples are taken at the ticks that find us running, so there are
+   * about as many as the ticks of user time we used.
+   */
+  n = sum();
+  if (n == 0) e(3);
+  if (n > 2 * ticks + 2) e(4);
+  if (n < ticks / 2) e(5);
+
+  /* Nothing is counted when profiling is off. */
+  (void) busy(2);
+  if (sum() != n) e(6);
+}
+
+void test43b()
+{				/* Test profiling others. */
+  int pid, status, fd[2];
+  char c;
+
+  subtest = 2;
+
+  /* Profiling a child of the same user is allowed. */
+  if (pipe(fd) != 0) e(1);
+  switch (pid = fork()) {
+      case -1:
+	e(2);
+	return;
+      case 0:
+	if (read(fd[0], &c, 1) != 1) exit(1);
+	(void) busy(CLK_TCK / 4);
+	exit(0);
+  }
+  memset(count, 0, sizeof(count));
+  if (pprofil(pid, count, sizeof(count), 0, 0x2000) != 0) e(3);
+  if (write(fd[1], "", 1) != 1) e(4);
+  if (wait(&status) != pid) e(5);
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) e(6);
+  close(fd[0]);
+  close(fd[1]);
+  if (sum() == 0) e(7);
+
+  /* The child is gone. */
+  if (pprofil(pid, count, sizeof(count), 0, 0x2000) != -1) e(8);
+  if (errno != ESRCH) e(9);
+
+  /* A buffer outside our memory is refused. */
+  if (profil((unsigned short *) -2, 512, 0, 0x2000) != -1) e(10);
+
+  /* Only the superuser may profile a server. */
+  if (geteuid() != 0) {
+	if (pprofil(PROF_SERVER(FS_PROC_NR), count, sizeof(count), 0,
+							0x2000) != -1) e(11);
+	if (errno != EPERM) e(12);
+  }
+}
+
+long busy(ticks)
+int ticks;
+{
+/* Spin for a number of ticks of user time, return how many really passed. */
+  struct tms t0, t1;
+
+  (void) times(&t0);
+  do {
+	for (spin = 0; spin < 1000; spin++) {}
+	(void) times(&t1);
+  } while (t1.tms_utime - t0.tms_utime < ticks);
+  return((long) (t1.tms_utime - t0.tms_utime));
+}
+
+long sum()
+{
+  long n = 0;
+  int i;
+
+  for (i = 0; i < NCOUNT; i++) n += count[i];
+  return(n);
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
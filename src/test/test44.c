@@ -0,0 +1,251 @@
+/* test44: string routines */
+
+/* Compare the string and memory routines of the library, some of which
+ * look at several bytes at a time, to simple byte loops.  Every routine is
+ * tried with strings at each alignment and of every length up to a few
+ * hundred bytes, with the byte looked for at each place or not there.
+ */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	1
+#define MAXLEN		300	/* longest string tried */
+#define ALIGNS		8	/* alignments tried */
+#define BIGLEN		3000	/* long string for strstr() */
+
+int errct = 0;
+int subtest = 1;
+char buf[ALIGNS + MAXLEN + 8];
+char pat[MAXLEN + 1];
+char big[BIGLEN + 1];
+char bigpat[BIGLEN + 1];
+unsigned long seed = 1;
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test44a, (void));
+_PROTOTYPE(void test44b, (void));
+_PROTOTYPE(void test44c, (void));
+_PROTOTYPE(void fill, (char *s, int len));
+_PROTOTYPE(char *find, (char *s, size_t slen, char *p, size_t plen));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 44 ");
+  fflush(stdout);
+
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test44a();
+	if (m & 0002) test44b();
+	if (m & 0004) test44c();
+  }
+  quit();
+}
+
+void test44a()
+{				/* Test strlen, strchr, strrchr, memchr. */
+  int a, len, c, i, j;
+  char *s, *first, *last;
+
+  subtest = 1;
+
+  for (a = 0; a < ALIGNS; a++) {
+	s = buf + a;
+	for (len = 0; len <= MAXLEN; len++) {
+		fill(s, len);
+		if (strlen(s) != len) e(1);
+
+		/* Some bytes of the string, one that isn't there, and 0. */
+		for (i = 0; i <= len + 1; i += i + 8 < len ? 7 : 1) {
+			c = i < len ? s[i] & 0xFF : i == len ? 0xFF : 0;
+			first = last = NULL;
+			for (j = 0; j < len; j++) {
+				if ((s[j] & 0xFF) != c) continue;
+				if (first == NULL) first = s + j;
+				last = s + j;
+			}
+			if (c == 0) first = last = s + len;
+			if (strchr(s, c) != first) e(2);
+			if (strrchr(s, c) != last) e(3);
+			if (c != 0 && memchr(s, c, (size_t) len) != first) e(4);
+		}
+		if (errct > 0) return;
+	}
+  }
+
+  /* memchr() stops at the length, not at a zero. */
+  fill(buf, 100);
+  buf[50] = 0;
+  buf[70] = (char) 0x80;
+  if (memchr(buf, 0x80, (size_t) 70) != NULL) e(5);
+  if (memchr(buf, 0x80, (size_t) 71) != buf + 70) e(6);
+}
+
+void test44b()
+{				/* Test memcmp, strcmp. */
+  int a, b, len, i, r;
+  char *s, *t;
+
+  subtest = 2;
+
+  for (a = 0; a < 4; a++) {
+	for (b = 0; b < 4; b++) {
+		s = buf + a;
+		t = pat + b;
+		for (len = 0; len <= 64; len++) {
+			fill(s, len);
+			memcpy(t, s, (size_t) len + 1);
+			if (memcmp(s, t, (size_t) len) != 0) e(1);
+			if (strcmp(s, t) != 0) e(2);
+			for (i = 0; i < len; i++) {
+				t[i]++;
+				r = (s[i] & 0xFF) < (t[i] & 0xFF) ? -1 : 1;
+				if ((memcmp(s, t, (size_t) len) < 0) != (r < 0))
+					e(3);
+				if ((strcmp(s, t) < 0) != (r < 0)) e(4);
+				t[i]--;
+			}
+			if (errct > 0) return;
+		}
+	}
+  }
+}
+
+void test44c()
+{				/* Test strstr, memmem. */
+  int len, pos, plen, a;
+  char *s, *want;
+
+  subtest = 3;
+
+  for (a = 0; a < 4; a++) {
+	s = buf + a;
+	for (len = 0; len <= MAXLEN; len += 7) {
+		fill(s, len);
+		for (pos = 0; pos < len; pos += 11) {
+			for (plen = 1; pos + plen <= len;
+					plen += plen < 5 ? 1 : plen) {
+				memcpy(pat, s + pos, (size_t) plen);
+				pat[plen] = 0;
+				want = find(s, (size_t) len, pat, (size_t) plen);
+				if (want == NULL || want > s + pos) e(1);
+				if (strstr(s, pat) != want) e(2);
+				if (memmem(s, (size_t) len, pat, (size_t) plen)
+								!= want) e(3);
+
+				/* Almost the same, but not quite. */
+				pat[plen - 1] = pat[plen - 1] % 40 + 1;
+				want = find(s, (size_t) len, pat, (size_t) plen);
+				if (strstr(s, pat) != want) e(4);
+				if (memmem(s, (size_t) len, pat, (size_t) plen)
+								!= want) e(5);
+				if (errct > 0) return;
+			}
+		}
+	}
+  }
+
+  /* Patterns that almost match in many places. */
+  memset(buf, 'a', (size_t) MAXLEN);
+  buf[MAXLEN] = 0;
+  for (plen = 1; plen < 260; plen++) {
+	memset(pat, 'a', (size_t) plen);
+	pat[plen] = 0;
+	if (strstr(buf, pat) != (plen <= MAXLEN ? buf : NULL)) e(6);
+	pat[plen - 1] = 'b';
+	if (strstr(buf, pat) != NULL) e(7);
+	pat[0] = 'b';
+	pat[plen - 1] = 'a';
+	if (plen > 1 && strstr(buf, pat) != NULL) e(8);
+  }
+  if (strstr(buf, "") != buf) e(9);
+  if (memmem(buf, (size_t) 10, "", (size_t) 0) != buf) e(10);
+  if (memmem(buf, (size_t) 3, "aaaa", (size_t) 4) != NULL) e(11);
+
+  /* A long string, that strstr() searches in pieces: matches around the
+   * places where one piece ends and the next begins.
+   */
+  fill(big, BIGLEN);
+  for (pos = 0; pos < BIGLEN; pos++) {
+	if ((pos + 40) % 1024 >= 50) continue;
+	for (plen = 2; pos + plen <= BIGLEN; plen *= 3) {
+		memcpy(bigpat, big + pos, (size_t) plen);
+		bigpat[plen] = 0;
+		want = find(big, (size_t) BIGLEN, bigpat, (size_t) plen);
+		if (strstr(big, bigpat) != want) e(12);
+		bigpat[plen - 1] = bigpat[plen - 1] % 40 + 1;
+		want = find(big, (size_t) BIGLEN, bigpat, (size_t) plen);
+		if (strstr(big, bigpat) != want) e(13);
+		if (errct > 0) return;
+	}
+  }
+}
+
+void fill(s, len)
+char *s;
+int len;
+{
+/* Make a string of random bytes, with garbage behind the zero. */
+  int i;
+
+  for (i = 0; i < len; i++) {
+	seed = seed * 1103515245L + 12345;
+	s[i] = (char) ((seed >> 16) % 40 + 1);
+  }
+  s[len] = 0;
+  s[len + 1] = (char) 0xFF;
+  s[len + 2] = 1;
+}
+
+char *find(s, slen, p, plen)
+char *s;
+size_t slen;
+char *p;
+size_t plen;
+{
+/* The first place where p is in s, the slow way. */
+  size_t i, j;
+
+  for (i = 0; i + plen <= slen; i++) {
+	for (j = 0; j < plen && s[i + j] == p[j]; j++) {}
+	if (j == plen) return(s + i);
+  }
+  return(NULL);
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
@@ -0,0 +1,460 @@
+/* test45: regcomp() and regexec() */
+
+/* Regexec() runs a DFA first and backtracks only from where it says the
+ * first match starts.  This test checks it on a table of patterns, against
+ * the plain backtracking matcher it had before (copied below, it works on
+ * the same compiled programs) on random patterns and strings, and on
+ * patterns that used to take exponential time.
+ */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <regexp.h>
+#include <stdio.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	2
+#define NRANDOM		300	/* random patterns per iteration */
+
+int errct = 0;
+int subtest = 1;
+int regerrors;
+
+/* The old matcher. */
+#define	END	0
+#define	BOL	1
+#define	EOL	2
+#define	ANY	3
+#define	ANYOF	4
+#define	ANYBUT	5
+#define	BRANCH	6
+#define	BACK	7
+#define	EXACTLY	8
+#define	NOTHING	9
+#define	STAR	10
+#define	PLUS	11
+#define	OPEN	20
+#define	CLOSE	30
+#define	OP(p)	(*(p))
+#define	NEXT(p)	(((*((p)+1)&0377)<<8) + (*((p)+2)&0377))
+#define	OPERAND(p)	((p) + 3)
+
+char *oinput, *obol, **ostartp, **oendp;
+char *ostart[NSUBEXP], *oend[NSUBEXP];
+
+struct {
+  char *pat;
+  char *str;
+  int bol;
+  int start, end;		/* of the match, -1 if none */
+} table[] = {
+  { "abc",		"xxabcxx",	1,	2,	5 },
+  { "abc",		"xxabxx",	1,	-1,	-1 },
+  { "^abc",		"abcabc",	1,	0,	3 },
+  { "^abc",		"abcabc",	0,	-1,	-1 },
+  { "abc$",		"abcabc",	1,	3,	6 },
+  { "^$",		"",		1,	0,	0 },
+  { "^$",		"",		0,	-1,	-1 },
+  { "$",		"abc",		1,	3,	3 },
+  { "a*",		"bbb",		1,	0,	0 },
+  { "a+",		"bbaab",	1,	2,	4 },
+  { "b[^b]*b",		"abxxbxb",	1,	1,	5 },
+  { "(a|ab)(c|bcd)",	"abcd",		1,	0,	4 },
+  { "(a+)+b",		"aaaaab",	1,	0,	6 },
+  { "x(a|b)*y",		"xabay xy",	1,	0,	5 },
+  { "[0-9]+\\.[0-9]*",	"pi is 3.14.",	1,	6,	10 },
+  { "(foo|bar)baz$",	"foobaz barbaz",1,	7,	13 },
+  { "a.c",		"a\nc abc",	1,	0,	3 },
+  { "\\(",		"a(b",		1,	1,	2 },
+  { "(^a|b)c",		"xacbc",	1,	3,	5 },
+  { "(a$|b)",		"xab",		1,	2,	3 },
+};
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test45a, (void));
+_PROTOTYPE(void test45b, (void));
+_PROTOTYPE(void test45c, (void));
+_PROTOTYPE(void randpat, (char *p, int depth));
+_PROTOTYPE(int same, (regexp *r, char *s, int bol));
+_PROTOTYPE(int oldexec, (regexp *prog, char *string, int bolflag));
+_PROTOTYPE(int oldtry, (regexp *prog, char *string));
+_PROTOTYPE(int oldmatch, (char *prog));
+_PROTOTYPE(int oldrepeat, (char *p));
+_PROTOTYPE(char *oldnext, (char *p));
+_PROTOTYPE(void timeout, (int sig));
+_PROTOTYPE(void regerror, (char *message));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  sync();
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 45 ");
+  fflush(stdout);
+
+  srand(45);
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test45a();
+	if (m & 0002) test45b();
+	if (m & 0004) test45c();
+  }
+  quit();
+}
+
+void test45a()
+{				/* Test a table of patterns. */
+  regexp *r;
+  int i, n, match;
+
+  subtest = 1;
+
+  for (i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+	if ((r = regcomp(table[i].pat)) == NULL) {
+		e(1);
+		continue;
+	}
+	/* Twice, the second time with the DFA states already made. */
+	for (n = 0; n < 2; n++) {
+		match = regexec(r, table[i].str, table[i].bol);
+		if (match != (table[i].start >= 0)) e(2);
+		if (match && r->startp[0] != table[i].str + table[i].start)
+			e(3);
+		if (match && r->endp[0] != table[i].str + table[i].end)
+			e(4);
+		if (!same(r, table[i].str, table[i].bol)) e(5);
+	}
+	free(r);
+  }
+
+  /* Subexpressions come out as before. */
+  if ((r = regcomp("(a*)(b|bc)(c*)d")) == NULL) e(6);
+  if (!regexec(r, "xaabccd", 1)) e(7);
+  if (r->startp[1] == NULL || strncmp(r->startp[1], "aa", 2) != 0) e(8);
+  if (r->endp[3] - r->startp[3] != 2) e(9);
+  free(r);
+
+  /* Compile errors still are. */
+  regerrors = 0;
+  if (regcomp("(a*)*b") != NULL) e(10);
+  if (regcomp("a(b") != NULL) e(11);
+  if (regerrors != 2) e(12);
+}
+
+void test45b()
+{				/* Test random patterns against the old matcher. */
+  regexp *r[6];
+  char pat[200], str[20];
+  int i, j, k, n, len;
+
+  subtest = 2;
+
+  /* Use a few at once, more than there are DFAs kept. */
+  n = 0;
+  for (i = 0; i < NRANDOM; i++) {
+	pat[0] = '\0';
+	randpat(pat, 0);
+	regerrors = 0;
+	if ((r[n] = regcomp(pat)) == NULL) {
+		if (regerrors == 0) e(1);
+		continue;
+	}
+	if (++n < 6) continue;
+	for (j = 0; j < 8; j++) {
+		len = rand() % 16;
+		for (k = 0; k < len; k++) str[k] = "abcx"[rand() % 4];
+		str[len] = '\0';
+		for (k = 0; k < n; k++) {
+			if (!same(r[k], str, j & 1)) {
+				e(2);
+				printf("pattern \"%s\" string \"%s\"\n",
+							pat, str);
+			}
+		}
+	}
+	while (n > 0) free(r[--n]);
+  }
+  while (n > 0) free(r[--n]);
+}
+
+void test45c()
+{				/* Test patterns that used to blow up. */
+  static char *pats[] = { "(a+)+b", "(a*a)+b", "((a|b)+c)+d", "(.+.+)+x" };
+  regexp *r;
+  char str[64];
+  int i;
+
+  subtest = 3;
+
+  memset(str, 'a', 40);
+  strcpy(str + 40, "c");
+  signal(SIGALRM, timeout);
+  for (i = 0; i < sizeof(pats) / sizeof(pats[0]); i++) {
+	if ((r = regcomp(pats[i])) == NULL) {
+		e(1);
+		continue;
+	}
+	alarm(10);
+	if (regexec(r, str, 1)) e(2);
+	alarm(0);
+	free(r);
+  }
+
+  /* And that match in the end. */
+  if ((r = regcomp("(a+)+c")) == NULL) e(3);
+  alarm(10);
+  if (!regexec(r, str, 1)) e(4);
+  alarm(0);
+  if (r->startp[0] != str || r->endp[0] != str + 41) e(5);
+  free(r);
+}
+
+void randpat(p, depth)
+char *p;
+int depth;
+{
+/* Append a random pattern over a few characters. */
+  static char *atoms[] = { "a", "b", "c", ".", "[ab]", "[^a]", "ab", "^", "$" };
+  int n, a;
+
+  for (n = rand() % 3 + 1; n > 0; n--) {
+	a = rand() % 11;
+	if (a < 9) {
+		strcat(p, atoms[a]);
+	} else if (depth < 3) {
+		strcat(p, "(");
+		randpat(p, depth + 1);
+		if (rand() % 3 == 0) {
+			strcat(p, "|");
+			randpat(p, depth + 1);
+		}
+		strcat(p, ")");
+	} else {
+		strcat(p, "x");
+	}
+	switch (rand() % 6) {
+	    case 0:	strcat(p, "*");	break;
+	    case 1:	strcat(p, "+");	break;
+	    case 2:	strcat(p, "?");	break;
+	}
+  }
+  if (rand() % 4 == 0 && depth < 3) {
+	strcat(p, "|");
+	randpat(p, depth + 1);
+  }
+}
+
+int same(r, s, bol)
+regexp *r;
+char *s;
+int bol;
+{
+/* Do the old and the new matcher agree on everything? */
+  int i;
+
+  if (regexec(r, s, bol) != oldexec(r, s, bol)) return(0);
+  if (ostart[0] == NULL) return(1);
+  for (i = 0; i < NSUBEXP; i++) {
+	if (r->startp[i] != ostart[i] || r->endp[i] != oend[i]) return(0);
+  }
+  return(1);
+}
+
+/* The old regexec(), but with its own startp and endp. */
+int oldexec(prog, string, bolflag)
+regexp *prog;
+char *string;
+int bolflag;
+{
+  char *s;
+
+  ostart[0] = NULL;
+  obol = bolflag ? string : NULL;
+  if (prog->reganch) return(oldtry(prog, string));
+  s = string;
+  do {
+	if (oldtry(prog, s)) return(1);
+  } while (*s++ != '\0');
+  return(0);
+}
+
+int oldtry(prog, string)
+regexp *prog;
+char *string;
+{
+  int i;
+
+  oinput = string;
+  ostartp = ostart;
+  oendp = oend;
+  for (i = 0; i < NSUBEXP; i++) ostart[i] = oend[i] = NULL;
+  if (oldmatch(prog->program + 1)) {
+	ostart[0] = string;
+	oend[0] = oinput;
+	return(1);
+  }
+  ostart[0] = NULL;
+  return(0);
+}
+
+int oldmatch(prog)
+char *prog;
+{
+  char *scan, *next, *save, nextch;
+  int no, min, len;
+
+  for (scan = prog; scan != NULL; scan = next) {
+	next = oldnext(scan);
+	switch (OP(scan)) {
+	    case BOL:
+		if (oinput != obol) return(0);
+		break;
+	    case EOL:
+		if (*oinput != '\0') return(0);
+		break;
+	    case ANY:
+		if (*oinput == '\0') return(0);
+		oinput++;
+		break;
+	    case EXACTLY:
+		len = strlen(OPERAND(scan));
+		if (strncmp(OPERAND(scan), oinput, len) != 0) return(0);
+		oinput += len;
+		break;
+	    case ANYOF:
+		if (*oinput == '\0' || strchr(OPERAND(scan), *oinput) == NULL)
+			return(0);
+		oinput++;
+		break;
+	    case ANYBUT:
+		if (*oinput == '\0' || strchr(OPERAND(scan), *oinput) != NULL)
+			return(0);
+		oinput++;
+		break;
+	    case NOTHING:
+	    case BACK:
+		break;
+	    case BRANCH:
+		if (OP(next) != BRANCH) {
+			next = OPERAND(scan);
+			break;
+		}
+		do {
+			save = oinput;
+			if (oldmatch(OPERAND(scan))) return(1);
+			oinput = save;
+			scan = oldnext(scan);
+		} while (scan != NULL && OP(scan) == BRANCH);
+		return(0);
+	    case STAR:
+	    case PLUS:
+		nextch = OP(next) == EXACTLY ? *OPERAND(next) : '\0';
+		min = OP(scan) == STAR ? 0 : 1;
+		save = oinput;
+		for (no = oldrepeat(OPERAND(scan)); no >= min; no--) {
+			oinput = save + no;
+			if ((nextch == '\0' || *oinput == nextch)
+						&& oldmatch(next)) return(1);
+		}
+		return(0);
+	    case END:
+		return(1);
+	    default:
+		if (OP(scan) > OPEN && OP(scan) < OPEN + NSUBEXP) {
+			no = OP(scan) - OPEN;
+			save = oinput;
+			if (!oldmatch(next)) return(0);
+			if (ostartp[no] == NULL) ostartp[no] = save;
+			return(1);
+		}
+		if (OP(scan) > CLOSE && OP(scan) < CLOSE + NSUBEXP) {
+			no = OP(scan) - CLOSE;
+			save = oinput;
+			if (!oldmatch(next)) return(0);
+			if (oendp[no] == NULL) oendp[no] = save;
+			return(1);
+		}
+		e(99);
+		return(0);
+	}
+  }
+  return(0);
+}
+
+int oldrepeat(p)
+char *p;
+{
+  char *scan = oinput, *opnd = OPERAND(p);
+
+  switch (OP(p)) {
+      case ANY:
+	scan += strlen(scan);
+	break;
+      case EXACTLY:
+	while (*opnd == *scan) scan++;
+	break;
+      case ANYOF:
+	while (*scan != '\0' && strchr(opnd, *scan) != NULL) scan++;
+	break;
+      case ANYBUT:
+	while (*scan != '\0' && strchr(opnd, *scan) == NULL) scan++;
+	break;
+  }
+  return(scan - oinput);
+}
+
+char *oldnext(p)
+char *p;
+{
+  int offset = NEXT(p);
+
+  if (offset == 0) return(NULL);
+  return(OP(p) == BACK ? p - offset : p + offset);
+}
+
+void timeout(sig)
+int sig;
+{
+  e(98);
+  quit();
+}
+
+void regerror(message)
+char *message;
+{
+  regerrors++;
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
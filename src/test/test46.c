@@ -0,0 +1,282 @@
+/* test46: printf() of numbers */
+
+/* Test the conversion of integers and doubles by printf().  Integers are
+ * checked against digits made here one at a time.  Doubles are checked for
+ * round trips through strtod() at 17 digits, for correct rounding, ties to
+ * even, on values whose exact decimal form is known, and on a few values
+ * whose digits are known by heart.
+ */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	2
+#define NRANDOM		2000	/* random values per subtest */
+
+int errct = 0;
+int subtest = 1;
+
+char dblmax[] = "179769313486231570814527423731704356798070567525844996598917\
+476803157260780028538760589558632766878171540458953514382464234321326889464\
+182768467546703537516986049910576551282076245490090389328944075868508455133\
+942304583236903222948165808559332123348274797826204144723168738177180919299\
+881250404026184124858368";
+
+struct {
+  char *fmt;
+  double val;
+  char *out;
+} table[] = {
+  { "%g",	0.1,		"0.1" },
+  { "%.17g",	0.1,		"0.10000000000000001" },
+  { "%.20f",	0.1,		"0.10000000000000000555" },
+  { "%.0f",	0.5,		"0" },
+  { "%.0f",	1.5,		"2" },
+  { "%.0f",	2.5,		"2" },
+  { "%.1f",	0.25,		"0.2" },
+  { "%.1f",	0.35,		"0.3" },	/* 0.34999999999999997... */
+  { "%.2e",	1.125,		"1.12e+00" },
+  { "%e",	1e300,		"1.000000e+300" },
+  { "%g",	1e-5,		"1e-05" },
+  { "%g",	123456789.0,	"1.23457e+08" },
+  { "%g",	100.0,		"100" },
+  { "%#g",	1.0,		"1.00000" },
+  { "%.3f",	-0.0005,	"-0.001" },	/* -0.00050000000000000001 */
+  { "%10.4f",	3.14159265,	"    3.1416" },
+  { "%-+9.2f",	2.0 / 3,	"+0.67    " },
+  { "%.15g",	0.3,		"0.3" },
+  { "%.17g",	0.3,		"0.29999999999999999" },
+};
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test46a, (void));
+_PROTOTYPE(void test46b, (void));
+_PROTOTYPE(void test46c, (void));
+_PROTOTYPE(void test46d, (void));
+_PROTOTYPE(unsigned long randlong, (void));
+_PROTOTYPE(double randdouble, (void));
+_PROTOTYPE(char *digits, (unsigned long val, int base, char *s));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  sync();
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 46 ");
+  fflush(stdout);
+
+  srand(46);
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test46a();
+	if (m & 0002) test46b();
+	if (m & 0004) test46c();
+	if (m & 0010) test46d();
+  }
+  quit();
+}
+
+void test46a()
+{				/* Test integers. */
+  char buf[80], want[80], *p;
+  unsigned long v;
+  long l;
+  int i;
+
+  subtest = 1;
+
+  for (i = 0; i < NRANDOM; i++) {
+	v = randlong();
+	l = (long) v;
+
+	sprintf(buf, "%lu", v);
+	*digits(v, 10, want) = '\0';
+	if (strcmp(buf, want) != 0) e(1);
+
+	sprintf(buf, "%ld", l);
+	p = want;
+	if (l < 0) *p++ = '-';
+	*digits(l < 0 ? -(unsigned long) l : (unsigned long) l, 10, p) = '\0';
+	if (strcmp(buf, want) != 0) e(2);
+
+	sprintf(buf, "%lx", v);
+	*digits(v, 16, want) = '\0';
+	if (strcmp(buf, want) != 0) e(3);
+
+	sprintf(buf, "%lo", v);
+	*digits(v, 8, want) = '\0';
+	if (strcmp(buf, want) != 0) e(4);
+
+	sprintf(buf, "%u", (unsigned) v);
+	*digits((unsigned long) (unsigned) v, 10, want) = '\0';
+	if (strcmp(buf, want) != 0) e(5);
+  }
+
+  sprintf(buf, "%d %d %d %d", 0, 9, 10, 99);
+  if (strcmp(buf, "0 9 10 99") != 0) e(6);
+  sprintf(buf, "%d %d %d", 100, -1000, INT_MAX);
+  sprintf(want, "100 -1000 %u", (unsigned) INT_MAX);
+  if (strcmp(buf, want) != 0) e(7);
+  sprintf(buf, "%lu %ld", ULONG_MAX, LONG_MIN + 1);
+  if (strcmp(buf, "4294967295 -2147483647") != 0 &&
+		sizeof(long) == 4) e(8);
+  sprintf(buf, "%.5d|%5.3d|%-6d|%06d|%+d|% d", 42, 7, 12, -34, 5, 5);
+  if (strcmp(buf, "00042|  007|12    |-00034|+5| 5") != 0) e(9);
+  sprintf(buf, "%#x %#o %X %.0d|", 255, 8, 0xBEEF, 0);
+  if (strcmp(buf, "0xff 010 BEEF |") != 0) e(10);
+  sprintf(buf, "%b", 10);
+  if (strcmp(buf, "1010") != 0) e(11);
+}
+
+void test46b()
+{				/* Test round trips of doubles. */
+  char buf[80];
+  double x, y;
+  int i;
+
+  subtest = 2;
+
+  for (i = 0; i < NRANDOM; i++) {
+	x = randdouble();
+	sprintf(buf, "%.17g", x);
+	y = strtod(buf, (char **) NULL);
+	if (y != x) {
+		e(1);
+		printf("%s\n", buf);
+	}
+	sprintf(buf, "%.16e", x);
+	if (strtod(buf, (char **) NULL) != x) e(2);
+  }
+}
+
+void test46c()
+{				/* Test rounding of values with known digits. */
+  char buf[80], want[80];
+  unsigned long m, n, q, rem, p10;
+  double x;
+  int i, j, p, k;
+
+  subtest = 3;
+
+  /* x = m / 2^j = m * 5^j / 10^j exactly, n = m * 5^j fits in a long. */
+  for (i = 0; i < NRANDOM; i++) {
+	j = rand() % 7;
+	m = (unsigned long) rand() % 131072L;
+	x = ldexp((double) m, -j);
+	n = m;
+	for (k = 0; k < j; k++) n *= 5;
+	for (p = 0; p < j; p++) {
+		/* Round n to p decimals, to even on a tie. */
+		for (p10 = 1, k = p; k < j; k++) p10 *= 10;
+		q = n / p10;
+		rem = n % p10;
+		if (rem > p10 / 2 || (rem == p10 / 2 && (q & 1))) q++;
+		for (p10 = 1, k = 0; k < p; k++) p10 *= 10;
+		if (p == 0)
+			sprintf(want, "%lu", q);
+		else
+			sprintf(want, "%lu.%0*lu", q / p10, p, q % p10);
+		sprintf(buf, "%.*f", p, x);
+		if (strcmp(buf, want) != 0) {
+			e(1);
+			printf("%s %s\n", buf, want);
+		}
+	}
+  }
+}
+
+void test46d()
+{				/* Test values whose digits are known. */
+  char buf[400];
+  double x;
+  int i;
+
+  subtest = 4;
+
+  for (i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+	sprintf(buf, table[i].fmt, table[i].val);
+	if (strcmp(buf, table[i].out) != 0) {
+		e(1);
+		printf("%s: %s, not %s\n", table[i].fmt, buf, table[i].out);
+	}
+  }
+
+  /* All the digits of the largest double. */
+  x = ldexp(2097151.0 * 4294967296.0 + 4294967295.0, 971);
+  sprintf(buf, "%.0f", x);
+  if (strcmp(buf, dblmax) != 0) e(3);
+  sprintf(buf, "%.17g", x);
+  if (strcmp(buf, "1.7976931348623157e+308") != 0) e(4);
+
+  /* And the smallest ones. */
+  sprintf(buf, "%.6e", ldexp(1.0, -1074));
+  if (strcmp(buf, "4.940656e-324") != 0) e(5);
+  sprintf(buf, "%.17g", ldexp(1.0, -1022));
+  if (strcmp(buf, "2.2250738585072014e-308") != 0) e(6);
+}
+
+unsigned long randlong()
+{
+  unsigned long v;
+
+  v = ((unsigned long) rand() << 16) ^ (unsigned long) rand();
+  return(v >> rand() % 32);
+}
+
+double randdouble()
+{
+/* A double with random digits and a random exponent. */
+  double x;
+
+  x = (double) randlong() * 4294967296.0 + (double) randlong();
+  x = ldexp(x, rand() % 2000 - 1000);
+  return(rand() % 2 ? -x : x);
+}
+
+char *digits(val, base, s)
+unsigned long val;
+int base;
+char *s;
+{
+/* The digits of val, one division at a time. */
+  if (val >= base) s = digits(val / base, base, s);
+  *s++ = "0123456789abcdef"[val % base];
+  return(s);
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
@@ -0,0 +1,594 @@
+/* test47: floating point arithmetic */
+
+/* Test that +, -, * and / round correctly, to nearest with ties to even.
+ * A table of hard cases, with results from an IEEE machine, is checked first.
+ * Then sums, differences, products and quotients of random integers scaled
+ * by random powers of two are checked against the exact values, worked out
+ * here with integers of 16 bit digits.  Results near the underflow are among
+ * them; overflow, infinity and NaN are not.
+ */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <stdio.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	2
+#define NRANDOM		500	/* random operands per subtest */
+#define NBIG		12	/* digits of an exact value, 192 bits */
+
+typedef unsigned short big[NBIG];	/* least significant digit first */
+
+int errct = 0;
+int subtest = 1;
+
+/* A double is two longs, low one first, a float is the first long. */
+union fp {
+  double d;
+  float f;
+  unsigned long l[2];
+};
+
+struct {
+  char op;
+  int size;
+  unsigned long a[2], b[2], r[2];	/* high word first */
+} table[] = {
+  { '+', 8, 0x3FF00000, 0x00000000, 0x3CA00000, 0x00000000,
+			0x3FF00000, 0x00000000 },
+  { '+', 8, 0x3FF00000, 0x00000000, 0x3CB80000, 0x00000000,
+			0x3FF00000, 0x00000002 },
+  { '+', 8, 0x3FF00000, 0x00000001, 0x3CA00000, 0x00000000,
+			0x3FF00000, 0x00000002 },
+  { '+', 8, 0x3FF00000, 0x00000000, 0x3CA00000, 0x00000001,
+			0x3FF00000, 0x00000001 },
+  { '-', 8, 0x3FF00000, 0x00000000, 0x3C900000, 0x00000000,
+			0x3FF00000, 0x00000000 },
+  { '-', 8, 0x3FF00000, 0x00000000, 0x3C900000, 0x00000001,
+			0x3FEFFFFF, 0xFFFFFFFF },
+  { '-', 8, 0x3FF00000, 0x00000000, 0x3FEFFFFF, 0xFFFFFFFF,
+			0x3CA00000, 0x00000000 },
+  { '+', 8, 0x3FB99999, 0x9999999A, 0x3FC99999, 0x9999999A,
+			0x3FD33333, 0x33333334 },
+  { '-', 8, 0x4341C379, 0x37E08000, 0x3FF00000, 0x00000000,
+			0x4341C379, 0x37E08000 },
+  { '+', 8, 0xC0680168, 0xE6311EE2, 0xC3AF8C68, 0xCFFFFFFF,
+			0xC3AF8C68, 0xD0000001 },
+  { '+', 8, 0x3E6174C1, 0x38649475, 0x3CFF9F5E, 0x06C00328,
+			0x3E6174C1, 0x77A35083 },
+  { '-', 8, 0x425C4A99, 0x8DD2E23E, 0x3F49003F, 0xCFFFFFFF,
+			0x425C4A99, 0x8DD2E231 },
+  { '-', 8, 0x407C7003, 0xE597F52F, 0x434611F5, 0x6FFFFFFF,
+			0xC34611F5, 0x6FFFFF1B },
+  { '+', 8, 0x00100000, 0x00000000, 0x80000000, 0x00000001,
+			0x000FFFFF, 0xFFFFFFFF },
+  { '+', 8, 0x00000000, 0x00000003, 0x00000000, 0x00000005,
+			0x00000000, 0x00000008 },
+  { '-', 8, 0x7FE00000, 0x00000000, 0x7C900000, 0x00000000,
+			0x7FDFFFFF, 0xFFFFFFFF },
+  { '*', 8, 0x3FB99999, 0x9999999A, 0x40080000, 0x00000000,
+			0x3FD33333, 0x33333334 },
+  { '*', 8, 0x3FF00000, 0x00000001, 0x3FF00000, 0x00000001,
+			0x3FF00000, 0x00000002 },
+  { '*', 8, 0x3FEFFFFF, 0xFFFFFFFF, 0x3FEFFFFF, 0xFFFFFFFF,
+			0x3FEFFFFF, 0xFFFFFFFE },
+  { '*', 8, 0x3FF00000, 0x00000001, 0x3FEFFFFF, 0xFFFFFFFF,
+			0x3FF00000, 0x00000000 },
+  { '*', 8, 0x41A00000, 0x02000000, 0x41900000, 0x04000000,
+			0x43400000, 0x06000000 },
+  { '*', 8, 0x2E379528, 0x2E3601A8, 0x3EB3E356, 0xD8B55D2C,
+			0x2CFD5033, 0xE210A7AB },
+  { '*', 8, 0x54AA4EEA, 0xBFFFFFFF, 0x42DA02C3, 0x8BC6552C,
+			0x57956264, 0x6E7C5C03 },
+  { '*', 8, 0x31A6CA95, 0xA2405D9C, 0xBD3D0860, 0x3F1BE45C,
+			0xAEF4AD8E, 0xCD267FD9 },
+  { '*', 8, 0x01700000, 0x00000000, 0x3BA80000, 0x00000000,
+			0x00000000, 0x00000030 },
+  { '*', 8, 0x01780000, 0x00000000, 0x3B500000, 0x00000000,
+			0x00000000, 0x00000002 },
+  { '*', 8, 0x017C0000, 0x00000000, 0x3B400000, 0x00000000,
+			0x00000000, 0x00000001 },
+  { '*', 8, 0x1E600000, 0x00000000, 0x1E600000, 0x00000000,
+			0x00000000, 0x00000001 },
+  { '*', 8, 0x7E37E43C, 0x8800759C, 0x01A56E1F, 0xC2F8F359,
+			0x3FF00000, 0x00000000 },
+  { '*', 8, 0x7FE00000, 0x00000000, 0x3FFFFFFF, 0xFFFFFFFF,
+			0x7FEFFFFF, 0xFFFFFFFF },
+  { '/', 8, 0x3FF00000, 0x00000000, 0x40080000, 0x00000000,
+			0x3FD55555, 0x55555555 },
+  { '/', 8, 0x40000000, 0x00000000, 0x40080000, 0x00000000,
+			0x3FE55555, 0x55555555 },
+  { '/', 8, 0x3FF00000, 0x00000000, 0x40240000, 0x00000000,
+			0x3FB99999, 0x9999999A },
+  { '/', 8, 0x40240000, 0x00000000, 0x40080000, 0x00000000,
+			0x400AAAAA, 0xAAAAAAAB },
+  { '/', 8, 0x7E37E43C, 0x8800759C, 0x3E7AD7F2, 0x9ABCAF48,
+			0x7FAC7B1F, 0x3CAC7434 },
+  { '/', 8, 0x40360000, 0x00000000, 0x401C0000, 0x00000000,
+			0x40092492, 0x49249249 },
+  { '/', 8, 0xC1D5FFCF, 0x4FFFFFFF, 0xC85774F4, 0x1D35881B,
+			0x396E02F4, 0x6463C6B3 },
+  { '/', 8, 0x47D161CE, 0xAEA614CE, 0xCAAEC4C0, 0x43AB6303,
+			0xBD1213E6, 0x960DDC49 },
+  { '/', 8, 0x492A11F2, 0x5A046F4C, 0xB88F55F1, 0x1369E9C4,
+			0xD08A9F6D, 0xBB8D7801 },
+  { '/', 8, 0x27835188, 0xC502788F, 0x002E67A3, 0xEFFFFFFF,
+			0x674454FE, 0xF64E63A3 },
+  { '/', 8, 0x3FF00000, 0x00000000, 0x3FEFFFFF, 0xFFFFFFFF,
+			0x3FF00000, 0x00000001 },
+  { '/', 8, 0x3FEFFFFF, 0xFFFFFFFF, 0x3FF00000, 0x00000000,
+			0x3FEFFFFF, 0xFFFFFFFF },
+  { '/', 8, 0x3FF00000, 0x00000000, 0x3FF00000, 0x00000001,
+			0x3FEFFFFF, 0xFFFFFFFE },
+  { '/', 8, 0x00100000, 0x00000000, 0x40080000, 0x00000000,
+			0x00055555, 0x55555555 },
+  { '/', 8, 0x00000000, 0x00004000, 0x4202A05F, 0x20000000,
+			0x00000000, 0x00000000 },
+  { '/', 8, 0x433FFFFF, 0xFFFFFFFF, 0x433FFFFF, 0xFFFFFFFE,
+			0x3FF00000, 0x00000001 },
+  { '/', 8, 0x00000000, 0x00000001, 0x40000000, 0x00000000,
+			0x00000000, 0x00000000 },
+  { '/', 8, 0x00000000, 0x00000003, 0x40000000, 0x00000000,
+			0x00000000, 0x00000002 },
+  { '+', 4, 0x3F800000, 0, 0x33800000, 0,
+			0x3F800000, 0 },
+  { '+', 4, 0x3F800000, 0, 0x34400000, 0,
+			0x3F800002, 0 },
+  { '+', 4, 0xBF3E43C6, 0, 0xB3007409, 0,
+			0xBF3E43C7, 0 },
+  { '-', 4, 0x487D75AC, 0, 0x43135DFE, 0,
+			0x487D50D5, 0 },
+  { '+', 4, 0x3DCCCCCD, 0, 0x3E4CCCCD, 0,
+			0x3E99999A, 0 },
+  { '*', 4, 0x4C9DDE03, 0, 0x57E682E8, 0,
+			0x650E2631, 0 },
+  { '*', 4, 0xA1AA31F9, 0, 0x35367E13, 0,
+			0x9772A6B1, 0 },
+  { '*', 4, 0x3DCCCCCD, 0, 0x40400000, 0,
+			0x3E99999A, 0 },
+  { '/', 4, 0x3F800000, 0, 0x40400000, 0,
+			0x3EAAAAAB, 0 },
+  { '/', 4, 0xE249D71F, 0, 0x496BABBA, 0,
+			0xD85B4053, 0 },
+  { '/', 4, 0x460B5FAE, 0, 0x1DFA3527, 0,
+			0x678E99AD, 0 },
+  { '/', 4, 0x40000000, 0, 0x40400000, 0,
+			0x3F2AAAAB, 0 },
+  { '*', 4, 0x0D800000, 0, 0x31400000, 0,
+			0x00180000, 0 },
+  { '/', 4, 0x00800000, 0, 0x40A00000, 0,
+			0x0019999A, 0 },
+};
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test47a, (void));
+_PROTOTYPE(void test47b, (void));
+_PROTOTYPE(void test47c, (void));
+_PROTOTYPE(void test47d, (void));
+_PROTOTYPE(int dnearest, (double x, big n, int en, unsigned long d));
+_PROTOTYPE(int fnearest, (double x, big n, int en, unsigned long d));
+_PROTOTYPE(int nearest, (int size, unsigned long hi, unsigned long lo,
+				big n, int en, unsigned long d));
+_PROTOTYPE(void bigset, (big b, unsigned long v));
+_PROTOTYPE(void bigshl, (big b, int n));
+_PROTOTYPE(void bigadd, (big r, big x));
+_PROTOTYPE(void bigsub, (big r, big x));
+_PROTOTYPE(void bigmul, (big r, big x, big y));
+_PROTOTYPE(int bigcmp, (big x, big y));
+_PROTOTYPE(unsigned long randlong, (int bits));
+_PROTOTYPE(int randexp, (int lo, int hi));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  sync();
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 47 ");
+  fflush(stdout);
+
+  srand(47);
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test47a();
+	if (m & 0002) test47b();
+	if (m & 0004) test47c();
+	if (m & 0010) test47d();
+  }
+  quit();
+}
+
+void test47a()
+{				/* Test the table. */
+  union fp a, b, r, want;
+  int i;
+
+  subtest = 1;
+
+  for (i = 0; i < sizeof(table) / sizeof(table[0]); i++) {
+	if (table[i].size == sizeof(double)) {
+		a.l[1] = table[i].a[0];
+		a.l[0] = table[i].a[1];
+		b.l[1] = table[i].b[0];
+		b.l[0] = table[i].b[1];
+		want.l[1] = table[i].r[0];
+		want.l[0] = table[i].r[1];
+		switch (table[i].op) {
+		    case '+':	r.d = a.d + b.d;	break;
+		    case '-':	r.d = a.d - b.d;	break;
+		    case '*':	r.d = a.d * b.d;	break;
+		    case '/':	r.d = a.d / b.d;	break;
+		}
+		if (r.l[0] != want.l[0] || r.l[1] != want.l[1]) {
+			e(1);
+			printf("entry %d: %08lx %08lx\n", i, r.l[1], r.l[0]);
+		}
+	} else {
+		a.l[0] = table[i].a[0];
+		b.l[0] = table[i].b[0];
+		switch (table[i].op) {
+		    case '+':	r.f = a.f + b.f;	break;
+		    case '-':	r.f = a.f - b.f;	break;
+		    case '*':	r.f = a.f * b.f;	break;
+		    case '/':	r.f = a.f / b.f;	break;
+		}
+		if (r.l[0] != table[i].r[0]) {
+			e(2);
+			printf("entry %d: %08lx\n", i, r.l[0]);
+		}
+	}
+  }
+}
+
+void test47b()
+{				/* Test sums and differences. */
+  big n, t;
+  unsigned long a, b;
+  int i, ea, eb, en;
+  double x, y, z;
+  float fx, fy, fz;
+
+  subtest = 2;
+
+  for (i = 0; i < NRANDOM; i++) {
+	/* a * 2^ea + b * 2^eb = n * 2^en */
+	a = randlong(31);
+	b = randlong(31);
+	eb = randexp(-1074, 900);
+	ea = eb + rand() % 120 - 60;
+	if (ea < -1074) ea = -1074;
+	x = ldexp((double) a, ea);
+	y = ldexp((double) b, eb);
+	en = ea < eb ? ea : eb;
+	bigset(n, a);
+	bigshl(n, ea - en);
+	bigset(t, b);
+	bigshl(t, eb - en);
+
+	z = x + y;
+	bigadd(t, n);
+	if (!dnearest(z, t, en, 1L)) e(1);
+	bigsub(t, n);
+
+	z = x - y;
+	if (bigcmp(n, t) >= 0) {
+		bigsub(n, t);
+		if (z < 0 || !dnearest(z, n, en, 1L)) e(2);
+	} else {
+		bigsub(t, n);
+		if (z > 0 || !dnearest(-z, t, en, 1L)) e(3);
+	}
+
+	/* The same with floats. */
+	a >>= 7;
+	b >>= 7;
+	eb = randexp(-149, 75);
+	ea = eb + rand() % 50 - 25;
+	if (ea < -149) ea = -149;
+	fx = ldexp((double) a, ea);
+	fy = ldexp((double) b, eb);
+	en = ea < eb ? ea : eb;
+	bigset(n, a);
+	bigshl(n, ea - en);
+	bigset(t, b);
+	bigshl(t, eb - en);
+	fz = fx + fy;
+	bigadd(t, n);
+	if (!fnearest(fz, t, en, 1L)) e(4);
+	bigsub(t, n);
+	fz = fx - fy;
+	if (bigcmp(n, t) >= 0) {
+		bigsub(n, t);
+		if (fz < 0 || !fnearest(fz, n, en, 1L)) e(5);
+	} else {
+		bigsub(t, n);
+		if (fz > 0 || !fnearest(-fz, t, en, 1L)) e(6);
+	}
+  }
+}
+
+void test47c()
+{				/* Test products. */
+  big n, s, t;
+  unsigned long a, b;
+  int i, ea, eb;
+  double x, y, z;
+  float fz;
+
+  subtest = 3;
+
+  for (i = 0; i < NRANDOM; i++) {
+	a = randlong(31) | 1;
+	b = randlong(31) | 1;
+	ea = randexp(-1074, 450);
+	eb = randexp(-1074 - ea > -560 ? -1074 - ea : -560, 450);
+	x = ldexp((double) a, ea);
+	y = ldexp((double) b, eb);
+	bigset(s, a);
+	bigset(t, b);
+	bigmul(n, s, t);
+	z = x * y;
+	if (!dnearest(z, n, ea + eb, 1L)) e(1);
+	z = -x * y;
+	if (z > 0 || !dnearest(-z, n, ea + eb, 1L)) e(2);
+
+	a >>= 7;
+	b >>= 7;
+	ea = randexp(-149, 30);
+	eb = randexp(-100, 30);
+	bigset(s, a);
+	bigset(t, b);
+	bigmul(n, s, t);
+	fz = (float) ldexp((double) a, ea) * (float) ldexp((double) b, eb);
+	if (!fnearest(fz, n, ea + eb, 1L)) e(3);
+  }
+}
+
+void test47d()
+{				/* Test quotients. */
+  big n;
+  unsigned long a, b;
+  int i, ea, eb;
+  double z;
+  float fz;
+
+  subtest = 4;
+
+  for (i = 0; i < NRANDOM; i++) {
+	a = randlong(31);
+	b = randlong(31) | 1;
+	ea = randexp(-1074, 950);
+	eb = randexp(ea - 950 > -1074 ? ea - 950 : -1074,
+			ea + 1040 < 950 ? ea + 1040 : 950);
+	bigset(n, a);
+	z = ldexp((double) a, ea) / ldexp((double) b, eb);
+	if (!dnearest(z, n, ea - eb, b)) e(1);
+	z = ldexp((double) a, ea) / -ldexp((double) b, eb);
+	if (z > 0 || !dnearest(-z, n, ea - eb, b)) e(2);
+
+	a >>= 7;
+	b = b >> 7 | 1;
+	ea = randexp(-149, 90);
+	eb = randexp(ea - 90 > -149 ? ea - 90 : -149, 90);
+	bigset(n, a);
+	fz = (float) ldexp((double) a, ea) / (float) ldexp((double) b, eb);
+	if (!fnearest(fz, n, ea - eb, b)) e(3);
+  }
+}
+
+int dnearest(x, n, en, d)
+double x;
+big n;
+int en;
+unsigned long d;
+{
+  union fp u;
+
+  u.d = x;
+  return(nearest(sizeof(double), u.l[1], u.l[0], n, en, d));
+}
+
+int fnearest(x, n, en, d)
+double x;
+big n;
+int en;
+unsigned long d;
+{
+  union fp u;
+
+  u.f = x;
+  return(nearest(sizeof(float), u.l[0], 0L, n, en, d));
+}
+
+int nearest(size, hi, lo, n, en, d)
+int size;
+unsigned long hi, lo;
+big n;
+int en;
+unsigned long d;
+{
+/* Tell if the float or double with words hi and lo is the nearest one to
+ * n * 2^en / d, ties to even.
+ */
+  big m, a, b, h, t;
+  unsigned long f;
+  int x, ex, low, c;
+
+  if (size == sizeof(double)) {
+	x = (int) (hi >> 20) & 0x7FF;
+	f = hi & 0xFFFFFL;
+	if (x != 0) f |= 0x100000L;
+	ex = (x != 0 ? x : 1) - 1075;
+	low = x > 1 && f == 0x100000L && lo == 0;
+  } else {
+	x = (int) (hi >> 23) & 0xFF;
+	f = hi & 0x7FFFFFL;
+	if (x != 0) f |= 0x800000L;
+	ex = (x != 0 ? x : 1) - 150;
+	low = x > 1 && f == 0x800000L;
+	lo = f;
+	f = 0;
+  }
+  bigset(m, f);
+  bigshl(m, 32);
+  bigset(t, lo);
+  bigadd(m, t);
+
+  /* x = m * 2^ex, compare m * 2^ex * d = a with n * 2^en = b, scaled. */
+  bigset(t, d);
+  bigmul(a, m, t);
+  memcpy(b, n, sizeof(big));
+  bigset(h, d);				/* the gap between x and the next */
+  if (ex > en) {
+	bigshl(a, ex - en);
+	bigshl(h, ex - en);
+  } else {
+	bigshl(b, en - ex);
+  }
+  c = bigcmp(a, b);
+  if (c >= 0) {
+	bigsub(a, b);
+  } else {
+	bigsub(b, a);
+	memcpy(a, b, sizeof(big));
+  }
+
+  /* Below a power of two the gap is half as big. */
+  bigshl(a, low && c > 0 ? 2 : 1);
+  c = bigcmp(a, h);
+  return(c < 0 || (c == 0 && (lo & 1) == 0));
+}
+
+void bigset(b, v)
+big b;
+unsigned long v;
+{
+  int i;
+
+  for (i = 0; i < NBIG; i++) {
+	b[i] = v;
+	v >>= 16;
+  }
+}
+
+void bigshl(b, n)
+big b;
+int n;
+{
+  int i, w;
+  unsigned long v;
+
+  w = n / 16;
+  n %= 16;
+  for (i = NBIG - 1; i >= 0; i--) {
+	v = i >= w ? (unsigned long) b[i - w] << n : 0;
+	if (i > w) v |= (unsigned long) b[i - w - 1] << n >> 16;
+	b[i] = v;
+  }
+}
+
+void bigadd(r, x)
+big r, x;
+{
+  int i;
+  unsigned long v = 0;
+
+  for (i = 0; i < NBIG; i++) {
+	v += (unsigned long) r[i] + x[i];
+	r[i] = v;
+	v >>= 16;
+  }
+}
+
+void bigsub(r, x)
+big r, x;
+{
+/* r -= x, r >= x */
+  int i;
+  long v = 0;
+
+  for (i = 0; i < NBIG; i++) {
+	v += (long) r[i] - x[i];
+	r[i] = v;
+	v = v < 0 ? -1 : 0;
+  }
+}
+
+void bigmul(r, x, y)
+big r, x, y;
+{
+  int i, j;
+  unsigned long v;
+
+  for (i = 0; i < NBIG; i++) r[i] = 0;
+  for (i = 0; i < NBIG; i++) {
+	if (x[i] == 0) continue;
+	v = 0;
+	for (j = 0; i + j < NBIG; j++) {
+		v += (unsigned long) x[i] * y[j] + r[i + j];
+		r[i + j] = v;
+		v >>= 16;
+	}
+  }
+}
+
+int bigcmp(x, y)
+big x, y;
+{
+  int i;
+
+  for (i = NBIG - 1; i >= 0; i--) {
+	if (x[i] != y[i]) return(x[i] < y[i] ? -1 : 1);
+  }
+  return(0);
+}
+
+unsigned long randlong(bits)
+int bits;
+{
+/* A random number of at most 'bits' bits, and often fewer. */
+  unsigned long v;
+
+  v = ((unsigned long) rand() << 16) ^ ((unsigned long) rand() << 1) ^ rand();
+  v &= (1L << bits) - 1;
+  return(v >> rand() % 8 * (rand() % 4));
+}
+
+int randexp(lo, hi)
+int lo, hi;
+{
+  return(lo + (int) (((unsigned long) rand() << 8 ^ rand()) % (hi - lo + 1)));
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
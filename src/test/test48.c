@@ -0,0 +1,325 @@
+/* test48: hashed databases made by mkdb */
+
+/* Getpwnam(), getpwuid(), getgrnam(), getgrgid() and tgetent() first look
+ * in the database mkdb makes of the text file.  Every lookup must give the
+ * same answer with the database as without it, and after the text file is
+ * changed the database must be ignored.
+ */
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <limits.h>
+#include <errno.h>
+#include <utime.h>
+#include <pwd.h>
+#include <grp.h>
+#include <termcap.h>
+#include <stdio.h>
+
+#define MAX_ERROR	4
+#define ITERATIONS	2
+
+#define NNAMES		8	/* names and ids looked up */
+
+#define System(cmd)   if (system(cmd) != 0) printf("``%s'' failed\n", cmd)
+#define Chdir(dir)    if (chdir(dir) != 0) printf("Can't goto %s\n", dir)
+
+int errct = 0;
+int subtest = 1;
+
+char *pwtext = "\
+root:##root:0:0::/:\n\
+daemon:*:1:1::/etc:\n\
+bad line\n\
+bin:##root:2:0:Binaries:/usr/src:\n\
+ast:*:8:3:Andrew S. Tanenbaum:/usr/ast:/usr/bin/sh\n\
+root:*:9:9:Second root:/tmp:\n\
+other:*:2:5:Same uid as bin:/tmp:\n\
+nobody:*:0x7FFF:99::/tmp:\n";
+
+char *pwname[NNAMES] = {
+  "root", "daemon", "bin", "ast", "other", "nobody", "bad line", "nope"
+};
+int pwuid[NNAMES] = { 0, 1, 2, 8, 9, 0x7FFF, 3, 100 };
+
+char *grtext = "\
+operator:*:0:root,bin\n\
+daemon:*:1:daemon\n\
+bin::2:\n\
+other:*:3:ast,kjb,philip\n\
+operator:*:4:\n\
+also:*:3:\n\
+nogroup:*:99:\n";
+
+char *grname[NNAMES] = {
+  "operator", "daemon", "bin", "other", "also", "nogroup", "tty", ""
+};
+int grgid[NNAMES] = { 0, 1, 2, 3, 4, 99, 5, 1000 };
+
+char *tctext = "\
+# A terminal may have many names.\n\
+dumb|un|unknown:co#80:os:am:\n\
+vt100|vt100-am|dec vt100:\\\n\
+	:co#80:li#24:cl=\\E[H\\E[J:\\\n\
+	:cm=\\E[%i%d;%dH:nd=\\E[C:up=\\E[A:\n\
+\n\
+minix|minix console:li#25:co#80:tc=vt100:\n\
+dumb|dumb again:co#40:\n";
+
+char *tcname[NNAMES] = {
+  "dumb", "un", "unknown", "vt100", "dec vt100", "minix", "again", "vt10"
+};
+
+char answer[NNAMES * 2][1024];	/* lookups without a database */
+
+_PROTOTYPE(void main, (int argc, char *argv[]));
+_PROTOTYPE(void test48a, (void));
+_PROTOTYPE(void test48b, (void));
+_PROTOTYPE(void test48c, (void));
+_PROTOTYPE(void mkfile, (char *name, char *text));
+_PROTOTYPE(void touch, (char *name));
+_PROTOTYPE(void pwlookups, (int save));
+_PROTOTYPE(void grlookups, (int save));
+_PROTOTYPE(void tclookups, (int save));
+_PROTOTYPE(void check, (int i, int save, char *result));
+_PROTOTYPE(void e, (int number));
+_PROTOTYPE(void quit, (void));
+
+void main(argc, argv)
+int argc;
+char *argv[];
+{
+  int i, m = 0xFFFF;
+
+  sync();
+  if (argc == 2) m = atoi(argv[1]);
+  printf("Test 48 ");
+  fflush(stdout);
+  System("rm -rf DIR_48; mkdir DIR_48");
+  Chdir("DIR_48");
+
+  for (i = 0; i < ITERATIONS; i++) {
+	if (m & 0001) test48a();
+	if (m & 0002) test48b();
+	if (m & 0004) test48c();
+  }
+  quit();
+}
+
+void test48a()
+{				/* Test passwd. */
+  char text[1024];
+
+  subtest = 1;
+  System("rm -rf ../DIR_48/*");
+
+  mkfile("passwd", pwtext);
+  setpwfile("passwd");
+  pwlookups(1);
+  System("mkdb -p passwd");
+  if (access("passwd.db", 0) != 0) e(1);
+  pwlookups(0);
+
+  /* A passwd of the same size changed in the second mkdb ran is seen. */
+  strcpy(text, pwtext);
+  memcpy(strstr(text, "ast:"), "kjb", 3);
+  mkfile("passwd", text);
+  if (getpwnam("kjb") == NULL) e(6);
+  if (getpwnam("ast") != NULL) e(7);
+  mkfile("passwd", pwtext);
+
+  /* A changed passwd must be read again. */
+  touch("passwd");
+  pwlookups(0);
+  System("echo 'nope:*:100:1::/tmp:' >> passwd");
+  if (getpwnam("nope") == NULL) e(2);
+  if (getpwuid(100) == NULL) e(3);
+  System("mkdb -p passwd");
+  if (getpwnam("nope") == NULL) e(4);
+  if (getpwuid(100) == NULL) e(5);
+  setpwfile("/etc/passwd");
+}
+
+void test48b()
+{				/* Test group. */
+  subtest = 2;
+  System("rm -rf ../DIR_48/*");
+
+  mkfile("group", grtext);
+  setgrfile("group");
+  grlookups(1);
+  System("mkdb -g group");
+  if (access("group.db", 0) != 0) e(1);
+  grlookups(0);
+
+  touch("group");
+  grlookups(0);
+  System("echo 'tty:*:5:' >> group");
+  if (getgrnam("tty") == NULL) e(2);
+  if (getgrgid(5) == NULL) e(3);
+  System("mkdb -g group");
+  if (getgrnam("tty") == NULL) e(4);
+  if (getgrgid(5) == NULL) e(5);
+  setgrfile("/etc/group");
+}
+
+void test48c()
+{				/* Test termcap. */
+  char cwd[PATH_MAX], env[PATH_MAX + 16];
+  char bp[1024];
+
+  subtest = 3;
+  System("rm -rf ../DIR_48/*");
+
+  /* Tgetent() takes a $TERMCAP that isn't a path as the entry itself. */
+  if (getcwd(cwd, sizeof(cwd)) == NULL) e(1);
+  sprintf(env, "TERMCAP=%s/termcap", cwd);
+  if (putenv(env) != 0) e(2);
+
+  mkfile("termcap", tctext);
+  tclookups(1);
+  System("mkdb -t termcap");
+  if (access("termcap.db", 0) != 0) e(3);
+  tclookups(0);
+
+  touch("termcap");
+  tclookups(0);
+  System("echo 'vt10|almost:co#80:' >> termcap");
+  if (tgetent(bp, "vt10") != 1) e(4);
+  System("mkdb -t termcap");
+  if (tgetent(bp, "vt10") != 1) e(5);
+}
+
+void mkfile(name, text)
+char *name;
+char *text;
+{
+  FILE *fp;
+
+  if ((fp = fopen(name, "w")) == NULL) e(90);
+  if (fputs(text, fp) == EOF) e(91);
+  if (fclose(fp) != 0) e(92);
+}
+
+void touch(name)
+char *name;
+{
+/* Change the modification time, but not the size, of a text file. */
+  struct stat st;
+  struct utimbuf ut;
+
+  if (stat(name, &st) != 0) e(93);
+  ut.actime = st.st_atime;
+  ut.modtime = st.st_mtime + 1;
+  if (utime(name, &ut) != 0) e(94);
+}
+
+void pwlookups(save)
+int save;
+{
+/* Look up all users by name and by id, and save or check the answers. */
+  struct passwd *pw;
+  char result[1024];
+  int i;
+
+  for (i = 0; i < 2 * NNAMES; i++) {
+	if (i < NNAMES)
+		pw = getpwnam(pwname[i]);
+	else
+		pw = getpwuid(pwuid[i - NNAMES]);
+	if (pw == NULL)
+		strcpy(result, "none");
+	else
+		sprintf(result, "%s:%s:%d:%d:%s:%s:%s", pw->pw_name,
+			pw->pw_passwd, pw->pw_uid, pw->pw_gid, pw->pw_gecos,
+			pw->pw_dir, pw->pw_shell);
+	check(i, save, result);
+  }
+}
+
+void grlookups(save)
+int save;
+{
+/* Look up all groups by name and by id, and save or check the answers. */
+  struct group *gr;
+  char result[1024];
+  char **mem;
+  int i;
+
+  for (i = 0; i < 2 * NNAMES; i++) {
+	if (i < NNAMES)
+		gr = getgrnam(grname[i]);
+	else
+		gr = getgrgid(grgid[i - NNAMES]);
+	if (gr == NULL) {
+		strcpy(result, "none");
+	} else {
+		sprintf(result, "%s:%s:%d:", gr->gr_name, gr->gr_passwd,
+								gr->gr_gid);
+		for (mem = gr->gr_mem; *mem != NULL; mem++) {
+			strcat(result, *mem);
+			strcat(result, ",");
+		}
+	}
+	check(i, save, result);
+  }
+}
+
+void tclookups(save)
+int save;
+{
+/* Look up all terminals, and save or check the entries. */
+  char bp[1024];
+  int i, r;
+
+  for (i = 0; i < NNAMES; i++) {
+	r = tgetent(bp, tcname[i]);
+	if (r != 1) sprintf(bp, "%d", r);
+	check(i, save, bp);
+  }
+}
+
+void check(i, save, result)
+int i;
+int save;
+char *result;
+{
+  if (save)
+	strcpy(answer[i], result);
+  else if (strcmp(answer[i], result) != 0)
+	e(10 + i);
+}
+
+void e(n)
+int n;
+{
+  int err_num = errno;		/* Save in case printf clobbers it. */
+
+  printf("Subtest %d,  error %d  errno=%d: ", subtest, n, errno);
+  errno = err_num;
+  perror("");
+  if (errct++ > MAX_ERROR) {
+	printf("Too many errors; test aborted\n");
+	chdir("..");
+	system("rm -rf DIR*");
+	exit(1);
+  }
+  errno = 0;
+}
+
+void quit()
+{
+  Chdir("..");
+  System("rm -rf DIR_48");
+
+  if (errct == 0) {
+	printf("ok\n");
+	exit(0);
+  } else {
+	printf("%d errors\n", errct);
+	exit(1);
+  }
+}
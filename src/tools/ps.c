@@ -28,10 +28,12 @@
  *
  * Most fields are similar to V7 ps(1), except for CPU, NICE, PRI which are
  * absent, RECV which replaces WCHAN, and PGRP that is an extra.
- * The info is obtained from the following fields of proc, mproc and fproc:
+ * The info is obtained from the following fields of proc, mproc and fproc,
+ * merged by the memory task into one pstab record per process:
  * F	- kernel status field, p_flags
  * S	- kernel status field, p_flags; mm status field, mp_flags (R if p_flags
- *	  is 0; Z if mp_flags == HANGING; T if mp_flags == STOPPED; else W).
+ *	  is 0; Z if mp_flags == HANGING; T if mp_flags == STOPPED; S if
+ *	  waiting, paused, or suspended by fs; else W).
  * UID	- mm eff uid field, mp_effuid
  * PID	- mm pid field, mp_pid
  * PPID	- mm parent process index field, mp_parent (used as index in proc).
@@ -48,6 +50,9 @@
  *	  field), or user process argument list (obtained by reading the stack
  *	  frame; the resulting address is used to get the argument vector from
  *	  user space and converted into a concatenated argument list).
+ *
+ * The tables are fetched with one MIOCGPSTAB ioctl, so they are seen at one
+ * moment, and the tty names in /dev are only looked up if a tty is shown.
  */
 
 #include <minix/config.h>
@@ -97,6 +102,7 @@ typedef struct {
 
 ttyinfo_t *ttyinfo;		/* ttyinfo holds actual tty info */
 size_t n_ttyinfo;		/* Number of tty info slots */
+int got_names;			/* Set once gettynames has been called */
 
 /* Macro to convert memory offsets to rounded kilo-units */
 #define	off_to_k(off)	((unsigned) (((off) + 512) / 1024))
@@ -104,19 +110,16 @@ size_t n_ttyinfo;		/* Number of tty info slots */
 /* Number of tasks and processes. */
 int nr_tasks, nr_procs;
 
-/* Process tables of the kernel, MM, and FS. */
-struct proc *ps_proc;
-struct mproc *ps_mproc;
-struct fproc *ps_fproc;
+/* Snapshot of the process tables of the kernel, MM, and FS. */
+struct pstab *pstab;
 
 /* Where is INIT? */
 int init_proc_nr;
 #define low_user init_proc_nr
 
-#define	KMEM_PATH	"/dev/kmem"	/* opened for kernel proc table */
-#define	MEM_PATH	"/dev/mem"	/* opened for mm/fs + user processes */
+#define	MEM_PATH	"/dev/mem"	/* opened for the tables + user processes */
 
-int kmemfd, memfd;		/* file descriptors of [k]mem */
+int memfd;			/* file descriptor of mem */
 
 /* Short and long listing formats:
  *
@@ -158,13 +161,6 @@ struct pstat {			/* structure filled by pstat() */
   vir_bytes ps_procargs;	/* initial stack frame from MM */
 };
 
-/* Ps_state field values in pstat struct above */
-#define	Z_STATE		'Z'	/* Zombie */
-#define	W_STATE		'W'	/* Waiting */
-#define	S_STATE		'S'	/* Sleeping */
-#define	R_STATE		'R'	/* Runnable */
-#define	T_STATE		'T'	/* stopped (Trace) */
-
 _PROTOTYPE(char *tname, (Dev_t dev_nr ));
 _PROTOTYPE(char *taskname, (int p_nr ));
 _PROTOTYPE(char *prrecv, (struct pstat *bufp ));
@@ -172,8 +168,6 @@ _PROTOTYPE(void disaster, (int sig ));
 _PROTOTYPE(int main, (int argc, char *argv []));
 _PROTOTYPE(char *get_args, (struct pstat *bufp ));
 _PROTOTYPE(int pstat, (int p_nr, struct pstat *bufp ));
-_PROTOTYPE(int addrread, (int fd, phys_clicks base, vir_bytes addr, 
-						    char *buf, int nbytes ));
 _PROTOTYPE(void usage, (char *pname ));
 _PROTOTYPE(void err, (char *s ));
 _PROTOTYPE(int gettynames, (void));
@@ -192,6 +186,10 @@ Dev_t dev_nr;
 
   if (majdev(dev_nr) == TTY_MAJ && mindev(dev_nr) == 0) return "co";
 
+  if (!got_names) {
+	if (gettynames() == -1) err("Can't get tty names");
+	got_names = TRUE;
+  }
   for (i = 0; i < n_ttyinfo && ttyinfo[i].tty_name[0] != '\0'; i++)
 	if (ttyinfo[i].tty_dev == dev_nr)
 		return ttyinfo[i].tty_name + 3;
@@ -203,7 +201,7 @@ Dev_t dev_nr;
 char *taskname(p_nr)
 int p_nr;
 {
-  return ps_proc[p_nr + nr_tasks].p_name;
+  return pstab[p_nr + nr_tasks].ps_name;
 }
 
 /* Prrecv prints the RECV field for process with pstat buffer pointer bufp.
@@ -218,7 +216,7 @@ struct pstat *bufp;
   if (bufp->ps_recv == ANY) return "ANY";
 
   task = taskname(bufp->ps_recv);
-  if (bufp->ps_state != S_STATE) return task;
+  if (bufp->ps_state != PS_SLEEP) return task;
 
   blkstr = "?";
   if (bufp->ps_recv == MM_PROC_NR) {
@@ -268,6 +266,7 @@ char *argv[];
   char *mm_path;		/* mm, */
   char *fs_path;		/* and fs used in ps -U */
   struct psinfo psinfo;
+  size_t size;
 
   (void) signal(SIGSEGV, disaster);	/* catch a common crash */
 
@@ -285,44 +284,22 @@ char *argv[];
 	}
   }
 
-  /* Open memory devices and get PS info from the kernel */
-  if ((kmemfd = open(KMEM_PATH, O_RDONLY)) == -1) err(KMEM_PATH);
+  /* Open memory device and get PS info from the kernel */
   if ((memfd = open(MEM_PATH, O_RDONLY)) == -1) err(MEM_PATH);
-  if (gettynames() == -1) err("Can't get tty names");
   if (ioctl(memfd, MIOCGPSINFO, (void *) &psinfo) == -1)
 	err("can't get PS info from kernel");
   nr_tasks = psinfo.nr_tasks;
   nr_procs = psinfo.nr_procs;
 
-  /* Allocate memory for process tables */
-  ps_proc = (struct proc *) malloc((nr_tasks + nr_procs) * sizeof(ps_proc[0]));
-  ps_mproc = (struct mproc *) malloc(nr_procs * sizeof(ps_mproc[0]));
-  ps_fproc = (struct fproc *) malloc(nr_procs * sizeof(ps_fproc[0]));
-  if (ps_proc == NULL || ps_mproc == NULL || ps_fproc == NULL)
-	err("Out of memory");
-
-  /* Get kernel process table */
-  if (addrread(kmemfd, (phys_clicks) 0,
-		psinfo.proc, (char *) ps_proc,
-		(nr_tasks + nr_procs) * sizeof(ps_proc[0]))
-			!= (nr_tasks + nr_procs) * sizeof(ps_proc[0]))
-	err("Can't get kernel proc table from /dev/kmem");
-
-  /* Get mm/fs process tables */
-  if (addrread(memfd, ps_proc[nr_tasks + MM_PROC_NR].p_map[D].mem_phys,
-		psinfo.mproc, (char *) ps_mproc,
-		nr_procs * sizeof(ps_mproc[0]))
-			!= nr_procs * sizeof(ps_mproc[0]))
-	err("Can't get mm proc table from /dev/mem");
-  if (addrread(memfd, ps_proc[nr_tasks + FS_PROC_NR].p_map[D].mem_phys,
-		psinfo.fproc, (char *) ps_fproc,
-		nr_procs * sizeof(ps_fproc[0]))
-			!= nr_procs * sizeof(ps_fproc[0]))
-	err("Can't get fs proc table from /dev/mem");
+  /* Get a snapshot of the process tables */
+  size = (nr_tasks + nr_procs) * sizeof(pstab[0]);
+  if ((pstab = (struct pstab *) malloc(size)) == NULL) err("Out of memory");
+  if (ioctl(memfd, MIOCGPSTAB, (void *) pstab) == -1)
+	err("Can't get the process tables from /dev/mem");
 
   /* We need to know where INIT hangs out. */
   for (i = FS_PROC_NR; i < nr_procs; i++) {
-	if (strcmp(ps_proc[nr_tasks + i].p_name, "INIT") == 0) break;
+	if (strcmp(pstab[nr_tasks + i].ps_name, "INIT") == 0) break;
   }
   init_proc_nr = i;
 
@@ -419,82 +396,48 @@ struct pstat *bufp;
 }
 
 /* Pstat collects info on process number p_nr and returns it in buf.
- * It is assumed that tasks do not have entries in fproc/mproc.
+ * The memory task left zeros for the mm/fs fields of tasks and servers.
  */
 int pstat(p_nr, bufp)
 int p_nr;
 struct pstat *bufp;
 {
-  int p_ki = p_nr + nr_tasks;	/* kernel proc index */
+  struct pstab *pp;
 
   if (p_nr < -nr_tasks || p_nr >= nr_procs) return -1;
 
-  if ((ps_proc[p_ki].p_flags & P_SLOT_FREE)
-  				&& !(ps_mproc[p_nr].mp_flags & IN_USE))
-	return -1;
-
-  bufp->ps_flags = ps_proc[p_ki].p_flags;
-
-  if (p_nr >= low_user) {
-	bufp->ps_dev = ps_fproc[p_nr].fp_tty;
-	bufp->ps_ftask = ps_fproc[p_nr].fp_task;
-  } else {
-	bufp->ps_dev = 0;
-	bufp->ps_ftask = 0;
-  }
-
-  if (p_nr >= low_user) {
-	bufp->ps_ruid = ps_mproc[p_nr].mp_realuid;
-	bufp->ps_euid = ps_mproc[p_nr].mp_effuid;
-	bufp->ps_pid = ps_mproc[p_nr].mp_pid;
-	bufp->ps_ppid = ps_mproc[ps_mproc[p_nr].mp_parent].mp_pid;
-	bufp->ps_pgrp = ps_mproc[p_nr].mp_procgrp;
-	bufp->ps_mflags = ps_mproc[p_nr].mp_flags;
-  } else {
-	bufp->ps_pid = bufp->ps_ppid = 0;
-	bufp->ps_ruid = bufp->ps_euid = 0;
-	bufp->ps_pgrp = 0;
-	bufp->ps_mflags = 0;
-  }
-
-  /* State is interpretation of combined kernel/mm flags for non-tasks */
-  if (p_nr >= low_user) {		/* non-tasks */
-	if (ps_mproc[p_nr].mp_flags & HANGING)
-		bufp->ps_state = Z_STATE;	/* zombie */
-	else if (ps_mproc[p_nr].mp_flags & STOPPED)
-		bufp->ps_state = T_STATE;	/* stopped (traced) */
-	else if (ps_proc[p_ki].p_flags == 0)
-		bufp->ps_state = R_STATE;	/* in run-queue */
-	else if (ps_mproc[p_nr].mp_flags & (WAITING | PAUSED) ||
-		 ps_fproc[p_nr].fp_suspended == SUSPENDED)
-		bufp->ps_state = S_STATE;	/* sleeping */
-	else
-		bufp->ps_state = W_STATE;	/* a short wait */
-  } else {			/* tasks are simple */
-	if (ps_proc[p_ki].p_flags == 0)
-		bufp->ps_state = R_STATE;	/* in run-queue */
-	else
-		bufp->ps_state = W_STATE;	/* other i.e. waiting */
-  }
-
-  bufp->ps_tsize = (size_t) ps_proc[p_ki].p_map[T].mem_len << CLICK_SHIFT;
-  bufp->ps_dsize = (size_t) ps_proc[p_ki].p_map[D].mem_len << CLICK_SHIFT;
-  bufp->ps_ssize = (size_t) ps_proc[p_ki].p_map[S].mem_len << CLICK_SHIFT;
-  bufp->ps_vtext = (off_t) ps_proc[p_ki].p_map[T].mem_vir << CLICK_SHIFT;
-  bufp->ps_vdata = (off_t) ps_proc[p_ki].p_map[D].mem_vir << CLICK_SHIFT;
-  bufp->ps_vstack = (off_t) ps_proc[p_ki].p_map[S].mem_vir << CLICK_SHIFT;
-  bufp->ps_text = (off_t) ps_proc[p_ki].p_map[T].mem_phys << CLICK_SHIFT;
-  bufp->ps_data = (off_t) ps_proc[p_ki].p_map[D].mem_phys << CLICK_SHIFT;
-  bufp->ps_stack = (off_t) ps_proc[p_ki].p_map[S].mem_phys << CLICK_SHIFT;
-
-  bufp->ps_recv = ps_proc[p_ki].p_getfrom;
-
-  bufp->ps_utime = ps_proc[p_ki].user_time;
-  bufp->ps_stime = ps_proc[p_ki].sys_time;
-
-  bufp->ps_procargs = ps_mproc[p_nr].mp_procargs;
-
-  if (bufp->ps_state == Z_STATE)
+  pp = &pstab[p_nr + nr_tasks];
+  if (pp->ps_state == PS_FREE) return -1;
+
+  bufp->ps_flags = pp->ps_flags;
+  bufp->ps_dev = pp->ps_tty;
+  bufp->ps_ftask = pp->ps_ftask;
+  bufp->ps_ruid = pp->ps_ruid;
+  bufp->ps_euid = pp->ps_euid;
+  bufp->ps_pid = pp->ps_pid;
+  bufp->ps_ppid = pp->ps_ppid;
+  bufp->ps_pgrp = pp->ps_pgrp;
+  bufp->ps_mflags = pp->ps_mflags;
+  bufp->ps_state = pp->ps_state;
+
+  bufp->ps_tsize = (size_t) pp->ps_map[T].mem_len << CLICK_SHIFT;
+  bufp->ps_dsize = (size_t) pp->ps_map[D].mem_len << CLICK_SHIFT;
+  bufp->ps_ssize = (size_t) pp->ps_map[S].mem_len << CLICK_SHIFT;
+  bufp->ps_vtext = (off_t) pp->ps_map[T].mem_vir << CLICK_SHIFT;
+  bufp->ps_vdata = (off_t) pp->ps_map[D].mem_vir << CLICK_SHIFT;
+  bufp->ps_vstack = (off_t) pp->ps_map[S].mem_vir << CLICK_SHIFT;
+  bufp->ps_text = (off_t) pp->ps_map[T].mem_phys << CLICK_SHIFT;
+  bufp->ps_data = (off_t) pp->ps_map[D].mem_phys << CLICK_SHIFT;
+  bufp->ps_stack = (off_t) pp->ps_map[S].mem_phys << CLICK_SHIFT;
+
+  bufp->ps_recv = pp->ps_recv;
+
+  bufp->ps_utime = pp->ps_utime;
+  bufp->ps_stime = pp->ps_stime;
+
+  bufp->ps_procargs = pp->ps_procargs;
+
+  if (bufp->ps_state == PS_ZOMBIE)
 	bufp->ps_args = "<defunct>";
   else if (p_nr > init_proc_nr)
 	bufp->ps_args = get_args(bufp);
@@ -502,20 +445,6 @@ struct pstat *bufp;
   return 0;
 }
 
-/* Addrread reads nbytes from offset addr to click base of fd into buf. */
-int addrread(fd, base, addr, buf, nbytes)
-int fd;
-phys_clicks base;
-vir_bytes addr;
-char *buf;
-int nbytes;
-{
-  if (lseek(fd, ((off_t) base << CLICK_SHIFT) + addr, 0) < 0)
-	return -1;
-
-  return read(fd, buf, nbytes);
-}
-
 void usage(pname)
 char *pname;
 {